@@ -0,0 +1,892 @@
+#include "nftablesfirewall.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <net/if.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <functional>
+
+#include <linux/netfilter.h>
+#include <linux/netfilter/nfnetlink.h>
+#include <linux/netfilter/nf_tables.h>
+#include <libmnl/libmnl.h>
+#include <libnftnl/batch.h>
+#include <libnftnl/chain.h>
+#include <libnftnl/common.h>
+#include <libnftnl/expr.h>
+#include <libnftnl/gen.h>
+#include <libnftnl/rule.h>
+#include <libnftnl/set.h>
+#include <libnftnl/table.h>
+
+#include "../logger.h"
+
+namespace
+{
+const char *TABLE_NAME = "windscribe";
+const char *INPUT_CHAIN_NAME = "input";
+const char *OUTPUT_CHAIN_NAME = "output";
+const char *IPS4_SET_NAME = "allowed_ips4";
+const char *IPS6_SET_NAME = "allowed_ips6";
+// the sets are referred to by these ids in the batch which creates them
+const uint32_t IPS4_SET_ID = 1;
+const uint32_t IPS6_SET_ID = 2;
+// the ids of the ipv4_addr and ipv6_addr types of nft, which only nft itself uses to print the sets
+const uint32_t NFT_TYPE_IPADDR = 7;
+const uint32_t NFT_TYPE_IP6ADDR = 8;
+
+// a batch is sent in pages, every message has to fit in the overrun space of a page
+const uint32_t BATCH_PAGE_SIZE = 128 * 1024;
+const uint32_t BATCH_PAGE_OVERRUN_SIZE = 64 * 1024;
+const size_t ELEMENTS_PER_MESSAGE = 512;
+const size_t REQUEST_BUFFER_SIZE = 8192;
+const size_t RECEIVE_BUFFER_SIZE = 64 * 1024;
+const int RECEIVE_TIMEOUT_SEC = 5;
+
+// offsets of the addresses in the IPv4 and the IPv6 headers
+const uint32_t IPV4_SOURCE_OFFSET = 12;
+const uint32_t IPV4_DESTINATION_OFFSET = 16;
+const uint32_t IPV6_SOURCE_OFFSET = 8;
+const uint32_t IPV6_DESTINATION_OFFSET = 24;
+
+typedef std::array<uint8_t, 16> Address;
+
+// the addresses from |first| to |last| inclusive, in the network byte order
+struct Range
+{
+    Address first;
+    Address last;
+};
+
+bool parseRange(const std::string &str, int family, Range &range)
+{
+    const int addressBits = family == AF_INET ? 32 : 128;
+    std::string address = str;
+    int prefix = addressBits;
+    const size_t slashPos = str.find('/');
+    if (slashPos != std::string::npos)
+    {
+        address = str.substr(0, slashPos);
+        const std::string prefixStr = str.substr(slashPos + 1);
+        char *end = nullptr;
+        const long value = strtol(prefixStr.c_str(), &end, 10);
+        if (prefixStr.empty() || *end != '\0' || value < 0 || value > addressBits)
+        {
+            return false;
+        }
+        prefix = static_cast<int>(value);
+    }
+
+    range.first.fill(0);
+    if (inet_pton(family, address.c_str(), range.first.data()) != 1)
+    {
+        return false;
+    }
+    range.last = range.first;
+    for (int i = 0; i < addressBits / 8; ++i)
+    {
+        const int bits = std::min(std::max(prefix - i * 8, 0), 8);
+        const uint8_t mask = static_cast<uint8_t>(0xFF00 >> bits);
+        range.first[i] &= mask;
+        range.last[i] = range.first[i] | static_cast<uint8_t>(~mask);
+    }
+    return true;
+}
+
+// |address| + 1; false if it wraps around
+bool increment(Address &address, size_t length)
+{
+    for (size_t i = length; i-- > 0;)
+    {
+        if (++address[i] != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the ranges sorted, with the overlapping and the adjacent ones joined, as an interval set takes them
+std::vector<Range> mergeRanges(std::vector<Range> ranges, size_t length)
+{
+    std::sort(ranges.begin(), ranges.end(), [](const Range &a, const Range &b) { return a.first < b.first; });
+    std::vector<Range> merged;
+    for (const auto &range : ranges)
+    {
+        if (!merged.empty())
+        {
+            Address next = merged.back().last;
+            if (!increment(next, length) || range.first <= next)
+            {
+                merged.back().last = std::max(merged.back().last, range.last);
+                continue;
+            }
+        }
+        merged.push_back(range);
+    }
+    return merged;
+}
+
+class NetlinkSocket
+{
+public:
+    NetlinkSocket() : socket_(mnl_socket_open(NETLINK_NETFILTER)), seq_(static_cast<uint32_t>(time(nullptr)))
+    {
+        if (socket_ && mnl_socket_bind(socket_, 0, MNL_SOCKET_AUTOPID) < 0)
+        {
+            mnl_socket_close(socket_);
+            socket_ = nullptr;
+        }
+        if (socket_)
+        {
+            struct timeval timeout = { RECEIVE_TIMEOUT_SEC, 0 };
+            setsockopt(mnl_socket_get_fd(socket_), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        }
+        else
+        {
+            Logger::instance().out("nftables: can't open the netlink socket: %s", strerror(errno));
+        }
+    }
+    ~NetlinkSocket()
+    {
+        if (socket_)
+        {
+            mnl_socket_close(socket_);
+        }
+    }
+
+    bool isOpen() const { return socket_ != nullptr; }
+    uint32_t nextSeq() { return seq_++; }
+
+    bool send(const struct nlmsghdr *nlh)
+    {
+        return mnl_socket_sendto(socket_, nlh, nlh->nlmsg_len) >= 0;
+    }
+
+    bool send(struct iovec *iov, size_t iovLength)
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < iovLength; ++i)
+        {
+            size += iov[i].iov_len;
+        }
+        // the whole batch goes in one message, the send buffer has to hold it; raising the limit needs root
+        int bufferSize = static_cast<int>(size);
+        if (setsockopt(mnl_socket_get_fd(socket_), SOL_SOCKET, SO_SNDBUFFORCE, &bufferSize, sizeof(bufferSize)) < 0)
+        {
+            setsockopt(mnl_socket_get_fd(socket_), SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+        }
+
+        struct sockaddr_nl address;
+        memset(&address, 0, sizeof(address));
+        address.nl_family = AF_NETLINK;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &address;
+        msg.msg_namelen = sizeof(address);
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovLength;
+        return sendmsg(mnl_socket_get_fd(socket_), &msg, 0) >= 0;
+    }
+
+    // Reads the replies until |count| requests are answered with an error, an ack or the end of a dump, and
+    // passes the other messages to |callback|. Returns 0 or the first error, as a negative errno.
+    int receive(unsigned int count, const std::function<void(const struct nlmsghdr *)> &callback)
+    {
+        std::vector<char> buffer(RECEIVE_BUFFER_SIZE);
+        int result = 0;
+        while (count > 0)
+        {
+            int length = static_cast<int>(mnl_socket_recvfrom(socket_, buffer.data(), buffer.size()));
+            if (length < 0)
+            {
+                return result != 0 ? result : -errno;
+            }
+            for (const struct nlmsghdr *nlh = reinterpret_cast<const struct nlmsghdr *>(buffer.data());
+                 mnl_nlmsg_ok(nlh, length); nlh = mnl_nlmsg_next(nlh, &length))
+            {
+                if (nlh->nlmsg_type == NLMSG_ERROR)
+                {
+                    const struct nlmsgerr *error = static_cast<const struct nlmsgerr *>(mnl_nlmsg_get_payload(nlh));
+                    if (error->error != 0 && result == 0)
+                    {
+                        result = error->error;
+                    }
+                    count = count > 0 ? count - 1 : 0;
+                }
+                else if (nlh->nlmsg_type == NLMSG_DONE)
+                {
+                    count = count > 0 ? count - 1 : 0;
+                }
+                else if (callback)
+                {
+                    callback(nlh);
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    struct mnl_socket *socket_;
+    uint32_t seq_;
+};
+
+// Messages committed by the kernel as one transaction: either all of them are applied or none is.
+class Batch
+{
+public:
+    explicit Batch(NetlinkSocket &socket) : socket_(socket),
+        batch_(nftnl_batch_alloc(BATCH_PAGE_SIZE, BATCH_PAGE_OVERRUN_SIZE)), messagesCount_(0)
+    {
+        nftnl_batch_begin(buffer(), socket_.nextSeq());
+        nftnl_batch_update(batch_);
+    }
+    ~Batch()
+    {
+        nftnl_batch_free(batch_);
+    }
+
+    // the header of the next message, which is complete once its payload is added and next() is called
+    struct nlmsghdr *add(uint16_t type, uint16_t flags)
+    {
+        ++messagesCount_;
+        return nftnl_nlmsg_build_hdr(buffer(), type, NFPROTO_INET, flags | NLM_F_ACK, socket_.nextSeq());
+    }
+    void next()
+    {
+        nftnl_batch_update(batch_);
+    }
+
+    int commit()
+    {
+        nftnl_batch_end(buffer(), socket_.nextSeq());
+        nftnl_batch_update(batch_);
+
+        const int iovLength = nftnl_batch_iovec_len(batch_);
+        std::vector<struct iovec> iov(iovLength);
+        nftnl_batch_iovec(batch_, iov.data(), iovLength);
+        if (!socket_.send(iov.data(), iov.size()))
+        {
+            return -errno;
+        }
+        // the kernel answers every message of the batch, the begin and the end markers aside
+        return socket_.receive(messagesCount_, nullptr);
+    }
+
+private:
+    char *buffer()
+    {
+        return static_cast<char *>(nftnl_batch_buffer(batch_));
+    }
+
+    NetlinkSocket &socket_;
+    struct nftnl_batch *batch_;
+    unsigned int messagesCount_;
+};
+
+void addTable(Batch &batch, uint16_t type, uint16_t flags)
+{
+    struct nftnl_table *table = nftnl_table_alloc();
+    nftnl_table_set_str(table, NFTNL_TABLE_NAME, TABLE_NAME);
+    nftnl_table_set_u32(table, NFTNL_TABLE_FAMILY, NFPROTO_INET);
+    nftnl_table_nlmsg_build_payload(batch.add(type, flags), table);
+    nftnl_table_free(table);
+    batch.next();
+}
+
+// the chain drops whatever its rules don't accept
+void addChain(Batch &batch, const char *name, uint32_t hook)
+{
+    struct nftnl_chain *chain = nftnl_chain_alloc();
+    nftnl_chain_set_str(chain, NFTNL_CHAIN_TABLE, TABLE_NAME);
+    nftnl_chain_set_str(chain, NFTNL_CHAIN_NAME, name);
+    nftnl_chain_set_u32(chain, NFTNL_CHAIN_FAMILY, NFPROTO_INET);
+    nftnl_chain_set_str(chain, NFTNL_CHAIN_TYPE, "filter");
+    nftnl_chain_set_u32(chain, NFTNL_CHAIN_HOOKNUM, hook);
+    nftnl_chain_set_s32(chain, NFTNL_CHAIN_PRIO, 0);
+    nftnl_chain_set_u32(chain, NFTNL_CHAIN_POLICY, NF_DROP);
+    nftnl_chain_nlmsg_build_payload(batch.add(NFT_MSG_NEWCHAIN, NLM_F_CREATE), chain);
+    nftnl_chain_free(chain);
+    batch.next();
+}
+
+struct nftnl_set *allocSet(const char *name, uint32_t id)
+{
+    struct nftnl_set *set = nftnl_set_alloc();
+    nftnl_set_set_str(set, NFTNL_SET_TABLE, TABLE_NAME);
+    nftnl_set_set_str(set, NFTNL_SET_NAME, name);
+    nftnl_set_set_u32(set, NFTNL_SET_FAMILY, NFPROTO_INET);
+    nftnl_set_set_u32(set, NFTNL_SET_ID, id);
+    return set;
+}
+
+// An interval set of the |ranges|. The kernel takes the intervals as their starts and the elements past their
+// ends flagged as the interval ends; like nft, the tree starts with the end of an interval at the zero address.
+void addSet(Batch &batch, const char *name, uint32_t id, uint32_t keyType, uint32_t keyLength,
+            const std::vector<Range> &ranges)
+{
+    struct nftnl_set *set = allocSet(name, id);
+    nftnl_set_set_u32(set, NFTNL_SET_KEY_TYPE, keyType);
+    nftnl_set_set_u32(set, NFTNL_SET_KEY_LEN, keyLength);
+    nftnl_set_set_u32(set, NFTNL_SET_FLAGS, NFT_SET_INTERVAL);
+    nftnl_set_nlmsg_build_payload(batch.add(NFT_MSG_NEWSET, NLM_F_CREATE), set);
+    nftnl_set_free(set);
+    batch.next();
+
+    std::vector<std::pair<Address, bool>> elements;
+    const Address zero = Address();
+    if (!ranges.empty() && ranges.front().first != zero)
+    {
+        elements.push_back(std::make_pair(zero, true));
+    }
+    for (const auto &range : ranges)
+    {
+        elements.push_back(std::make_pair(range.first, false));
+        Address end = range.last;
+        if (increment(end, keyLength))
+        {
+            elements.push_back(std::make_pair(end, true));
+        }
+    }
+
+    for (size_t begin = 0; begin < elements.size(); begin += ELEMENTS_PER_MESSAGE)
+    {
+        set = allocSet(name, id);
+        const size_t end = std::min(begin + ELEMENTS_PER_MESSAGE, elements.size());
+        for (size_t i = begin; i < end; ++i)
+        {
+            struct nftnl_set_elem *element = nftnl_set_elem_alloc();
+            nftnl_set_elem_set(element, NFTNL_SET_ELEM_KEY, elements[i].first.data(), keyLength);
+            if (elements[i].second)
+            {
+                nftnl_set_elem_set_u32(element, NFTNL_SET_ELEM_FLAGS, NFT_SET_ELEM_INTERVAL_END);
+            }
+            nftnl_set_elem_add(set, element);
+        }
+        nftnl_set_elems_nlmsg_build_payload(batch.add(NFT_MSG_NEWSETELEM, NLM_F_CREATE), set);
+        nftnl_set_free(set);
+        batch.next();
+    }
+}
+
+// A rule made of the matches added one after another, every match loads the value to compare to register 1.
+class Rule
+{
+public:
+    explicit Rule(const char *chain) : rule_(nftnl_rule_alloc())
+    {
+        nftnl_rule_set_str(rule_, NFTNL_RULE_TABLE, TABLE_NAME);
+        nftnl_rule_set_str(rule_, NFTNL_RULE_CHAIN, chain);
+        nftnl_rule_set_u32(rule_, NFTNL_RULE_FAMILY, NFPROTO_INET);
+    }
+    ~Rule()
+    {
+        nftnl_rule_free(rule_);
+    }
+
+    Rule &interface(bool isInput, const std::string &name)
+    {
+        char data[IFNAMSIZ] = {};
+        strncpy(data, name.c_str(), IFNAMSIZ - 1);
+        addMeta(isInput ? NFT_META_IIFNAME : NFT_META_OIFNAME);
+        addCmp(data, IFNAMSIZ);
+        return *this;
+    }
+
+    Rule &address(int family, bool isSource, const Range &range)
+    {
+        const uint32_t length = family == AF_INET ? 4 : 16;
+        addFamily(family);
+        addPayload(family, isSource, length);
+        Address mask;
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            mask[i] = static_cast<uint8_t>(~(range.first[i] ^ range.last[i]));
+        }
+        if (range.first != range.last)
+        {
+            const Address zero = Address();
+            struct nftnl_expr *expr = nftnl_expr_alloc("bitwise");
+            nftnl_expr_set_u32(expr, NFTNL_EXPR_BITWISE_SREG, NFT_REG_1);
+            nftnl_expr_set_u32(expr, NFTNL_EXPR_BITWISE_DREG, NFT_REG_1);
+            nftnl_expr_set_u32(expr, NFTNL_EXPR_BITWISE_LEN, length);
+            nftnl_expr_set(expr, NFTNL_EXPR_BITWISE_MASK, mask.data(), length);
+            nftnl_expr_set(expr, NFTNL_EXPR_BITWISE_XOR, zero.data(), length);
+            nftnl_rule_add_expr(rule_, expr);
+        }
+        addCmp(range.first.data(), length);
+        return *this;
+    }
+
+    Rule &lookup(int family, bool isSource, const char *setName, uint32_t setId)
+    {
+        addFamily(family);
+        addPayload(family, isSource, family == AF_INET ? 4 : 16);
+        struct nftnl_expr *expr = nftnl_expr_alloc("lookup");
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_LOOKUP_SREG, NFT_REG_1);
+        nftnl_expr_set_str(expr, NFTNL_EXPR_LOOKUP_SET, setName);
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_LOOKUP_SET_ID, setId);
+        nftnl_rule_add_expr(rule_, expr);
+        return *this;
+    }
+
+    void accept(Batch &batch)
+    {
+        struct nftnl_expr *expr = nftnl_expr_alloc("immediate");
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_IMM_DREG, NFT_REG_VERDICT);
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_IMM_VERDICT, NF_ACCEPT);
+        nftnl_rule_add_expr(rule_, expr);
+        nftnl_rule_nlmsg_build_payload(batch.add(NFT_MSG_NEWRULE, NLM_F_CREATE | NLM_F_APPEND), rule_);
+        batch.next();
+    }
+
+private:
+    void addMeta(uint32_t key)
+    {
+        struct nftnl_expr *expr = nftnl_expr_alloc("meta");
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_META_KEY, key);
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_META_DREG, NFT_REG_1);
+        nftnl_rule_add_expr(rule_, expr);
+    }
+
+    void addCmp(const void *data, uint32_t length)
+    {
+        struct nftnl_expr *expr = nftnl_expr_alloc("cmp");
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_CMP_SREG, NFT_REG_1);
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_CMP_OP, NFT_CMP_EQ);
+        nftnl_expr_set(expr, NFTNL_EXPR_CMP_DATA, data, length);
+        nftnl_rule_add_expr(rule_, expr);
+    }
+
+    // the addresses can only be loaded from the headers of the family of the table, inet has both
+    void addFamily(int family)
+    {
+        const uint8_t nfproto = family == AF_INET ? NFPROTO_IPV4 : NFPROTO_IPV6;
+        addMeta(NFT_META_NFPROTO);
+        addCmp(&nfproto, sizeof(nfproto));
+    }
+
+    void addPayload(int family, bool isSource, uint32_t length)
+    {
+        uint32_t offset;
+        if (family == AF_INET)
+            offset = isSource ? IPV4_SOURCE_OFFSET : IPV4_DESTINATION_OFFSET;
+        else
+            offset = isSource ? IPV6_SOURCE_OFFSET : IPV6_DESTINATION_OFFSET;
+        struct nftnl_expr *expr = nftnl_expr_alloc("payload");
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_PAYLOAD_BASE, NFT_PAYLOAD_NETWORK_HEADER);
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_PAYLOAD_OFFSET, offset);
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_PAYLOAD_LEN, length);
+        nftnl_expr_set_u32(expr, NFTNL_EXPR_PAYLOAD_DREG, NFT_REG_1);
+        nftnl_rule_add_expr(rule_, expr);
+    }
+
+    struct nftnl_rule *rule_;
+};
+
+// FNV-1a, of what the kernel dumps of the table
+class Fingerprint
+{
+public:
+    Fingerprint() : value_(14695981039346656037ULL) {}
+
+    void add(const void *data, size_t length)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < length; ++i)
+        {
+            value_ = (value_ ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+    void add(const std::string &str)
+    {
+        // the length too, so that the strings can't run into each other
+        const uint64_t length = str.size();
+        add(&length, sizeof(length));
+        add(str.data(), str.size());
+    }
+
+    uint64_t value() const { return value_; }
+
+private:
+    uint64_t value_;
+};
+
+// adds the elements of the set, with their flags, to |fingerprint|; false if the set can't be read
+bool addSetElements(const char *name, Fingerprint &fingerprint)
+{
+    NetlinkSocket socket;
+    if (!socket.isOpen())
+    {
+        return false;
+    }
+    char buffer[REQUEST_BUFFER_SIZE];
+    struct nlmsghdr *nlh = nftnl_nlmsg_build_hdr(buffer, NFT_MSG_GETSETELEM, NFPROTO_INET, NLM_F_DUMP | NLM_F_ACK,
+                                                 socket.nextSeq());
+    struct nftnl_set *filter = nftnl_set_alloc();
+    nftnl_set_set_str(filter, NFTNL_SET_TABLE, TABLE_NAME);
+    nftnl_set_set_str(filter, NFTNL_SET_NAME, name);
+    nftnl_set_elems_nlmsg_build_payload(nlh, filter);
+    nftnl_set_free(filter);
+    if (!socket.send(nlh))
+    {
+        return false;
+    }
+
+    fingerprint.add(std::string(name));
+    // the elements come in the order of the set, which doesn't depend on the order they were added in
+    const int error = socket.receive(1, [&fingerprint](const struct nlmsghdr *reply) {
+        struct nftnl_set *set = nftnl_set_alloc();
+        if (nftnl_set_elems_nlmsg_parse(reply, set) == 0)
+        {
+            struct nftnl_set_elems_iter *iter = nftnl_set_elems_iter_create(set);
+            for (struct nftnl_set_elem *element = nftnl_set_elems_iter_next(iter); element;
+                 element = nftnl_set_elems_iter_next(iter))
+            {
+                uint32_t length = 0;
+                const void *key = nftnl_set_elem_get(element, NFTNL_SET_ELEM_KEY, &length);
+                if (key)
+                {
+                    fingerprint.add(key, length);
+                }
+                const uint32_t flags = nftnl_set_elem_is_set(element, NFTNL_SET_ELEM_FLAGS) ?
+                                       nftnl_set_elem_get_u32(element, NFTNL_SET_ELEM_FLAGS) : 0;
+                fingerprint.add(&flags, sizeof(flags));
+            }
+            nftnl_set_elems_iter_destroy(iter);
+        }
+        nftnl_set_free(set);
+    });
+    return error == 0;
+}
+
+Range makeRange(const char *cidr)
+{
+    Range range;
+    parseRange(cidr, AF_INET, range);
+    return range;
+}
+
+void addRules(Batch &batch, const NftablesFirewall::Settings &settings)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        const bool isInput = i == 0;
+        const char *chain = isInput ? INPUT_CHAIN_NAME : OUTPUT_CHAIN_NAME;
+
+        Rule(chain).interface(isInput, "lo").accept(batch);
+        if (!settings.interfaceToSkip.empty())
+        {
+            Rule(chain).interface(isInput, settings.interfaceToSkip).accept(batch);
+        }
+        Rule(chain).lookup(AF_INET, isInput, IPS4_SET_NAME, IPS4_SET_ID).accept(batch);
+        Rule(chain).lookup(AF_INET6, isInput, IPS6_SET_NAME, IPS6_SET_ID).accept(batch);
+
+        if (settings.allowLan)
+        {
+            // Local Network
+            for (const char *cidr : { "192.168.0.0/16", "172.16.0.0/12", "10.0.0.0/8" })
+            {
+                Rule(chain).address(AF_INET, isInput, makeRange(cidr)).accept(batch);
+            }
+            if (isInput)
+            {
+                // Loopback addresses to the local host
+                Rule(chain).address(AF_INET, true, makeRange("127.0.0.0/8")).accept(batch);
+                // Multicast addresses
+                Rule(chain).address(AF_INET, true, makeRange("224.0.0.0/4")).accept(batch);
+            }
+        }
+    }
+}
+
+} // namespace
+
+NftablesFirewall::NftablesFirewall() : isGenerationKnown_(false), generation_(0), isTableApplied_(false),
+    isFingerprintKnown_(false), fingerprint_(0)
+{
+}
+
+bool NftablesFirewall::apply(const Settings &settings)
+{
+    std::vector<Range> ranges4, ranges6;
+    for (const auto &ip : settings.allowedIps)
+    {
+        Range range;
+        if (parseRange(ip, AF_INET, range))
+        {
+            ranges4.push_back(range);
+        }
+        else if (parseRange(ip, AF_INET6, range))
+        {
+            ranges6.push_back(range);
+        }
+        else
+        {
+            Logger::instance().out("nftables: skipped invalid address \"%s\"", ip.c_str());
+        }
+    }
+    ranges4 = mergeRanges(ranges4, 4);
+    ranges6 = mergeRanges(ranges6, 16);
+
+    NetlinkSocket socket;
+    if (!socket.isOpen())
+    {
+        return false;
+    }
+    Batch batch(socket);
+    // the table is created if missing, so that deleting it can't fail, and built anew
+    addTable(batch, NFT_MSG_NEWTABLE, NLM_F_CREATE);
+    addTable(batch, NFT_MSG_DELTABLE, 0);
+    addTable(batch, NFT_MSG_NEWTABLE, NLM_F_CREATE | NLM_F_EXCL);
+    addSet(batch, IPS4_SET_NAME, IPS4_SET_ID, NFT_TYPE_IPADDR, 4, ranges4);
+    addSet(batch, IPS6_SET_NAME, IPS6_SET_ID, NFT_TYPE_IP6ADDR, 16, ranges6);
+    addChain(batch, INPUT_CHAIN_NAME, NF_INET_LOCAL_IN);
+    addChain(batch, OUTPUT_CHAIN_NAME, NF_INET_LOCAL_OUT);
+    addRules(batch, settings);
+
+    const int error = batch.commit();
+    if (error != 0)
+    {
+        Logger::instance().out("nftables: applying the table failed: %s", strerror(-error));
+        isGenerationKnown_ = false;
+        isFingerprintKnown_ = false;
+        return false;
+    }
+    isTableApplied_ = true;
+    isGenerationKnown_ = getGeneration(generation_);
+    // read back, so that the table can be told apart from one built by anything else, even with the same rules
+    isFingerprintKnown_ = getFingerprint(fingerprint_);
+    Logger::instance().out("nftables: table applied with %zu IPv4 and %zu IPv6 ranges allowed",
+                           ranges4.size(), ranges6.size());
+    return true;
+}
+
+bool NftablesFirewall::remove()
+{
+    NetlinkSocket socket;
+    if (!socket.isOpen())
+    {
+        return false;
+    }
+    Batch batch(socket);
+    addTable(batch, NFT_MSG_NEWTABLE, NLM_F_CREATE);
+    addTable(batch, NFT_MSG_DELTABLE, 0);
+    const int error = batch.commit();
+    isFingerprintKnown_ = false;
+    if (error != 0)
+    {
+        Logger::instance().out("nftables: removing the table failed: %s", strerror(-error));
+        isGenerationKnown_ = false;
+        return false;
+    }
+    isTableApplied_ = false;
+    isGenerationKnown_ = getGeneration(generation_);
+    return true;
+}
+
+bool NftablesFirewall::isApplied()
+{
+    uint32_t generation = 0;
+    const bool isGenerationRead = getGeneration(generation);
+    if (isGenerationRead && isGenerationKnown_ && generation == generation_)
+    {
+        return isTableApplied_;
+    }
+
+    // the ruleset was changed since, by this helper or anything else: the rules and the allowed addresses of the
+    // table have to be what they were when it was applied
+    bool isInPlace;
+    if (isFingerprintKnown_)
+    {
+        uint64_t fingerprint = 0;
+        isInPlace = getFingerprint(fingerprint) && fingerprint == fingerprint_;
+    }
+    else
+    {
+        isInPlace = isTablePresent();
+    }
+    isGenerationKnown_ = isGenerationRead;
+    generation_ = generation;
+    isTableApplied_ = isInPlace;
+    return isInPlace;
+}
+
+bool NftablesFirewall::getGeneration(uint32_t &generation)
+{
+    NetlinkSocket socket;
+    if (!socket.isOpen())
+    {
+        return false;
+    }
+    char buffer[REQUEST_BUFFER_SIZE];
+    struct nlmsghdr *nlh = nftnl_nlmsg_build_hdr(buffer, NFT_MSG_GETGEN, AF_UNSPEC, NLM_F_ACK, socket.nextSeq());
+    if (!socket.send(nlh))
+    {
+        return false;
+    }
+
+    bool isFound = false;
+    const int error = socket.receive(1, [&generation, &isFound](const struct nlmsghdr *reply) {
+        if (NFNL_MSG_TYPE(reply->nlmsg_type) == NFT_MSG_NEWGEN)
+        {
+            struct nftnl_gen *gen = nftnl_gen_alloc();
+            if (nftnl_gen_nlmsg_parse(reply, gen) == 0)
+            {
+                generation = nftnl_gen_get_u32(gen, NFTNL_GEN_ID);
+                isFound = true;
+            }
+            nftnl_gen_free(gen);
+        }
+    });
+    return error == 0 && isFound;
+}
+
+bool NftablesFirewall::getFingerprint(uint64_t &fingerprint)
+{
+    const std::vector<std::string> rules = getRules();
+    if (rules.empty())
+    {
+        return false;
+    }
+    Fingerprint result;
+    for (const auto &rule : rules)
+    {
+        result.add(rule);
+    }
+    if (!addSetElements(IPS4_SET_NAME, result) || !addSetElements(IPS6_SET_NAME, result))
+    {
+        return false;
+    }
+    fingerprint = result.value();
+    return true;
+}
+
+bool NftablesFirewall::isTablePresent()
+{
+    NetlinkSocket socket;
+    if (!socket.isOpen())
+    {
+        return false;
+    }
+    char buffer[REQUEST_BUFFER_SIZE];
+    struct nlmsghdr *nlh = nftnl_nlmsg_build_hdr(buffer, NFT_MSG_GETTABLE, NFPROTO_INET, NLM_F_ACK,
+                                                 socket.nextSeq());
+    struct nftnl_table *table = nftnl_table_alloc();
+    nftnl_table_set_str(table, NFTNL_TABLE_NAME, TABLE_NAME);
+    nftnl_table_nlmsg_build_payload(nlh, table);
+    nftnl_table_free(table);
+    if (!socket.send(nlh))
+    {
+        return false;
+    }
+
+    bool isFound = false;
+    const int error = socket.receive(1, [&isFound](const struct nlmsghdr *reply) {
+        if (NFNL_MSG_TYPE(reply->nlmsg_type) == NFT_MSG_NEWTABLE)
+        {
+            isFound = true;
+        }
+    });
+    return error == 0 && isFound;
+}
+
+std::vector<std::string> NftablesFirewall::getRules()
+{
+    std::vector<std::string> rules;
+    NetlinkSocket socket;
+    if (!socket.isOpen())
+    {
+        return rules;
+    }
+    char buffer[REQUEST_BUFFER_SIZE];
+    struct nlmsghdr *nlh = nftnl_nlmsg_build_hdr(buffer, NFT_MSG_GETRULE, NFPROTO_INET, NLM_F_DUMP,
+                                                 socket.nextSeq());
+    struct nftnl_rule *filter = nftnl_rule_alloc();
+    nftnl_rule_set_str(filter, NFTNL_RULE_TABLE, TABLE_NAME);
+    nftnl_rule_nlmsg_build_payload(nlh, filter);
+    nftnl_rule_free(filter);
+    if (!socket.send(nlh))
+    {
+        return rules;
+    }
+
+    socket.receive(1, [&rules](const struct nlmsghdr *reply) {
+        struct nftnl_rule *rule = nftnl_rule_alloc();
+        const char *table = nullptr;
+        if (nftnl_rule_nlmsg_parse(reply, rule) == 0)
+        {
+            table = nftnl_rule_get_str(rule, NFTNL_RULE_TABLE);
+        }
+        if (table && strcmp(table, TABLE_NAME) == 0)
+        {
+            char text[4096];
+            nftnl_rule_snprintf(text, sizeof(text), rule, NFTNL_OUTPUT_DEFAULT, 0);
+            rules.push_back(text);
+        }
+        nftnl_rule_free(rule);
+    });
+    return rules;
+}
+
+bool NftablesFirewall::saveForBoot(const Settings &settings, const std::string &path)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+    if (!settings.interfaceToSkip.empty())
+    {
+        file << "interface " << settings.interfaceToSkip << "\n";
+    }
+    file << "lan " << (settings.allowLan ? 1 : 0) << "\n";
+    for (const auto &ip : settings.allowedIps)
+    {
+        file << "ip " << ip << "\n";
+    }
+    file.close();
+    return !file.fail();
+}
+
+bool NftablesFirewall::loadForBoot(const std::string &path, Settings &settings)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    settings = Settings();
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const size_t spacePos = line.find(' ');
+        if (spacePos == std::string::npos)
+        {
+            continue;
+        }
+        const std::string key = line.substr(0, spacePos);
+        const std::string value = line.substr(spacePos + 1);
+        if (key == "interface")
+        {
+            settings.interfaceToSkip = value;
+        }
+        else if (key == "lan")
+        {
+            settings.allowLan = value == "1";
+        }
+        else if (key == "ip")
+        {
+            settings.allowedIps.push_back(value);
+        }
+    }
+    return true;
+}
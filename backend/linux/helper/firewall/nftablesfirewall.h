@@ -0,0 +1,58 @@
+#ifndef NftablesFirewall_h
+#define NftablesFirewall_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// the settings applied last, the helper applies them again on OS boot
+#define NFT_BOOT_SETTINGS_PATH "/etc/windscribe/firewall_nft.txt"
+
+// The firewall of the client as the nf_tables table "inet windscribe", built in-process with libnftnl and sent
+// to the kernel over netlink. The table is replaced as a whole in a single batch, so both the IPv4 and the IPv6
+// rules change atomically and no traffic passes unfiltered in between.
+// The input and output chains drop everything except the loopback, the interface to skip, the allowed addresses
+// and, if allowed, the LAN; the allowed addresses are looked up in a set per address family.
+class NftablesFirewall final
+{
+public:
+    struct Settings
+    {
+        std::vector<std::string> allowedIps;    // addresses or CIDR ranges, IPv4 or IPv6
+        std::string interfaceToSkip;
+        bool allowLan;
+
+        Settings() : allowLan(false) {}
+    };
+
+    NftablesFirewall();
+
+    bool apply(const Settings &settings);
+    bool remove();
+    // True if the table applied last is in place; false also if the table can't be read. The generation of the
+    // ruleset changes on every commit to it, so while it is the one the table was applied or checked at, a single
+    // request confirms the table; otherwise the rules and the set elements of the table are read back and their
+    // fingerprint is compared to the one taken when the table was applied.
+    bool isApplied();
+    // the rules of the table as text, for the logs and the tests
+    static std::vector<std::string> getRules();
+    // the generation of the whole ruleset, of iptables-nft as well; changes on every commit to the ruleset
+    static bool getGeneration(uint32_t &generation);
+
+    // the settings to apply on OS boot, kept in a text file of one setting per line
+    static bool saveForBoot(const Settings &settings, const std::string &path);
+    static bool loadForBoot(const std::string &path, Settings &settings);
+
+private:
+    // of the rules and the set elements of the table, false if it can't be read
+    static bool getFingerprint(uint64_t &fingerprint);
+    static bool isTablePresent();
+
+    bool isGenerationKnown_;
+    uint32_t generation_;
+    bool isTableApplied_;       // at the generation known
+    bool isFingerprintKnown_;   // while the table applied last is expected in place
+    uint64_t fingerprint_;
+};
+
+#endif // NftablesFirewall_h
@@ -0,0 +1,20 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tst_nftablesfirewall.h"
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    if (!TestNftablesFirewall::enterNamespaces())
+    {
+        printf("SKIP: can't create an unprivileged user and network namespace\n");
+        return EXIT_SUCCESS;
+    }
+    TestNftablesFirewall test;
+    const int failedCount = test.run();
+    printf("%s: %d checks failed\n", failedCount == 0 ? "PASS" : "FAIL", failedCount);
+    return failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,193 @@
+#include "tst_nftablesfirewall.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#define VERIFY(condition) verify((condition), #condition, __LINE__)
+
+namespace
+{
+bool writeFile(const char *path, const std::string &text)
+{
+    const int fd = open(path, O_WRONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    const bool isWritten = write(fd, text.c_str(), text.size()) == static_cast<ssize_t>(text.size());
+    close(fd);
+    return isWritten;
+}
+}
+
+TestNftablesFirewall::TestNftablesFirewall() : failedCount_(0)
+{
+}
+
+bool TestNftablesFirewall::enterNamespaces()
+{
+    const uid_t uid = getuid();
+    const gid_t gid = getgid();
+    if (unshare(CLONE_NEWUSER | CLONE_NEWNET) != 0)
+    {
+        return false;
+    }
+    // root in the namespace is the user who runs the test
+    return writeFile("/proc/self/setgroups", "deny") &&
+           writeFile("/proc/self/uid_map", "0 " + std::to_string(uid) + " 1") &&
+           writeFile("/proc/self/gid_map", "0 " + std::to_string(gid) + " 1");
+}
+
+int TestNftablesFirewall::run()
+{
+    test_apply();
+    test_replace();
+    test_many_ips();
+    test_changed_elsewhere();
+    test_remove();
+    test_boot_settings();
+    return failedCount_;
+}
+
+void TestNftablesFirewall::test_apply()
+{
+    NftablesFirewall::Settings settings;
+    settings.allowedIps = { "1.1.1.1", "10.0.0.0/8", "10.1.0.0/16", "2001:db8::1", "2001:db8::/64" };
+    settings.interfaceToSkip = "tun0";
+    settings.allowLan = true;
+    VERIFY(!firewall_.isApplied());
+    VERIFY(firewall_.apply(settings));
+    VERIFY(firewall_.isApplied());
+
+    // loopback, the interface to skip, a lookup per family and the LAN: 192.168/16, 172.16/12, 10/8 both ways,
+    // 127/8 and 224/4 on input
+    const std::vector<std::string> rules = NftablesFirewall::getRules();
+    VERIFY(rules.size() == 2 * (1 + 1 + 2 + 3) + 2);
+    VERIFY(countRules("set allowed_ips4") == 2);
+    VERIFY(countRules("set allowed_ips6") == 2);
+    VERIFY(countRules("bitwise") == 8);
+}
+
+void TestNftablesFirewall::test_replace()
+{
+    NftablesFirewall::Settings settings;
+    settings.allowedIps = { "2.2.2.2" };
+    VERIFY(firewall_.apply(settings));
+    VERIFY(firewall_.isApplied());
+    // the table is built anew, nothing is left of the one applied before
+    VERIFY(NftablesFirewall::getRules().size() == 2 * (1 + 2));
+    VERIFY(countRules("bitwise") == 0);
+
+    // the invalid addresses are skipped
+    settings.allowedIps = { "2.2.2.2", "not an address", "3.3.3.3/33" };
+    VERIFY(firewall_.apply(settings));
+    VERIFY(NftablesFirewall::getRules().size() == 2 * (1 + 2));
+}
+
+void TestNftablesFirewall::test_many_ips()
+{
+    // the elements don't fit in a single message
+    NftablesFirewall::Settings settings;
+    for (int i = 0; i < 20000; ++i)
+    {
+        settings.allowedIps.push_back("10." + std::to_string(i / 256 % 256) + "." + std::to_string(i % 256) + "." +
+                                      std::to_string(i % 2 == 0 ? 1 : 3));
+    }
+    settings.allowedIps.push_back("::/0");
+    VERIFY(firewall_.apply(settings));
+    VERIFY(firewall_.isApplied());
+}
+
+void TestNftablesFirewall::test_changed_elsewhere()
+{
+    NftablesFirewall::Settings settings;
+    settings.allowedIps = { "1.1.1.1" };
+    VERIFY(firewall_.apply(settings));
+    VERIFY(firewall_.isApplied());
+    VERIFY(firewall_.isApplied());
+
+    // a table with the same rules but other allowed addresses in place of the one applied
+    NftablesFirewall other;
+    NftablesFirewall::Settings otherSettings;
+    otherSettings.allowedIps = { "8.8.8.8" };
+    VERIFY(other.apply(otherSettings));
+    VERIFY(NftablesFirewall::getRules().size() == 2 * (1 + 2));
+    VERIFY(!firewall_.isApplied());
+    VERIFY(firewall_.apply(settings));
+    VERIFY(firewall_.isApplied());
+
+    // a table with other rules in place of the one applied
+    settings.interfaceToSkip = "tun0";
+    VERIFY(other.apply(settings));
+    VERIFY(!firewall_.isApplied());
+    VERIFY(other.isApplied());
+
+    VERIFY(other.remove());
+    VERIFY(!firewall_.isApplied());
+    VERIFY(firewall_.apply(settings));
+    VERIFY(firewall_.isApplied());
+}
+
+void TestNftablesFirewall::test_remove()
+{
+    VERIFY(firewall_.remove());
+    VERIFY(!firewall_.isApplied());
+    VERIFY(NftablesFirewall::getRules().empty());
+    // nothing to remove
+    VERIFY(firewall_.remove());
+}
+
+void TestNftablesFirewall::test_boot_settings()
+{
+    char path[] = "/tmp/tst_nftablesfirewall_XXXXXX";
+    const int fd = mkstemp(path);
+    VERIFY(fd >= 0);
+    if (fd < 0)
+    {
+        return;
+    }
+    close(fd);
+
+    NftablesFirewall::Settings settings;
+    settings.allowedIps = { "1.1.1.1", "2001:db8::/64" };
+    settings.interfaceToSkip = "wg0";
+    settings.allowLan = true;
+    VERIFY(NftablesFirewall::saveForBoot(settings, path));
+
+    NftablesFirewall::Settings loaded;
+    VERIFY(NftablesFirewall::loadForBoot(path, loaded));
+    VERIFY(loaded.allowedIps == settings.allowedIps);
+    VERIFY(loaded.interfaceToSkip == settings.interfaceToSkip);
+    VERIFY(loaded.allowLan);
+
+    unlink(path);
+    VERIFY(!NftablesFirewall::loadForBoot(path, loaded));
+}
+
+void TestNftablesFirewall::verify(bool condition, const char *description, int line)
+{
+    if (!condition)
+    {
+        printf("FAIL at line %d: %s\n", line, description);
+        ++failedCount_;
+    }
+}
+
+int TestNftablesFirewall::countRules(const std::string &text)
+{
+    int count = 0;
+    for (const auto &rule : NftablesFirewall::getRules())
+    {
+        if (rule.find(text) != std::string::npos)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,34 @@
+#ifndef TestNftablesFirewall_h
+#define TestNftablesFirewall_h
+
+#include <string>
+#include "../nftablesfirewall.h"
+
+// The tests of the nftables table against the kernel. They run unprivileged in a new user and network namespace,
+// where the process is root of its own network stack only, so the firewall of the host is never touched.
+class TestNftablesFirewall
+{
+public:
+    TestNftablesFirewall();
+
+    // false if the namespaces can't be created, e.g. unprivileged user namespaces are disabled
+    static bool enterNamespaces();
+    // returns the number of failed checks
+    int run();
+
+private:
+    void test_apply();
+    void test_replace();
+    void test_many_ips();
+    void test_changed_elsewhere();
+    void test_remove();
+    void test_boot_settings();
+
+    void verify(bool condition, const char *description, int line);
+    int countRules(const std::string &text);
+
+    NftablesFirewall firewall_;
+    int failedCount_;
+};
+
+#endif // TestNftablesFirewall_h
@@ -13,6 +13,7 @@ LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_serialization.a
 LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_thread.a
 LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_filesystem.a
 LIBS += -L$$BUILD_LIBS_PATH/openssl/lib -lssl -lcrypto
+LIBS += -lnftnl -lmnl
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
@@ -31,6 +32,7 @@ SOURCES += \
         ../../../common/utils/executable_signature/executable_signature.cpp \
         ../../../common/utils/executable_signature/executablesignature_linux.cpp \
         execute_cmd.cpp \
+        firewall/nftablesfirewall.cpp \
         ipc/helper_security.cpp \
         logger.cpp \
         main.cpp \
@@ -47,6 +49,7 @@ HEADERS += \
     ../../posix_common/helper_commands_serialize.h \
     3rdparty/pstream.h \
     execute_cmd.h \
+    firewall/nftablesfirewall.h \
     ipc/helper_security.h \
     logger.h \
     server.h \
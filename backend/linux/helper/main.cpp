@@ -3,6 +3,7 @@
 #include "server.h"
 #include "logger.h"
 #include "utils.h"
+#include "firewall/nftablesfirewall.h"
 
 Server server;
 
@@ -28,7 +29,18 @@ int main(int argc, const char *argv[])
     Logger::instance().checkLogSize();
 
     // restore firewall setting on OS reboot, if there are saved rules on /etc/windscribe dir
+    // the nftables table is used instead of the iptables rules where the kernel supports it;
+    // the set of allowed IPs goes first, the rules refer to it
 
+    NftablesFirewall::Settings nftSettings;
+    if (NftablesFirewall::loadForBoot(NFT_BOOT_SETTINGS_PATH, nftSettings))
+    {
+        NftablesFirewall().apply(nftSettings);
+    }
+    if (Utils::isFileExists("/etc/windscribe/rules.ipset"))
+    {
+        Utils::executeCommand("ipset restore -exist < /etc/windscribe/rules.ipset");
+    }
     if (Utils::isFileExists("/etc/windscribe/rules.v4"))
     {
         Utils::executeCommand("iptables-restore < /etc/windscribe/rules.v4");
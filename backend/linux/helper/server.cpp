@@ -300,6 +300,41 @@ bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf,
             outCmdAnswer.executed = 0;
         }*/
     }
+    else if (cmdId == HELPER_CMD_FIREWALL_NFT)
+    {
+        CMD_FIREWALL_NFT cmd;
+        ia >> cmd;
+
+        if (cmd.action == FIREWALL_NFT_APPLY)
+        {
+            NftablesFirewall::Settings settings;
+            settings.allowedIps = cmd.allowedIps;
+            settings.interfaceToSkip = cmd.interfaceToSkip;
+            settings.allowLan = cmd.allowLan;
+            outCmdAnswer.executed = nftablesFirewall_.apply(settings);
+            // the table is built anew from these on OS boot
+            if (outCmdAnswer.executed && !NftablesFirewall::saveForBoot(settings, NFT_BOOT_SETTINGS_PATH))
+            {
+                Logger::instance().out("nftables: can't save the settings to %s", NFT_BOOT_SETTINGS_PATH);
+            }
+        }
+        else if (cmd.action == FIREWALL_NFT_REMOVE)
+        {
+            unlink(NFT_BOOT_SETTINGS_PATH);
+            outCmdAnswer.executed = nftablesFirewall_.remove();
+        }
+        else if (cmd.action == FIREWALL_NFT_CHECK)
+        {
+            outCmdAnswer.customInfoValue[0] = nftablesFirewall_.isApplied();
+            outCmdAnswer.executed = 1;
+        }
+        else if (cmd.action == FIREWALL_NFT_GENERATION)
+        {
+            uint32_t generation = 0;
+            outCmdAnswer.executed = NftablesFirewall::getGeneration(generation);
+            outCmdAnswer.customInfoValue[0] = generation;
+        }
+    }
 
     buf->consume(headerSize + length);
 
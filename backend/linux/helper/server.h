@@ -12,6 +12,7 @@
 #include "../../posix_common/helper_commands.h"
 #include "wireguard/wireguardadapter.h"
 #include "wireguard/wireguardcontroller.h"
+#include "firewall/nftablesfirewall.h"
 
 
 typedef boost::shared_ptr<boost::asio::local::stream_protocol::socket> socket_ptr;
@@ -27,6 +28,7 @@ public:
 private:
     //SplitTunneling splitTunneling_;
     WireGuardController wireGuardController_;
+    NftablesFirewall nftablesFirewall_;
     boost::asio::io_service service_;
     boost::asio::local::stream_protocol::acceptor *acceptor_;
     
@@ -24,6 +24,7 @@
 #define HELPER_CMD_INSTALLER_EXECUTE_COPY_FILE  14
 
 #define HELPER_CMD_APPLY_CUSTOM_DNS             15
+#define HELPER_CMD_FIREWALL_NFT                 16
 
 
 
@@ -162,4 +163,23 @@ struct CMD_APPLY_CUSTOM_DNS
     std::string networkService;
 };
 
+enum FirewallNftAction
+{
+    FIREWALL_NFT_APPLY,
+    FIREWALL_NFT_REMOVE,
+    FIREWALL_NFT_CHECK,     // customInfoValue[0] of the answer is 1 if the table is in place
+    FIREWALL_NFT_GENERATION,    // customInfoValue[0] of the answer is the generation of the nf_tables ruleset
+};
+
+// Linux only, the nftables table of the firewall
+struct CMD_FIREWALL_NFT
+{
+    int action;
+    std::vector<std::string> allowedIps;
+    std::string interfaceToSkip;
+    bool allowLan;
+
+    CMD_FIREWALL_NFT() : action(FIREWALL_NFT_CHECK), allowLan(false) {}
+};
+
 #endif
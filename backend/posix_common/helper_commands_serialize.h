@@ -147,6 +147,16 @@ void serialize(Archive &ar, CMD_APPLY_CUSTOM_DNS &a, const unsigned int version)
     ar & a.networkService;
 }
 
+template<class Archive>
+void serialize(Archive &ar, CMD_FIREWALL_NFT &a, const unsigned int version)
+{
+    UNUSED(version);
+    ar & a.action;
+    ar & a.allowedIps;
+    ar & a.interfaceToSkip;
+    ar & a.allowLan;
+}
+
 }
 }
 
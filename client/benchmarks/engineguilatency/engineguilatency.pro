@@ -0,0 +1,63 @@
+# Engine -> GUI notification latency benchmark: a stub engine replays notifications into the real
+# EngineServer and Backend under the offscreen platform. Not part of the application build.
+QT       += core gui network svg widgets
+
+TARGET = engineguilatency
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_MESSAGELOGCONTEXT
+DEFINES += QT_DEPRECATED_WARNINGS
+
+COMMON_PATH = $$PWD/../../../common
+BUILD_LIBS_PATH = $$PWD/../../../build-libs
+
+INCLUDEPATH += $$COMMON_PATH
+INCLUDEPATH += $$PWD/../..
+
+!linux {
+    error("The engine/GUI latency benchmark is only supported on Linux")
+}
+
+linux {
+
+#remove linux deprecated copy warnings
+QMAKE_CXXFLAGS_WARN_ON += -Wno-deprecated-copy
+
+INCLUDEPATH += $$BUILD_LIBS_PATH/protobuf/include
+LIBS += -L$$BUILD_LIBS_PATH/protobuf/lib -lprotobuf
+
+INCLUDEPATH += $$BUILD_LIBS_PATH/openssl/include
+LIBS += -L$$BUILD_LIBS_PATH/openssl/lib -lssl -lcrypto
+
+INCLUDEPATH += $$BUILD_LIBS_PATH/curl/include
+LIBS += -L$$BUILD_LIBS_PATH/curl/lib/ -lcurl
+
+INCLUDEPATH += $$BUILD_LIBS_PATH/cares/include
+LIBS += -L$$BUILD_LIBS_PATH/cares/lib -lcares
+
+INCLUDEPATH += $$BUILD_LIBS_PATH/boost/include
+LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_filesystem.a
+LIBS += $$BUILD_LIBS_PATH/boost/lib/libboost_serialization.a
+
+} # linux
+
+SOURCES += \
+    main.cpp \
+    latencyrecorder.cpp \
+    repaintprobe.cpp \
+    stubengine.cpp
+
+HEADERS += \
+    latencyrecorder.h \
+    repaintprobe.h \
+    stubengine.h
+
+include(../../common.pri)
+include(../../gui/gui.pri)
+include(../../engine/engine.pri)
+
+exists($$COMMON_PATH/utils/hardcodedsecrets.ini) {
+    RESOURCES += ../../secrets.qrc
+}
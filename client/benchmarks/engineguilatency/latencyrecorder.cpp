@@ -0,0 +1,148 @@
+#include "latencyrecorder.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <stdio.h>
+
+namespace {
+
+double percentileMs(QVector<qint64> values, double percentile)
+{
+    if (values.isEmpty())
+    {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    int index = static_cast<int>(percentile * (values.size() - 1) + 0.5);
+    return values[index] / 1000000.0;
+}
+
+}
+
+LatencyRecorder::LatencyRecorder(int count) : emitNs_(count, 0), emittedCount_(0)
+{
+    for (TypeState &ts : types_)
+    {
+        ts.seqs.reserve(count);
+        ts.nextUndelivered = 0;
+        ts.coalesced = 0;
+        ts.deliveryNs.reserve(count);
+        ts.repaintNs.reserve(count);
+    }
+    pendingPaint_.reserve(count);
+    clock_.start();
+}
+
+const char *LatencyRecorder::typeName(NOTIFICATION_TYPE type)
+{
+    switch (type)
+    {
+        case CONNECT_STATE: return "connect";
+        case MY_IP: return "myip";
+        case PING: return "ping";
+        case LOCATIONS: return "locations";
+        case STATISTICS: return "statistics";
+        default: return "unknown";
+    }
+}
+
+void LatencyRecorder::emitted(NOTIFICATION_TYPE type, quint32 seq)
+{
+    QMutexLocker locker(&mutex_);
+    Q_ASSERT(static_cast<int>(seq) < emitNs_.size());
+    emitNs_[seq] = clock_.nsecsElapsed();
+    types_[type].seqs << seq;
+    emittedCount_++;
+}
+
+void LatencyRecorder::delivered(NOTIFICATION_TYPE type, quint32 seq)
+{
+    const qint64 now = clock_.nsecsElapsed();
+    QMutexLocker locker(&mutex_);
+    TypeState &ts = types_[type];
+    for (int i = ts.nextUndelivered; i < ts.seqs.size(); ++i)
+    {
+        if (ts.seqs[i] == seq)
+        {
+            ts.coalesced += i - ts.nextUndelivered;
+            deliver(type, i, now);
+            ts.nextUndelivered = i + 1;
+            return;
+        }
+    }
+    // a repeated delivery of a value which is already accounted, e.g. a state re-emitted by a helper
+}
+
+void LatencyRecorder::deliveredAllPending(NOTIFICATION_TYPE type)
+{
+    const qint64 now = clock_.nsecsElapsed();
+    QMutexLocker locker(&mutex_);
+    TypeState &ts = types_[type];
+    for (int i = ts.nextUndelivered; i < ts.seqs.size(); ++i)
+    {
+        deliver(type, i, now);
+    }
+    ts.nextUndelivered = ts.seqs.size();
+}
+
+void LatencyRecorder::painted()
+{
+    const qint64 now = clock_.nsecsElapsed();
+    QMutexLocker locker(&mutex_);
+    for (const PendingPaint &pp : qAsConst(pendingPaint_))
+    {
+        types_[pp.type].repaintNs << now - pp.emitNs;
+    }
+    pendingPaint_.clear();
+}
+
+int LatencyRecorder::emittedCount() const
+{
+    QMutexLocker locker(&mutex_);
+    return emittedCount_;
+}
+
+int LatencyRecorder::pendingCount() const
+{
+    QMutexLocker locker(&mutex_);
+    int pending = pendingPaint_.size();
+    for (const TypeState &ts : types_)
+    {
+        pending += ts.seqs.size() - ts.nextUndelivered;
+    }
+    return pending;
+}
+
+void LatencyRecorder::printReport(qint64 durationNs, quint64 allocations) const
+{
+    QMutexLocker locker(&mutex_);
+    const double durationSec = durationNs / 1000000000.0;
+
+    printf("%-11s %8s %9s %9s %10s %10s %10s %11s %11s\n", "type", "emitted", "delivered", "coalesced",
+           "p50 ms", "p99 ms", "max ms", "paint p50", "paint p99");
+    int delivered = 0;
+    for (int t = 0; t < NOTIFICATION_TYPES_COUNT; ++t)
+    {
+        const TypeState &ts = types_[t];
+        if (ts.seqs.isEmpty())
+        {
+            continue;
+        }
+        delivered += ts.deliveryNs.size();
+        printf("%-11s %8d %9d %9d %10.3f %10.3f %10.3f %11.3f %11.3f\n", typeName(static_cast<NOTIFICATION_TYPE>(t)),
+               ts.seqs.size(), ts.deliveryNs.size(), ts.coalesced,
+               percentileMs(ts.deliveryNs, 0.5), percentileMs(ts.deliveryNs, 0.99), percentileMs(ts.deliveryNs, 1.0),
+               percentileMs(ts.repaintNs, 0.5), percentileMs(ts.repaintNs, 0.99));
+    }
+
+    printf("\nduration:                     %.3f s\n", durationSec);
+    printf("throughput (emitted):         %.1f notifications/s\n", durationSec > 0 ? emittedCount_ / durationSec : 0.0);
+    printf("throughput (delivered):       %.1f notifications/s\n", durationSec > 0 ? delivered / durationSec : 0.0);
+    printf("allocations per notification: %.2f\n", emittedCount_ > 0 ? static_cast<double>(allocations) / emittedCount_ : 0.0);
+}
+
+void LatencyRecorder::deliver(NOTIFICATION_TYPE type, int index, qint64 nowNs)
+{
+    const qint64 emitNs = emitNs_[types_[type].seqs[index]];
+    types_[type].deliveryNs << nowNs - emitNs;
+    pendingPaint_ << PendingPaint{ type, emitNs };
+}
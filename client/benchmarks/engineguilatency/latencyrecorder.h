@@ -0,0 +1,61 @@
+#ifndef LATENCYRECORDER_H
+#define LATENCYRECORDER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVector>
+
+// Records when every replayed notification left the stub engine, when the GUI side got it from
+// Backend and when the following repaint happened. All the storage is allocated up front, so the
+// recorder itself doesn't show up in the allocation count of the benchmark.
+class LatencyRecorder
+{
+public:
+    enum NOTIFICATION_TYPE { CONNECT_STATE, MY_IP, PING, LOCATIONS, STATISTICS, NOTIFICATION_TYPES_COUNT };
+
+    explicit LatencyRecorder(int count);
+
+    static const char *typeName(NOTIFICATION_TYPE type);
+
+    qint64 nowNs() const { return clock_.nsecsElapsed(); }
+
+    // engine thread
+    void emitted(NOTIFICATION_TYPE type, quint32 seq);
+
+    // GUI thread. The notifications of the type emitted before |seq| and not delivered yet were coalesced
+    // on the way; for the types without a payload every pending notification counts as delivered.
+    void delivered(NOTIFICATION_TYPE type, quint32 seq);
+    void deliveredAllPending(NOTIFICATION_TYPE type);
+    void painted();
+
+    int emittedCount() const;
+    int pendingCount() const;
+
+    void printReport(qint64 durationNs, quint64 allocations) const;
+
+private:
+    struct TypeState
+    {
+        QVector<quint32> seqs;          // emitted, in order
+        int nextUndelivered;
+        int coalesced;
+        QVector<qint64> deliveryNs;
+        QVector<qint64> repaintNs;
+    };
+    struct PendingPaint
+    {
+        NOTIFICATION_TYPE type;
+        qint64 emitNs;
+    };
+
+    QElapsedTimer clock_;
+    mutable QMutex mutex_;
+    QVector<qint64> emitNs_;            // indexed by seq
+    TypeState types_[NOTIFICATION_TYPES_COUNT];
+    QVector<PendingPaint> pendingPaint_;
+    int emittedCount_;
+
+    void deliver(NOTIFICATION_TYPE type, int index, qint64 nowNs);
+};
+
+#endif // LATENCYRECORDER_H
@@ -0,0 +1,224 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include "backend/backend.h"
+#include "engine/engineserver.h"
+#include "engine/enginenotificationmailbox.h"
+#include "latencyrecorder.h"
+#include "repaintprobe.h"
+#include "stubengine.h"
+
+// Engine -> GUI notification latency benchmark.
+// A stub engine in its own thread replays a mix of notifications into a real EngineServer and Backend,
+// running under the offscreen platform. Reported: throughput, p50/p99 delivery latency to the Backend
+// signal and to the following repaint, and heap allocations per notification in the whole process.
+//
+// engineguilatency [--count N] [--rate N] [--locations N] [--mix connect=1,myip=1,ping=50,locations=1,statistics=20]
+
+static std::atomic<bool> g_countAllocations(false);
+static std::atomic<unsigned long long> g_allocations(0);
+
+void *operator new(size_t size)
+{
+    if (g_countAllocations.load(std::memory_order_relaxed))
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void *p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+static bool g_isVerbose = false;
+
+static void messageHandler(QtMsgType type, const QMessageLogContext &, const QString &msg)
+{
+    // the engine and GUI code log every notification, which would measure the log output instead
+    if (g_isVerbose || type >= QtWarningMsg)
+    {
+        fprintf(stderr, "%s\n", qPrintable(msg));
+    }
+}
+
+static bool parseMix(const QString &mix, int weights[LatencyRecorder::NOTIFICATION_TYPES_COUNT])
+{
+    for (int t = 0; t < LatencyRecorder::NOTIFICATION_TYPES_COUNT; ++t)
+    {
+        weights[t] = 0;
+    }
+    bool isAny = false;
+    const QStringList parts = mix.split(',', QString::SkipEmptyParts);
+    for (const QString &part : parts)
+    {
+        const QStringList kv = part.split('=');
+        bool ok = false;
+        const int weight = kv.size() == 2 ? kv[1].toInt(&ok) : 0;
+        if (!ok || weight < 0)
+        {
+            return false;
+        }
+        int type = 0;
+        for (; type < LatencyRecorder::NOTIFICATION_TYPES_COUNT; ++type)
+        {
+            if (kv[0].trimmed() == LatencyRecorder::typeName(static_cast<LatencyRecorder::NOTIFICATION_TYPE>(type)))
+            {
+                break;
+            }
+        }
+        if (type == LatencyRecorder::NOTIFICATION_TYPES_COUNT)
+        {
+            return false;
+        }
+        weights[type] = weight;
+        isAny = isAny || weight > 0;
+    }
+    return isAny;
+}
+
+int main(int argc, char *argv[])
+{
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    qInstallMessageHandler(messageHandler);
+
+    QApplication a(argc, argv);
+    // separate settings, so the benchmark never touches the settings of the installed application
+    a.setOrganizationName("Windscribe");
+    a.setApplicationName("WindscribeEngineGuiLatency");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption countOption("count", "Notifications to replay.", "n", "20000");
+    QCommandLineOption rateOption("rate", "Notifications per second.", "n", "5000");
+    QCommandLineOption locationsOption("locations", "Locations in a locations update (4 cities each).", "n", "120");
+    QCommandLineOption mixOption("mix", "Relative share of the notification types.", "mix",
+                                 "connect=1,myip=1,ping=50,locations=1,statistics=20");
+    QCommandLineOption verboseOption("verbose", "Print the engine and GUI log.");
+    parser.addOption(countOption);
+    parser.addOption(rateOption);
+    parser.addOption(locationsOption);
+    parser.addOption(mixOption);
+    parser.addOption(verboseOption);
+    parser.process(a);
+
+    StubEngine::Options options;
+    options.count = parser.value(countOption).toInt();
+    options.rate = parser.value(rateOption).toInt();
+    options.locationsCount = parser.value(locationsOption).toInt();
+    g_isVerbose = parser.isSet(verboseOption);
+    if (options.count <= 0 || options.rate <= 0 || options.locationsCount <= 0 || !parseMix(parser.value(mixOption), options.weights))
+    {
+        parser.showHelp(1);
+    }
+
+    LatencyRecorder recorder(options.count);
+
+    Backend backend;
+    EngineServer *engineServer = backend.findChild<EngineServer *>();
+    EngineNotificationMailbox *mailbox = engineServer ? engineServer->findChild<EngineNotificationMailbox *>() : nullptr;
+    if (!engineServer || !mailbox)
+    {
+        fprintf(stderr, "EngineServer is not found in Backend\n");
+        return 1;
+    }
+
+    RepaintProbe probe(&recorder);
+    QObject::connect(&backend, SIGNAL(connectStateChanged(ProtoTypes::ConnectState)), &probe, SLOT(onConnectStateChanged(ProtoTypes::ConnectState)));
+    QObject::connect(&backend, SIGNAL(myIpChanged(QString, bool)), &probe, SLOT(onMyIpChanged(QString, bool)));
+    QObject::connect(backend.getLocationsModel(), SIGNAL(locationSpeedChanged(LocationID, PingTime)), &probe, SLOT(onLocationSpeedChanged(LocationID, PingTime)));
+    QObject::connect(&backend, SIGNAL(locationsUpdated()), &probe, SLOT(onLocationsUpdated()));
+    QObject::connect(&backend, SIGNAL(statisticsUpdated(quint64, quint64, bool)), &probe, SLOT(onStatisticsUpdated(quint64, quint64, bool)));
+    probe.show();
+
+    // the stub is wired the same way EngineServer::buildEngine() wires the real engine
+    QThread threadEngine;
+    StubEngine *stub = new StubEngine(options, &recorder);
+    stub->moveToThread(&threadEngine);
+    QObject::connect(&threadEngine, SIGNAL(started()), stub, SLOT(start()));
+    QObject::connect(&threadEngine, SIGNAL(finished()), stub, SLOT(deleteLater()));
+    mailbox->connectToEngine(stub, stub);
+    QObject::connect(stub, SIGNAL(locationsUpdated(LocationID, QString, QSharedPointer<QVector<locationsmodel::LocationItem> >)),
+                     engineServer, SLOT(onEngineLocationsModelItemsUpdated(LocationID, QString, QSharedPointer<QVector<locationsmodel::LocationItem> >)));
+    QObject::connect(stub, SIGNAL(locationPingTimeChanged(LocationID, PingTime)),
+                     engineServer, SLOT(onEngineLocationsModelPingChangedChanged(LocationID, PingTime)));
+
+    qint64 startNs = 0;
+    bool isStubFinished = false;
+    QObject::connect(stub, &StubEngine::finished, &a, [&isStubFinished]() { isStubFinished = true; });
+
+    // once everything is emitted, wait for the tail to be delivered; statistics come in 1 s batches
+    QTimer waitTimer;
+    qint64 stubFinishedNs = 0;
+    QObject::connect(&waitTimer, &QTimer::timeout, &a, [&]()
+    {
+        if (!isStubFinished)
+        {
+            return;
+        }
+        if (stubFinishedNs == 0)
+        {
+            stubFinishedNs = recorder.nowNs();
+        }
+        const bool isTimeout = recorder.nowNs() - stubFinishedNs > 3000000000LL;
+        if (recorder.pendingCount() == 0 || isTimeout)
+        {
+            g_countAllocations = false;
+            waitTimer.stop();
+            if (isTimeout)
+            {
+                printf("%d notifications were not delivered within 3 s\n\n", recorder.pendingCount());
+            }
+            recorder.printReport(recorder.nowNs() - startNs, g_allocations.load());
+            a.quit();
+        }
+    });
+
+    QTimer::singleShot(0, &a, [&]()
+    {
+        g_allocations = 0;
+        g_countAllocations = true;
+        startNs = recorder.nowNs();
+        threadEngine.start(QThread::LowPriority);
+        waitTimer.start(10);
+    });
+
+    const int ret = a.exec();
+    threadEngine.quit();
+    threadEngine.wait();
+    return ret;
+}
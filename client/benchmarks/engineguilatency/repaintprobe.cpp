@@ -0,0 +1,45 @@
+#include "repaintprobe.h"
+#include <QPainter>
+
+RepaintProbe::RepaintProbe(LatencyRecorder *recorder, QWidget *parent) : QWidget(parent),
+    recorder_(recorder)
+{
+    resize(64, 64);
+}
+
+void RepaintProbe::onConnectStateChanged(const ProtoTypes::ConnectState &connectState)
+{
+    recorder_->delivered(LatencyRecorder::CONNECT_STATE, connectState.location().id());
+    update();
+}
+
+void RepaintProbe::onMyIpChanged(const QString &ip, bool /*isFromDisconnectedState*/)
+{
+    recorder_->delivered(LatencyRecorder::MY_IP, ip.toUInt());
+    update();
+}
+
+void RepaintProbe::onLocationSpeedChanged(LocationID /*id*/, PingTime speed)
+{
+    recorder_->delivered(LatencyRecorder::PING, speed.toInt());
+    update();
+}
+
+void RepaintProbe::onLocationsUpdated()
+{
+    recorder_->deliveredAllPending(LatencyRecorder::LOCATIONS);
+    update();
+}
+
+void RepaintProbe::onStatisticsUpdated(quint64 /*bytesIn*/, quint64 /*bytesOut*/, bool /*isTotalBytes*/)
+{
+    recorder_->deliveredAllPending(LatencyRecorder::STATISTICS);
+    update();
+}
+
+void RepaintProbe::paintEvent(QPaintEvent * /*event*/)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+    recorder_->painted();
+}
@@ -0,0 +1,32 @@
+#ifndef REPAINTPROBE_H
+#define REPAINTPROBE_H
+
+#include <QWidget>
+#include "types/locationid.h"
+#include "types/pingtime.h"
+#include "utils/protobuf_includes.h"
+#include "latencyrecorder.h"
+
+// Receives the Backend notifications on the GUI thread like the main window does and schedules a
+// repaint for each of them; the latency is recorded on delivery and again when the repaint happens.
+class RepaintProbe : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit RepaintProbe(LatencyRecorder *recorder, QWidget *parent = nullptr);
+
+public slots:
+    void onConnectStateChanged(const ProtoTypes::ConnectState &connectState);
+    void onMyIpChanged(const QString &ip, bool isFromDisconnectedState);
+    void onLocationSpeedChanged(LocationID id, PingTime speed);
+    void onLocationsUpdated();
+    void onStatisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    LatencyRecorder *recorder_;
+};
+
+#endif // REPAINTPROBE_H
@@ -0,0 +1,115 @@
+#include "stubengine.h"
+
+StubEngine::StubEngine(const Options &options, LatencyRecorder *recorder) : QObject(nullptr),
+    options_(options), recorder_(recorder), timer_(nullptr), seq_(0)
+{
+    // the types are interleaved by their weights in a fixed order, so every run replays the same sequence
+    int maxWeight = 0;
+    for (int w : options_.weights)
+    {
+        maxWeight = qMax(maxWeight, w);
+    }
+    for (int round = 0; round < maxWeight; ++round)
+    {
+        for (int t = 0; t < LatencyRecorder::NOTIFICATION_TYPES_COUNT; ++t)
+        {
+            if (round < options_.weights[t])
+            {
+                schedule_ << static_cast<LatencyRecorder::NOTIFICATION_TYPE>(t);
+            }
+        }
+    }
+    Q_ASSERT(!schedule_.isEmpty());
+
+    locations_ = makeLocations();
+}
+
+void StubEngine::start()
+{
+    timer_ = new QTimer(this);
+    timer_->setTimerType(Qt::PreciseTimer);
+    connect(timer_, SIGNAL(timeout()), SLOT(onTimer()));
+    timer_->start(1);
+    elapsed_.start();
+}
+
+void StubEngine::onTimer()
+{
+    const qint64 due = qMin(static_cast<qint64>(options_.count), options_.rate * elapsed_.elapsed() / 1000 + 1);
+    while (static_cast<qint64>(seq_) < due)
+    {
+        emitNext();
+    }
+    if (static_cast<int>(seq_) >= options_.count)
+    {
+        timer_->stop();
+        Q_EMIT finished();
+    }
+}
+
+void StubEngine::emitNext()
+{
+    const quint32 seq = seq_++;
+    const LatencyRecorder::NOTIFICATION_TYPE type = schedule_[seq % schedule_.size()];
+    recorder_->emitted(type, seq);
+
+    switch (type)
+    {
+        case LatencyRecorder::CONNECT_STATE:
+        {
+            // the seq travels in the location id, it is the only payload which reaches the GUI untouched
+            const CONNECT_STATE state = (seq % 2) ? CONNECT_STATE_CONNECTED : CONNECT_STATE_CONNECTING;
+            Q_EMIT stateChanged(state, DISCONNECTED_BY_USER, ProtoTypes::NO_CONNECT_ERROR,
+                                LocationID::createApiLocationId(static_cast<int>(seq), "City", "Nick"));
+            break;
+        }
+        case LatencyRecorder::MY_IP:
+            Q_EMIT myIpUpdated(QString::number(seq), true, false);
+            break;
+        case LatencyRecorder::PING:
+        {
+            const locationsmodel::CityItem &city = locations_[seq % locations_.size()].cities.first();
+            Q_EMIT locationPingTimeChanged(city.id, PingTime(static_cast<int>(seq)));
+            break;
+        }
+        case LatencyRecorder::LOCATIONS:
+        {
+            // every other location changes, as after a server list refresh
+            for (int i = seq % 2; i < locations_.size(); i += 2)
+            {
+                locations_[i].cities.first().nick = QString("Nick %1").arg(seq);
+            }
+            QSharedPointer<QVector<locationsmodel::LocationItem> > items(new QVector<locationsmodel::LocationItem>(locations_));
+            Q_EMIT locationsUpdated(LocationID::createBestLocationId(1), QString(), items);
+            break;
+        }
+        case LatencyRecorder::STATISTICS:
+            Q_EMIT statisticsUpdated(1000, 100, false);
+            break;
+        default:
+            Q_ASSERT(false);
+    }
+}
+
+QVector<locationsmodel::LocationItem> StubEngine::makeLocations() const
+{
+    QVector<locationsmodel::LocationItem> locations;
+    for (int i = 0; i < options_.locationsCount; ++i)
+    {
+        locationsmodel::LocationItem item;
+        item.id = LocationID::createTopApiLocationId(i + 1);
+        item.name = QString("Location %1").arg(i + 1);
+        item.countryCode = "CA";
+        for (int c = 0; c < 4; ++c)
+        {
+            locationsmodel::CityItem city;
+            city.city = QString("City %1-%2").arg(i + 1).arg(c + 1);
+            city.nick = QString("Nick %1").arg(c + 1);
+            city.id = LocationID::createApiLocationId(i + 1, city.city, city.nick);
+            city.pingTimeMs = 50 + c;
+            item.cities << city;
+        }
+        locations << item;
+    }
+    return locations;
+}
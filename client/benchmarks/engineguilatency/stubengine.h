@@ -0,0 +1,63 @@
+#ifndef STUBENGINE_H
+#define STUBENGINE_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QVector>
+#include "engine/types/types.h"
+#include "engine/locationsmodel/locationitem.h"
+#include "latencyrecorder.h"
+
+// Stands in for Engine, ConnectStateController and EngineLocationsModel: lives in its own thread and
+// emits their notification signals with the same signatures, so EngineServer and Backend process them
+// exactly as they would process the real ones. Nothing is connected, pinged or downloaded.
+class StubEngine : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options
+    {
+        int count;                                                      // notifications to replay
+        int rate;                                                       // per second
+        int locationsCount;                                             // size of a locations update
+        int weights[LatencyRecorder::NOTIFICATION_TYPES_COUNT];         // relative share of every type
+    };
+
+    StubEngine(const Options &options, LatencyRecorder *recorder);
+
+public slots:
+    void start();
+
+signals:
+    void finished();
+
+    // Engine
+    void statisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes);
+    void myIpUpdated(const QString &ip, bool success, bool isDisconnected);
+    void firewallStateChanged(bool isEnabled);
+    void networkChanged(ProtoTypes::NetworkInterface networkInterface);
+    // ConnectStateController
+    void stateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &location);
+    // EngineLocationsModel
+    void locationsUpdated(const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer<QVector<locationsmodel::LocationItem> > locations);
+    void locationPingTimeChanged(const LocationID &id, PingTime timeMs);
+
+private slots:
+    void onTimer();
+
+private:
+    Options options_;
+    LatencyRecorder *recorder_;
+    QTimer *timer_;
+    QElapsedTimer elapsed_;
+    QVector<LatencyRecorder::NOTIFICATION_TYPE> schedule_;
+    QVector<locationsmodel::LocationItem> locations_;
+    quint32 seq_;
+
+    void emitNext();
+    QVector<locationsmodel::LocationItem> makeLocations() const;
+};
+
+#endif // STUBENGINE_H
@@ -48,13 +48,18 @@ SOURCES += \
     $$COMMON_PATH/ipc/generated_proto/apiinfo.pb.cc \
     $$COMMON_PATH/types/locationid.cpp \
     $$COMMON_PATH/types/pingtime.cpp \
+    $$COMMON_PATH/utils/asynclogwriter.cpp \
     $$COMMON_PATH/utils/clean_sensitive_info.cpp \
     $$COMMON_PATH/utils/extraconfig.cpp \
     $$COMMON_PATH/utils/languagesutil.cpp \
     $$COMMON_PATH/utils/logger.cpp \
+    $$COMMON_PATH/utils/logratelimiter.cpp \
+    $$COMMON_PATH/utils/logrecord.cpp \
+    $$COMMON_PATH/utils/logring.cpp \
+    $$COMMON_PATH/utils/logrotator.cpp \
     $$COMMON_PATH/utils/mergelog.cpp \
+    $$COMMON_PATH/utils/protobuf_summary.cpp \
     $$COMMON_PATH/utils/utils.cpp \
-    $$COMMON_PATH/utils/widgetutils.cpp \
     $$COMMON_PATH/utils/executable_signature/executable_signature.cpp \
     $$COMMON_PATH/utils/ipvalidation.cpp \
     $$COMMON_PATH/version/appversion.cpp \
@@ -74,15 +79,21 @@ HEADERS += \
     $$COMMON_PATH/ipc/generated_proto/apiinfo.pb.h \
     $$COMMON_PATH/types/locationid.h \
     $$COMMON_PATH/types/pingtime.h \
+    $$COMMON_PATH/utils/asynclogwriter.h \
     $$COMMON_PATH/utils/clean_sensitive_info.h \
+    $$COMMON_PATH/utils/replacement_matcher.h \
     $$COMMON_PATH/utils/extraconfig.h \
     $$COMMON_PATH/utils/languagesutil.h \
     $$COMMON_PATH/utils/logger.h \
+    $$COMMON_PATH/utils/logratelimiter.h \
+    $$COMMON_PATH/utils/logrecord.h \
+    $$COMMON_PATH/utils/logring.h \
+    $$COMMON_PATH/utils/logrotator.h \
     $$COMMON_PATH/utils/mergelog.h \
     $$COMMON_PATH/utils/multiline_message_logger.h \
     $$COMMON_PATH/utils/utils.h \
     $$COMMON_PATH/utils/protobuf_includes.h \
-    $$COMMON_PATH/utils/widgetutils.h \
+    $$COMMON_PATH/utils/protobuf_summary.h \
     $$COMMON_PATH/utils/executable_signature/executable_signature.h \
     $$COMMON_PATH/utils/ipvalidation.h \
     $$COMMON_PATH/version/appversion.h \
@@ -90,6 +101,7 @@ HEADERS += \
     $$COMMON_PATH/utils/hardcodedsettings.h \
     $$COMMON_PATH/utils/simplecrypt.h \
     $$COMMON_PATH/ipc/command.h \
+    $$COMMON_PATH/ipc/commandlog.h \
     $$COMMON_PATH/ipc/commandfactory.h \
     $$COMMON_PATH/ipc/connection.h \
     $$COMMON_PATH/ipc/iconnection.h \
@@ -100,3 +112,9 @@ HEADERS += \
     $$COMMON_PATH/ipc/tcpserver.h \
     $$COMMON_PATH/ipc/generated_proto/clientcommands.pb.h \
     $$COMMON_PATH/ipc/generated_proto/servercommands.pb.h
+
+# the headless engine daemon is built without QtWidgets
+!contains(CONFIG, windscribe_daemon) {
+    SOURCES += $$COMMON_PATH/utils/widgetutils.cpp
+    HEADERS += $$COMMON_PATH/utils/widgetutils.h
+}
@@ -0,0 +1,75 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QSocketNotifier>
+#include <QTimer>
+#include "engine/engineserver.h"
+#include "utils/logger.h"
+#include "version/appversion.h"
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// SIGTERM/SIGINT are forwarded through a socket pair, so the engine is stopped from the event loop
+// rather than from inside the signal handler.
+static int g_signalFd[2] = { -1, -1 };
+
+static void handler_signal(int signum)
+{
+    char c = static_cast<char>(signum);
+    ssize_t ret = ::write(g_signalFd[0], &c, sizeof(c));
+    Q_UNUSED(ret);
+}
+
+int main(int argc, char *argv[])
+{
+    qSetMessagePattern("[{gmt_time} %{time process}] [%{category}]\t %{message}");
+
+    QCoreApplication a(argc, argv);
+
+    // These values are used for QSettings by default, must be the same as in the GUI so the daemon
+    // picks up the saved login and engine settings.
+    a.setOrganizationName("Windscribe");
+    a.setApplicationName("Windscribe2");
+
+    Logger::instance().install("engine", true, false);
+
+    qCDebug(LOG_BASIC) << "App start time (headless daemon):" << QDateTime::currentDateTime().toString();
+    qCDebug(LOG_BASIC) << "App version:" << AppVersion::instance().fullVersionString();
+
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, g_signalFd) != 0)
+    {
+        qCDebug(LOG_BASIC) << "Can't create signal socket pair, exit";
+        return 1;
+    }
+    QSocketNotifier signalNotifier(g_signalFd[1], QSocketNotifier::Read);
+
+    EngineServer engineServer;
+    QObject::connect(&engineServer, SIGNAL(finished()), &a, SLOT(quit()));
+
+    bool isStopping = false;
+    QObject::connect(&signalNotifier, &QSocketNotifier::activated, [&engineServer, &isStopping]()
+    {
+        char c;
+        ssize_t ret = ::read(g_signalFd[1], &c, sizeof(c));
+        Q_UNUSED(ret);
+        qCDebug(LOG_BASIC) << "Signal received:" << static_cast<int>(c);
+        if (!isStopping)
+        {
+            isStopping = true;
+            engineServer.stopDaemon();
+        }
+    });
+
+    signal(SIGTERM, handler_signal);
+    signal(SIGINT, handler_signal);
+
+    QTimer::singleShot(0, &engineServer, SLOT(startDaemon()));
+
+    int ret = a.exec();
+
+    ::close(g_signalFd[0]);
+    ::close(g_signalFd[1]);
+    qCDebug(LOG_BASIC) << "Headless daemon finished";
+    return ret;
+}
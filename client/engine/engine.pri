@@ -50,6 +50,10 @@ HEADERS += $$PWD/engine/connectionmanager/adapterutils_win.h \
            $$PWD/engine/macaddresscontroller/macaddresscontroller_win.h \
            $$PWD/engine/networkdetectionmanager/networkdetectionmanager_win.h \
            $$PWD/engine/networkdetectionmanager/networkchangeworkerthread.h
+
+# zlib for the compressed debug log upload, the same library curl is built with
+INCLUDEPATH += $$BUILD_LIBS_PATH/zlib/include
+LIBS += -L$$BUILD_LIBS_PATH/zlib/lib -lzdll
 } #end win32
 
 macx {
@@ -94,6 +98,9 @@ OBJECTIVE_SOURCES += $$PWD/engine/connectionmanager/sleepevents_mac.mm \
                      $$PWD/engine/proxy/autodetectproxy_mac.mm \
                      $$PWD/engine/connectionmanager/ikev2connection_mac.mm
 
+# zlib for the compressed debug log upload
+LIBS += -lz
+
 } # end macx
 
 
@@ -108,6 +115,7 @@ SOURCES += \
            $$PWD/engine/firewall/firewallcontroller_linux.cpp \
            $$PWD/engine/connectionmanager/ikev2connection_linux.cpp \
            $$PWD/engine/networkdetectionmanager/networkdetectionmanager_linux.cpp \
+           $$PWD/engine/networkdetectionmanager/routemonitor_linux.cpp \
            $$PWD/engine/macaddresscontroller/macaddresscontroller_linux.cpp
 
 HEADERS += \
@@ -118,8 +126,12 @@ HEADERS += \
            $$PWD/engine/firewall/firewallcontroller_linux.h \
            $$PWD/engine/connectionmanager/ikev2connection_linux.h \
            $$PWD/engine/networkdetectionmanager/networkdetectionmanager_linux.h \
+           $$PWD/engine/networkdetectionmanager/routemonitor_linux.h \
            $$PWD/engine/macaddresscontroller/macaddresscontroller_linux.h
 
+# zlib for the compressed debug log upload
+LIBS += -lz
+
 } # linux
 
 
@@ -136,11 +148,13 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/apiinfo/staticips.cpp \
     $$PWD/engine/apiinfo/servercredentials.cpp \
     $$PWD/engine/autoupdater/downloadhelper.cpp \
+    $$PWD/engine/networkdetectionmanager/networkchangecoalescer.cpp \
     $$PWD/engine/ping/keepalivemanager.cpp \
     $$PWD/engine/locationsmodel/enginelocationsmodel.cpp \
     $$PWD/engine/locationsmodel/apilocationsmodel.cpp \
     $$PWD/engine/locationsmodel/customconfiglocationsmodel.cpp \
     $$PWD/engine/locationsmodel/locationitem.cpp \
+    $$PWD/engine/locationsmodel/locationsdelta.cpp \
     $$PWD/engine/locationsmodel/pingipscontroller.cpp \
     $$PWD/engine/locationsmodel/pingstorage.cpp \
     $$PWD/engine/locationsmodel/bestlocation.cpp \
@@ -158,7 +172,7 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/proxy/proxysettings.cpp \
     $$PWD/engine/types/connectionsettings.cpp \
     $$PWD/engine/getmyipcontroller.cpp \
-    $$PWD/engine/firewall/uniqueiplist.cpp \
+    $$PWD/engine/firewall/ipaddressset.cpp \
     $$PWD/engine/firewall/firewallexceptions.cpp \
     $$PWD/engine/firewall/firewallcontroller.cpp \
     $$PWD/engine/proxy/proxyservercontroller.cpp \
@@ -200,6 +214,7 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/types/types.cpp \
     $$PWD/engine/serverapi/curlnetworkmanager.cpp \
     $$PWD/engine/serverapi/curlrequest.cpp \
+    $$PWD/engine/serverapi/debuglogbody.cpp \
     $$PWD/engine/serverapi/dnscache.cpp \
     $$PWD/engine/serverapi/serverapi.cpp \
     $$PWD/engine/engine.cpp \
@@ -226,7 +241,9 @@ SOURCES += $$PWD/engine/apiinfo/apiinfo.cpp \
     $$PWD/engine/customconfigs/customconfigsdirwatcher.cpp \
     $$PWD/engine/types/wireguardconfig.cpp \
     $$PWD/engine/getdeviceid.cpp \
+    $$PWD/enginenotificationmailbox.cpp \
     $$PWD/engineserver.cpp \
+    $$PWD/trafficstatistics.cpp \
     $$PWD/clientconnectiondescr.cpp \
     $$PWD/engine/connectionmanager/finishactiveconnections.cpp \
     $$PWD/engine/networkaccessmanager/certmanager.cpp \
@@ -242,6 +259,7 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/locationsmodel/apilocationsmodel.h \
     $$PWD/engine/locationsmodel/customconfiglocationsmodel.h \
     $$PWD/engine/locationsmodel/locationitem.h \
+    $$PWD/engine/locationsmodel/locationsdelta.h \
     $$PWD/engine/locationsmodel/pingipscontroller.h \
     $$PWD/engine/locationsmodel/pingstorage.h \
     $$PWD/engine/locationsmodel/bestlocation.h \
@@ -266,6 +284,7 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/autoupdater/downloadhelper.h \
     $$PWD/engine/macaddresscontroller/imacaddresscontroller.h \
     $$PWD/engine/networkdetectionmanager/inetworkdetectionmanager.h \
+    $$PWD/engine/networkdetectionmanager/networkchangecoalescer.h \
     $$PWD/engine/ping/keepalivemanager.h \
     $$PWD/engine/packetsizecontroller.h \
     $$PWD/engine/enginesettings.h \
@@ -276,7 +295,7 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/proxy/proxysettings.h \
     $$PWD/engine/types/connectionsettings.h \
     $$PWD/engine/getmyipcontroller.h \
-    $$PWD/engine/firewall/uniqueiplist.h \
+    $$PWD/engine/firewall/ipaddressset.h \
     $$PWD/engine/helper/ihelper.h \
     $$PWD/engine/firewall/firewallcontroller.h \
     $$PWD/engine/firewall/firewallexceptions.h \
@@ -322,6 +341,7 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/openvpnversioncontroller.h \
     $$PWD/engine/serverapi/curlnetworkmanager.h \
     $$PWD/engine/serverapi/curlrequest.h \
+    $$PWD/engine/serverapi/debuglogbody.h \
     $$PWD/engine/serverapi/dnscache.h \
     $$PWD/engine/serverapi/serverapi.h \
     $$PWD/engine/engine.h \
@@ -352,7 +372,9 @@ HEADERS  +=  $$PWD/engine/locationsmodel/enginelocationsmodel.h \
     $$PWD/engine/customconfigs/customconfigsdirwatcher.h \
     $$PWD/engine/types/wireguardconfig.h \
     $$PWD/engine/getdeviceid.h \
+    $$PWD/enginenotificationmailbox.h \
     $$PWD/engineserver.h \
+    $$PWD/trafficstatistics.h \
     $$PWD/clientconnectiondescr.h \
     $$PWD/engine/connectionmanager/finishactiveconnections.h \
     $$PWD/engine/networkaccessmanager/certmanager.h \
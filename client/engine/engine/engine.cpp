@@ -1056,7 +1056,7 @@ void Engine::connectClickImpl(const LocationID &locationId)
         if (!bFirewallStateOn)
         {
             qCDebug(LOG_BASIC) << "Automatic enable firewall before connection";
-            QString ips = firewallExceptions_.getIPAddressesForFirewall();
+            const IpAddressSet ips = firewallExceptions_.getIPAddressesForFirewall();
             firewallController_->firewallOn(ips, engineSettings_.isAllowLanTraffic());
             Q_EMIT firewallStateChanged(true);
         }
@@ -1079,32 +1079,13 @@ void Engine::sendDebugLogImpl()
         userName = apiInfo_->getSessionStatus().getUsername();
     }
 
-#ifdef Q_OS_WIN
-    if (!MergeLog::canMerge())
-    {
-        Q_EMIT sendUserWarning(ProtoTypes::USER_WARNING_SEND_LOG_FILE_TOO_BIG);
-        return;
-    }
-#endif
-
-    QString log = MergeLog::mergePrevLogs(true);
-    log += "================================================================================================================================================================================================\n";
-    log += "================================================================================================================================================================================================\n";
-    log += MergeLog::mergeLogs(true);
-
-    /*
-    // For testing merge log functionality
-    QString path = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
-    path += "/merged_logs.txt";
-    QFile file(path);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
-    {
-        file.write(log.toLatin1());
-        file.close();
-    }
-    */
-
-    serverAPI_->debugLog(userName, log, serverApiUserRole_, true);
+    // the logs are merged right into the request body when it is made, they don't have to fit in memory
+    serverAPI_->debugLog(userName, [](QIODevice *out) {
+        const char separator[] = "================================================================================================================================================================================================\n";
+        return MergeLog::mergePrevLogsTo(out, true) &&
+               out->write(separator) > 0 && out->write(separator) > 0 &&
+               MergeLog::mergeLogsTo(out, true);
+    }, serverApiUserRole_, true);
 }
 
 void Engine::getWebSessionTokenImpl(ProtoTypes::WebSessionPurpose purpose)
@@ -1711,7 +1692,7 @@ void Engine::onConnectionManagerConnected()
             if (!firewallController_->firewallActualState())
             {
                 qCDebug(LOG_BASIC) << "Automatic enable firewall after connection";
-                QString ips = firewallExceptions_.getIPAddressesForFirewallForConnectedState(connectionManager_->getLastConnectedIp());
+                const IpAddressSet ips = firewallExceptions_.getIPAddressesForFirewallForConnectedState(connectionManager_->getLastConnectedIp());
                 firewallController_->firewallOn(ips, engineSettings_.isAllowLanTraffic());
                 Q_EMIT firewallStateChanged(true);
                 isFirewallAlreadyEnabled = true;
@@ -2836,7 +2817,7 @@ void Engine::doDisconnectRestoreStuff()
 #endif
     if (firewallController_->firewallActualState())
     {
-        QString ips = firewallExceptions_.getIPAddressesForFirewall();
+        const IpAddressSet ips = firewallExceptions_.getIPAddressesForFirewall();
         firewallController_->firewallOn(ips, engineSettings_.isAllowLanTraffic());
     }
 
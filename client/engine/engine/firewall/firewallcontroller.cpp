@@ -7,7 +7,7 @@ FirewallController::FirewallController(QObject *parent) : QObject(parent),
 {
 }
 
-bool FirewallController::firewallOn(const QString &ip, bool bAllowLanTraffic)
+bool FirewallController::firewallOn(const IpAddressSet &ips, bool bAllowLanTraffic)
 {
     if (!bInitialized_)
     {
@@ -16,9 +16,9 @@ bool FirewallController::firewallOn(const QString &ip, bool bAllowLanTraffic)
     }
     else
     {
-        bStateChanged_ = (latestEnabledState_ != true || latestIp_ != ip || latestAllowLanTraffic_ != bAllowLanTraffic);
+        bStateChanged_ = (latestEnabledState_ != true || latestIps_ != ips || latestAllowLanTraffic_ != bAllowLanTraffic);
     }
-    latestIp_ = ip;
+    latestIps_ = ips;
     latestAllowLanTraffic_ = bAllowLanTraffic;
     latestEnabledState_ = true;
     return true;
@@ -64,8 +64,3 @@ bool FirewallController::isStateChanged()
 {
     return bStateChanged_;
 }
-
-int FirewallController::countIps(const QString &ips)
-{
-    return ips.count(';') + 1;
-}
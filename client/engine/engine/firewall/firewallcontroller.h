@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include "engine/apiinfo/staticips.h"
+#include "ipaddressset.h"
 
 class IHelper;
 
@@ -16,7 +17,7 @@ public:
     virtual ~FirewallController() {}
 
     // this function also uses for change firewall ips, then it is already enabled
-    virtual bool firewallOn(const QString &ip, bool bAllowLanTraffic);
+    virtual bool firewallOn(const IpAddressSet &ips, bool bAllowLanTraffic);
     virtual bool firewallOff();
     virtual bool firewallActualState() = 0;
 
@@ -29,9 +30,8 @@ public:
 
 protected:
     bool isStateChanged();
-    int countIps(const QString &ips);
 
-    QString latestIp_;
+    IpAddressSet latestIps_;
     bool latestAllowLanTraffic_;
     bool latestEnabledState_;
     apiinfo::StaticIpPortsVector latestStaticIpPorts_;
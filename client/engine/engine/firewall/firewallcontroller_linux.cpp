@@ -4,10 +4,24 @@
 #include "utils/utils.h"
 #include <QDir>
 #include "engine/helper/ihelper.h"
+#include <QElapsedTimer>
+#include <QSet>
+
+namespace
+{
+// the set of the allowed IPs matched by the windscribe_input/windscribe_output rules
+const QString IPSET_NAME = "windscribe_ips";
+const QString IPSET_TEMP_NAME = "windscribe_ips_new";
+const int IPSET_MAX_ELEMENTS = 262144;
+// the state applied by the controller is checked in full at this interval at most, unless it's found changed
+const qint64 FULL_CHECK_INTERVAL_MS = 60 * 1000;
+}
 
 FirewallController_linux::FirewallController_linux(QObject *parent, IHelper *helper) :
     FirewallController(parent), forceUpdateInterfaceToSkip_(false), mutex_(QMutex::Recursive),
-    comment_("\"Windscribe client rule\"")
+    comment_("\"Windscribe client rule\""), isIpsetUnsupported_(false), appliedUseIpset_(false),
+    bootUseIpset_(false), isNftUnsupported_(false), isNftApplied_(false), knownState_(KNOWN_STATE_UNKNOWN),
+    iptablesBackend_(IPTABLES_BACKEND_UNKNOWN), isKnownGenerationValid_(false), knownGeneration_(0)
 {
     helper_ = dynamic_cast<Helper_linux *>(helper);
 
@@ -15,28 +29,30 @@ FirewallController_linux::FirewallController_linux(QObject *parent, IHelper *hel
     QDir dir(pathToIp6SavedTable_);
     dir.mkpath(pathToIp6SavedTable_);
     pathToTempTable_ = pathToIp6SavedTable_;
+    pathToIpsetTable_ = pathToIp6SavedTable_;
 
     pathToIp6SavedTable_ += "/ip6table_saved.txt";
     pathToTempTable_ += "/windscribe_table.txt";
+    pathToIpsetTable_ += "/windscribe_ipset.txt";
 }
 
 FirewallController_linux::~FirewallController_linux()
 {
 }
 
-bool FirewallController_linux::firewallOn(const QString &ip, bool bAllowLanTraffic)
+bool FirewallController_linux::firewallOn(const IpAddressSet &ips, bool bAllowLanTraffic)
 {
     QMutexLocker locker(&mutex_);
-    FirewallController::firewallOn(ip, bAllowLanTraffic);
+    FirewallController::firewallOn(ips, bAllowLanTraffic);
     if (isStateChanged())
     {
-        qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall enabled with ips count:" << countIps(ip);
-        return firewallOnImpl(ip, bAllowLanTraffic, latestStaticIpPorts_);
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall enabled with ips count:" << ips.count();
+        return firewallOnImpl(ips, bAllowLanTraffic, latestStaticIpPorts_);
     }
     else if (forceUpdateInterfaceToSkip_)
     {
         qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall changed due to interface-to-skip update";
-        return firewallOnImpl(ip, bAllowLanTraffic, latestStaticIpPorts_);
+        return firewallOnImpl(ips, bAllowLanTraffic, latestStaticIpPorts_);
     }
     else
     {
@@ -50,67 +66,18 @@ bool FirewallController_linux::firewallOff()
     FirewallController::firewallOff();
     if (isStateChanged())
     {
-        QString cmd;
-        int exitCode;
-        QStringList rules = getWindscribeRules(comment_, true);
-
-        // delete Windscribe rules, if found
-        if (!rules.isEmpty())
-        {
-            if (rules.last().contains("COMMIT"))
-            {
-                rules.insert(rules.count() - 1, "-X windscribe_input");
-                rules.insert(rules.count() - 1, "-X windscribe_output");
-            }
-
-            QFile file2(pathToTempTable_);
-            if (file2.open(QIODevice::WriteOnly | QIODevice::Text))
-            {
-                QTextStream out(&file2);
-                for (const auto &l : rules)
-                {
-                    out << l << "\n";
-                }
-                file2.close();
-            }
-
-
-            cmd = "iptables-restore -n < " + pathToTempTable_;
-            helper_->executeRootCommand(cmd, &exitCode);
-            if (exitCode != 0)
-            {
-                qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
-            }
-        }
-        QFile::remove(pathToTempTable_);
-
-        if (QFile::exists(pathToIp6SavedTable_))
+        // the iptables rules were removed when the table was applied, and none were applied since
+        const bool isIptablesApplied = !isNftApplied_ || !appliedRules_.isEmpty();
+        if (!isNftUnsupported_)
         {
-            cmd = "ip6tables-restore < " + pathToIp6SavedTable_;
-            helper_->executeRootCommand(cmd, &exitCode);
-            if (exitCode != 0)
-            {
-                qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
-            }
-
-            QFile::remove(pathToIp6SavedTable_);
-        }
-
-
-        // remove rules from /etc/windscribe directory to avoid enabling them on OS reboot
-        cmd = "rm -f /etc/windscribe/rules.v4";
-        helper_->executeRootCommand(cmd, &exitCode);
-        if (exitCode != 0)
-        {
-            qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+            removeFirewallNft();
+            isNftApplied_ = false;
         }
-        cmd = "rm -f /etc/windscribe/rules.v6";
-        helper_->executeRootCommand(cmd, &exitCode);
-        if (exitCode != 0)
+        if (isIptablesApplied)
         {
-            qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+            removeIptablesRules();
         }
-
+        setKnownState(KNOWN_STATE_OFF);
         return true;
     }
     else
@@ -122,14 +89,31 @@ bool FirewallController_linux::firewallOff()
 bool FirewallController_linux::firewallActualState()
 {
     QMutexLocker locker(&mutex_);
-    if (helper_->currentState() != IHelper::STATE_CONNECTED)
+    if (!isHelperConnected())
     {
         return false;
     }
 
-    int exitCode;
-    helper_->executeRootCommand("iptables --check INPUT -j windscribe_input -m comment --comment " + comment_ + " 2>&-", &exitCode);
-    return exitCode == 0;
+    // the state applied last is taken as it is while the cheap verification confirms it, the full check runs the
+    // iptables command and is only done now and then
+    if (knownState_ != KNOWN_STATE_UNKNOWN && knownStateTimer_.elapsed() < FULL_CHECK_INTERVAL_MS)
+    {
+        if (verifyKnownState())
+        {
+            return knownState_ != KNOWN_STATE_OFF;
+        }
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "The firewall state differs from the one applied, checking it in full";
+    }
+
+    if (!isNftUnsupported_ && isFirewallNftApplied())
+    {
+        setKnownState(KNOWN_STATE_NFT);
+    }
+    else
+    {
+        setKnownState(isIptablesRulesInstalled() ? KNOWN_STATE_IPTABLES : KNOWN_STATE_OFF);
+    }
+    return knownState_ != KNOWN_STATE_OFF;
 }
 
 bool FirewallController_linux::whitelistPorts(const apiinfo::StaticIpPortsVector &ports)
@@ -159,156 +143,653 @@ void FirewallController_linux::enableFirewallOnBoot(bool bEnable)
     //nothing todo for Linux
 }
 
-bool FirewallController_linux::firewallOnImpl(const QString &ip, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports)
+bool FirewallController_linux::isHelperConnected() const
+{
+    return helper_->currentState() == IHelper::STATE_CONNECTED;
+}
+
+QString FirewallController_linux::executeRootCommand(const QString &commandLine, int *exitCode)
+{
+    return helper_->executeRootCommand(commandLine, exitCode);
+}
+
+bool FirewallController_linux::applyFirewallNft(const QStringList &ips, bool bAllowLanTraffic)
+{
+    return helper_->applyFirewallNft(ips, interfaceToSkip_, bAllowLanTraffic);
+}
+
+bool FirewallController_linux::removeFirewallNft()
+{
+    return helper_->removeFirewallNft();
+}
+
+bool FirewallController_linux::isFirewallNftApplied()
+{
+    return helper_->isFirewallNftApplied();
+}
+
+bool FirewallController_linux::getNftGeneration(quint32 &generation)
+{
+    return helper_->getNftGeneration(generation);
+}
+
+void FirewallController_linux::setKnownState(KNOWN_STATE state)
+{
+    knownState_ = state;
+    knownStateTimer_.start();
+    // the table is confirmed by the helper itself
+    isKnownGenerationValid_ = (state == KNOWN_STATE_IPTABLES || state == KNOWN_STATE_OFF) &&
+                              getNftGeneration(knownGeneration_) && isIptablesNft();
+}
+
+// The nftables table is confirmed by the helper with a netlink request, which compares the generation of the
+// ruleset with the one the table was applied at. The rules of iptables-nft are in the same ruleset, so while its
+// generation is the one they were applied or found at, nothing has changed them. The rules of the legacy
+// iptables, and their absence, are not verified: they are taken as they were left until the next full check, as
+// checking them needs the iptables command run.
+bool FirewallController_linux::verifyKnownState()
+{
+    if (knownState_ == KNOWN_STATE_NFT)
+    {
+        return isFirewallNftApplied();
+    }
+    if (isKnownGenerationValid_)
+    {
+        quint32 generation = 0;
+        return getNftGeneration(generation) && generation == knownGeneration_;
+    }
+    return true;
+}
+
+// iptables-nft tells its backend in the version, "iptables v1.8.7 (nf_tables)"
+bool FirewallController_linux::isIptablesNft()
+{
+    if (iptablesBackend_ == IPTABLES_BACKEND_UNKNOWN)
+    {
+        int exitCode;
+        const QString version = executeRootCommand("iptables --version", &exitCode);
+        if (exitCode != 0)
+        {
+            return false;
+        }
+        iptablesBackend_ = version.contains("nf_tables") ? IPTABLES_BACKEND_NFT : IPTABLES_BACKEND_LEGACY;
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "iptables version:" << version.trimmed();
+    }
+    return iptablesBackend_ == IPTABLES_BACKEND_NFT;
+}
+
+bool FirewallController_linux::isIptablesRulesInstalled()
+{
+    int exitCode;
+    executeRootCommand("iptables --check INPUT -j windscribe_input -m comment --comment " + comment_ + " 2>&-", &exitCode);
+    return exitCode == 0;
+}
+
+// The rules applied last are taken as in place while the generation of the ruleset is the one they were applied
+// at, otherwise the jump to the windscribe_input chain is checked for.
+bool FirewallController_linux::isAppliedRulesInPlace()
+{
+    if (knownState_ == KNOWN_STATE_IPTABLES && isKnownGenerationValid_)
+    {
+        quint32 generation = 0;
+        if (getNftGeneration(generation) && generation == knownGeneration_)
+        {
+            return true;
+        }
+    }
+    return isIptablesRulesInstalled();
+}
+
+bool FirewallController_linux::firewallOnImpl(const IpAddressSet &allowedIps, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports)
 {
     // TODO: this is need for Linux?
     Q_UNUSED(ports);
 
+    // the iptables rules and the ipset set filter IPv4, the nftables table both families; the blocks of the set
+    // are sorted, so the same IPs make the same rules
+    const IpAddressSet ipv4Ips = allowedIps.filter(IpAddressSet::FAMILY_IPV4);
+    const QStringList ips = ipv4Ips.toStringList();
+    forceUpdateInterfaceToSkip_ = false;
+
+    // the helper replaces the whole nftables table in one netlink transaction, iptables is used where it can't
+    if (!isNftUnsupported_)
+    {
+        if (applyFirewallNft(allowedIps.toStringList(), bAllowLanTraffic))
+        {
+            if (!isNftApplied_)
+            {
+                // the iptables rules, applied before or restored on OS boot, would block what the table allows
+                if (!appliedRules_.isEmpty() || isIptablesRulesInstalled())
+                {
+                    removeIptablesRules();
+                }
+                isNftApplied_ = true;
+                qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall applied with nftables";
+            }
+            setKnownState(KNOWN_STATE_NFT);
+            return true;
+        }
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Can't apply the firewall with nftables, using iptables";
+        isNftUnsupported_ = true;
+        if (isNftApplied_)
+        {
+            removeFirewallNft();
+            isNftApplied_ = false;
+            setKnownState(KNOWN_STATE_UNKNOWN);
+        }
+    }
+
+    // the rules applied last may have been flushed by something else, a difference to them would be applied to
+    // rules which are gone
+    if (!appliedRules_.isEmpty() && !isAppliedRulesInPlace())
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "The firewall rules applied last are gone, reloading them";
+        clearAppliedState();
+    }
+
+    // the rules applied last are in place, change only what differs from them
+    if (!appliedRules_.isEmpty())
+    {
+        const QStringList rules = makeRules(ips, bAllowLanTraffic, appliedUseIpset_, appliedDnsLeaksRules_);
+        if (applyDelta(rules, ipv4Ips))
+        {
+            setKnownState(KNOWN_STATE_IPTABLES);
+            return true;
+        }
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Can't update the firewall rules incrementally, reloading them";
+    }
+
     // if the firewall is not installed by the program, then save iptables to file in order to restore when will we turn off the firewall
     if (!firewallActualState())
     {
         int exitCode;
         QString cmd = "ip6tables-save > " + pathToIp6SavedTable_;
-        helper_->executeRootCommand(cmd, &exitCode);
+        executeRootCommand(cmd, &exitCode);
         if (exitCode != 0)
         {
             qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
         }
     }
 
+    // the allowed IPs go to the ipset set matched by a single rule per chain, where ipset is supported
+    bool useIpset = !isIpsetUnsupported_ && updateIpset(ips);
+
     // get firewall rules, which could have been installed by a script update-resolv-conf/update-systemd-resolved to avoid DNS-leaks
     // if these rules exist, then we should leave(not delete) them.
     const QStringList dnsLeaksRules = getWindscribeRules("\"Windscribe client dns leak protection\"", false);
 
-    forceUpdateInterfaceToSkip_ = false;
-
-    QFile file(pathToTempTable_);
-    if (file.open(QIODevice::WriteOnly))
+    QStringList rules = makeRules(ips, bAllowLanTraffic, useIpset, dnsLeaksRules);
+    if (!restoreRules(rules))
     {
-        QTextStream stream(&file);
+        if (!useIpset)
+        {
+            clearAppliedState();
+            setKnownState(KNOWN_STATE_UNKNOWN);
+            return false;
+        }
+        // the set match extension may be missing in the kernel even if ipset works, use a rule per IP then
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Can't apply the rules with the ipset set, falling back to a rule per ip";
+        isIpsetUnsupported_ = true;
+        useIpset = false;
+        rules = makeRules(ips, bAllowLanTraffic, useIpset, dnsLeaksRules);
+        if (!restoreRules(rules))
+        {
+            clearAppliedState();
+            setKnownState(KNOWN_STATE_UNKNOWN);
+            return false;
+        }
+        destroyIpset();
+    }
+    appliedRules_ = rules;
+    appliedIps_ = ipv4Ips;
+    appliedUseIpset_ = useIpset;
+    appliedDnsLeaksRules_ = dnsLeaksRules;
 
-        stream << "*filter\n";
-        stream << ":windscribe_input - [0:0]\n";
-        stream << ":windscribe_output - [0:0]\n";
+    // disable IPv6
+    QStringList cmds;
+    cmds << "ip6tables -P INPUT DROP";
+    cmds << "ip6tables -P OUTPUT DROP";
+    cmds << "ip6tables -P FORWARD DROP";
+    cmds << "ip6tables -Z";
+    cmds << "ip6tables -F";
+    cmds << "ip6tables -X";
 
-        if (!dnsLeaksRules.isEmpty())
+    for (auto &cmd : cmds)
+    {
+        int exitCode;
+        executeRootCommand(cmd, &exitCode);
+        if (exitCode != 0)
         {
-            stream << ":windscribe_dnsleaks - [0:0]\n";
-            for (auto &rule : dnsLeaksRules)
-            {
-                if (rule.startsWith("-A"))
-                {
-                    stream << rule + "\n";
-                }
-            }
+            qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
         }
+    }
+
+    saveForBoot(rules, ipv4Ips, useIpset);
 
-        stream << "-A INPUT -j windscribe_input -m comment --comment " + comment_ + "\n";
-        stream << "-A OUTPUT -j windscribe_output -m comment --comment " + comment_ + "\n";
+    setKnownState(KNOWN_STATE_IPTABLES);
+    return true;
+}
 
-        stream << "-A windscribe_input -i lo -j ACCEPT -m comment --comment " + comment_ + "\n";
-        stream << "-A windscribe_output -o lo -j ACCEPT -m comment --comment " + comment_ + "\n";
+// Applies the difference between |rules| and the rules applied last, and between the |ips| and the set applied
+// last, with one command for the set and one for the rules at most. The rules are changed in a single
+// iptables-restore transaction, and the new IPs are added to the set before the old ones are removed, so no
+// traffic is let through unfiltered meanwhile. Returns false if the difference can't be applied this way.
+bool FirewallController_linux::applyDelta(const QStringList &rules, const IpAddressSet &ips)
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    // only the rules of the windscribe_input and windscribe_output chains are changed in place, the positions
+    // of the others (the jumps from INPUT and OUTPUT, the DNS leak rules) are unknown
+    auto isOwnChainRule = [](const QString &rule) {
+        return rule.startsWith("-A windscribe_input ") || rule.startsWith("-A windscribe_output ");
+    };
+    QStringList otherRules, appliedOtherRules;
+    for (const auto &rule : rules)
+    {
+        if (!isOwnChainRule(rule))
+            otherRules << rule;
+    }
+    for (const auto &rule : qAsConst(appliedRules_))
+    {
+        if (!isOwnChainRule(rule))
+            appliedOtherRules << rule;
+    }
+    const QSet<QString> ruleSet = QSet<QString>::fromList(rules);
+    const QSet<QString> appliedRuleSet = QSet<QString>::fromList(appliedRules_);
+    // a repeated rule can't be told from its copy by the position
+    if (otherRules != appliedOtherRules || ruleSet.count() != rules.count() ||
+        appliedRuleSet.count() != appliedRules_.count())
+    {
+        return false;
+    }
 
-        if (!interfaceToSkip_.isEmpty())
+    QStringList ruleCommands;
+    for (const auto &rule : qAsConst(appliedRules_))
+    {
+        if (isOwnChainRule(rule) && !ruleSet.contains(rule))
+        {
+            ruleCommands << "-D" + rule.mid(2);
+        }
+    }
+    // the rules left keep their order, so each new rule goes to its position in the new chain
+    const int removedRulesCount = ruleCommands.count();
+    QHash<QString, int> chainPositions;
+    for (const auto &rule : rules)
+    {
+        if (!isOwnChainRule(rule))
+            continue;
+        const QString chain = rule.section(' ', 1, 1);
+        const int position = ++chainPositions[chain];
+        if (!appliedRuleSet.contains(rule))
         {
-            stream << "-A windscribe_input -i " + interfaceToSkip_ + " -j ACCEPT -m comment --comment " + comment_ + "\n";
-            stream << "-A windscribe_output -o " + interfaceToSkip_ + " -j ACCEPT -m comment --comment " + comment_ + "\n";
+            ruleCommands << "-I " + chain + " " + QString::number(position) + rule.mid(2 + 1 + chain.length());
         }
+    }
 
-        const QStringList ips = ip.split(';');
-        for (auto &i : ips)
+    QStringList ipCommands;
+    int addedIpsCount = 0;
+    if (appliedUseIpset_)
+    {
+        for (const auto &i : ips.difference(appliedIps_).toStringList())
+        {
+            ipCommands << "add " + IPSET_NAME + " " + i + " -exist";
+        }
+        addedIpsCount = ipCommands.count();
+        for (const auto &i : appliedIps_.difference(ips).toStringList())
         {
-            stream << "-A windscribe_input -s " + i + "/32 -j ACCEPT -m comment --comment " + comment_ + "\n";
-            stream << "-A windscribe_output -d " + i + "/32 -j ACCEPT -m comment --comment " + comment_ + "\n";
+            ipCommands << "del " + IPSET_NAME + " " + i + " -exist";
         }
+    }
+
+    if (ruleCommands.isEmpty() && ipCommands.isEmpty())
+    {
+        return true;
+    }
+    const int addedRulesCount = ruleCommands.count() - removedRulesCount;
 
-        if (bAllowLanTraffic)
+    if (!ipCommands.isEmpty())
+    {
+        if (!writeLines(pathToIpsetTable_, ipCommands))
+        {
+            return false;
+        }
+        int exitCode;
+        QString cmd = "ipset restore < " + pathToIpsetTable_;
+        executeRootCommand(cmd, &exitCode);
+        QFile::remove(pathToIpsetTable_);
+        if (exitCode != 0)
         {
-            // Local Network
-            stream << "-A windscribe_input -s 192.168.0.0/16 -j ACCEPT -m comment --comment " + comment_ + "\n";
-            stream << "-A windscribe_output -d 192.168.0.0/16 -j ACCEPT -m comment --comment " + comment_ + "\n";
+            qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+            return false;
+        }
+        appliedIps_ = ips;
+    }
 
-            stream << "-A windscribe_input -s 172.16.0.0/12 -j ACCEPT -m comment --comment " + comment_ + "\n";
-            stream << "-A windscribe_output -d 172.16.0.0/12 -j ACCEPT -m comment --comment " + comment_ + "\n";
+    if (!ruleCommands.isEmpty())
+    {
+        ruleCommands.prepend("*filter");
+        ruleCommands << "COMMIT";
+        if (!writeLines(pathToTempTable_, ruleCommands))
+        {
+            return false;
+        }
+        int exitCode;
+        QString cmd = "iptables-restore -n < " + pathToTempTable_;
+        executeRootCommand(cmd, &exitCode);
+        QFile::remove(pathToTempTable_);
+        if (exitCode != 0)
+        {
+            qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+            return false;
+        }
+        appliedRules_ = rules;
+    }
+    saveForBoot(appliedRules_, appliedIps_, appliedUseIpset_);
 
-            stream << "-A windscribe_input -s 10.0.0.0/8 -j ACCEPT -m comment --comment " + comment_ + "\n";
-            stream << "-A windscribe_output -d 10.0.0.0/8 -j ACCEPT -m comment --comment " + comment_ + "\n";
+    qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall updated incrementally:"
+                                     << addedRulesCount << "rules added," << removedRulesCount << "rules removed," << addedIpsCount << "ips added,"
+                                     << ipCommands.count() - addedIpsCount << "ips removed, in"
+                                     << elapsedTimer.elapsed() << "ms";
+    return true;
+}
 
-            // Loopback addresses to the local host
-            stream << "-A windscribe_input -s 127.0.0.0/8 -j ACCEPT -m comment --comment " + comment_ + "\n";
+// deletes the Windscribe rules from iptables, restores the IPv6 rules saved before they were applied and removes
+// the rules restored on OS boot
+void FirewallController_linux::removeIptablesRules()
+{
+    QString cmd;
+    int exitCode;
+    QStringList rules = getWindscribeRules(comment_, true);
 
-            // Multicast addresses
-            stream << "-A windscribe_input -s 224.0.0.0/4 -j ACCEPT -m comment --comment " + comment_ + "\n";
+    // delete Windscribe rules, if found
+    if (!rules.isEmpty())
+    {
+        if (rules.last().contains("COMMIT"))
+        {
+            rules.insert(rules.count() - 1, "-X windscribe_input");
+            rules.insert(rules.count() - 1, "-X windscribe_output");
         }
 
-        stream << "-A windscribe_input -j DROP -m comment --comment " + comment_ + "\n";
-        stream << "-A windscribe_output -j DROP -m comment --comment " + comment_ + "\n";
-        stream << "COMMIT\n";
-
-        file.close();
+        QFile file2(pathToTempTable_);
+        if (file2.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            QTextStream out(&file2);
+            for (const auto &l : rules)
+            {
+                out << l << "\n";
+            }
+            file2.close();
+        }
 
 
-        int exitCode;
-        QString cmd = "iptables-restore < " + pathToTempTable_;
-        helper_->executeRootCommand(cmd, &exitCode);
+        cmd = "iptables-restore -n < " + pathToTempTable_;
+        executeRootCommand(cmd, &exitCode);
         if (exitCode != 0)
         {
             qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
         }
-
-        file.remove();
     }
-    else
+    QFile::remove(pathToTempTable_);
+    clearAppliedState();
+
+    // the set can only be destroyed when no rule refers to it
+    if (!isIpsetUnsupported_)
     {
-        qCDebug(LOG_FIREWALL_CONTROLLER) << "Can't create file:" << pathToTempTable_;
-        return false;
+        destroyIpset();
     }
 
-    // disable IPv6
-    QStringList cmds;
-    cmds << "ip6tables -P INPUT DROP";
-    cmds << "ip6tables -P OUTPUT DROP";
-    cmds << "ip6tables -P FORWARD DROP";
-    cmds << "ip6tables -Z";
-    cmds << "ip6tables -F";
-    cmds << "ip6tables -X";
-
-    for (auto &cmd : cmds)
+    if (QFile::exists(pathToIp6SavedTable_))
     {
-        int exitCode;
-        helper_->executeRootCommand(cmd, &exitCode);
+        cmd = "ip6tables-restore < " + pathToIp6SavedTable_;
+        executeRootCommand(cmd, &exitCode);
         if (exitCode != 0)
         {
             qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
         }
+
+        QFile::remove(pathToIp6SavedTable_);
+    }
+
+
+    // remove rules from /etc/windscribe directory to avoid enabling them on OS reboot
+    cmd = "rm -f /etc/windscribe/rules.v4";
+    executeRootCommand(cmd, &exitCode);
+    if (exitCode != 0)
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
     }
+    cmd = "rm -f /etc/windscribe/rules.v6";
+    executeRootCommand(cmd, &exitCode);
+    if (exitCode != 0)
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+    }
+    saveIpsetForBoot(false);
+    bootRules_.clear();
+    bootIps_ = IpAddressSet();
+    bootUseIpset_ = false;
+}
+
+// saves the rules and the set to be restored on OS boot, each only if it differs from the one saved last
+void FirewallController_linux::saveForBoot(const QStringList &rules, const IpAddressSet &ips, bool useIpset)
+{
+    // nothing is known of the files before the first save, a set of an earlier run may be there
+    const bool isFirstSave = bootRules_.isEmpty();
+    if (rules != bootRules_)
+    {
+        saveRulesForBoot();
+        bootRules_ = rules;
+    }
+    if (isFirstSave || useIpset != bootUseIpset_ || (useIpset && ips != bootIps_))
+    {
+        saveIpsetForBoot(useIpset);
+        bootUseIpset_ = useIpset;
+        bootIps_ = useIpset ? ips : IpAddressSet();
+    }
+}
 
-    // save current rules to /etc/windscribe directory to make it restorable on OS boot with windscribe-helper
+// save current rules to /etc/windscribe directory to make it restorable on OS boot with windscribe-helper
+void FirewallController_linux::saveRulesForBoot()
+{
     int exitCode;
     QString cmd = "iptables-save > /etc/windscribe/rules.v4";
-    helper_->executeRootCommand(cmd, &exitCode);
+    executeRootCommand(cmd, &exitCode);
     if (exitCode != 0)
     {
         qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
     }
 
     cmd = "ip6tables-save > /etc/windscribe/rules.v6";
-    helper_->executeRootCommand(cmd, &exitCode);
+    executeRootCommand(cmd, &exitCode);
     if (exitCode != 0)
     {
         qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
     }
+}
+
+void FirewallController_linux::clearAppliedState()
+{
+    appliedRules_.clear();
+    appliedIps_ = IpAddressSet();
+    appliedUseIpset_ = false;
+    appliedDnsLeaksRules_.clear();
+}
 
+bool FirewallController_linux::writeLines(const QString &path, const QStringList &lines)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Can't create file:" << path;
+        return false;
+    }
+    QTextStream stream(&file);
+    for (const auto &line : lines)
+    {
+        stream << line << "\n";
+    }
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
+
+QStringList FirewallController_linux::makeRules(const QStringList &ips, bool bAllowLanTraffic, bool useIpset,
+                                                const QStringList &dnsLeaksRules) const
+{
+    QStringList rules;
+    rules << "*filter";
+    rules << ":windscribe_input - [0:0]";
+    rules << ":windscribe_output - [0:0]";
+
+    if (!dnsLeaksRules.isEmpty())
+    {
+        rules << ":windscribe_dnsleaks - [0:0]";
+        for (auto &rule : dnsLeaksRules)
+        {
+            if (rule.startsWith("-A"))
+            {
+                rules << rule;
+            }
+        }
+    }
+
+    rules << "-A INPUT -j windscribe_input -m comment --comment " + comment_;
+    rules << "-A OUTPUT -j windscribe_output -m comment --comment " + comment_;
+
+    rules << "-A windscribe_input -i lo -j ACCEPT -m comment --comment " + comment_;
+    rules << "-A windscribe_output -o lo -j ACCEPT -m comment --comment " + comment_;
+
+    if (!interfaceToSkip_.isEmpty())
+    {
+        rules << "-A windscribe_input -i " + interfaceToSkip_ + " -j ACCEPT -m comment --comment " + comment_;
+        rules << "-A windscribe_output -o " + interfaceToSkip_ + " -j ACCEPT -m comment --comment " + comment_;
+    }
+
+    if (useIpset)
+    {
+        rules << "-A windscribe_input -m set --match-set " + IPSET_NAME + " src -j ACCEPT -m comment --comment " + comment_;
+        rules << "-A windscribe_output -m set --match-set " + IPSET_NAME + " dst -j ACCEPT -m comment --comment " + comment_;
+    }
+    else
+    {
+        for (auto &i : ips)
+        {
+            // a single address with its prefix, as iptables-save lists it
+            const QString net = i.contains('/') ? i : i + "/32";
+            rules << "-A windscribe_input -s " + net + " -j ACCEPT -m comment --comment " + comment_;
+            rules << "-A windscribe_output -d " + net + " -j ACCEPT -m comment --comment " + comment_;
+        }
+    }
+
+    if (bAllowLanTraffic)
+    {
+        // Local Network
+        rules << "-A windscribe_input -s 192.168.0.0/16 -j ACCEPT -m comment --comment " + comment_;
+        rules << "-A windscribe_output -d 192.168.0.0/16 -j ACCEPT -m comment --comment " + comment_;
+
+        rules << "-A windscribe_input -s 172.16.0.0/12 -j ACCEPT -m comment --comment " + comment_;
+        rules << "-A windscribe_output -d 172.16.0.0/12 -j ACCEPT -m comment --comment " + comment_;
+
+        rules << "-A windscribe_input -s 10.0.0.0/8 -j ACCEPT -m comment --comment " + comment_;
+        rules << "-A windscribe_output -d 10.0.0.0/8 -j ACCEPT -m comment --comment " + comment_;
+
+        // Loopback addresses to the local host
+        rules << "-A windscribe_input -s 127.0.0.0/8 -j ACCEPT -m comment --comment " + comment_;
+
+        // Multicast addresses
+        rules << "-A windscribe_input -s 224.0.0.0/4 -j ACCEPT -m comment --comment " + comment_;
+    }
+
+    rules << "-A windscribe_input -j DROP -m comment --comment " + comment_;
+    rules << "-A windscribe_output -j DROP -m comment --comment " + comment_;
+    rules << "COMMIT";
+    return rules;
+}
+
+bool FirewallController_linux::restoreRules(const QStringList &rules)
+{
+    if (!writeLines(pathToTempTable_, rules))
+    {
+        return false;
+    }
+
+    int exitCode;
+    QString cmd = "iptables-restore < " + pathToTempTable_;
+    executeRootCommand(cmd, &exitCode);
+    if (exitCode != 0)
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+    }
+
+    QFile::remove(pathToTempTable_);
+    return exitCode == 0;
+}
+
+// Fills the set of allowed IPs: a new set is filled and swapped with the one in use in a single ipset restore,
+// so the rules which match it never see it half-filled.
+bool FirewallController_linux::updateIpset(const QStringList &ips)
+{
+    QFile file(pathToIpsetTable_);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Can't create file:" << pathToIpsetTable_;
+        return false;
+    }
+    const QString createParams = " hash:net family inet maxelem " + QString::number(IPSET_MAX_ELEMENTS) + " -exist";
+    QTextStream stream(&file);
+    stream << "create " << IPSET_NAME << createParams << "\n";
+    stream << "create " << IPSET_TEMP_NAME << createParams << "\n";
+    stream << "flush " << IPSET_TEMP_NAME << "\n";
+    for (const auto &i : ips)
+    {
+        stream << "add " << IPSET_TEMP_NAME << " " << i << " -exist\n";
+    }
+    stream << "swap " << IPSET_TEMP_NAME << " " << IPSET_NAME << "\n";
+    stream << "destroy " << IPSET_TEMP_NAME << "\n";
+    stream.flush();
+    file.close();
+
+    int exitCode;
+    QString cmd = "ipset restore < " + pathToIpsetTable_;
+    executeRootCommand(cmd, &exitCode);
+    file.remove();
+    if (exitCode != 0)
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd
+                                         << ", using a rule per ip";
+        executeRootCommand("ipset destroy " + IPSET_TEMP_NAME + " 2>&-", &exitCode);
+        isIpsetUnsupported_ = true;
+        return false;
+    }
     return true;
 }
 
+void FirewallController_linux::destroyIpset()
+{
+    int exitCode;
+    executeRootCommand("ipset destroy " + IPSET_NAME + " 2>&-", &exitCode);
+}
+
+// the set has to be restored on OS boot before the rules which match it
+void FirewallController_linux::saveIpsetForBoot(bool isUsed)
+{
+    int exitCode;
+    QString cmd = isUsed ? "ipset save " + IPSET_NAME + " > /etc/windscribe/rules.ipset"
+                         : "rm -f /etc/windscribe/rules.ipset";
+    executeRootCommand(cmd, &exitCode);
+    if (exitCode != 0)
+    {
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
+    }
+}
+
 // Extract rules from iptables with comment.If modifyForDelete == true, then replace commands for delete.
 QStringList FirewallController_linux::getWindscribeRules(const QString &comment, bool modifyForDelete)
 {
     QStringList rules;
     int exitCode;
     QString cmd = "iptables-save > " + pathToTempTable_;
-    helper_->executeRootCommand(cmd, &exitCode);
+    executeRootCommand(cmd, &exitCode);
     if (exitCode != 0)
     {
         qCDebug(LOG_FIREWALL_CONTROLLER) << "Unsuccessful exit code:" << exitCode << " for cmd:" << cmd;
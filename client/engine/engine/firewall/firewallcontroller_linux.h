@@ -1,6 +1,7 @@
 #ifndef FIREWALLCONTROLLER_LINUX_H
 #define FIREWALLCONTROLLER_LINUX_H
 
+#include <QElapsedTimer>
 #include "firewallcontroller.h"
 #include "engine/helper/helper_linux.h"
 
@@ -12,7 +13,7 @@ public:
     explicit FirewallController_linux(QObject *parent, IHelper *helper);
     ~FirewallController_linux() override;
 
-    bool firewallOn(const QString &ip, bool bAllowLanTraffic) override;
+    bool firewallOn(const IpAddressSet &ips, bool bAllowLanTraffic) override;
     bool firewallOff() override;
     bool firewallActualState() override;
 
@@ -22,6 +23,15 @@ public:
     void setInterfaceToSkip_posix(const QString &interfaceToSkip) override;
     void enableFirewallOnBoot(bool bEnable) override;
 
+protected:
+    // the root commands are run by the helper; overridden in the tests
+    virtual bool isHelperConnected() const;
+    virtual QString executeRootCommand(const QString &commandLine, int *exitCode);
+    virtual bool applyFirewallNft(const QStringList &ips, bool bAllowLanTraffic);
+    virtual bool removeFirewallNft();
+    virtual bool isFirewallNftApplied();
+    virtual bool getNftGeneration(quint32 &generation);
+
 private:
     Helper_linux *helper_;
     QString interfaceToSkip_;
@@ -29,9 +39,50 @@ private:
     QMutex mutex_;
     QString pathToIp6SavedTable_;
     QString pathToTempTable_;
+    QString pathToIpsetTable_;
     QString comment_;
+    bool isIpsetUnsupported_;
+    // the state applied last, the next changes are applied as a difference to it; no rules if it's unknown
+    QStringList appliedRules_;
+    IpAddressSet appliedIps_;
+    bool appliedUseIpset_;
+    QStringList appliedDnsLeaksRules_;
+    // the rules and the set saved last to be restored on OS boot
+    QStringList bootRules_;
+    IpAddressSet bootIps_;
+    bool bootUseIpset_;
+    // the helper applies the firewall as an nftables table, unless it failed to
+    bool isNftUnsupported_;
+    bool isNftApplied_;
+    // the state applied or found last, and the time since it was
+    enum KNOWN_STATE { KNOWN_STATE_UNKNOWN, KNOWN_STATE_OFF, KNOWN_STATE_IPTABLES, KNOWN_STATE_NFT };
+    KNOWN_STATE knownState_;
+    QElapsedTimer knownStateTimer_;
+    // the generation of the nf_tables ruleset the iptables rules or their absence were known at, if iptables
+    // keeps its rules in nf_tables
+    enum IPTABLES_BACKEND { IPTABLES_BACKEND_UNKNOWN, IPTABLES_BACKEND_LEGACY, IPTABLES_BACKEND_NFT };
+    IPTABLES_BACKEND iptablesBackend_;
+    bool isKnownGenerationValid_;
+    quint32 knownGeneration_;
 
-    bool firewallOnImpl(const QString &ip, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports);
+    bool firewallOnImpl(const IpAddressSet &allowedIps, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports);
+    QStringList makeRules(const QStringList &ips, bool bAllowLanTraffic, bool useIpset,
+                          const QStringList &dnsLeaksRules) const;
+    bool applyDelta(const QStringList &rules, const IpAddressSet &ips);
+    void clearAppliedState();
+    void setKnownState(KNOWN_STATE state);
+    bool verifyKnownState();
+    bool isIptablesNft();
+    bool isIptablesRulesInstalled();
+    bool isAppliedRulesInPlace();
+    void removeIptablesRules();
+    bool writeLines(const QString &path, const QStringList &lines);
+    bool restoreRules(const QStringList &rules);
+    void saveForBoot(const QStringList &rules, const IpAddressSet &ips, bool useIpset);
+    void saveRulesForBoot();
+    bool updateIpset(const QStringList &ips);
+    void destroyIpset();
+    void saveIpsetForBoot(bool isUsed);
     QStringList getWindscribeRules(const QString &comment, bool modifyForDelete);
 };
 
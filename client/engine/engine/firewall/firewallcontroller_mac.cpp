@@ -15,19 +15,19 @@ FirewallController_mac::~FirewallController_mac()
 
 }
 
-bool FirewallController_mac::firewallOn(const QString &ip, bool bAllowLanTraffic)
+bool FirewallController_mac::firewallOn(const IpAddressSet &ips, bool bAllowLanTraffic)
 {
     QMutexLocker locker(&mutex_);
-    FirewallController::firewallOn(ip, bAllowLanTraffic);
+    FirewallController::firewallOn(ips, bAllowLanTraffic);
     if (isStateChanged())
     {
-        qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall changed with ips count:" << countIps(ip);
-        return firewallOnImpl(ip, bAllowLanTraffic, latestStaticIpPorts_);
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall changed with ips count:" << ips.count();
+        return firewallOnImpl(ips, bAllowLanTraffic, latestStaticIpPorts_);
     }
     else if (forceUpdateInterfaceToSkip_)
     {
         qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall changed due to interface-to-skip update";
-        return firewallOnImpl(ip, bAllowLanTraffic, latestStaticIpPorts_);
+        return firewallOnImpl(ips, bAllowLanTraffic, latestStaticIpPorts_);
     }
     else
     {
@@ -85,7 +85,7 @@ bool FirewallController_mac::whitelistPorts(const apiinfo::StaticIpPortsVector &
     FirewallController::whitelistPorts(ports);
     if (isStateChanged() && latestEnabledState_)
     {
-        return firewallOnImpl(latestIp_, latestAllowLanTraffic_, ports);
+        return firewallOnImpl(latestIps_, latestAllowLanTraffic_, ports);
     }
     else
     {
@@ -98,7 +98,7 @@ bool FirewallController_mac::deleteWhitelistPorts()
     return whitelistPorts(apiinfo::StaticIpPortsVector());
 }
 
-bool FirewallController_mac::firewallOnImpl(const QString &ip, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports )
+bool FirewallController_mac::firewallOnImpl(const IpAddressSet &ips, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports )
 {
     QString pfConfigFilePath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
     QDir dir(pfConfigFilePath);
@@ -130,9 +130,8 @@ bool FirewallController_mac::firewallOnImpl(const QString &ip, bool bAllowLanTra
     pf += "block in all\n";
     pf += "block out all\n";
 
-    QString ips =ip;
-    ips = ips.replace(";", " ");
-    pf += "table <windscribe_ips> const { " + ips + " }\n";
+    // the rules which match the table are for IPv4
+    pf += "table <windscribe_ips> const { " + ips.toStringList(IpAddressSet::FAMILY_IPV4).join(' ') + " }\n";
 
     pf += "pass out quick inet proto udp from 0.0.0.0 to 255.255.255.255 port = 67\n";
     pf += "pass in quick proto udp from any to any port = 68\n";
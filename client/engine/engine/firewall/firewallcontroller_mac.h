@@ -12,7 +12,7 @@ public:
     explicit FirewallController_mac(QObject *parent, IHelper *helper);
     ~FirewallController_mac() override;
 
-    bool firewallOn(const QString &ip, bool bAllowLanTraffic) override;
+    bool firewallOn(const IpAddressSet &ips, bool bAllowLanTraffic) override;
     bool firewallOff() override;
     bool firewallActualState() override;
 
@@ -27,7 +27,7 @@ private:
     QString interfaceToSkip_;
     bool forceUpdateInterfaceToSkip_;
     QMutex mutex_;
-    bool firewallOnImpl(const QString &ip, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports);
+    bool firewallOnImpl(const IpAddressSet &ips, bool bAllowLanTraffic, const apiinfo::StaticIpPortsVector &ports);
 };
 
 #endif // FIREWALLCONTROLLER_MAC_H
@@ -14,14 +14,15 @@ FirewallController_win::~FirewallController_win()
 
 }
 
-bool FirewallController_win::firewallOn(const QString &ip, bool bAllowLanTraffic)
+bool FirewallController_win::firewallOn(const IpAddressSet &ips, bool bAllowLanTraffic)
 {
     QMutexLocker locker(&mutex_);
-    FirewallController::firewallOn(ip, bAllowLanTraffic);
+    FirewallController::firewallOn(ips, bAllowLanTraffic);
     if (isStateChanged())
     {
-        qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall enabled with ips count:" << countIps(ip);
-        return helper_win_->firewallOn(ip, bAllowLanTraffic);
+        qCDebug(LOG_FIREWALL_CONTROLLER) << "firewall enabled with ips count:" << ips.count();
+        // the filters of the service match IPv4 addresses
+        return helper_win_->firewallOn(ips.toFirewallString(IpAddressSet::FAMILY_IPV4), bAllowLanTraffic);
     }
     else
     {
@@ -12,7 +12,7 @@ public:
     explicit FirewallController_win(QObject *parent, IHelper *helper);
     ~FirewallController_win() override;
 
-    bool firewallOn(const QString &ip, bool bAllowLanTraffic) override;
+    bool firewallOn(const IpAddressSet &ips, bool bAllowLanTraffic) override;
     bool firewallOff() override;
     bool firewallActualState() override;
 
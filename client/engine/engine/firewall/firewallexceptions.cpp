@@ -1,5 +1,4 @@
 #include "firewallexceptions.h"
-#include "uniqueiplist.h"
 #include <QThread>
 #include "utils/hardcodedsettings.h"
 #include "engine/dnsresolver/dnsutils.h"
@@ -71,11 +70,11 @@ void FirewallExceptions::setCustomConfigPingIps(const QStringList &listIps)
     customConfigsPingIPs_ = listIps;
 }
 
-QString FirewallExceptions::getIPAddressesForFirewall() const
+IpAddressSet FirewallExceptions::getIPAddressesForFirewall() const
 {
     //Q_ASSERT(QApplication::instance()->thread() == QThread::currentThread());
 
-    UniqueIpList ipList;
+    IpAddressSet ipList;
     ipList.add("127.0.0.1");
 
     // add dns servers
@@ -169,19 +168,19 @@ QString FirewallExceptions::getIPAddressesForFirewall() const
         }
     }
 
-    return ipList.getFirewallString();
+    return ipList;
 }
 
-QString FirewallExceptions::getIPAddressesForFirewallForConnectedState(const QString &connectedIp) const
+IpAddressSet FirewallExceptions::getIPAddressesForFirewallForConnectedState(const QString &connectedIp) const
 {
-    UniqueIpList ipList;
+    IpAddressSet ipList;
     ipList.add("127.0.0.1");
     ipList.add(connectedIp);
     if (!remoteIP_.isEmpty())
     {
         ipList.add(remoteIP_);
     }
-    return ipList.getFirewallString();
+    return ipList;
 }
 
 FirewallExceptions::FirewallExceptions(): dnsPolicyType_(DNS_TYPE_OPEN_DNS)
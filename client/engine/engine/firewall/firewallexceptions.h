@@ -3,6 +3,7 @@
 
 #include <QSharedPointer>
 #include "engine/proxy/proxysettings.h"
+#include "ipaddressset.h"
 
 class FirewallExceptions
 {
@@ -22,8 +23,8 @@ public:
     void setLocationsPingIps(const QStringList &listIps);
     void setCustomConfigPingIps(const QStringList &listIps);
 
-    QString getIPAddressesForFirewall() const;
-    QString getIPAddressesForFirewallForConnectedState(const QString &connectedIp) const;
+    IpAddressSet getIPAddressesForFirewall() const;
+    IpAddressSet getIPAddressesForFirewallForConnectedState(const QString &connectedIp) const;
 
 private:
     QStringList hostIPs_;
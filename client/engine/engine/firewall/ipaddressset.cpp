@@ -0,0 +1,337 @@
+#include "ipaddressset.h"
+#include <QHostAddress>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <tuple>
+
+namespace
+{
+struct Address
+{
+    quint64 high;
+    quint64 low;
+
+    bool operator==(const Address &other) const { return high == other.high && low == other.low; }
+    bool operator<(const Address &other) const
+    {
+        return high < other.high || (high == other.high && low < other.low);
+    }
+};
+
+int addressWidth(bool isIpv6)
+{
+    return isIpv6 ? 128 : 32;
+}
+
+// the lowest |hostBits| bits set
+Address hostMask(int hostBits)
+{
+    if (hostBits >= 128)
+        return { ~quint64(0), ~quint64(0) };
+    if (hostBits >= 64)
+        return { (quint64(1) << (hostBits - 64)) - 1, ~quint64(0) };
+    return { 0, hostBits == 0 ? 0 : (quint64(1) << hostBits) - 1 };
+}
+
+Address maxAddress(bool isIpv6)
+{
+    return hostMask(addressWidth(isIpv6));
+}
+
+Address increment(const Address &address)
+{
+    Address result = address;
+    if (++result.low == 0)
+        ++result.high;
+    return result;
+}
+
+Address orMask(const Address &address, const Address &mask)
+{
+    return { address.high | mask.high, address.low | mask.low };
+}
+
+int countTrailingZeros(const Address &address, int width)
+{
+    if (address.low != 0)
+        return qMin(int(qCountTrailingZeroBits(address.low)), width);
+    if (address.high != 0)
+        return qMin(64 + int(qCountTrailingZeroBits(address.high)), width);
+    return width;
+}
+
+// a decimal number of up to 3 digits, without a sign or spaces
+bool parseDecimal(const QStringRef &text, int maxValue, int &value)
+{
+    if (text.isEmpty() || text.size() > 3)
+        return false;
+    value = 0;
+    for (const QChar c : text)
+    {
+        if (c < QLatin1Char('0') || c > QLatin1Char('9'))
+            return false;
+        value = value * 10 + (c.unicode() - '0');
+    }
+    return value <= maxValue;
+}
+
+bool parseIpv4(const QStringRef &text, Address &address)
+{
+    address.high = 0;
+    address.low = 0;
+    int start = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        // a dot past the last octet fails the number
+        const int end = i < 3 ? text.indexOf('.', start) : text.size();
+        int value;
+        if (end == -1 || !parseDecimal(text.mid(start, end - start), 255, value))
+            return false;
+        address.low = (address.low << 8) | quint64(value);
+        start = end + 1;
+    }
+    return true;
+}
+
+bool parseIpv6(const QStringRef &text, Address &address)
+{
+    // an address with a scope isn't one to filter
+    if (text.contains('%'))
+        return false;
+    QHostAddress hostAddress;
+    if (!hostAddress.setAddress(text.toString()) || hostAddress.protocol() != QAbstractSocket::IPv6Protocol)
+        return false;
+    const Q_IPV6ADDR bytes = hostAddress.toIPv6Address();
+    address.high = 0;
+    address.low = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        address.high = (address.high << 8) | bytes[i];
+        address.low = (address.low << 8) | bytes[i + 8];
+    }
+    return true;
+}
+
+QString formatIpv4(quint64 address)
+{
+    return QString::number((address >> 24) & 0xFF) + '.' + QString::number((address >> 16) & 0xFF) + '.' +
+           QString::number((address >> 8) & 0xFF) + '.' + QString::number(address & 0xFF);
+}
+
+QString formatIpv6(quint64 high, quint64 low)
+{
+    Q_IPV6ADDR bytes;
+    for (int i = 0; i < 8; ++i)
+    {
+        bytes[i] = static_cast<quint8>(high >> (56 - 8 * i));
+        bytes[i + 8] = static_cast<quint8>(low >> (56 - 8 * i));
+    }
+    return QHostAddress(bytes).toString();
+}
+}
+
+IpAddressSet::IpAddressSet() : isNormalized_(true)
+{
+}
+
+IpAddressSet IpAddressSet::fromFirewallString(const QString &ips)
+{
+    IpAddressSet set;
+    for (const QStringRef &ip : ips.splitRef(';', QString::SkipEmptyParts))
+    {
+        set.add(ip.toString());
+    }
+    return set;
+}
+
+bool IpAddressSet::add(const QString &ip)
+{
+    const int slashPos = ip.indexOf('/');
+    const QStringRef addressText = slashPos == -1 ? QStringRef(&ip) : ip.leftRef(slashPos);
+
+    Block block;
+    block.isIpv6 = addressText.contains(':');
+    Address address;
+    if (!(block.isIpv6 ? parseIpv6(addressText, address) : parseIpv4(addressText, address)))
+    {
+        return false;
+    }
+    const int width = addressWidth(block.isIpv6);
+    block.prefixLength = width;
+    if (slashPos != -1)
+    {
+        if (!parseDecimal(ip.midRef(slashPos + 1), width, block.prefixLength))
+        {
+            return false;
+        }
+        const Address mask = hostMask(width - block.prefixLength);
+        address.high &= ~mask.high;
+        address.low &= ~mask.low;
+    }
+    block.high = address.high;
+    block.low = address.low;
+
+    blocks_.append(block);
+    isNormalized_ = false;
+    return true;
+}
+
+bool IpAddressSet::isEmpty() const
+{
+    return blocks_.isEmpty();
+}
+
+int IpAddressSet::count() const
+{
+    normalize();
+    return blocks_.count();
+}
+
+IpAddressSet IpAddressSet::difference(const IpAddressSet &other) const
+{
+    normalize();
+    other.normalize();
+
+    // the blocks of a normalized list neither overlap nor merge, so any part of the list is normalized as well
+    IpAddressSet result;
+    int i = 0;
+    for (const Block &block : qAsConst(blocks_))
+    {
+        while (i < other.blocks_.count() && other.blocks_[i] < block)
+        {
+            ++i;
+        }
+        if (i == other.blocks_.count() || !(other.blocks_[i] == block))
+        {
+            result.blocks_.append(block);
+        }
+    }
+    return result;
+}
+
+IpAddressSet IpAddressSet::filter(int families) const
+{
+    normalize();
+    IpAddressSet result;
+    for (const Block &block : qAsConst(blocks_))
+    {
+        if (isOfFamilies(block, families))
+        {
+            result.blocks_.append(block);
+        }
+    }
+    return result;
+}
+
+QStringList IpAddressSet::toStringList(int families) const
+{
+    normalize();
+    QStringList list;
+    list.reserve(blocks_.count());
+    for (const Block &block : qAsConst(blocks_))
+    {
+        if (!isOfFamilies(block, families))
+        {
+            continue;
+        }
+        QString text = block.isIpv6 ? formatIpv6(block.high, block.low) : formatIpv4(block.low);
+        if (block.prefixLength != addressWidth(block.isIpv6))
+        {
+            text += '/' + QString::number(block.prefixLength);
+        }
+        list << text;
+    }
+    return list;
+}
+
+QString IpAddressSet::toFirewallString(int families) const
+{
+    return toStringList(families).join(';');
+}
+
+bool IpAddressSet::operator==(const IpAddressSet &other) const
+{
+    normalize();
+    other.normalize();
+    return blocks_ == other.blocks_;
+}
+
+bool IpAddressSet::operator!=(const IpAddressSet &other) const
+{
+    return !(*this == other);
+}
+
+bool IpAddressSet::Block::operator==(const Block &other) const
+{
+    return isIpv6 == other.isIpv6 && high == other.high && low == other.low && prefixLength == other.prefixLength;
+}
+
+bool IpAddressSet::Block::operator<(const Block &other) const
+{
+    return std::tie(isIpv6, high, low, prefixLength) < std::tie(other.isIpv6, other.high, other.low, other.prefixLength);
+}
+
+bool IpAddressSet::isOfFamilies(const Block &block, int families)
+{
+    return (families & (block.isIpv6 ? FAMILY_IPV6 : FAMILY_IPV4)) != 0;
+}
+
+// Sorts the blocks, merges the overlapping and adjacent ones into ranges and splits each range into the fewest
+// aligned CIDR blocks: the largest block which starts at the start of the range and fits in it, then the same for
+// the rest of the range.
+void IpAddressSet::normalize() const
+{
+    if (isNormalized_)
+    {
+        return;
+    }
+    std::sort(blocks_.begin(), blocks_.end());
+
+    QVector<Block> normalized;
+    normalized.reserve(blocks_.count());
+    int i = 0;
+    while (i < blocks_.count())
+    {
+        const bool isIpv6 = blocks_[i].isIpv6;
+        const int width = addressWidth(isIpv6);
+        Address first = { blocks_[i].high, blocks_[i].low };
+        Address last = orMask(first, hostMask(width - blocks_[i].prefixLength));
+        for (++i; i < blocks_.count() && blocks_[i].isIpv6 == isIpv6; ++i)
+        {
+            const Address start = { blocks_[i].high, blocks_[i].low };
+            // nothing of the family is past the end of the range
+            if (last == maxAddress(isIpv6))
+            {
+                continue;
+            }
+            if (increment(last) < start)
+            {
+                break;
+            }
+            const Address end = orMask(start, hostMask(width - blocks_[i].prefixLength));
+            if (last < end)
+            {
+                last = end;
+            }
+        }
+
+        while (true)
+        {
+            int hostBits = countTrailingZeros(first, width);
+            while (hostBits > 0 && last < orMask(first, hostMask(hostBits)))
+            {
+                --hostBits;
+            }
+            normalized.append({ isIpv6, first.high, first.low, width - hostBits });
+            const Address blockLast = orMask(first, hostMask(hostBits));
+            if (blockLast == last)
+            {
+                break;
+            }
+            first = increment(blockLast);
+        }
+    }
+
+    blocks_ = normalized;
+    isNormalized_ = true;
+}
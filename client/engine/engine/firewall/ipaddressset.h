@@ -0,0 +1,62 @@
+#ifndef IPADDRESSSET_H
+#define IPADDRESSSET_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// A set of IPv4 and IPv6 addresses and CIDR ranges, kept in binary as the sorted list of the fewest CIDR blocks
+// which cover them: duplicates and addresses within a range already added collapse, adjacent addresses merge
+// into prefixes. The list is sorted and merged on the first read after changes, so adding N addresses costs
+// O(N log N) in total; a set is read from one thread at a time, as it's sorted on a read.
+class IpAddressSet
+{
+public:
+    enum FAMILY { FAMILY_IPV4 = 0x1, FAMILY_IPV6 = 0x2, FAMILY_ALL = FAMILY_IPV4 | FAMILY_IPV6 };
+
+    IpAddressSet();
+    // the addresses of a firewall string, separated with ';'
+    static IpAddressSet fromFirewallString(const QString &ips);
+
+    // adds an address or a CIDR range, the host bits of a range are cleared; returns false and adds nothing if
+    // it isn't a valid one
+    bool add(const QString &ip);
+
+    bool isEmpty() const;
+    // of the CIDR blocks
+    int count() const;
+    // The blocks of this set which aren't blocks of the |other| one. Both lists are sorted, so they are walked
+    // once; the blocks are what a store of entries, like an ipset set, adds and deletes to turn one set into
+    // the other.
+    IpAddressSet difference(const IpAddressSet &other) const;
+    // the blocks of the |families|
+    IpAddressSet filter(int families) const;
+
+    // the blocks as "1.2.3.4" for a single address and "1.2.3.0/24" for a range, sorted
+    QStringList toStringList(int families = FAMILY_ALL) const;
+    QString toFirewallString(int families = FAMILY_ALL) const;
+
+    bool operator==(const IpAddressSet &other) const;
+    bool operator!=(const IpAddressSet &other) const;
+
+private:
+    // an IPv4 address is kept in the low bits of |low|
+    struct Block
+    {
+        bool isIpv6;
+        quint64 high;
+        quint64 low;
+        int prefixLength;
+
+        bool operator==(const Block &other) const;
+        bool operator<(const Block &other) const;
+    };
+
+    static bool isOfFamilies(const Block &block, int families);
+    void normalize() const;
+
+    mutable QVector<Block> blocks_;
+    mutable bool isNormalized_;
+};
+
+#endif // IPADDRESSSET_H
@@ -0,0 +1,16 @@
+#include <QtTest>
+#include <QCoreApplication>
+
+#include "tst_firewallcontroller_linux.h"
+#include "tst_ipaddressset.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int status = 0;
+
+    status |= QTest::qExec(new TestFirewallControllerLinux(), argc, argv);
+    status |= QTest::qExec(new TestIpAddressSet(), argc, argv);
+
+    return status;
+}
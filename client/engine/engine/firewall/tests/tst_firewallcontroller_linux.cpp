@@ -0,0 +1,352 @@
+#include "tst_firewallcontroller_linux.h"
+#include <QtTest>
+#include <QFile>
+#include <QStandardPaths>
+
+namespace
+{
+IpAddressSet ips(const QString &firewallString)
+{
+    return IpAddressSet::fromFirewallString(firewallString);
+}
+}
+
+QString FakeHelperFirewallController::executeRootCommand(const QString &commandLine, int *exitCode)
+{
+    commands_ << commandLine;
+    QString input;
+    const int inputPos = commandLine.indexOf(" < ");
+    if (inputPos != -1)
+    {
+        QFile file(commandLine.mid(inputPos + 3).trimmed());
+        if (file.open(QIODevice::ReadOnly))
+            input = QString::fromUtf8(file.readAll());
+    }
+    inputs_ << input;
+
+    int code = 0;
+    QString output;
+    if (commandLine.startsWith("iptables --version"))
+        output = isIptablesNft_ ? "iptables v1.8.7 (nf_tables)\n" : "iptables v1.8.7 (legacy)\n";
+    else if (commandLine.startsWith("iptables --check"))
+        code = isInstalled_ ? 0 : 1;
+    else if (commandLine.startsWith("ipset") && !isIpsetSupported_)
+        code = 127;
+    else if (commandLine.startsWith("iptables-restore < "))
+        isInstalled_ = input.contains("-A INPUT -j windscribe_input");
+    if (commandLine.startsWith("iptables-restore") || commandLine.startsWith("ip6tables -") ||
+        commandLine.startsWith("ip6tables-restore"))
+        ++nftGeneration_;
+    if (exitCode)
+        *exitCode = code;
+    return output;
+}
+
+bool FakeHelperFirewallController::applyFirewallNft(const QStringList &ips, bool bAllowLanTraffic)
+{
+    Q_UNUSED(bAllowLanTraffic);
+    if (!isNftSupported_)
+        return false;
+    isNftInstalled_ = true;
+    nftIps_ = ips;
+    return true;
+}
+
+bool FakeHelperFirewallController::removeFirewallNft()
+{
+    isNftInstalled_ = false;
+    nftIps_.clear();
+    return isNftSupported_;
+}
+
+bool FakeHelperFirewallController::getNftGeneration(quint32 &generation)
+{
+    // a helper of an older version doesn't know the command
+    if (!isIptablesNft_)
+        return false;
+    generation = nftGeneration_;
+    return true;
+}
+
+QString FakeHelperFirewallController::inputOf(const QString &commandPrefix) const
+{
+    for (int i = 0; i < commands_.count(); ++i)
+    {
+        if (commands_[i].startsWith(commandPrefix))
+            return inputs_[i];
+    }
+    return QString();
+}
+
+TestFirewallControllerLinux::TestFirewallControllerLinux()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+TestFirewallControllerLinux::~TestFirewallControllerLinux()
+{
+}
+
+void TestFirewallControllerLinux::test_identical_calls()
+{
+    FakeHelperFirewallController controller;
+    QVERIFY(controller.firewallOn(ips("1.1.1.1;2.2.2.2"), true));
+    QVERIFY(controller.inputOf("iptables-restore < ").contains(
+        "-A windscribe_output -m set --match-set windscribe_ips dst -j ACCEPT"));
+    QVERIFY(controller.inputOf("ipset restore < ").contains("add windscribe_ips_new 2.2.2.2 -exist"));
+
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("1.1.1.1;2.2.2.2"), true));
+    QCOMPARE(controller.commands(), QStringList());
+
+    // the same IPs in another order make the same rules and set
+    QVERIFY(controller.firewallOn(ips("2.2.2.2;1.1.1.1"), true));
+    QCOMPARE(controller.commands(), QStringList());
+
+    controller.setInterfaceToSkip_posix("");
+    QVERIFY(controller.firewallOn(ips("2.2.2.2;1.1.1.1"), true));
+    QCOMPARE(controller.commands(), QStringList());
+}
+
+void TestFirewallControllerLinux::test_ips_delta()
+{
+    FakeHelperFirewallController controller;
+    QVERIFY(controller.firewallOn(ips("1.1.1.1;2.2.2.2"), false));
+
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("2.2.2.2;3.3.3.3"), false));
+    const QStringList commands = controller.commands();
+    QCOMPARE(commands.count(), 3);
+    // the rules of the legacy iptables are confirmed before the difference is applied to them
+    QVERIFY(commands[0].startsWith("iptables --check"));
+    QVERIFY(commands[1].startsWith("ipset restore < "));
+    // the new IP is added before the old one is removed
+    QCOMPARE(controller.inputs()[1],
+             QString("add windscribe_ips 3.3.3.3 -exist\ndel windscribe_ips 1.1.1.1 -exist\n"));
+    QVERIFY(commands[2].startsWith("ipset save windscribe_ips > "));
+}
+
+void TestFirewallControllerLinux::test_rules_delta()
+{
+    FakeHelperFirewallController controller;
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), true));
+
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), false));
+    QVERIFY(controller.inputOf("iptables-restore < ").isEmpty());
+    const QString delta = controller.inputOf("iptables-restore -n < ");
+    QVERIFY(delta.startsWith("*filter\n"));
+    QVERIFY(delta.endsWith("COMMIT\n"));
+    QCOMPARE(delta.count("\n-D "), 8);
+    QCOMPARE(delta.count("\n-I "), 0);
+    QVERIFY(delta.contains("-D windscribe_input -s 192.168.0.0/16 -j ACCEPT"));
+    QVERIFY(controller.inputOf("ipset").isEmpty());
+
+    controller.clearCommands();
+    controller.setInterfaceToSkip_posix("tun0");
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), false));
+    const QString insert = controller.inputOf("iptables-restore -n < ");
+    QVERIFY(insert.contains("-I windscribe_input 2 -i tun0 -j ACCEPT"));
+    QVERIFY(insert.contains("-I windscribe_output 2 -o tun0 -j ACCEPT"));
+    QCOMPARE(insert.count("\n-D "), 0);
+}
+
+void TestFirewallControllerLinux::test_ips_delta_without_ipset()
+{
+    FakeHelperFirewallController controller;
+    controller.setIpsetSupported(false);
+    QVERIFY(controller.firewallOn(ips("1.1.1.1;2.2.2.2"), false));
+    QVERIFY(controller.inputOf("iptables-restore < ").contains("-A windscribe_output -d 2.2.2.2/32 -j ACCEPT"));
+
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("2.2.2.2;3.3.3.3"), false));
+    QVERIFY(controller.inputOf("iptables-restore < ").isEmpty());
+    const QString delta = controller.inputOf("iptables-restore -n < ");
+    QVERIFY(delta.contains("-D windscribe_input -s 1.1.1.1/32 -j ACCEPT"));
+    QVERIFY(delta.contains("-D windscribe_output -d 1.1.1.1/32 -j ACCEPT"));
+    // after lo and 2.2.2.2
+    QVERIFY(delta.contains("-I windscribe_input 3 -s 3.3.3.3/32 -j ACCEPT"));
+    QVERIFY(delta.contains("-I windscribe_output 3 -d 3.3.3.3/32 -j ACCEPT"));
+
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("3.3.3.3;2.2.2.2"), false));
+    QCOMPARE(controller.commands(), QStringList());
+}
+
+void TestFirewallControllerLinux::test_delta_after_external_removal()
+{
+    FakeHelperFirewallController controller;
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), false));
+
+    // the rules flushed by something else are loaded as a whole
+    controller.removeExternally();
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("2.2.2.2"), false));
+    QVERIFY(controller.inputOf("iptables-restore < ").contains("-A INPUT -j windscribe_input"));
+    QVERIFY(controller.inputOf("iptables-restore -n < ").isEmpty());
+
+    // the generation of the ruleset of iptables-nft confirms the rules without the iptables command
+    FakeHelperFirewallController nftController;
+    nftController.setIptablesNft(true);
+    QVERIFY(nftController.firewallOn(ips("1.1.1.1"), false));
+    nftController.clearCommands();
+    QVERIFY(nftController.firewallOn(ips("2.2.2.2"), false));
+    QVERIFY(nftController.commands().filter("iptables --check").isEmpty());
+    QVERIFY(nftController.commands()[0].startsWith("ipset restore < "));
+
+    nftController.removeExternally();
+    nftController.clearCommands();
+    QVERIFY(nftController.firewallOn(ips("3.3.3.3"), false));
+    QVERIFY(!nftController.inputOf("iptables-restore < ").isEmpty());
+}
+
+void TestFirewallControllerLinux::test_boot_rules()
+{
+    FakeHelperFirewallController controller;
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), false));
+    QCOMPARE(controller.commands().filter("> /etc/windscribe/rules.v4").count(), 1);
+    QCOMPARE(controller.commands().filter("> /etc/windscribe/rules.ipset").count(), 1);
+
+    // the rules reloaded as a whole are the same, only the set is saved again
+    controller.removeExternally();
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("2.2.2.2"), false));
+    QVERIFY(!controller.inputOf("iptables-restore < ").isEmpty());
+    QCOMPARE(controller.commands().filter("> /etc/windscribe/rules.v4").count(), 0);
+    QCOMPARE(controller.commands().filter("> /etc/windscribe/rules.ipset").count(), 1);
+
+    // the rules changed by a delta are saved
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("2.2.2.2"), true));
+    QVERIFY(!controller.inputOf("iptables-restore -n < ").isEmpty());
+    QCOMPARE(controller.commands().filter("> /etc/windscribe/rules.v4").count(), 1);
+    QCOMPARE(controller.commands().filter("> /etc/windscribe/rules.ipset").count(), 0);
+}
+
+void TestFirewallControllerLinux::test_ranges()
+{
+    // the adjacent addresses make a range, the IPv6 ones are left to the nftables table
+    const IpAddressSet allowedIps = ips("10.0.0.2;10.0.0.0;10.0.0.1;10.0.0.3;2001:db8::1");
+    FakeHelperFirewallController controller;
+    controller.setIpsetSupported(false);
+    QVERIFY(controller.firewallOn(allowedIps, false));
+    const QString rules = controller.inputOf("iptables-restore < ");
+    QVERIFY(rules.contains("-A windscribe_input -s 10.0.0.0/30 -j ACCEPT"));
+    QCOMPARE(rules.count("-A windscribe_output -d "), 1);
+
+    // the range grows into a larger one
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("10.0.0.0/30;10.0.0.4;10.0.0.5;10.0.0.6/31"), false));
+    const QString delta = controller.inputOf("iptables-restore -n < ");
+    QVERIFY(delta.contains("-D windscribe_output -d 10.0.0.0/30 -j ACCEPT"));
+    QVERIFY(delta.contains("-I windscribe_output 2 -d 10.0.0.0/29 -j ACCEPT"));
+
+    FakeHelperFirewallController nftController;
+    nftController.setNftSupported(true);
+    QVERIFY(nftController.firewallOn(allowedIps, false));
+    QCOMPARE(nftController.nftIps(), QStringList() << "10.0.0.0/30" << "2001:db8::1");
+}
+
+void TestFirewallControllerLinux::test_off_and_on()
+{
+    FakeHelperFirewallController controller;
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), false));
+    QVERIFY(controller.firewallOff());
+
+    // nothing is known to be applied after the firewall is off, so the rules are loaded as a whole
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), false));
+    QVERIFY(!controller.inputOf("iptables-restore < ").isEmpty());
+    QVERIFY(controller.inputOf("iptables-restore -n < ").isEmpty());
+}
+
+void TestFirewallControllerLinux::test_nft()
+{
+    FakeHelperFirewallController controller;
+    controller.setNftSupported(true);
+    QVERIFY(controller.firewallOn(ips("2.2.2.2;1.1.1.1;1.1.1.1"), true));
+    QVERIFY(controller.isNftInstalled());
+    QCOMPARE(controller.nftIps(), QStringList() << "1.1.1.1" << "2.2.2.2");
+    // only the check for the iptables rules of an earlier run
+    QCOMPARE(controller.commands().count(), 1);
+    QVERIFY(controller.commands()[0].startsWith("iptables --check"));
+    QVERIFY(controller.firewallActualState());
+
+    controller.clearCommands();
+    QVERIFY(controller.firewallOn(ips("3.3.3.3"), true));
+    QCOMPARE(controller.nftIps(), QStringList() << "3.3.3.3");
+    QCOMPARE(controller.commands(), QStringList());
+
+    // only the table is removed, the iptables rules were removed when it was applied
+    QVERIFY(controller.firewallOff());
+    QVERIFY(!controller.isNftInstalled());
+    QCOMPARE(controller.commands(), QStringList());
+}
+
+void TestFirewallControllerLinux::test_nft_unsupported()
+{
+    FakeHelperFirewallController controller;
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), true));
+    QVERIFY(!controller.isNftInstalled());
+    QVERIFY(controller.inputOf("iptables-restore < ").contains("-A windscribe_input -j DROP"));
+
+    // the table isn't tried again
+    controller.setNftSupported(true);
+    QVERIFY(controller.firewallOn(ips("2.2.2.2"), true));
+    QVERIFY(!controller.isNftInstalled());
+}
+
+void TestFirewallControllerLinux::test_cached_state()
+{
+    FakeHelperFirewallController controller;
+    QVERIFY(!controller.firewallActualState());
+    QCOMPARE(controller.commands().count(), 1);
+
+    // the state applied is known, checking the iptables rules is left for the full check
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), true));
+    controller.clearCommands();
+    QVERIFY(controller.firewallActualState());
+    QVERIFY(controller.firewallActualState());
+    QCOMPARE(controller.commands(), QStringList());
+
+    QVERIFY(controller.firewallOff());
+    controller.clearCommands();
+    QVERIFY(!controller.firewallActualState());
+    QCOMPARE(controller.commands(), QStringList());
+
+    // the table is confirmed by the helper, a table removed by something else is found by the full check
+    FakeHelperFirewallController nftController;
+    nftController.setNftSupported(true);
+    QVERIFY(nftController.firewallOn(ips("1.1.1.1"), true));
+    nftController.clearCommands();
+    QVERIFY(nftController.firewallActualState());
+    QCOMPARE(nftController.commands(), QStringList());
+    nftController.removeExternally();
+    QVERIFY(!nftController.firewallActualState());
+    QCOMPARE(nftController.commands().count(), 1);
+    QVERIFY(nftController.commands()[0].startsWith("iptables --check"));
+}
+
+void TestFirewallControllerLinux::test_cached_state_iptables_nft()
+{
+    FakeHelperFirewallController controller;
+    controller.setIptablesNft(true);
+    QVERIFY(controller.firewallOn(ips("1.1.1.1"), true));
+
+    // the generation of the ruleset confirms the rules without the iptables command
+    controller.clearCommands();
+    QVERIFY(controller.firewallActualState());
+    QCOMPARE(controller.commands(), QStringList());
+
+    // the rules removed by something else are found by the full check right away
+    controller.removeExternally();
+    QVERIFY(!controller.firewallActualState());
+    QCOMPARE(controller.commands().count(), 1);
+    QVERIFY(controller.commands()[0].startsWith("iptables --check"));
+
+    // their absence is confirmed the same way
+    QVERIFY(controller.firewallOff());
+    controller.clearCommands();
+    QVERIFY(!controller.firewallActualState());
+    QCOMPARE(controller.commands(), QStringList());
+}
@@ -0,0 +1,77 @@
+#ifndef TESTFIREWALLCONTROLLERLINUX_H
+#define TESTFIREWALLCONTROLLERLINUX_H
+
+#include <QObject>
+#include <QStringList>
+#include "firewall/firewallcontroller_linux.h"
+
+// the controller with a fake helper, which records the commands instead of running them
+class FakeHelperFirewallController : public FirewallController_linux
+{
+    Q_OBJECT
+public:
+    FakeHelperFirewallController() : FirewallController_linux(nullptr, nullptr),
+        isInstalled_(false), isIpsetSupported_(true), isNftSupported_(false), isNftInstalled_(false),
+        isIptablesNft_(false), nftGeneration_(1) {}
+
+    void setIpsetSupported(bool isSupported) { isIpsetSupported_ = isSupported; }
+    // the helper of an older version or a kernel without nf_tables doesn't apply the table
+    void setNftSupported(bool isSupported) { isNftSupported_ = isSupported; }
+    bool isNftInstalled() const { return isNftInstalled_; }
+    // iptables-nft, whose rules change the generation of the nf_tables ruleset
+    void setIptablesNft(bool isNft) { isIptablesNft_ = isNft; }
+    // the table or the rules removed by something else
+    void removeExternally() { isNftInstalled_ = false; isInstalled_ = false; ++nftGeneration_; }
+    // the allowed IPs of the table applied last
+    QStringList nftIps() const { return nftIps_; }
+    void clearCommands() { commands_.clear(); inputs_.clear(); }
+    // the commands run, in order, and the content of the file each of them reads (empty if none)
+    QStringList commands() const { return commands_; }
+    QStringList inputs() const { return inputs_; }
+    QString inputOf(const QString &commandPrefix) const;
+
+protected:
+    bool isHelperConnected() const override { return true; }
+    QString executeRootCommand(const QString &commandLine, int *exitCode) override;
+    bool applyFirewallNft(const QStringList &ips, bool bAllowLanTraffic) override;
+    bool removeFirewallNft() override;
+    bool isFirewallNftApplied() override { return isNftInstalled_; }
+    bool getNftGeneration(quint32 &generation) override;
+
+private:
+    bool isInstalled_;
+    bool isIpsetSupported_;
+    bool isNftSupported_;
+    bool isNftInstalled_;
+    bool isIptablesNft_;
+    quint32 nftGeneration_;
+    QStringList nftIps_;
+    QStringList commands_;
+    QStringList inputs_;
+};
+
+class TestFirewallControllerLinux : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFirewallControllerLinux();
+    ~TestFirewallControllerLinux();
+
+private slots:
+    void test_identical_calls();
+    void test_ips_delta();
+    void test_rules_delta();
+    void test_ips_delta_without_ipset();
+    void test_delta_after_external_removal();
+    void test_boot_rules();
+    void test_ranges();
+    void test_off_and_on();
+    void test_nft();
+    void test_nft_unsupported();
+    void test_cached_state();
+    void test_cached_state_iptables_nft();
+};
+
+
+#endif // TESTFIREWALLCONTROLLERLINUX_H
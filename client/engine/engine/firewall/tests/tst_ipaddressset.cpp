@@ -0,0 +1,197 @@
+#include "tst_ipaddressset.h"
+#include <QtTest>
+#include <QRandomGenerator>
+#include <algorithm>
+#include "firewall/ipaddressset.h"
+
+namespace
+{
+const int BENCHMARK_ADDRESSES_COUNT = 20000;
+
+IpAddressSet makeSet(const QStringList &ips)
+{
+    IpAddressSet set;
+    for (const QString &ip : ips)
+    {
+        set.add(ip);
+    }
+    return set;
+}
+}
+
+TestIpAddressSet::TestIpAddressSet()
+{
+}
+
+TestIpAddressSet::~TestIpAddressSet()
+{
+}
+
+void TestIpAddressSet::test_deduplication()
+{
+    IpAddressSet set;
+    QVERIFY(set.isEmpty());
+    QVERIFY(set.add("1.1.1.1"));
+    QVERIFY(set.add("1.1.1.1"));
+    QVERIFY(set.add("001.1.1.1"));
+    QCOMPARE(set.count(), 1);
+
+    // the addresses within a range collapse into it
+    QVERIFY(set.add("10.1.2.3"));
+    QVERIFY(set.add("10.0.0.0/8"));
+    QVERIFY(set.add("10.255.0.0/16"));
+    QVERIFY(set.add("2001:db8::1"));
+    QVERIFY(set.add("2001:DB8:0:0::1"));
+    QCOMPARE(set.toStringList(), QStringList() << "1.1.1.1" << "10.0.0.0/8" << "2001:db8::1");
+
+    // the host bits of a range are cleared
+    IpAddressSet ranges;
+    QVERIFY(ranges.add("192.168.1.77/24"));
+    QVERIFY(ranges.add("2001:db8::ff/64"));
+    QCOMPARE(ranges.toStringList(), QStringList() << "192.168.1.0/24" << "2001:db8::/64");
+}
+
+void TestIpAddressSet::test_aggregation()
+{
+    IpAddressSet set;
+    for (int i = 255; i >= 0; --i)
+    {
+        QVERIFY(set.add("10.0.0." + QString::number(i)));
+    }
+    QCOMPARE(set.toStringList(), QStringList() << "10.0.0.0/24");
+
+    // the fewest blocks which cover the range, each aligned to its size
+    IpAddressSet unaligned;
+    for (int i = 1; i <= 6; ++i)
+    {
+        QVERIFY(unaligned.add("10.0.0." + QString::number(i)));
+    }
+    QCOMPARE(unaligned.toStringList(), QStringList() << "10.0.0.1" << "10.0.0.2/31" << "10.0.0.4/31" << "10.0.0.6");
+
+    // the ranges which overlap or touch merge, the families don't
+    IpAddressSet ranges;
+    QVERIFY(ranges.add("10.0.0.0/25"));
+    QVERIFY(ranges.add("10.0.0.64/26"));
+    QVERIFY(ranges.add("10.0.0.128/25"));
+    QVERIFY(ranges.add("10.0.1.0/24"));
+    QVERIFY(ranges.add("::ffff:10.0.2.0"));
+    QCOMPARE(ranges.toStringList(), QStringList() << "10.0.0.0/23" << "::ffff:10.0.2.0");
+
+    // the whole address space
+    IpAddressSet all;
+    QVERIFY(all.add("255.255.255.255"));
+    QVERIFY(all.add("0.0.0.0/1"));
+    QVERIFY(all.add("128.0.0.0/1"));
+    QVERIFY(all.add("::/1"));
+    QVERIFY(all.add("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"));
+    QVERIFY(all.add("8000::/1"));
+    QCOMPARE(all.toStringList(), QStringList() << "0.0.0.0/0" << "::/0");
+}
+
+void TestIpAddressSet::test_invalid()
+{
+    const QStringList invalid = QStringList() << "" << "1.2.3" << "1.2.3.4.5" << "1.2.3.4." << "256.1.1.1"
+                                              << "1.2.3.4/33" << "1.2.3.4/" << "1.2.3.4/-1" << "+1.2.3.4"
+                                              << " 1.2.3.4" << "1.2.3.4 " << "1..3.4" << "1.2.3.1000"
+                                              << "windscribe.com" << "2001:db8::/129" << "2001:db8:::1"
+                                              << "fe80::1%eth0" << "1.2.3.4/8/8";
+    IpAddressSet set;
+    for (const QString &ip : invalid)
+    {
+        QVERIFY2(!set.add(ip), qPrintable(ip));
+    }
+    QVERIFY(set.isEmpty());
+    QCOMPARE(set.count(), 0);
+}
+
+void TestIpAddressSet::test_difference()
+{
+    const IpAddressSet applied = IpAddressSet::fromFirewallString("1.1.1.1;2.2.2.2;10.0.0.0/24;2001:db8::1");
+    const IpAddressSet next = IpAddressSet::fromFirewallString("2.2.2.2;3.3.3.3;10.0.0.0/25;2001:db8::1");
+
+    // the blocks are compared as they are, not the addresses: a part of a range is a block of its own
+    QCOMPARE(next.difference(applied).toStringList(), QStringList() << "3.3.3.3" << "10.0.0.0/25");
+    QCOMPARE(applied.difference(next).toStringList(), QStringList() << "1.1.1.1" << "10.0.0.0/24");
+    QVERIFY(applied.difference(applied).isEmpty());
+    QCOMPARE(applied.difference(IpAddressSet()), applied);
+    QVERIFY(IpAddressSet().difference(applied).isEmpty());
+
+    QVERIFY(applied != next);
+    QVERIFY(applied == IpAddressSet::fromFirewallString("2001:db8::1;10.0.0.0/24;2.2.2.2;1.1.1.1;1.1.1.1"));
+    QCOMPARE(applied.filter(IpAddressSet::FAMILY_IPV6).toStringList(), QStringList() << "2001:db8::1");
+}
+
+void TestIpAddressSet::test_firewall_string()
+{
+    const IpAddressSet set = IpAddressSet::fromFirewallString("2.2.2.2;;1.1.1.1;not an ip;2001:db8::1;1.1.1.0");
+    QCOMPARE(set.toFirewallString(), QString("1.1.1.0/31;2.2.2.2;2001:db8::1"));
+    QCOMPARE(set.toFirewallString(IpAddressSet::FAMILY_IPV4), QString("1.1.1.0/31;2.2.2.2"));
+    QCOMPARE(set.toFirewallString(IpAddressSet::FAMILY_IPV6), QString("2001:db8::1"));
+    QCOMPARE(IpAddressSet().toFirewallString(), QString());
+}
+
+void TestIpAddressSet::benchmark_construction()
+{
+    const QStringList ips = makeAddresses(BENCHMARK_ADDRESSES_COUNT, 1);
+    int count = 0;
+    QBENCHMARK
+    {
+        count = makeSet(ips).count();
+    }
+    QVERIFY(count > 0);
+    QVERIFY(count < ips.count());
+}
+
+void TestIpAddressSet::benchmark_difference()
+{
+    // a tenth of the addresses changed, as the ping IPs of the locations change with an update of the list
+    const QStringList ips = makeAddresses(BENCHMARK_ADDRESSES_COUNT, 1);
+    const QStringList changedIps = ips.mid(0, ips.count() - ips.count() / 10) +
+                                   makeAddresses(BENCHMARK_ADDRESSES_COUNT / 10, 2);
+    const IpAddressSet applied = makeSet(ips);
+    const IpAddressSet next = makeSet(changedIps);
+    // sorted before the benchmark
+    QVERIFY(applied != next);
+
+    IpAddressSet added, removed;
+    QBENCHMARK
+    {
+        added = next.difference(applied);
+        removed = applied.difference(next);
+    }
+    QVERIFY(!added.isEmpty());
+    QVERIFY(!removed.isEmpty());
+    QVERIFY(added.count() < next.count());
+}
+
+// random IPv4 addresses, runs of consecutive ones, which merge, and some IPv6 addresses, in random order
+QStringList TestIpAddressSet::makeAddresses(int count, quint32 seed) const
+{
+    QRandomGenerator generator(seed);
+    QStringList ips;
+    ips.reserve(count);
+    while (ips.count() < count)
+    {
+        const quint32 address = generator.generate();
+        switch (generator.bounded(3))
+        {
+        case 0:
+            for (int i = 0; i < 16 && ips.count() < count; ++i)
+            {
+                const quint32 next = address + i;
+                ips << QString("%1.%2.%3.%4").arg(next >> 24).arg((next >> 16) & 0xFF).arg((next >> 8) & 0xFF)
+                                             .arg(next & 0xFF);
+            }
+            break;
+        case 1:
+            ips << QString("2001:db8:%1::%2").arg(address >> 16, 0, 16).arg(address & 0xFFFF, 0, 16);
+            break;
+        default:
+            ips << QString("%1.%2.%3.%4").arg(address >> 24).arg((address >> 16) & 0xFF).arg((address >> 8) & 0xFF)
+                                         .arg(address & 0xFF);
+            break;
+        }
+    }
+    std::shuffle(ips.begin(), ips.end(), generator);
+    return ips;
+}
@@ -0,0 +1,32 @@
+#ifndef TESTIPADDRESSSET_H
+#define TESTIPADDRESSSET_H
+
+#include <QObject>
+#include <QStringList>
+
+class TestIpAddressSet : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestIpAddressSet();
+    ~TestIpAddressSet();
+
+private slots:
+    void test_deduplication();
+    void test_aggregation();
+    void test_invalid();
+    void test_difference();
+    void test_firewall_string();
+
+    // the set of the firewall exceptions has a few thousand addresses with the locations to ping, the
+    // benchmarks take more
+    void benchmark_construction();
+    void benchmark_difference();
+
+private:
+    QStringList makeAddresses(int count, quint32 seed) const;
+};
+
+
+#endif // TESTIPADDRESSSET_H
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 
 #include "utils/logger.h"
+#include "../../../../backend/posix_common/helper_commands_serialize.h"
 
 #include <chrono>
 #include <thread>
@@ -75,4 +76,65 @@ bool Helper_linux::installUpdate(const QString &package) const
         return true;
 }
 
+bool Helper_linux::applyFirewallNft(const QStringList &ips, const QString &interfaceToSkip, bool bAllowLanTraffic)
+{
+    CMD_FIREWALL_NFT cmd;
+    cmd.action = FIREWALL_NFT_APPLY;
+    for (const auto &ip : ips)
+        cmd.allowedIps.push_back(ip.toStdString());
+    cmd.interfaceToSkip = interfaceToSkip.toStdString();
+    cmd.allowLan = bAllowLanTraffic;
+
+    CMD_ANSWER answerCmd;
+    return sendFirewallNftCmd(cmd, answerCmd) && answerCmd.executed != 0;
+}
+
+bool Helper_linux::removeFirewallNft()
+{
+    CMD_FIREWALL_NFT cmd;
+    cmd.action = FIREWALL_NFT_REMOVE;
+    CMD_ANSWER answerCmd;
+    return sendFirewallNftCmd(cmd, answerCmd) && answerCmd.executed != 0;
+}
 
+bool Helper_linux::isFirewallNftApplied()
+{
+    CMD_FIREWALL_NFT cmd;
+    cmd.action = FIREWALL_NFT_CHECK;
+    CMD_ANSWER answerCmd;
+    return sendFirewallNftCmd(cmd, answerCmd) && answerCmd.executed != 0 && answerCmd.customInfoValue[0] != 0;
+}
+
+bool Helper_linux::getNftGeneration(quint32 &generation)
+{
+    CMD_FIREWALL_NFT cmd;
+    cmd.action = FIREWALL_NFT_GENERATION;
+    CMD_ANSWER answerCmd;
+    if (!sendFirewallNftCmd(cmd, answerCmd) || answerCmd.executed == 0)
+        return false;
+    generation = static_cast<quint32>(answerCmd.customInfoValue[0]);
+    return true;
+}
+
+// a helper of an older version doesn't know the command and answers it as not executed
+bool Helper_linux::sendFirewallNftCmd(const CMD_FIREWALL_NFT &cmd, CMD_ANSWER &answerCmd)
+{
+    QMutexLocker locker(&mutex_);
+
+    if (curState_ != STATE_CONNECTED)
+        return false;
+
+    std::stringstream stream;
+    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
+    oa << cmd;
+
+    if (!sendCmdToHelper(HELPER_CMD_FIREWALL_NFT, stream.str())) {
+        doDisconnectAndReconnect();
+        return false;
+    }
+    if (!readAnswer(answerCmd)) {
+        doDisconnectAndReconnect();
+        return false;
+    }
+    return true;
+}
@@ -19,7 +19,17 @@ public:
 
     bool installUpdate(const QString& package) const;
 
+    // the firewall as a single nftables table applied by the helper; false if the helper can't use nftables
+    bool applyFirewallNft(const QStringList &ips, const QString &interfaceToSkip, bool bAllowLanTraffic);
+    bool removeFirewallNft();
+    bool isFirewallNftApplied();
+    // the generation of the nf_tables ruleset, which iptables-nft keeps its rules in as well
+    bool getNftGeneration(quint32 &generation);
+
 private:
+    bool sendFirewallNftCmd(const CMD_FIREWALL_NFT &cmd, CMD_ANSWER &answerCmd);
+
+
     const static QString WINDSCRIBE_PATH;
     const static QString USER_ENTER_PASSWORD_STRING;
 };
@@ -7,7 +7,7 @@ bool FailedPingLogController::logFailedIPs(const QString &ip)
 
     if (!failedPingIps_.contains(ip))
     {
-        qCDebug(LOG_PING) << "Ping failed for node: " << ip;
+        qCDebugRecord(LOG_PING, "Ping failed for node: %1", ip);
         failedPingIps_ << ip;
         return true;
     }
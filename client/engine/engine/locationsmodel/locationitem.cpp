@@ -3,4 +3,5 @@
 #include <QSharedPointer>
 
 const int typeIdVectorModelLocationItem = qRegisterMetaType<QSharedPointer<QVector<locationsmodel::LocationItem> >>("QSharedPointer<QVector<locationsmodel::LocationItem> >");
+const int typeIdLocationsSnapshot = qRegisterMetaType<locationsmodel::LocationsSnapshot>("locationsmodel::LocationsSnapshot");
 const int typeIdModelLocationItem = qRegisterMetaType<locationsmodel::LocationItem>("locationsmodel::LocationItem");
@@ -1,6 +1,7 @@
 #ifndef LOCATIONSMODEL_LOCATIONITEM_H
 #define LOCATIONSMODEL_LOCATIONITEM_H
 
+#include <QSharedPointer>
 #include <QString>
 #include <QVector>
 #include "types/pingtime.h"
@@ -33,6 +34,23 @@ struct CityItem
 
     // set default values
     CityItem() : isPro(false), isDisabled(false), customConfigType(customconfigs::CUSTOM_CONFIG_OPENVPN), customConfigIsCorrect(false), link_speed(100), health(0) {}
+
+    // the ping is left out: it changes with every ping sweep and reaches the clients by locationSpeedChanged, so a
+    // location whose pings alone changed isn't sent again in the locations delta
+    bool operator==(const CityItem &other) const
+    {
+        return id == other.id && city == other.city && nick == other.nick &&
+               isPro == other.isPro && isDisabled == other.isDisabled &&
+               staticIpCountryCode == other.staticIpCountryCode && staticIpType == other.staticIpType && staticIp == other.staticIp &&
+               customConfigType == other.customConfigType && customConfigIsCorrect == other.customConfigIsCorrect &&
+               customConfigErrorMessage == other.customConfigErrorMessage &&
+               link_speed == other.link_speed && health == other.health;
+    }
+
+    bool operator!=(const CityItem &other) const
+    {
+        return !operator==(other);
+    }
 };
 
 struct LocationItem
@@ -49,6 +67,17 @@ struct LocationItem
 
     LocationItem& operator=(const LocationItem&) = default;
 
+    bool operator==(const LocationItem &other) const
+    {
+        return id == other.id && name == other.name && countryCode == other.countryCode &&
+               isPremiumOnly == other.isPremiumOnly && p2p == other.p2p && cities == other.cities;
+    }
+
+    bool operator!=(const LocationItem &other) const
+    {
+        return !operator==(other);
+    }
+
     void fillProtobuf(ProtoTypes::Location *l) const
     {
         *l->mutable_id() = id.toProtobuf();
@@ -80,6 +109,10 @@ struct LocationItem
     }
 };
 
+// Immutable locations list published by the engine. The engine builds a new vector for every update,
+// so the GUI can keep and read the same instance without copying it.
+typedef QSharedPointer<const QVector<LocationItem> > LocationsSnapshot;
+
 } //namespace locationsmodel
 
 #endif // LOCATIONSMODEL_LOCATIONITEM_H
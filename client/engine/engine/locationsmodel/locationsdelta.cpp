@@ -0,0 +1,106 @@
+#include "locationsdelta.h"
+#include <QMetaType>
+
+const int typeIdLocationsDelta = qRegisterMetaType<locationsmodel::LocationsDelta>("locationsmodel::LocationsDelta");
+
+namespace locationsmodel {
+
+LocationsDeltaBuilder::LocationsDeltaBuilder() : version_(0), hasSnapshot_(false)
+{
+}
+
+LocationsDelta LocationsDeltaBuilder::update(const LocationID &bestLocation, const QString &staticIpDeviceName, LocationsSnapshot locations)
+{
+    if (!hasSnapshot_)
+    {
+        bestLocation_ = bestLocation;
+        staticIpDeviceName_ = staticIpDeviceName;
+        locations_ = locations;
+        indexById_.clear();
+        for (int i = 0; i < locations_->size(); ++i)
+        {
+            indexById_.insert(locations_->at(i).id, i);
+        }
+        hasSnapshot_ = true;
+        version_++;
+        return fullSnapshot();
+    }
+
+    LocationsDelta delta;
+    delta.baseVersion = version_;
+    delta.bestLocation = bestLocation;
+    delta.staticIpDeviceName = staticIpDeviceName;
+    delta.order = makeOrder(*locations);
+
+    QHash<LocationID, int> newIndexById;
+    newIndexById.reserve(locations->size());
+    for (int i = 0; i < locations->size(); ++i)
+    {
+        const LocationItem &li = locations->at(i);
+        newIndexById.insert(li.id, i);
+
+        auto it = indexById_.constFind(li.id);
+        if (it == indexById_.constEnd() || locations_->at(it.value()) != li)
+        {
+            delta.changedLocations << li;
+        }
+    }
+    for (auto it = indexById_.constBegin(); it != indexById_.constEnd(); ++it)
+    {
+        if (!newIndexById.contains(it.key()))
+        {
+            delta.removedLocations << it.key();
+        }
+    }
+
+    const bool isOrderChanged = delta.order != makeOrder(*locations_);
+    const bool isChanged = !delta.changedLocations.isEmpty() || !delta.removedLocations.isEmpty() || isOrderChanged ||
+                           bestLocation != bestLocation_ || staticIpDeviceName != staticIpDeviceName_;
+
+    bestLocation_ = bestLocation;
+    staticIpDeviceName_ = staticIpDeviceName;
+    locations_ = locations;
+    indexById_ = newIndexById;
+    if (isChanged)
+    {
+        version_++;
+    }
+    delta.version = version_;
+    return delta;
+}
+
+LocationsDelta LocationsDeltaBuilder::fullSnapshot() const
+{
+    LocationsDelta delta;
+    delta.baseVersion = version_;
+    delta.version = version_;
+    delta.isFullSnapshot = true;
+    delta.bestLocation = bestLocation_;
+    delta.staticIpDeviceName = staticIpDeviceName_;
+    if (locations_)
+    {
+        delta.changedLocations = *locations_;
+        delta.order = makeOrder(*locations_);
+    }
+    return delta;
+}
+
+void LocationsDeltaBuilder::reset()
+{
+    hasSnapshot_ = false;
+    locations_.reset();
+    indexById_.clear();
+}
+
+QVector<LocationID> LocationsDeltaBuilder::makeOrder(const QVector<LocationItem> &locations)
+{
+    QVector<LocationID> order;
+    order.reserve(locations.size());
+    for (const LocationItem &li : locations)
+    {
+        order << li.id;
+    }
+    return order;
+}
+
+} //namespace locationsmodel
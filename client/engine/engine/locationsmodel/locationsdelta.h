@@ -0,0 +1,58 @@
+#ifndef LOCATIONSMODEL_LOCATIONSDELTA_H
+#define LOCATIONSMODEL_LOCATIONSDELTA_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "locationitem.h"
+
+namespace locationsmodel {
+
+// Changes of the API locations list between two versions, keyed by LocationID.
+// A changed location is sent as a whole item (with all its cities), unchanged ones are not sent at all.
+struct LocationsDelta
+{
+    quint64 baseVersion;                // version the delta must be applied to, ignored for a full snapshot
+    quint64 version;                    // version of the list after the delta is applied
+    bool isFullSnapshot;                // changedLocations contains the whole list
+
+    LocationID bestLocation;
+    QString staticIpDeviceName;
+
+    QVector<LocationItem> changedLocations;     // added or changed locations
+    QVector<LocationID> removedLocations;
+    QVector<LocationID> order;                  // ids of all locations in the engine order
+
+    LocationsDelta() : baseVersion(0), version(0), isFullSnapshot(false) {}
+
+    bool isEmpty() const
+    {
+        return !isFullSnapshot && changedLocations.isEmpty() && removedLocations.isEmpty() && baseVersion == version;
+    }
+};
+
+// Keeps the last published locations list and makes deltas against it.
+class LocationsDeltaBuilder
+{
+public:
+    LocationsDeltaBuilder();
+
+    // compares the new list with the previous one; the first update after reset() is a full snapshot
+    LocationsDelta update(const LocationID &bestLocation, const QString &staticIpDeviceName, LocationsSnapshot locations);
+    LocationsDelta fullSnapshot() const;
+    void reset();
+
+private:
+    quint64 version_;
+    bool hasSnapshot_;
+    LocationID bestLocation_;
+    QString staticIpDeviceName_;
+    LocationsSnapshot locations_;
+    QHash<LocationID, int> indexById_;      // index in locations_
+
+    static QVector<LocationID> makeOrder(const QVector<LocationItem> &locations);
+};
+
+} //namespace locationsmodel
+
+#endif // LOCATIONSMODEL_LOCATIONSDELTA_H
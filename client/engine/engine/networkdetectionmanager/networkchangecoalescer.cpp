@@ -0,0 +1,114 @@
+#include "networkchangecoalescer.h"
+
+#include <QStringList>
+
+NetworkChangeCoalescer::NetworkChangeCoalescer(QObject *parent, int settleTimeMs, int maxDelayMs) : QObject(parent),
+    settleTimeMs_(settleTimeMs), maxDelayMs_(maxDelayMs), settleDeadlineMs_(-1), burstStartMs_(0)
+{
+    clock_.start();
+    settleTimer_.setSingleShot(true);
+    connect(&settleTimer_, SIGNAL(timeout()), SLOT(onSettleTimer()));
+}
+
+void NetworkChangeCoalescer::reset(bool isOnline, const ProtoTypes::NetworkInterface &networkInterface, const QString &gateway)
+{
+    settleTimer_.stop();
+    settleDeadlineMs_ = -1;
+    publishedState_.isOnline = isOnline;
+    publishedState_.networkInterface = networkInterface;
+    publishedState_.gateway = gateway;
+    pendingState_ = publishedState_;
+}
+
+void NetworkChangeCoalescer::report(bool isOnline, const ProtoTypes::NetworkInterface &networkInterface, const QString &gateway)
+{
+    pendingState_.isOnline = isOnline;
+    pendingState_.networkInterface = networkInterface;
+    pendingState_.gateway = gateway;
+
+    // each state of a burst puts the change off, up to the max delay since its first one
+    const qint64 now = nowMs();
+    if (settleDeadlineMs_ < 0)
+    {
+        burstStartMs_ = now;
+    }
+    settleDeadlineMs_ = qMin(now + settleTimeMs_, burstStartMs_ + maxDelayMs_);
+    settleTimer_.start(static_cast<int>(qMax<qint64>(0, settleDeadlineMs_ - now)));
+}
+
+int NetworkChangeCoalescer::changesBetween(bool isOnline1, const ProtoTypes::NetworkInterface &networkInterface1, const QString &gateway1,
+                                           bool isOnline2, const ProtoTypes::NetworkInterface &networkInterface2, const QString &gateway2)
+{
+    int changes = 0;
+    if (isOnline1 != isOnline2)
+    {
+        changes |= CHANGE_ONLINE;
+    }
+    if (networkInterface1.network_or_ssid() != networkInterface2.network_or_ssid())
+    {
+        changes |= CHANGE_NETWORK;
+    }
+    // the rest of the interface
+    ProtoTypes::NetworkInterface interface1 = networkInterface1;
+    ProtoTypes::NetworkInterface interface2 = networkInterface2;
+    interface1.clear_network_or_ssid();
+    interface2.clear_network_or_ssid();
+    if (!google::protobuf::util::MessageDifferencer::Equals(interface1, interface2))
+    {
+        changes |= CHANGE_INTERFACE;
+    }
+    if (gateway1 != gateway2)
+    {
+        changes |= CHANGE_GATEWAY;
+    }
+    return changes;
+}
+
+QString NetworkChangeCoalescer::changesToString(int changes)
+{
+    QStringList list;
+    if (changes & CHANGE_ONLINE)
+        list << "online";
+    if (changes & CHANGE_INTERFACE)
+        list << "interface";
+    if (changes & CHANGE_NETWORK)
+        list << "network";
+    if (changes & CHANGE_GATEWAY)
+        list << "gateway";
+    return list.join(", ");
+}
+
+qint64 NetworkChangeCoalescer::nowMs() const
+{
+    return clock_.elapsed();
+}
+
+void NetworkChangeCoalescer::checkSettled()
+{
+    if (settleDeadlineMs_ < 0)
+    {
+        return;
+    }
+    const qint64 now = nowMs();
+    if (now < settleDeadlineMs_)
+    {
+        settleTimer_.start(static_cast<int>(settleDeadlineMs_ - now));
+        return;
+    }
+    settleTimer_.stop();
+    settleDeadlineMs_ = -1;
+
+    // a burst which ends where it started changes nothing
+    const int changes = changesBetween(publishedState_.isOnline, publishedState_.networkInterface, publishedState_.gateway,
+                                       pendingState_.isOnline, pendingState_.networkInterface, pendingState_.gateway);
+    publishedState_ = pendingState_;
+    if (changes != 0)
+    {
+        emit networkChanged(publishedState_.isOnline, publishedState_.networkInterface, changes);
+    }
+}
+
+void NetworkChangeCoalescer::onSettleTimer()
+{
+    checkSettled();
+}
@@ -0,0 +1,74 @@
+#ifndef NETWORKCHANGECOALESCER_H
+#define NETWORKCHANGECOALESCER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include "utils/protobuf_includes.h"
+
+// Turns the bursts of network states reported by a network detection manager into a single change. Roaming between
+// access points, a DHCP renewal or docking make several link, address and route changes within a second; each one
+// made the connection reconnect and the firewall and pings restart.
+// A change is published once no state has been reported for the settle time, or at the latest after the max delay
+// of a burst, and only if the last state of the burst differs from the state published before.
+class NetworkChangeCoalescer : public QObject
+{
+    Q_OBJECT
+public:
+    enum CHANGE {
+        CHANGE_ONLINE = 0x1,
+        CHANGE_INTERFACE = 0x2,         // the interface, or its attributes other than the network
+        CHANGE_NETWORK = 0x4,           // the network name or SSID
+        CHANGE_GATEWAY = 0x8
+    };
+
+    explicit NetworkChangeCoalescer(QObject *parent, int settleTimeMs = SETTLE_TIME_MS, int maxDelayMs = MAX_DELAY_MS);
+
+    // the state known without a change to publish, like the one read at the start; drops a pending change
+    void reset(bool isOnline, const ProtoTypes::NetworkInterface &networkInterface, const QString &gateway);
+    void report(bool isOnline, const ProtoTypes::NetworkInterface &networkInterface, const QString &gateway);
+
+    bool isChangePending() const { return settleDeadlineMs_ >= 0; }
+
+    // the CHANGE flags set between the states
+    static int changesBetween(bool isOnline1, const ProtoTypes::NetworkInterface &networkInterface1, const QString &gateway1,
+                              bool isOnline2, const ProtoTypes::NetworkInterface &networkInterface2, const QString &gateway2);
+    static QString changesToString(int changes);
+
+signals:
+    void networkChanged(bool isOnline, const ProtoTypes::NetworkInterface &networkInterface, int changes);
+
+protected:
+    // monotonic milliseconds; the tests drive the coalescer with a clock of their own and call checkSettled()
+    virtual qint64 nowMs() const;
+    // publishes the change once its time has come, otherwise waits for the rest of the time
+    void checkSettled();
+
+private slots:
+    void onSettleTimer();
+
+private:
+    static constexpr int SETTLE_TIME_MS = 500;
+    static constexpr int MAX_DELAY_MS = 3000;
+
+    struct State
+    {
+        bool isOnline;
+        ProtoTypes::NetworkInterface networkInterface;
+        QString gateway;
+
+        State() : isOnline(false) {}
+    };
+
+    const int settleTimeMs_;
+    const int maxDelayMs_;
+    State publishedState_;
+    State pendingState_;
+    QElapsedTimer clock_;
+    // the change is published at the deadline, -1 if none is pending
+    qint64 settleDeadlineMs_;
+    qint64 burstStartMs_;
+    QTimer settleTimer_;
+};
+
+#endif // NETWORKCHANGECOALESCER_H
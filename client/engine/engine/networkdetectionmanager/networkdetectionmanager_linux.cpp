@@ -1,29 +1,36 @@
 #include "networkdetectionmanager_linux.h"
 
-#include <QRegularExpression>
 #include "utils/macutils.h"
 #include "utils/utils.h"
 #include "utils/logger.h"
 #include <sys/socket.h>
 #include <sys/ioctl.h>
 #include <net/if.h>
+#include <string.h>
 #include <unistd.h>
 #include <linux/wireless.h>
 
 const int typeIdNetworkInterface = qRegisterMetaType<ProtoTypes::NetworkInterface>("ProtoTypes::NetworkInterface");
 
-NetworkDetectionManager_linux::NetworkDetectionManager_linux(QObject *parent, IHelper *helper) : INetworkDetectionManager (parent)
+NetworkDetectionManager_linux::NetworkDetectionManager_linux(QObject *parent, IHelper *helper) : INetworkDetectionManager (parent),
+    isOnline_(false)
 {
     Q_UNUSED(helper);
 
     networkInterface_ = Utils::noNetworkInterface();
-    getDefaultRouteInterface(isOnline_);
-    updateNetworkInfo(false);
 
-    ncm_ = new QNetworkConfigurationManager(this);
-    connect(ncm_, &QNetworkConfigurationManager::configurationAdded, this, &NetworkDetectionManager_linux::onNetworkUpdated);
-    connect(ncm_, &QNetworkConfigurationManager::configurationChanged, this, &NetworkDetectionManager_linux::onNetworkUpdated);
-    connect(ncm_, &QNetworkConfigurationManager::configurationRemoved, this, &NetworkDetectionManager_linux::onNetworkUpdated);
+    // a burst of changes makes a single one
+    networkChangeCoalescer_ = new NetworkChangeCoalescer(this);
+    connect(networkChangeCoalescer_, &NetworkChangeCoalescer::networkChanged, this, &NetworkDetectionManager_linux::onNetworkChangeSettled);
+
+    // the kernel tells of the changes of the links, addresses and routes, they are kept in memory
+    routeMonitor_ = new RouteMonitor_linux(this);
+    connect(routeMonitor_, &RouteMonitor_linux::changed, this, &NetworkDetectionManager_linux::onRoutesChanged);
+    if (!routeMonitor_->start())
+    {
+        qCDebug(LOG_BASIC) << "NetworkDetectionManager_linux: can't monitor the routes, the network is taken as offline";
+    }
+    updateNetworkInfo(false, QSet<int>());
 }
 
 NetworkDetectionManager_linux::~NetworkDetectionManager_linux()
@@ -40,74 +47,80 @@ bool NetworkDetectionManager_linux::isOnline()
     return isOnline_;
 }
 
-void NetworkDetectionManager_linux::onNetworkUpdated(const QNetworkConfiguration &/*config*/)
+void NetworkDetectionManager_linux::onRoutesChanged(const QSet<int> &interfaceIndexes)
 {
-    updateNetworkInfo(true);
+    updateNetworkInfo(true, interfaceIndexes);
 }
 
-void NetworkDetectionManager_linux::updateNetworkInfo(bool bWithEmitSignal)
+void NetworkDetectionManager_linux::onNetworkChangeSettled(bool isOnline, const ProtoTypes::NetworkInterface &networkInterface, int changes)
+{
+    qCDebug(LOG_BASIC) << "NetworkDetectionManager_linux: network changed (" << NetworkChangeCoalescer::changesToString(changes)
+                       << "), online:" << isOnline << ", interface:" << QString::fromStdString(networkInterface.interface_name());
+    emit networkChanged(isOnline, networkInterface);
+}
+
+void NetworkDetectionManager_linux::updateNetworkInfo(bool bWithEmitSignal, const QSet<int> &changedInterfaceIndexes)
 {
     bool newIsOnline;
-    QString ifname = getDefaultRouteInterface(newIsOnline);
+    QString newGateway;
+    const int ifindex = getDefaultRouteInterface(newIsOnline, newGateway);
     ProtoTypes::NetworkInterface newNetworkInterface = Utils::noNetworkInterface();
-    if (!ifname.isEmpty())
+    if (ifindex != 0)
     {
-        getInterfacePars(ifname, newNetworkInterface);
+        // nothing of the interface changed, so the name of its network is the same; it's only looked up anew for
+        // another interface or a change of this one
+        if (ifindex == networkInterface_.interface_index() && !changedInterfaceIndexes.contains(ifindex))
+        {
+            newNetworkInterface = networkInterface_;
+        }
+        else
+        {
+            getInterfacePars(ifindex, routeMonitor_->links().value(ifindex), newNetworkInterface);
+        }
     }
 
-    if (newIsOnline != isOnline_ || !google::protobuf::util::MessageDifferencer::Equals(newNetworkInterface, networkInterface_))
+    if (newIsOnline != isOnline_ || newGateway != gateway_ ||
+        !google::protobuf::util::MessageDifferencer::Equals(newNetworkInterface, networkInterface_))
     {
         isOnline_ = newIsOnline;
         networkInterface_ = newNetworkInterface;
+        gateway_ = newGateway;
         if (bWithEmitSignal)
         {
-            emit networkChanged(isOnline_, networkInterface_);
+            networkChangeCoalescer_->report(isOnline_, networkInterface_, gateway_);
         }
     }
-}
-
-QString NetworkDetectionManager_linux::getDefaultRouteInterface(bool &isOnline)
-{
-    QString strReply;
-    FILE *file = popen("/etc/windscribe/route -n | grep '^0\\.0\\.0\\.0'", "r");
-    if (file)
+    if (!bWithEmitSignal)
     {
-        char szLine[4096];
-        while(fgets(szLine, sizeof(szLine), file) != 0)
-        {
-            strReply += szLine;
-        }
-        pclose(file);
+        networkChangeCoalescer_->reset(isOnline_, networkInterface_, gateway_);
     }
+}
 
-    const QStringList lines = strReply.split('\n', QString::SkipEmptyParts);
-
-    isOnline = !lines.isEmpty();
+// the interface of the default route preferred by the kernel, other than a tunnel, or 0 if there is none
+int NetworkDetectionManager_linux::getDefaultRouteInterface(bool &isOnline, QString &gateway)
+{
+    const QVector<RouteMonitor_linux::DefaultRoute> &routes = routeMonitor_->defaultRoutes();
+    isOnline = !routes.isEmpty();
+    gateway.clear();
 
-    for (auto &it : lines)
+    for (const auto &route : routes)
     {
-        const QStringList pars = it.split(QRegExp("\\s+"), QString::SkipEmptyParts);
-        if (pars.size() == 8)
+        const QString ifname = routeMonitor_->links().value(route.interfaceIndex).name;
+        if (!ifname.isEmpty() && !ifname.startsWith("tun") && !ifname.startsWith("utun"))
         {
-            if (!pars[7].startsWith("tun") && !pars[7].startsWith("utun"))
-            {
-                return pars[7];
-            }
-        }
-        else
-        {
-            qDebug(LOG_BASIC) << "NetworkDetectionManager_linux::getDefaultRouteInterface parse error";
-            return QString();
+            gateway = route.gateway;
+            return route.interfaceIndex;
         }
     }
-    return QString();
+    return 0;
 }
 
-void NetworkDetectionManager_linux::getInterfacePars(const QString &ifname, ProtoTypes::NetworkInterface &outNetworkInterface)
+void NetworkDetectionManager_linux::getInterfacePars(int ifindex, const RouteMonitor_linux::Link &link, ProtoTypes::NetworkInterface &outNetworkInterface)
 {
+    const QString &ifname = link.name;
     outNetworkInterface.set_interface_name(ifname.toStdString().c_str());
-    outNetworkInterface.set_interface_index(if_nametoindex(ifname.toStdString().c_str()));
-    QString macAddress = getMacAddressByIfName(ifname);
+    outNetworkInterface.set_interface_index(ifindex);
+    QString macAddress = getMacAddress(link);
     outNetworkInterface.set_physical_address(macAddress.toStdString().c_str());
 
     bool isWifi = checkWirelessByIfName(ifname);
@@ -138,49 +151,15 @@ void NetworkDetectionManager_linux::getInterfacePars(const QString &ifname, Prot
         }
     }
 
-    outNetworkInterface.set_active(isActiveByIfName(ifname));
+    outNetworkInterface.set_active((link.flags & (IFF_UP | IFF_RUNNING)) == (IFF_UP | IFF_RUNNING));
 }
 
-QString NetworkDetectionManager_linux::getMacAddressByIfName(const QString &ifname)
+// the first 6 bytes of the hardware address, zeros for a link without one
+QString NetworkDetectionManager_linux::getMacAddress(const RouteMonitor_linux::Link &link)
 {
-    QString ret;
-
-    int fd = socket(AF_INET, SOCK_DGRAM, 0);
-    if (fd != -1)
-    {
-        struct ifreq ifr;
-        memset(&ifr, 0, sizeof(ifr));
-        ifr.ifr_addr.sa_family = AF_INET;
-        strncpy(ifr.ifr_name , ifname.toStdString().c_str() , IFNAMSIZ-1);
-        if (ioctl(fd, SIOCGIFHWADDR, &ifr) == 0)
-        {
-           unsigned char *mac = (unsigned char *)ifr.ifr_hwaddr.sa_data;
-           // format mac address
-           ret = QString::asprintf("%.2X:%.2X:%.2X:%.2X:%.2X:%.2X" , mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-       }
-       close(fd);
-    }
-    return ret;
-}
-
-bool NetworkDetectionManager_linux::isActiveByIfName(const QString &ifname)
-{
-    bool ret = false;
-
-    int fd = socket(AF_INET, SOCK_DGRAM, 0);
-    if (fd != -1)
-    {
-        struct ifreq ifr;
-        memset(&ifr, 0, sizeof(ifr));
-        ifr.ifr_addr.sa_family = AF_INET;
-        strncpy(ifr.ifr_name , ifname.toStdString().c_str() , IFNAMSIZ-1);
-        if (ioctl(fd, SIOCGIFFLAGS, &ifr) == 0)
-        {
-           ret = (ifr.ifr_flags & ( IFF_UP | IFF_RUNNING )) == ( IFF_UP | IFF_RUNNING );
-        }
-        close(fd);
-    }
-    return ret;
+    unsigned char mac[6] = {};
+    memcpy(mac, link.hardwareAddress.constData(), qMin(link.hardwareAddress.size(), int(sizeof(mac))));
+    return QString::asprintf("%.2X:%.2X:%.2X:%.2X:%.2X:%.2X" , mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 }
 
 bool NetworkDetectionManager_linux::checkWirelessByIfName(const QString &ifname)
@@ -1,10 +1,11 @@
 #ifndef NETWORKDETECTIONMANAGER_LINUX_H
 #define NETWORKDETECTIONMANAGER_LINUX_H
 
-#include <QMutex>
-#include <QNetworkConfigurationManager>
+#include <QSet>
 #include "engine/helper/ihelper.h"
 #include "inetworkdetectionmanager.h"
+#include "networkchangecoalescer.h"
+#include "routemonitor_linux.h"
 
 class NetworkDetectionManager_linux : public INetworkDetectionManager
 {
@@ -16,19 +17,21 @@ public:
     bool isOnline() override;
 
 private slots:
-    void onNetworkUpdated(const QNetworkConfiguration &config);
+    void onRoutesChanged(const QSet<int> &interfaceIndexes);
+    void onNetworkChangeSettled(bool isOnline, const ProtoTypes::NetworkInterface &networkInterface, int changes);
 
 private:
     bool isOnline_;
     ProtoTypes::NetworkInterface networkInterface_;
-    QNetworkConfigurationManager *ncm_;
+    QString gateway_;
+    RouteMonitor_linux *routeMonitor_;
+    NetworkChangeCoalescer *networkChangeCoalescer_;
 
 
-    void updateNetworkInfo(bool bWithEmitSignal);
-    QString getDefaultRouteInterface(bool &isOnline);
-    void getInterfacePars(const QString &ifname, ProtoTypes::NetworkInterface &outNetworkInterface);
-    QString getMacAddressByIfName(const QString &ifname);
-    bool isActiveByIfName(const QString &ifname);
+    void updateNetworkInfo(bool bWithEmitSignal, const QSet<int> &changedInterfaceIndexes);
+    int getDefaultRouteInterface(bool &isOnline, QString &gateway);
+    void getInterfacePars(int ifindex, const RouteMonitor_linux::Link &link, ProtoTypes::NetworkInterface &outNetworkInterface);
+    QString getMacAddress(const RouteMonitor_linux::Link &link);
     bool checkWirelessByIfName(const QString &ifname);
     QString getFriendlyNameByIfName(const QString &ifname);
 };
@@ -0,0 +1,572 @@
+#include "routemonitor_linux.h"
+
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include "utils/logger.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+const int BUFFER_SIZE = 64 * 1024;
+// the kernel drops the messages which don't fit in the buffer of the socket, a burst of changes fits in this one
+const int RECEIVE_BUFFER_SIZE = 1024 * 1024;
+const int DUMP_TIMEOUT_MS = 1000;
+const int DUMP_RETRY_INTERVAL_MS = 2000;
+
+QString formatAddress(int family, const void *data, size_t size)
+{
+    if (!((family == AF_INET && size >= 4) || (family == AF_INET6 && size >= 16)))
+    {
+        return QString();
+    }
+    char text[INET6_ADDRSTRLEN];
+    if (!inet_ntop(family, data, text, sizeof(text)))
+    {
+        return QString();
+    }
+    return QString::fromLatin1(text);
+}
+
+quint32 readU32(const rtattr *attribute)
+{
+    quint32 value = 0;
+    if (RTA_PAYLOAD(attribute) >= sizeof(value))
+    {
+        memcpy(&value, RTA_DATA(attribute), sizeof(value));
+    }
+    return value;
+}
+}
+
+bool RouteMonitor_linux::Link::operator==(const Link &other) const
+{
+    return name == other.name && flags == other.flags && hardwareAddress == other.hardwareAddress &&
+           addresses == other.addresses;
+}
+
+bool RouteMonitor_linux::DefaultRoute::operator==(const DefaultRoute &other) const
+{
+    return interfaceIndex == other.interfaceIndex && gateway == other.gateway && priority == other.priority;
+}
+
+RouteMonitor_linux::RouteMonitor_linux(QObject *parent) : QObject(parent),
+    socket_(-1), portId_(0), notifier_(nullptr), sequence_(0), isRouteDumpNeeded_(false), isStateReadNeeded_(false)
+{
+    buffer_.resize(BUFFER_SIZE);
+    retryTimer_.setSingleShot(true);
+    retryTimer_.setInterval(DUMP_RETRY_INTERVAL_MS);
+    connect(&retryTimer_, &QTimer::timeout, this, &RouteMonitor_linux::onRetryTimer);
+}
+
+RouteMonitor_linux::~RouteMonitor_linux()
+{
+    delete notifier_;
+    if (socket_ != -1)
+    {
+        close(socket_);
+    }
+}
+
+bool RouteMonitor_linux::start()
+{
+    socket_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (socket_ == -1)
+    {
+        qCDebug(LOG_BASIC) << "RouteMonitor_linux: can't open the netlink socket, errno:" << errno;
+        return false;
+    }
+    const int receiveBufferSize = RECEIVE_BUFFER_SIZE;
+    setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+
+    // only the IPv4 default routes are of interest, the addresses of both families are
+    sockaddr_nl address;
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR | RTMGRP_IPV4_ROUTE;
+    if (bind(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        qCDebug(LOG_BASIC) << "RouteMonitor_linux: can't subscribe to the netlink groups, errno:" << errno;
+        close(socket_);
+        socket_ = -1;
+        return false;
+    }
+    socklen_t addressSize = sizeof(address);
+    if (getsockname(socket_, reinterpret_cast<sockaddr *>(&address), &addressSize) != 0)
+    {
+        qCDebug(LOG_BASIC) << "RouteMonitor_linux: can't get the netlink port id, errno:" << errno;
+        close(socket_);
+        socket_ = -1;
+        return false;
+    }
+    portId_ = address.nl_pid;
+
+    // subscribed before the state is read, so no change is missed in between
+    if (!readCurrentState())
+    {
+        close(socket_);
+        socket_ = -1;
+        return false;
+    }
+
+    notifier_ = new QSocketNotifier(socket_, QSocketNotifier::Read, this);
+    connect(notifier_, &QSocketNotifier::activated, this, &RouteMonitor_linux::onSocketActivated);
+    return true;
+}
+
+void RouteMonitor_linux::processMessages(const QByteArray &datagram)
+{
+    const View oldView = view_;
+    parseMessages(datagram.constData(), datagram.size(), 0, nullptr);
+    if (socket_ != -1)
+    {
+        readPendingDumps();
+    }
+    emitChanges(oldView);
+}
+
+// reads all the messages queued, so a burst of them makes a single change
+void RouteMonitor_linux::onSocketActivated()
+{
+    const View oldView = view_;
+    while (true)
+    {
+        const ssize_t size = recv(socket_, buffer_.data(), buffer_.size(), MSG_DONTWAIT);
+        if (size < 0 && errno == ENOBUFS)
+        {
+            // the view known is kept until the state is read in full
+            qCDebug(LOG_BASIC) << "RouteMonitor_linux: netlink messages were lost, reading the state again";
+            isStateReadNeeded_ = true;
+            break;
+        }
+        if (size <= 0)
+        {
+            break;
+        }
+        parseMessages(buffer_.constData(), static_cast<int>(size), 0, nullptr);
+    }
+    readPendingDumps();
+    emitChanges(oldView);
+}
+
+void RouteMonitor_linux::onRetryTimer()
+{
+    const View oldView = view_;
+    readPendingDumps();
+    emitChanges(oldView);
+}
+
+bool RouteMonitor_linux::readCurrentState()
+{
+    View view;
+    if (!dump(RTM_GETLINK, AF_UNSPEC, view) || !dump(RTM_GETADDR, AF_UNSPEC, view) || !dumpDefaultRoutes(view))
+    {
+        isStateReadNeeded_ = true;
+        return false;
+    }
+    view_ = view;
+    isStateReadNeeded_ = false;
+    return true;
+}
+
+bool RouteMonitor_linux::readDefaultRoutes()
+{
+    // the links of the copy follow the changes which come during the dump, as those of the view known do
+    View view = view_;
+    if (!dumpDefaultRoutes(view))
+    {
+        return false;
+    }
+    view_ = view;
+    return true;
+}
+
+bool RouteMonitor_linux::dumpDefaultRoutes(View &view)
+{
+    view.defaultRoutes.clear();
+    // a change during the dump may drop the routes after they were read, it asks for another dump then
+    isRouteDumpNeeded_ = false;
+    if (!dump(RTM_GETROUTE, AF_INET, view))
+    {
+        isRouteDumpNeeded_ = true;
+        return false;
+    }
+    return true;
+}
+
+void RouteMonitor_linux::readPendingDumps()
+{
+    if (isStateReadNeeded_)
+    {
+        readCurrentState();
+    }
+    else if (isRouteDumpNeeded_)
+    {
+        readDefaultRoutes();
+    }
+    if ((isStateReadNeeded_ || isRouteDumpNeeded_) && !retryTimer_.isActive())
+    {
+        retryTimer_.start();
+    }
+}
+
+// Requests all the objects of the |type| and reads the replies until the last one. The changes which come
+// meanwhile are applied as they come, to the view known and to |view|.
+bool RouteMonitor_linux::dump(int type, int family, View &view)
+{
+    struct
+    {
+        nlmsghdr header;
+        union
+        {
+            ifinfomsg link;
+            ifaddrmsg address;
+            rtmsg route;
+        };
+    } request;
+    memset(&request, 0, sizeof(request));
+    switch (type)
+    {
+    case RTM_GETLINK:
+        request.header.nlmsg_len = NLMSG_LENGTH(sizeof(ifinfomsg));
+        request.link.ifi_family = family;
+        break;
+    case RTM_GETADDR:
+        request.header.nlmsg_len = NLMSG_LENGTH(sizeof(ifaddrmsg));
+        request.address.ifa_family = family;
+        break;
+    default:
+        request.header.nlmsg_len = NLMSG_LENGTH(sizeof(rtmsg));
+        request.route.rtm_family = family;
+        break;
+    }
+    // 0 stands for no dump
+    if (++sequence_ == 0)
+    {
+        ++sequence_;
+    }
+    request.header.nlmsg_type = type;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = sequence_;
+
+    sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(socket_, &request, request.header.nlmsg_len, 0, reinterpret_cast<sockaddr *>(&kernel),
+               sizeof(kernel)) < 0)
+    {
+        qCDebug(LOG_BASIC) << "RouteMonitor_linux: can't send the netlink request" << type << ", errno:" << errno;
+        return false;
+    }
+
+    // the poll blocks the thread of the monitor, so its time is logged
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    DUMP_STATE state = DUMP_PENDING;
+    while (state == DUMP_PENDING && elapsedTimer.elapsed() < DUMP_TIMEOUT_MS)
+    {
+        pollfd fd = { socket_, POLLIN, 0 };
+        if (poll(&fd, 1, qMax(0, DUMP_TIMEOUT_MS - static_cast<int>(elapsedTimer.elapsed()))) <= 0)
+        {
+            continue;
+        }
+        const ssize_t size = recv(socket_, buffer_.data(), buffer_.size(), MSG_DONTWAIT);
+        if (size < 0)
+        {
+            if (errno == EAGAIN || errno == EINTR)
+            {
+                continue;
+            }
+            // ENOBUFS among them: the replies may be lost, and the changes as well
+            qCDebug(LOG_BASIC) << "RouteMonitor_linux: can't read the netlink reply, errno:" << errno;
+            if (errno == ENOBUFS)
+            {
+                isStateReadNeeded_ = true;
+            }
+            state = DUMP_FAILED;
+            break;
+        }
+        state = parseMessages(buffer_.constData(), static_cast<int>(size), sequence_, &view);
+    }
+    if (state == DUMP_PENDING)
+    {
+        qCDebug(LOG_BASIC) << "RouteMonitor_linux: no reply to the netlink request" << type;
+    }
+    qCDebug(LOG_BASIC) << "RouteMonitor_linux: the dump" << type << (state == DUMP_DONE ? "took" : "failed after")
+                       << elapsedTimer.elapsed() << "ms";
+    return state == DUMP_DONE;
+}
+
+// Applies the replies of the dump of |dumpSequence| to |dumpView|, and the notifications to the view known and to
+// |dumpView|. A reply is sent to the port id of the socket; a notification carries the port id and the sequence of
+// the request which caused it, like that of NetworkManager or of the ip command, so neither tells it apart alone.
+RouteMonitor_linux::DUMP_STATE RouteMonitor_linux::parseMessages(const char *data, int size, quint32 dumpSequence,
+                                                                 View *dumpView)
+{
+    DUMP_STATE state = DUMP_PENDING;
+    int length = size;
+    for (const nlmsghdr *header = reinterpret_cast<const nlmsghdr *>(data); NLMSG_OK(header, length);
+         header = NLMSG_NEXT(header, length))
+    {
+        const bool isOwnReply = portId_ != 0 && header->nlmsg_pid == portId_ && header->nlmsg_seq != 0;
+        const bool isDumpReply = isOwnReply && dumpView && dumpSequence != 0 && header->nlmsg_seq == dumpSequence;
+        if (isDumpReply && header->nlmsg_type == NLMSG_DONE)
+        {
+            state = DUMP_DONE;
+        }
+        else if (isDumpReply && header->nlmsg_type == NLMSG_ERROR)
+        {
+            const nlmsgerr *error = static_cast<const nlmsgerr *>(NLMSG_DATA(header));
+            if (header->nlmsg_len >= NLMSG_LENGTH(sizeof(nlmsgerr)) && error->error != 0)
+            {
+                qCDebug(LOG_BASIC) << "RouteMonitor_linux: the netlink request failed, errno:" << -error->error;
+                state = DUMP_FAILED;
+            }
+            else
+            {
+                state = DUMP_DONE;
+            }
+        }
+        else if (isDumpReply)
+        {
+            parseMessage(header, *dumpView);
+        }
+        else if (isOwnReply)
+        {
+            // a late reply of a dump which failed, the dump is retried
+            continue;
+        }
+        else
+        {
+            if (parseMessage(header, view_))
+            {
+                isRouteDumpNeeded_ = true;
+            }
+            if (dumpView)
+            {
+                parseMessage(header, *dumpView);
+            }
+        }
+    }
+    return state;
+}
+
+bool RouteMonitor_linux::parseMessage(const void *message, View &view)
+{
+    const nlmsghdr *header = static_cast<const nlmsghdr *>(message);
+    switch (header->nlmsg_type)
+    {
+    case RTM_NEWLINK:
+    case RTM_DELLINK:
+        if (header->nlmsg_len >= NLMSG_LENGTH(sizeof(ifinfomsg)))
+            return parseLink(header, header->nlmsg_type == RTM_DELLINK, view);
+        break;
+    case RTM_NEWADDR:
+    case RTM_DELADDR:
+        if (header->nlmsg_len >= NLMSG_LENGTH(sizeof(ifaddrmsg)))
+            return parseAddress(header, header->nlmsg_type == RTM_DELADDR, view);
+        break;
+    case RTM_NEWROUTE:
+    case RTM_DELROUTE:
+        if (header->nlmsg_len >= NLMSG_LENGTH(sizeof(rtmsg)))
+            parseRoute(header, header->nlmsg_type == RTM_DELROUTE, view);
+        break;
+    default:
+        break;
+    }
+    return false;
+}
+
+bool RouteMonitor_linux::parseLink(const void *message, bool isRemoved, View &view)
+{
+    const nlmsghdr *header = static_cast<const nlmsghdr *>(message);
+    const ifinfomsg *info = static_cast<const ifinfomsg *>(NLMSG_DATA(header));
+    // the routes of a link which is gone or down are dropped
+    if (isRemoved)
+    {
+        return view.links.remove(info->ifi_index) > 0;
+    }
+
+    bool isRouteDumpNeeded = false;
+    Link &link = view.links[info->ifi_index];
+    if (link.flags != info->ifi_flags)
+    {
+        link.flags = info->ifi_flags;
+        isRouteDumpNeeded = true;
+    }
+    // the wireless events come as links without a change, so only the attributes present are taken
+    int length = IFLA_PAYLOAD(header);
+    for (const rtattr *attribute = IFLA_RTA(info); RTA_OK(attribute, length); attribute = RTA_NEXT(attribute, length))
+    {
+        const char *data = static_cast<const char *>(RTA_DATA(attribute));
+        if (attribute->rta_type == IFLA_IFNAME)
+        {
+            link.name = QString::fromUtf8(data, static_cast<int>(qstrnlen(data, RTA_PAYLOAD(attribute))));
+        }
+        else if (attribute->rta_type == IFLA_ADDRESS)
+        {
+            link.hardwareAddress = QByteArray(data, static_cast<int>(RTA_PAYLOAD(attribute)));
+        }
+    }
+    return isRouteDumpNeeded;
+}
+
+bool RouteMonitor_linux::parseAddress(const void *message, bool isRemoved, View &view)
+{
+    const nlmsghdr *header = static_cast<const nlmsghdr *>(message);
+    const ifaddrmsg *info = static_cast<const ifaddrmsg *>(NLMSG_DATA(header));
+    // the address of the interface is IFA_LOCAL where there is one, IFA_ADDRESS is the peer of a point-to-point
+    // link then
+    QString address, localAddress;
+    int length = IFA_PAYLOAD(header);
+    for (const rtattr *attribute = IFA_RTA(info); RTA_OK(attribute, length); attribute = RTA_NEXT(attribute, length))
+    {
+        if (attribute->rta_type == IFA_ADDRESS)
+            address = formatAddress(info->ifa_family, RTA_DATA(attribute), RTA_PAYLOAD(attribute));
+        else if (attribute->rta_type == IFA_LOCAL)
+            localAddress = formatAddress(info->ifa_family, RTA_DATA(attribute), RTA_PAYLOAD(attribute));
+    }
+    if (!localAddress.isEmpty())
+    {
+        address = localAddress;
+    }
+    if (address.isEmpty())
+    {
+        return false;
+    }
+    address += '/' + QString::number(info->ifa_prefixlen);
+
+    const int index = static_cast<int>(info->ifa_index);
+    if (isRemoved)
+    {
+        // the routes through the gateway of a removed address are dropped
+        auto it = view.links.find(index);
+        return it != view.links.end() && it->addresses.remove(address);
+    }
+    view.links[index].addresses.insert(address);
+    return false;
+}
+
+void RouteMonitor_linux::parseRoute(const void *message, bool isRemoved, View &view)
+{
+    const nlmsghdr *header = static_cast<const nlmsghdr *>(message);
+    const rtmsg *info = static_cast<const rtmsg *>(NLMSG_DATA(header));
+    if (info->rtm_family != AF_INET || info->rtm_dst_len != 0 || info->rtm_type != RTN_UNICAST)
+    {
+        return;
+    }
+
+    quint32 table = info->rtm_table;
+    DefaultRoute route;
+    int length = RTM_PAYLOAD(header);
+    for (const rtattr *attribute = RTM_RTA(info); RTA_OK(attribute, length); attribute = RTA_NEXT(attribute, length))
+    {
+        switch (attribute->rta_type)
+        {
+        case RTA_TABLE:
+            table = readU32(attribute);
+            break;
+        case RTA_OIF:
+            route.interfaceIndex = static_cast<int>(readU32(attribute));
+            break;
+        case RTA_GATEWAY:
+            route.gateway = formatAddress(AF_INET, RTA_DATA(attribute), RTA_PAYLOAD(attribute));
+            break;
+        case RTA_PRIORITY:
+            route.priority = readU32(attribute);
+            break;
+        case RTA_MULTIPATH:
+            // the first of the next hops stands for the route
+            if (RTA_PAYLOAD(attribute) >= sizeof(rtnexthop))
+            {
+                const rtnexthop *nextHop = static_cast<const rtnexthop *>(RTA_DATA(attribute));
+                route.interfaceIndex = nextHop->rtnh_ifindex;
+                int hopLength = qMin(static_cast<int>(nextHop->rtnh_len), static_cast<int>(RTA_PAYLOAD(attribute))) -
+                                static_cast<int>(RTNH_LENGTH(0));
+                for (const rtattr *hopAttribute = RTNH_DATA(nextHop); RTA_OK(hopAttribute, hopLength);
+                     hopAttribute = RTA_NEXT(hopAttribute, hopLength))
+                {
+                    if (hopAttribute->rta_type == RTA_GATEWAY)
+                        route.gateway = formatAddress(AF_INET, RTA_DATA(hopAttribute), RTA_PAYLOAD(hopAttribute));
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    if (table != RT_TABLE_MAIN)
+    {
+        return;
+    }
+
+    // the kernel keeps a single route with the same interface, gateway and priority
+    QVector<DefaultRoute> &defaultRoutes = view.defaultRoutes;
+    const int pos = defaultRoutes.indexOf(route);
+    if (isRemoved)
+    {
+        if (pos != -1)
+        {
+            defaultRoutes.remove(pos);
+        }
+    }
+    else if (pos == -1)
+    {
+        auto it = defaultRoutes.begin();
+        while (it != defaultRoutes.end() && it->priority <= route.priority)
+        {
+            ++it;
+        }
+        defaultRoutes.insert(it, route);
+    }
+}
+
+void RouteMonitor_linux::emitChanges(const View &oldView)
+{
+    const QMap<int, Link> &links = view_.links;
+    const QMap<int, Link> &oldLinks = oldView.links;
+    const QVector<DefaultRoute> &defaultRoutes = view_.defaultRoutes;
+    const QVector<DefaultRoute> &oldRoutes = oldView.defaultRoutes;
+
+    QSet<int> interfaceIndexes;
+    for (auto it = links.cbegin(); it != links.cend(); ++it)
+    {
+        const auto old = oldLinks.constFind(it.key());
+        if (old == oldLinks.cend() || *old != it.value())
+        {
+            interfaceIndexes << it.key();
+        }
+    }
+    for (auto it = oldLinks.cbegin(); it != oldLinks.cend(); ++it)
+    {
+        if (!links.contains(it.key()))
+        {
+            interfaceIndexes << it.key();
+        }
+    }
+    for (const DefaultRoute &route : qAsConst(defaultRoutes))
+    {
+        if (!oldRoutes.contains(route))
+        {
+            interfaceIndexes << route.interfaceIndex;
+        }
+    }
+    for (const DefaultRoute &route : oldRoutes)
+    {
+        if (!defaultRoutes.contains(route))
+        {
+            interfaceIndexes << route.interfaceIndex;
+        }
+    }
+
+    if (!interfaceIndexes.isEmpty())
+    {
+        emit changed(interfaceIndexes);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef ROUTEMONITOR_LINUX_H
+#define ROUTEMONITOR_LINUX_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+class QSocketNotifier;
+
+// The network links, their addresses and the IPv4 default routes of the main table, kept in memory from a
+// NETLINK_ROUTE socket subscribed to the link, address and route groups. The kernel sends a message on each change,
+// so a change is seen as soon as it's made and without running a process.
+// The kernel doesn't announce the routes it drops along with an interface or an address, so the routes are read
+// again after a link or an address changes. A dump is read into a view of its own and replaces the view known only
+// once it is complete; the view known is kept if the dump fails, and the dump is tried again a bit later.
+class RouteMonitor_linux : public QObject
+{
+    Q_OBJECT
+public:
+    struct Link
+    {
+        QString name;
+        unsigned int flags;             // IFF_UP, IFF_RUNNING, ...
+        QByteArray hardwareAddress;
+        QSet<QString> addresses;        // "address/prefix", IPv4 and IPv6
+
+        Link() : flags(0) {}
+        bool operator==(const Link &other) const;
+        bool operator!=(const Link &other) const { return !(*this == other); }
+    };
+
+    struct DefaultRoute
+    {
+        int interfaceIndex;
+        QString gateway;                // empty for a route without one, like that of a point-to-point link
+        quint32 priority;
+
+        DefaultRoute() : interfaceIndex(0), priority(0) {}
+        bool operator==(const DefaultRoute &other) const;
+    };
+
+    explicit RouteMonitor_linux(QObject *parent);
+    ~RouteMonitor_linux() override;
+
+    // subscribes to the changes and reads the current links, addresses and routes; false if it can't
+    bool start();
+
+    // by the interface index
+    const QMap<int, Link> &links() const { return view_.links; }
+    // the route the kernel prefers first
+    const QVector<DefaultRoute> &defaultRoutes() const { return view_.defaultRoutes; }
+
+    // applies a datagram of netlink messages, as read from the socket, to the view; public for the tests
+    void processMessages(const QByteArray &datagram);
+
+signals:
+    // the indexes of the interfaces whose link, addresses or default routes changed
+    void changed(const QSet<int> &interfaceIndexes);
+
+private slots:
+    void onSocketActivated();
+    void onRetryTimer();
+
+private:
+    struct View
+    {
+        QMap<int, Link> links;
+        QVector<DefaultRoute> defaultRoutes;
+    };
+
+    enum DUMP_STATE { DUMP_PENDING, DUMP_DONE, DUMP_FAILED };
+
+    int socket_;
+    // the port id the kernel gave the socket, the replies to its requests are sent to it; 0 until started
+    quint32 portId_;
+    QSocketNotifier *notifier_;
+    quint32 sequence_;
+    QByteArray buffer_;
+    View view_;
+    // set by a change which may have dropped routes
+    bool isRouteDumpNeeded_;
+    // set once messages were lost, or a dump of the whole state failed
+    bool isStateReadNeeded_;
+    QTimer retryTimer_;
+
+    bool readCurrentState();
+    bool readDefaultRoutes();
+    // replaces the routes of |view|
+    bool dumpDefaultRoutes(View &view);
+    // reads the pending dumps, a failed one is retried by the timer
+    void readPendingDumps();
+    // fills |view| from the replies, the changes which come meanwhile are applied to it as well
+    bool dump(int type, int family, View &view);
+    // |dumpView| - the view the replies of the dump of |dumpSequence| go to, nullptr if none
+    DUMP_STATE parseMessages(const char *data, int size, quint32 dumpSequence, View *dumpView);
+    // returns true if the routes may have been dropped along with the change
+    static bool parseMessage(const void *message, View &view);
+    static bool parseLink(const void *message, bool isRemoved, View &view);
+    static bool parseAddress(const void *message, bool isRemoved, View &view);
+    static void parseRoute(const void *message, bool isRemoved, View &view);
+    void emitChanges(const View &oldView);
+};
+
+#endif // ROUTEMONITOR_LINUX_H
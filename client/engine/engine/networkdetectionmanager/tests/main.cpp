@@ -0,0 +1,16 @@
+#include <QtTest>
+#include <QCoreApplication>
+
+#include "tst_networkchangecoalescer.h"
+#include "tst_routemonitor_linux.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int status = 0;
+
+    status |= QTest::qExec(new TestNetworkChangeCoalescer(), argc, argv);
+    status |= QTest::qExec(new TestRouteMonitorLinux(), argc, argv);
+
+    return status;
+}
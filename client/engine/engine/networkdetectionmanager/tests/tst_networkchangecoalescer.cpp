@@ -0,0 +1,234 @@
+#include "tst_networkchangecoalescer.h"
+#include <QtTest>
+#include "networkdetectionmanager/networkchangecoalescer.h"
+
+namespace
+{
+const int SETTLE_TIME_MS = 100;
+const int MAX_DELAY_MS = 400;
+
+// a network state reported after the delay since the previous one
+struct Step
+{
+    int delayMs;
+    bool isOnline;
+    int interfaceIndex;
+    const char *network;
+    const char *gateway;
+};
+
+struct Change
+{
+    bool isOnline;
+    int interfaceIndex;
+    QString network;
+    int changes;
+};
+
+ProtoTypes::NetworkInterface makeInterface(int interfaceIndex, const char *network)
+{
+    ProtoTypes::NetworkInterface networkInterface;
+    networkInterface.set_interface_index(interfaceIndex);
+    networkInterface.set_interface_name(interfaceIndex == 2 ? "eth0" : "wlan0");
+    networkInterface.set_network_or_ssid(network);
+    return networkInterface;
+}
+
+// the coalescer on a clock which only moves when the test advances it, the real timer never gets to fire
+class ManualClockCoalescer : public NetworkChangeCoalescer
+{
+public:
+    ManualClockCoalescer() : NetworkChangeCoalescer(nullptr, SETTLE_TIME_MS, MAX_DELAY_MS), nowMs_(0) {}
+
+    void advance(int ms)
+    {
+        for (int i = 0; i < ms; ++i)
+        {
+            ++nowMs_;
+            checkSettled();
+        }
+    }
+
+protected:
+    qint64 nowMs() const override { return nowMs_; }
+
+private:
+    qint64 nowMs_;
+};
+
+class Recorder
+{
+public:
+    explicit Recorder(NetworkChangeCoalescer &coalescer)
+    {
+        QObject::connect(&coalescer, &NetworkChangeCoalescer::networkChanged,
+                         [this](bool isOnline, const ProtoTypes::NetworkInterface &networkInterface, int changes) {
+            changes_ << Change { isOnline, networkInterface.interface_index(),
+                                 QString::fromStdString(networkInterface.network_or_ssid()), changes };
+        });
+    }
+    const QVector<Change> &changes() const { return changes_; }
+
+private:
+    QVector<Change> changes_;
+};
+
+void play(ManualClockCoalescer &coalescer, const QVector<Step> &steps)
+{
+    for (const Step &step : steps)
+    {
+        coalescer.advance(step.delayMs);
+        coalescer.report(step.isOnline, makeInterface(step.interfaceIndex, step.network), step.gateway);
+    }
+}
+
+// the time it took for the pending change to settle, -1 if it didn't
+int settle(ManualClockCoalescer &coalescer)
+{
+    for (int ms = 0; ms <= MAX_DELAY_MS; ++ms)
+    {
+        if (!coalescer.isChangePending())
+            return ms;
+        coalescer.advance(1);
+    }
+    return -1;
+}
+}
+
+TestNetworkChangeCoalescer::TestNetworkChangeCoalescer()
+{
+}
+
+TestNetworkChangeCoalescer::~TestNetworkChangeCoalescer()
+{
+}
+
+void TestNetworkChangeCoalescer::test_changes()
+{
+    const ProtoTypes::NetworkInterface home = makeInterface(3, "Home");
+    QCOMPARE(NetworkChangeCoalescer::changesBetween(true, home, "192.168.1.1", true, home, "192.168.1.1"), 0);
+    QCOMPARE(NetworkChangeCoalescer::changesBetween(true, home, "192.168.1.1", false, home, "192.168.1.1"),
+             int(NetworkChangeCoalescer::CHANGE_ONLINE));
+    QCOMPARE(NetworkChangeCoalescer::changesBetween(true, home, "192.168.1.1", true, makeInterface(3, "Office"), "10.0.0.1"),
+             NetworkChangeCoalescer::CHANGE_NETWORK | NetworkChangeCoalescer::CHANGE_GATEWAY);
+    QCOMPARE(NetworkChangeCoalescer::changesBetween(true, home, "192.168.1.1", true, makeInterface(2, "Home"), "192.168.1.1"),
+             int(NetworkChangeCoalescer::CHANGE_INTERFACE));
+
+    // an attribute of the interface other than the network
+    ProtoTypes::NetworkInterface inactiveHome = home;
+    inactiveHome.set_active(!home.active());
+    QCOMPARE(NetworkChangeCoalescer::changesBetween(true, home, "192.168.1.1", true, inactiveHome, "192.168.1.1"),
+             int(NetworkChangeCoalescer::CHANGE_INTERFACE));
+
+    QCOMPARE(NetworkChangeCoalescer::changesToString(NetworkChangeCoalescer::CHANGE_ONLINE | NetworkChangeCoalescer::CHANGE_GATEWAY),
+             QString("online, gateway"));
+    QCOMPARE(NetworkChangeCoalescer::changesToString(0), QString());
+}
+
+void TestNetworkChangeCoalescer::test_flap()
+{
+    // a DHCP renewal: the route goes and comes back to the same gateway on the same network
+    ManualClockCoalescer coalescer;
+    coalescer.reset(true, makeInterface(3, "Home"), "192.168.1.1");
+    Recorder recorder(coalescer);
+
+    play(coalescer, {
+        { 0, false, 3, "Home", "" },
+        { 10, false, -1, "", "" },
+        { 20, true, 3, "Home", "" },
+        { 10, true, 3, "Home", "192.168.1.1" },
+    });
+    QVERIFY(coalescer.isChangePending());
+    QCOMPARE(settle(coalescer), SETTLE_TIME_MS);
+    QCOMPARE(recorder.changes().count(), 0);
+}
+
+void TestNetworkChangeCoalescer::test_roaming()
+{
+    // from the wired network to another Wi-Fi network, through a few intermediate states
+    ManualClockCoalescer coalescer;
+    coalescer.reset(true, makeInterface(2, "Office LAN"), "10.0.0.1");
+    Recorder recorder(coalescer);
+
+    play(coalescer, {
+        { 0, false, -1, "", "" },
+        { 20, true, 3, "", "" },
+        { 20, true, 3, "Cafe", "" },
+        { 20, true, 3, "Cafe", "172.16.0.1" },
+    });
+    coalescer.advance(SETTLE_TIME_MS - 1);
+    QCOMPARE(recorder.changes().count(), 0);
+    coalescer.advance(1);
+
+    QCOMPARE(recorder.changes().count(), 1);
+    const Change &change = recorder.changes().first();
+    QVERIFY(change.isOnline);
+    QCOMPARE(change.interfaceIndex, 3);
+    QCOMPARE(change.network, QString("Cafe"));
+    QCOMPARE(change.changes, NetworkChangeCoalescer::CHANGE_INTERFACE | NetworkChangeCoalescer::CHANGE_NETWORK |
+                             NetworkChangeCoalescer::CHANGE_GATEWAY);
+
+    // then the Wi-Fi goes down for good
+    play(coalescer, {
+        { 0, true, 3, "Cafe", "" },
+        { 10, false, -1, "", "" },
+    });
+    QCOMPARE(settle(coalescer), SETTLE_TIME_MS);
+    QCOMPARE(recorder.changes().count(), 2);
+    QVERIFY(!recorder.changes()[1].isOnline);
+    QCOMPARE(recorder.changes()[1].changes, NetworkChangeCoalescer::CHANGE_ONLINE | NetworkChangeCoalescer::CHANGE_INTERFACE |
+                                            NetworkChangeCoalescer::CHANGE_NETWORK | NetworkChangeCoalescer::CHANGE_GATEWAY);
+}
+
+void TestNetworkChangeCoalescer::test_continuous_burst()
+{
+    // the states which keep coming don't put the change off for longer than the max delay
+    ManualClockCoalescer coalescer;
+    coalescer.reset(true, makeInterface(3, "Home"), "192.168.1.1");
+    Recorder recorder(coalescer);
+
+    // the first change comes out at the max delay since the first state of the burst
+    int elapsedMs = 0;
+    int i = 0;
+    play(coalescer, { { 0, true, 3, "Home", "192.168.1.2" } });
+    while (recorder.changes().isEmpty() && elapsedMs < MAX_DELAY_MS * 3)
+    {
+        play(coalescer, { { SETTLE_TIME_MS / 4, true, 3, "Home", (++i % 2) ? "192.168.1.3" : "192.168.1.2" } });
+        elapsedMs += SETTLE_TIME_MS / 4;
+    }
+    QCOMPARE(elapsedMs, MAX_DELAY_MS);
+    QCOMPARE(recorder.changes().count(), 1);
+
+    while (elapsedMs < MAX_DELAY_MS * 3)
+    {
+        play(coalescer, { { SETTLE_TIME_MS / 4, true, 3, "Home", (++i % 2) ? "192.168.1.3" : "192.168.1.2" } });
+        elapsedMs += SETTLE_TIME_MS / 4;
+    }
+    QVERIFY(settle(coalescer) >= 0);
+    QVERIFY(recorder.changes().count() <= 4);
+    for (const Change &change : recorder.changes())
+    {
+        QCOMPARE(change.changes, int(NetworkChangeCoalescer::CHANGE_GATEWAY));
+    }
+}
+
+void TestNetworkChangeCoalescer::test_reset()
+{
+    ManualClockCoalescer coalescer;
+    coalescer.reset(true, makeInterface(3, "Home"), "192.168.1.1");
+    Recorder recorder(coalescer);
+
+    play(coalescer, { { 0, false, -1, "", "" } });
+    QVERIFY(coalescer.isChangePending());
+    coalescer.reset(true, makeInterface(2, "Office LAN"), "10.0.0.1");
+    QVERIFY(!coalescer.isChangePending());
+    coalescer.advance(SETTLE_TIME_MS * 2);
+    QCOMPARE(recorder.changes().count(), 0);
+
+    // the changes are from the state reset to
+    play(coalescer, { { 0, true, 3, "Home", "192.168.1.1" } });
+    QCOMPARE(settle(coalescer), SETTLE_TIME_MS);
+    QCOMPARE(recorder.changes().count(), 1);
+    QCOMPARE(recorder.changes().first().changes, NetworkChangeCoalescer::CHANGE_INTERFACE | NetworkChangeCoalescer::CHANGE_NETWORK |
+                                                 NetworkChangeCoalescer::CHANGE_GATEWAY);
+}
@@ -0,0 +1,23 @@
+#ifndef TESTNETWORKCHANGECOALESCER_H
+#define TESTNETWORKCHANGECOALESCER_H
+
+#include <QObject>
+
+class TestNetworkChangeCoalescer : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestNetworkChangeCoalescer();
+    ~TestNetworkChangeCoalescer();
+
+private slots:
+    void test_changes();
+    void test_flap();
+    void test_roaming();
+    void test_continuous_burst();
+    void test_reset();
+};
+
+
+#endif // TESTNETWORKCHANGECOALESCER_H
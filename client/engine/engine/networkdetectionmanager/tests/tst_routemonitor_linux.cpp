@@ -0,0 +1,278 @@
+#include "tst_routemonitor_linux.h"
+#include <QtTest>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include "networkdetectionmanager/routemonitor_linux.h"
+
+namespace
+{
+// the netlink messages as the kernel sends them
+QByteArray attribute(int type, const void *data, int size)
+{
+    rtattr header;
+    header.rta_len = RTA_LENGTH(size);
+    header.rta_type = type;
+    QByteArray result(reinterpret_cast<const char *>(&header), sizeof(header));
+    result.append(static_cast<const char *>(data), size);
+    result.append(QByteArray(RTA_ALIGN(size) - size, '\0'));
+    return result;
+}
+
+QByteArray u32Attribute(int type, quint32 value)
+{
+    return attribute(type, &value, sizeof(value));
+}
+
+QByteArray addressAttribute(int type, int family, const char *address)
+{
+    unsigned char data[16];
+    inet_pton(family, address, data);
+    return attribute(type, data, family == AF_INET ? 4 : 16);
+}
+
+QByteArray message(int type, const void *body, int bodySize, const QByteArray &attributes)
+{
+    nlmsghdr header;
+    memset(&header, 0, sizeof(header));
+    header.nlmsg_type = type;
+    header.nlmsg_len = NLMSG_LENGTH(NLMSG_ALIGN(bodySize)) + attributes.size();
+    QByteArray result(reinterpret_cast<const char *>(&header), sizeof(header));
+    result.append(static_cast<const char *>(body), bodySize);
+    result.append(QByteArray(NLMSG_ALIGN(bodySize) - bodySize, '\0'));
+    result.append(attributes);
+    result.append(QByteArray(NLMSG_ALIGN(result.size()) - result.size(), '\0'));
+    return result;
+}
+
+QByteArray link(int type, int index, unsigned int flags, const char *name)
+{
+    ifinfomsg info;
+    memset(&info, 0, sizeof(info));
+    info.ifi_index = index;
+    info.ifi_flags = flags;
+    QByteArray attributes;
+    if (name)
+    {
+        attributes += attribute(IFLA_IFNAME, name, static_cast<int>(strlen(name)) + 1);
+        const unsigned char mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, static_cast<unsigned char>(index) };
+        attributes += attribute(IFLA_ADDRESS, mac, sizeof(mac));
+    }
+    return message(type, &info, sizeof(info), attributes);
+}
+
+QByteArray address(int type, int index, int family, const char *address, int prefixLength)
+{
+    ifaddrmsg info;
+    memset(&info, 0, sizeof(info));
+    info.ifa_family = family;
+    info.ifa_index = index;
+    info.ifa_prefixlen = prefixLength;
+    QByteArray attributes = addressAttribute(IFA_ADDRESS, family, address);
+    if (family == AF_INET)
+        attributes += addressAttribute(IFA_LOCAL, family, address);
+    return message(type, &info, sizeof(info), attributes);
+}
+
+QByteArray route(int type, int index, const char *gateway, quint32 priority, quint32 table = RT_TABLE_MAIN,
+                 int destinationLength = 0)
+{
+    rtmsg info;
+    memset(&info, 0, sizeof(info));
+    info.rtm_family = AF_INET;
+    info.rtm_dst_len = destinationLength;
+    info.rtm_table = table < 256 ? table : RT_TABLE_UNSPEC;
+    info.rtm_type = RTN_UNICAST;
+    QByteArray attributes = u32Attribute(RTA_TABLE, table) + u32Attribute(RTA_OIF, index) +
+                            u32Attribute(RTA_PRIORITY, priority);
+    if (gateway)
+        attributes += addressAttribute(RTA_GATEWAY, AF_INET, gateway);
+    return message(type, &info, sizeof(info), attributes);
+}
+
+// the notification of a change requested by another process carries the sequence and the port id of its request
+QByteArray requestedBy(QByteArray message, quint32 sequence, quint32 portId)
+{
+    nlmsghdr *header = reinterpret_cast<nlmsghdr *>(message.data());
+    header->nlmsg_seq = sequence;
+    header->nlmsg_pid = portId;
+    return message;
+}
+
+QSet<int> changedIndexes(const QSignalSpy &spy, int i)
+{
+    return qvariant_cast<QSet<int>>(spy.at(i).at(0));
+}
+
+const unsigned int UP_FLAGS = IFF_UP | IFF_RUNNING;
+}
+
+TestRouteMonitorLinux::TestRouteMonitorLinux()
+{
+}
+
+TestRouteMonitorLinux::~TestRouteMonitorLinux()
+{
+}
+
+void TestRouteMonitorLinux::test_links_and_addresses()
+{
+    RouteMonitor_linux monitor(nullptr);
+    QSignalSpy spy(&monitor, SIGNAL(changed(QSet<int>)));
+
+    monitor.processMessages(link(RTM_NEWLINK, 2, UP_FLAGS, "eth0"));
+    monitor.processMessages(address(RTM_NEWADDR, 2, AF_INET, "192.168.1.10", 24));
+    monitor.processMessages(address(RTM_NEWADDR, 2, AF_INET6, "2001:db8::10", 64));
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(changedIndexes(spy, 0), QSet<int>() << 2);
+    const RouteMonitor_linux::Link eth0 = monitor.links().value(2);
+    QCOMPARE(eth0.name, QString("eth0"));
+    QCOMPARE(eth0.flags, UP_FLAGS);
+    QCOMPARE(eth0.hardwareAddress, QByteArray("\x02\x00\x00\x00\x00\x02", 6));
+    QCOMPARE(eth0.addresses, QSet<QString>() << "192.168.1.10/24" << "2001:db8::10/64");
+
+    // the same state again, and a wireless event of the link without its attributes, change nothing
+    monitor.processMessages(link(RTM_NEWLINK, 2, UP_FLAGS, "eth0"));
+    monitor.processMessages(address(RTM_NEWADDR, 2, AF_INET6, "2001:db8::10", 64));
+    monitor.processMessages(link(RTM_NEWLINK, 2, UP_FLAGS, nullptr));
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(monitor.links().value(2).name, QString("eth0"));
+
+    monitor.processMessages(address(RTM_DELADDR, 2, AF_INET, "192.168.1.10", 24));
+    monitor.processMessages(link(RTM_NEWLINK, 2, IFF_UP, nullptr));
+    QCOMPARE(spy.count(), 5);
+    QCOMPARE(monitor.links().value(2).addresses, QSet<QString>() << "2001:db8::10/64");
+    QCOMPARE(monitor.links().value(2).flags, static_cast<unsigned int>(IFF_UP));
+}
+
+void TestRouteMonitorLinux::test_default_routes()
+{
+    RouteMonitor_linux monitor(nullptr);
+    monitor.processMessages(link(RTM_NEWLINK, 2, UP_FLAGS, "eth0"));
+    monitor.processMessages(link(RTM_NEWLINK, 3, UP_FLAGS, "wlan0"));
+    QSignalSpy spy(&monitor, SIGNAL(changed(QSet<int>)));
+
+    monitor.processMessages(route(RTM_NEWROUTE, 3, "10.0.0.1", 600));
+    monitor.processMessages(route(RTM_NEWROUTE, 2, "192.168.1.1", 100));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(changedIndexes(spy, 0), QSet<int>() << 3);
+    QCOMPARE(monitor.defaultRoutes().count(), 2);
+    QCOMPARE(monitor.defaultRoutes()[0].interfaceIndex, 2);
+    QCOMPARE(monitor.defaultRoutes()[0].gateway, QString("192.168.1.1"));
+    QCOMPARE(monitor.defaultRoutes()[0].priority, quint32(100));
+    QCOMPARE(monitor.defaultRoutes()[1].interfaceIndex, 3);
+
+    // not the default routes of the main table
+    monitor.processMessages(route(RTM_NEWROUTE, 2, nullptr, 100, RT_TABLE_MAIN, 24));
+    monitor.processMessages(route(RTM_NEWROUTE, 2, "192.168.1.1", 0, 51820));
+    monitor.processMessages(route(RTM_NEWROUTE, 2, "192.168.1.1", 0, RT_TABLE_LOCAL));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(monitor.defaultRoutes().count(), 2);
+
+    monitor.processMessages(route(RTM_DELROUTE, 2, "192.168.1.1", 100));
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(changedIndexes(spy, 2), QSet<int>() << 2);
+    QCOMPARE(monitor.defaultRoutes().count(), 1);
+    QCOMPARE(monitor.defaultRoutes()[0].interfaceIndex, 3);
+}
+
+void TestRouteMonitorLinux::test_multipath_route()
+{
+    RouteMonitor_linux monitor(nullptr);
+
+    rtmsg info;
+    memset(&info, 0, sizeof(info));
+    info.rtm_family = AF_INET;
+    info.rtm_table = RT_TABLE_MAIN;
+    info.rtm_type = RTN_UNICAST;
+    QByteArray hops;
+    for (int index = 4; index <= 5; ++index)
+    {
+        const QByteArray gateway = addressAttribute(RTA_GATEWAY, AF_INET, index == 4 ? "10.4.0.1" : "10.5.0.1");
+        rtnexthop hop;
+        memset(&hop, 0, sizeof(hop));
+        hop.rtnh_len = RTNH_LENGTH(gateway.size());
+        hop.rtnh_ifindex = index;
+        hops.append(reinterpret_cast<const char *>(&hop), sizeof(hop));
+        hops.append(gateway);
+    }
+    monitor.processMessages(message(RTM_NEWROUTE, &info, sizeof(info),
+                                    attribute(RTA_MULTIPATH, hops.constData(), hops.size())));
+
+    // the first of the next hops
+    QCOMPARE(monitor.defaultRoutes().count(), 1);
+    QCOMPARE(monitor.defaultRoutes()[0].interfaceIndex, 4);
+    QCOMPARE(monitor.defaultRoutes()[0].gateway, QString("10.4.0.1"));
+}
+
+void TestRouteMonitorLinux::test_removed_link()
+{
+    RouteMonitor_linux monitor(nullptr);
+    monitor.processMessages(link(RTM_NEWLINK, 7, UP_FLAGS, "usb0"));
+    monitor.processMessages(address(RTM_NEWADDR, 7, AF_INET, "172.20.10.2", 28));
+    QSignalSpy spy(&monitor, SIGNAL(changed(QSet<int>)));
+
+    monitor.processMessages(link(RTM_DELLINK, 7, 0, "usb0"));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(changedIndexes(spy, 0), QSet<int>() << 7);
+    QVERIFY(!monitor.links().contains(7));
+
+    monitor.processMessages(link(RTM_DELLINK, 7, 0, "usb0"));
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestRouteMonitorLinux::test_burst()
+{
+    // the messages read at once make a single change
+    RouteMonitor_linux monitor(nullptr);
+    QSignalSpy spy(&monitor, SIGNAL(changed(QSet<int>)));
+    monitor.processMessages(link(RTM_NEWLINK, 2, UP_FLAGS, "eth0") + link(RTM_NEWLINK, 3, UP_FLAGS, "wlan0") +
+                            address(RTM_NEWADDR, 3, AF_INET, "10.0.0.5", 24) +
+                            route(RTM_NEWROUTE, 3, "10.0.0.1", 600) +
+                            address(RTM_NEWADDR, 3, AF_INET, "10.0.0.5", 24) +
+                            route(RTM_DELROUTE, 3, "10.0.0.1", 600) +
+                            route(RTM_NEWROUTE, 3, "10.0.0.1", 600));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(changedIndexes(spy, 0), QSet<int>() << 2 << 3);
+    QCOMPARE(monitor.defaultRoutes().count(), 1);
+
+    // a truncated message is left alone
+    const QByteArray truncated = link(RTM_NEWLINK, 9, UP_FLAGS, "eth9");
+    monitor.processMessages(truncated.left(truncated.size() - 8));
+    QVERIFY(!monitor.links().contains(9));
+}
+
+void TestRouteMonitorLinux::test_foreign_request()
+{
+    RouteMonitor_linux monitor(nullptr);
+    monitor.processMessages(link(RTM_NEWLINK, 2, UP_FLAGS, "eth0"));
+    QSignalSpy spy(&monitor, SIGNAL(changed(QSet<int>)));
+
+    monitor.processMessages(requestedBy(address(RTM_NEWADDR, 2, AF_INET, "192.168.1.10", 24), 1700000000, 4321));
+    monitor.processMessages(requestedBy(route(RTM_NEWROUTE, 2, "192.168.1.1", 100), 1700000001, 4321));
+    QCOMPARE(spy.count(), 2);
+    QVERIFY(monitor.links()[2].addresses.contains("192.168.1.10/24"));
+    QCOMPARE(monitor.defaultRoutes().count(), 1);
+
+    monitor.processMessages(requestedBy(route(RTM_DELROUTE, 2, "192.168.1.1", 100), 1700000002, 4321));
+    QCOMPARE(spy.count(), 3);
+    QVERIFY(monitor.defaultRoutes().isEmpty());
+}
+
+void TestRouteMonitorLinux::test_start()
+{
+    // the state of this host, read from the kernel: the loopback is always there
+    RouteMonitor_linux monitor(nullptr);
+    QVERIFY(monitor.start());
+    bool isLoopbackFound = false;
+    for (const auto &link : monitor.links())
+    {
+        if (link.name == "lo")
+        {
+            isLoopbackFound = true;
+            QVERIFY(link.flags & IFF_LOOPBACK);
+        }
+    }
+    QVERIFY(isLoopbackFound);
+}
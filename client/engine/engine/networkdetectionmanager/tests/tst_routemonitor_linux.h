@@ -0,0 +1,25 @@
+#ifndef TESTROUTEMONITORLINUX_H
+#define TESTROUTEMONITORLINUX_H
+
+#include <QObject>
+
+class TestRouteMonitorLinux : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRouteMonitorLinux();
+    ~TestRouteMonitorLinux();
+
+private slots:
+    void test_links_and_addresses();
+    void test_default_routes();
+    void test_multipath_route();
+    void test_removed_link();
+    void test_burst();
+    void test_foreign_request();
+    void test_start();
+};
+
+
+#endif // TESTROUTEMONITORLINUX_H
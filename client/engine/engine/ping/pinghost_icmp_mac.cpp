@@ -79,7 +79,7 @@ void PingHost_ICMP_mac::onProcessFinished(int exitCode, QProcess::ExitStatus exi
                 }
                 else
                 {
-                    qCDebug(LOG_PING) << "Something incorrect in ping utility output:" << line;
+                    qCDebugRecord(LOG_PING, "Something incorrect in ping utility output: %1", line);
                     Q_ASSERT(false);
                 }
                 break;
@@ -88,7 +88,7 @@ void PingHost_ICMP_mac::onProcessFinished(int exitCode, QProcess::ExitStatus exi
     }
     else if (exitCode != 2)
     {
-        qCDebug(LOG_PING) << "ping utility return not 0 exitCode:" << exitCode;
+        qCDebugRecord(LOG_PING, "ping utility return not 0 exitCode: %1", exitCode);
     }
 
     QString ip = process->property("ip").toString();
@@ -123,7 +123,7 @@ void PingHost_ICMP_win::processNextPings()
         pingInfo->hIcmpFile = IcmpCreateFile();
         if (pingInfo->hIcmpFile == INVALID_HANDLE_VALUE)
         {
-            qCDebug(LOG_PING) << "IcmpCreateFile failed:" << GetLastError();
+            qCDebugRecord(LOG_PING, "IcmpCreateFile failed: %1", GetLastError());
 
             Q_EMIT pingFinished(false, 0, ip, pingInfo->isFromDisconnectedState_);
             delete pingInfo;
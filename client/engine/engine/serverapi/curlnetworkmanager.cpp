@@ -40,6 +40,23 @@ size_t write_to_bytearray(void *ptr, size_t size, size_t count, void *stream)
     return size*count;
 }
 
+size_t read_from_device(char *buffer, size_t size, size_t count, void *stream)
+{
+    QIODevice *device = static_cast<QIODevice *>(stream);
+    qint64 read = device->read(buffer, size*count);
+    return read < 0 ? CURL_READFUNC_ABORT : static_cast<size_t>(read);
+}
+
+int seek_device(void *stream, curl_off_t offset, int origin)
+{
+    QIODevice *device = static_cast<QIODevice *>(stream);
+    if (origin != SEEK_SET)
+    {
+        return CURL_SEEKFUNC_CANTSEEK;
+    }
+    return device->seek(offset) ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_FAIL;
+}
+
 CURLcode sslctx_function(CURL *curl, void *sslctx, void *parm)
 {
     Q_UNUSED(curl);
@@ -242,6 +259,11 @@ void CurlNetworkManager::run()
                         // check if gzip compression used
                         //Q_ASSERT(download < 30000);
 
+                        long httpCode = 0;
+                        if (curl_easy_getinfo(e, CURLINFO_RESPONSE_CODE, &httpCode) == CURLE_OK)
+                        {
+                            curlRequest->setHttpCode(httpCode);
+                        }
                         curlRequest->setCurlRetCode(m->data.result);
                         emit finished(curlRequest);
 
@@ -348,9 +370,28 @@ CURL *CurlNetworkManager::makePostRequest(CurlRequest *curlRequest)
         list = curl_slist_append(list, curlRequest->getContentTypeHeader().toStdString().c_str());
         if (list == NULL) goto failed;
         curlRequest->addCurlListForFreeLater(list);
+        for (const QString &header : curlRequest->getHeaders())
+        {
+            struct curl_slist *next = curl_slist_append(list, header.toStdString().c_str());
+            if (next == NULL) goto failed;
+        }
 
-        if (curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, curlRequest->getPostData().size()) != CURLE_OK) goto failed;
-        if (curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, curlRequest->getPostData().data()) != CURLE_OK) goto failed;
+        if (QIODevice *device = curlRequest->getPostDataDevice())
+        {
+            // the body is read while it is sent, from the start again if the request is retried with another IP
+            if (!device->seek(0)) goto failed;
+            if (curl_easy_setopt(curl, CURLOPT_POST, 1L) != CURLE_OK) goto failed;
+            if (curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_from_device) != CURLE_OK) goto failed;
+            if (curl_easy_setopt(curl, CURLOPT_READDATA, device) != CURLE_OK) goto failed;
+            if (curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, seek_device) != CURLE_OK) goto failed;
+            if (curl_easy_setopt(curl, CURLOPT_SEEKDATA, device) != CURLE_OK) goto failed;
+            if (curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(curlRequest->getPostDataDeviceSize())) != CURLE_OK) goto failed;
+        }
+        else
+        {
+            if (curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, curlRequest->getPostData().size()) != CURLE_OK) goto failed;
+            if (curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, curlRequest->getPostData().data()) != CURLE_OK) goto failed;
+        }
         if (curl_easy_setopt(curl, CURLOPT_HTTPHEADER, list) != CURLE_OK) goto failed;
         if (curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS , curlRequest->getTimeout()) != CURLE_OK) goto failed;
 
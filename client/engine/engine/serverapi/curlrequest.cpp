@@ -1,6 +1,7 @@
 #include "curlrequest.h"
 
-CurlRequest::CurlRequest() : curlCode_(CURLE_FAILED_INIT), methodType_(METHOD_GET), timeout_(0)
+CurlRequest::CurlRequest() : postDataDeviceSize_(0), curlCode_(CURLE_FAILED_INIT), httpCode_(0), methodType_(METHOD_GET),
+    timeout_(0)
 {
 }
 
@@ -36,6 +37,22 @@ QByteArray CurlRequest::getPostData() const
     return postData_;
 }
 
+void CurlRequest::setPostDataDevice(QIODevice *device, qint64 size)
+{
+    postDataDevice_.reset(device);
+    postDataDeviceSize_ = size;
+}
+
+QIODevice *CurlRequest::getPostDataDevice() const
+{
+    return postDataDevice_.data();
+}
+
+qint64 CurlRequest::getPostDataDeviceSize() const
+{
+    return postDataDeviceSize_;
+}
+
 void CurlRequest::setUrl(const QString &strUrl)
 {
     strUrl_ = strUrl;
@@ -66,6 +83,16 @@ CURLcode CurlRequest::getCurlRetCode() const
     return curlCode_;
 }
 
+void CurlRequest::setHttpCode(long code)
+{
+    httpCode_ = code;
+}
+
+long CurlRequest::getHttpCode() const
+{
+    return httpCode_;
+}
+
 void CurlRequest::setMethodType(CurlRequest::MethodType type)
 {
     methodType_ = type;
@@ -96,6 +123,16 @@ QString CurlRequest::getContentTypeHeader() const
     return contentTypeHeader_;
 }
 
+void CurlRequest::addHeader(const QString &strHeader)
+{
+    headers_ << strHeader;
+}
+
+QStringList CurlRequest::getHeaders() const
+{
+    return headers_;
+}
+
 void CurlRequest::addCurlListForFreeLater(curl_slist *list)
 {
     curlLists_ << list;
@@ -1,7 +1,9 @@
 #ifndef CURLREQUEST_H
 #define CURLREQUEST_H
 
+#include <QIODevice>
 #include <QQueue>
+#include <QScopedPointer>
 #include <QString>
 #include <QStringList>
 #include <QVector>
@@ -21,6 +23,12 @@ public:
     void setPostData(const QByteArray &data);
     QByteArray getPostData() const;
 
+    // the body is read from |device| while it is sent instead of the post data, |size| bytes from the start
+    // of the device; the request takes the ownership of the device
+    void setPostDataDevice(QIODevice *device, qint64 size);
+    QIODevice *getPostDataDevice() const;
+    qint64 getPostDataDeviceSize() const;
+
     void setUrl(const QString &strUrl);
     QString getUrl() const;
 
@@ -30,6 +38,10 @@ public:
     void setCurlRetCode(CURLcode code);
     CURLcode getCurlRetCode() const;
 
+    // the HTTP status of the response, 0 if none was received
+    void setHttpCode(long code);
+    long getHttpCode() const;
+
     enum MethodType { METHOD_GET, METHOD_POST, METHOD_PUT, METHOD_DELETE };
 
     void setMethodType(MethodType type);
@@ -41,6 +53,10 @@ public:
     void setContentTypeHeader(const QString &strHeader);
     QString getContentTypeHeader() const;
 
+    // headers sent in addition to the content type, e.g. "Content-Encoding: gzip"
+    void addHeader(const QString &strHeader);
+    QStringList getHeaders() const;
+
     void addCurlListForFreeLater(struct curl_slist *list);
     void addCurlShareHandleForFreeLater(CURLSH *share_handle);
 
@@ -54,12 +70,16 @@ public:
 private:
     QString getData_;
     QByteArray postData_;
+    QScopedPointer<QIODevice> postDataDevice_;
+    qint64 postDataDeviceSize_;
     QByteArray answer_;
     CURLcode curlCode_;
+    long httpCode_;
     QString strUrl_;
     MethodType methodType_;
     uint timeout_;
     QString contentTypeHeader_;
+    QStringList headers_;
     QVector<struct curl_slist *> curlLists_;
     QVector<CURLSH *> curlShareHandles_;
     QString hostname_;
@@ -0,0 +1,165 @@
+#include "debuglogbody.h"
+
+#include <QUrl>
+#include <cstring>
+
+namespace
+{
+// the log is encoded and the body is compressed in pieces of this size at most
+const int CHUNK_SIZE = 64 * 1024;
+// 16 + the window bits selects the gzip format, which "Content-Encoding: gzip" stands for
+const int GZIP_WINDOW_BITS = 15 + 16;
+const int GZIP_MEMORY_LEVEL = 8;
+}
+
+DebugLogBody::DebugLogBody(bool isCompressed) : isCompressed_(isCompressed), isOk_(false),
+    isStreamInitialized_(false), logSize_(0), bodySize_(0)
+{
+    memset(&stream_, 0, sizeof(stream_));
+}
+
+DebugLogBody::~DebugLogBody()
+{
+    if (isStreamInitialized_)
+    {
+        deflateEnd(&stream_);
+    }
+}
+
+bool DebugLogBody::begin(const QUrlQuery &fieldsBefore, const QString &logFieldName)
+{
+    Q_ASSERT(!file_);
+    file_.reset(new QTemporaryFile());
+    if (!file_->open())
+    {
+        return false;
+    }
+    if (isCompressed_)
+    {
+        if (deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GZIP_WINDOW_BITS, GZIP_MEMORY_LEVEL,
+                         Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            return false;
+        }
+        isStreamInitialized_ = true;
+        compressed_.resize(CHUNK_SIZE);
+    }
+
+    QByteArray head = fieldsBefore.toString(QUrl::FullyEncoded).toUtf8();
+    if (!head.isEmpty())
+    {
+        head += '&';
+    }
+    head += QUrl::toPercentEncoding(logFieldName) + '=';
+    isOk_ = writeBody(head.constData(), head.size(), false);
+    if (isOk_)
+    {
+        open(QIODevice::WriteOnly);
+    }
+    return isOk_;
+}
+
+bool DebugLogBody::finish(const QUrlQuery &fieldsAfter)
+{
+    if (!isOpen())
+    {
+        return false;
+    }
+    close();
+    const QByteArray rest = sensitiveInfoFilter_.finish();
+    QByteArray tail = fieldsAfter.toString(QUrl::FullyEncoded).toUtf8();
+    if (!tail.isEmpty())
+    {
+        tail.prepend('&');
+    }
+    isOk_ = isOk_ && writeLog(rest.constData(), rest.size(), true) &&
+            writeBody(tail.constData(), tail.size(), false) && writeBody(nullptr, 0, true) &&
+            file_->flush() && file_->seek(0);
+    return isOk_;
+}
+
+QIODevice *DebugLogBody::takeFile()
+{
+    return isOk_ && !isOpen() ? file_.take() : nullptr;
+}
+
+qint64 DebugLogBody::readData(char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+qint64 DebugLogBody::writeData(const char *data, qint64 maxSize)
+{
+    for (qint64 done = 0; done < maxSize; done += CHUNK_SIZE)
+    {
+        // a path split between the writes is held back by the filter until it is complete
+        const QByteArray cleaned = sensitiveInfoFilter_.process(
+            QByteArray::fromRawData(data + done, static_cast<int>(qMin<qint64>(CHUNK_SIZE, maxSize - done))));
+        if (!isOk_ || !writeLog(cleaned.constData(), cleaned.size(), false))
+        {
+            isOk_ = false;
+            return -1;
+        }
+    }
+    logSize_ += maxSize;
+    return maxSize;
+}
+
+bool DebugLogBody::writeLog(const char *data, qint64 size, bool isFinal)
+{
+    // base64 is encoded by whole groups of 3 bytes, so the pieces encode to the same text as the whole log
+    pending_.append(data, static_cast<int>(size));
+    const int groupsSize = isFinal ? pending_.size() : pending_.size() / 3 * 3;
+    if (groupsSize == 0)
+    {
+        return true;
+    }
+    encoded_ = QByteArray::fromRawData(pending_.constData(), groupsSize).toBase64();
+    pending_.remove(0, groupsSize);
+    // the field used to be encoded by QUrlQuery, of the base64 characters it only escapes the '=' padding
+    if (isFinal)
+    {
+        encoded_.replace("=", "%3D");
+    }
+    return writeBody(encoded_.constData(), encoded_.size(), false);
+}
+
+bool DebugLogBody::writeBody(const char *data, qint64 size, bool isFinal)
+{
+    if (!isCompressed_)
+    {
+        if (size > 0 && file_->write(data, size) != size)
+        {
+            return false;
+        }
+        bodySize_ += size;
+        return true;
+    }
+
+    stream_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream_.avail_in = static_cast<uInt>(size);
+    int ret;
+    do
+    {
+        stream_.next_out = reinterpret_cast<Bytef *>(compressed_.data());
+        stream_.avail_out = static_cast<uInt>(compressed_.size());
+        ret = deflate(&stream_, isFinal ? Z_FINISH : Z_NO_FLUSH);
+        if (ret == Z_STREAM_ERROR)
+        {
+            return false;
+        }
+        const qint64 produced = compressed_.size() - stream_.avail_out;
+        if (produced > 0 && file_->write(compressed_.constData(), produced) != produced)
+        {
+            return false;
+        }
+        bodySize_ += produced;
+        if (isFinal && ret == Z_BUF_ERROR && produced == 0)
+        {
+            return false;
+        }
+    } while (stream_.avail_out == 0 || (isFinal && ret != Z_STREAM_END));
+    return true;
+}
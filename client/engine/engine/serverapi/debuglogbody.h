@@ -0,0 +1,56 @@
+#ifndef DEBUGLOGBODY_H
+#define DEBUGLOGBODY_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QScopedPointer>
+#include <QTemporaryFile>
+#include <QUrlQuery>
+#include <zlib.h>
+#include "utils/clean_sensitive_info.h"
+
+// Body of the debug log request, the application/x-www-form-urlencoded form with the log among its fields.
+// The body is written to a temporary file while the log is merged: the log text written to this device is
+// cleaned of the sensitive paths, base64- and percent-encoded on the fly, and the whole body is gzip-compressed
+// unless |isCompressed| is off.
+// The memory used doesn't depend on the size of the log, curl reads the file when the request is sent.
+class DebugLogBody : public QIODevice
+{
+public:
+    explicit DebugLogBody(bool isCompressed);
+    ~DebugLogBody() override;
+
+    // writes |fieldsBefore| and the name of the log field, then the device is open for writing the log text
+    bool begin(const QUrlQuery &fieldsBefore, const QString &logFieldName);
+    // writes |fieldsAfter|, completes the body and closes the device; false if writing the file failed at any point
+    bool finish(const QUrlQuery &fieldsAfter = QUrlQuery());
+
+    bool isCompressed() const { return isCompressed_; }
+    // size of the log text written, before it is cleaned, and of the complete body, as it is sent
+    qint64 logSize() const { return logSize_; }
+    qint64 bodySize() const { return bodySize_; }
+    // the file with the complete body, positioned at its start; the caller takes the ownership
+    QIODevice *takeFile();
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    bool writeLog(const char *data, qint64 size, bool isFinal);
+    bool writeBody(const char *data, qint64 size, bool isFinal);
+
+    bool isCompressed_;
+    bool isOk_;
+    bool isStreamInitialized_;
+    z_stream stream_;
+    Utils::SensitiveInfoStreamFilter sensitiveInfoFilter_;
+    QScopedPointer<QTemporaryFile> file_;
+    QByteArray pending_;    // the last bytes of the log which don't make a whole base64 group yet
+    QByteArray encoded_;
+    QByteArray compressed_;
+    qint64 logSize_;
+    qint64 bodySize_;
+};
+
+#endif // DEBUGLOGBODY_H
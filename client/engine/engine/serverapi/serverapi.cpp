@@ -14,6 +14,7 @@
 #include "utils/ipvalidation.h"
 #include "version/appversion.h"
 #include "../tests/sessionandlocations_test.h"
+#include "debuglogbody.h"
 #include "utils/extraconfig.h"
 #include <algorithm>
 
@@ -196,17 +197,21 @@ private:
 class DebugLogRequest : public ServerAPI::BaseRequest
 {
 public:
-    DebugLogRequest(const QString &username, const QString &logStr, const QString &hostname,
-                    int replyType, uint timeout, uint userRole)
+    DebugLogRequest(const QString &username, const std::function<bool(QIODevice *)> &writeLog,
+                    bool isCompressed, const QString &hostname, int replyType, uint timeout,
+                    uint userRole)
         : ServerAPI::BaseRequest(hostname, replyType, timeout, userRole),
-          username_(username), logStr_(logStr) {}
+          username_(username), writeLog_(writeLog), isCompressed_(isCompressed) {}
 
     const QString &getUsername() const { return username_; }
-    const QString &getLogStr() const { return logStr_; }
+    const std::function<bool(QIODevice *)> &getWriteLog() const { return writeLog_; }
+    bool writeLog(QIODevice *out) const { return writeLog_(out); }
+    bool isCompressed() const { return isCompressed_; }
 
 private:
     QString username_;
-    QString logStr_;
+    std::function<bool(QIODevice *)> writeLog_;
+    bool isCompressed_;
 };
 
 class GetMyIpRequest : public ServerAPI::BaseRequest
@@ -705,7 +710,7 @@ void ServerAPI::checkUpdate(const ProtoTypes::UpdateChannel updateChannel, uint
         updateChannel, hostname_, REPLY_CHECK_UPDATE, NETWORK_TIMEOUT, userRole));
 }
 
-void ServerAPI::debugLog(const QString &username, const QString &strLog, uint userRole, bool isNeedCheckRequestsEnabled)
+void ServerAPI::debugLog(const QString &username, const std::function<bool(QIODevice *)> &writeLog, uint userRole, bool isNeedCheckRequestsEnabled)
 {
     if (isNeedCheckRequestsEnabled && !bIsRequestsEnabled_)
     {
@@ -714,7 +719,8 @@ void ServerAPI::debugLog(const QString &username, const QString &strLog, uint us
     }
 
     submitDnsRequest(createRequest<DebugLogRequest>(
-        username, strLog, hostname_, REPLY_DEBUG_LOG, NETWORK_TIMEOUT, userRole));
+        username, writeLog, !ExtraConfig::instance().getDebugLogUncompressed(), hostname_,
+        REPLY_DEBUG_LOG, NETWORK_TIMEOUT, userRole));
 }
 
 void ServerAPI::speedRating(const QString &authHash, const QString &speedRatingHostname, const QString &ip, int rating, uint userRole, bool isNeedCheckRequestsEnabled)
@@ -1279,17 +1285,28 @@ void ServerAPI::handleDebugLogDnsResolve(BaseRequest *rd, bool success, const QS
 
     QUrl url("https://" + crd->getHostname() + "/Report/applog");
 
-    QUrlQuery postData;
-    postData.addQueryItem("time", strTimestamp);
-    postData.addQueryItem("client_auth_hash", md5Hash);
-    QByteArray ba = crd->getLogStr().toUtf8();
-    postData.addQueryItem("logfile", ba.toBase64());
+    // the fields keep the order of the form, the log is written right into the (compressed) body file
+    QUrlQuery postDataBefore;
+    postDataBefore.addQueryItem("time", strTimestamp);
+    postDataBefore.addQueryItem("client_auth_hash", md5Hash);
+    QUrlQuery postDataAfter;
     if (!crd->getUsername().isEmpty())
-        postData.addQueryItem("username", crd->getUsername());
-    postData.addQueryItem("platform", Utils::getPlatformNameSafe());
+        postDataAfter.addQueryItem("username", crd->getUsername());
+    postDataAfter.addQueryItem("platform", Utils::getPlatformNameSafe());
+
+    DebugLogBody body(crd->isCompressed());
+    if (!body.begin(postDataBefore, "logfile") || !crd->writeLog(&body) || !body.finish(postDataAfter)) {
+        qCDebug(LOG_SERVER_API) << "API request DebugLog failed: can't write the request body";
+        emit debugLogAnswer(SERVER_RETURN_NETWORK_ERROR, crd->getUserRole());
+        return;
+    }
+    qCDebug(LOG_SERVER_API) << "DebugLog request: log size" << body.logSize() << "bytes, body size"
+                            << body.bodySize() << "bytes" << (body.isCompressed() ? "(gzip)" : "");
 
     auto *curl_request = crd->createCurlRequest();
-    curl_request->setPostData(postData.toString(QUrl::FullyEncoded).toUtf8());
+    if (body.isCompressed())
+        curl_request->addHeader("Content-Encoding: gzip");
+    curl_request->setPostDataDevice(body.takeFile(), body.bodySize());
     curl_request->setUrl(url.toString());
     submitCurlRequest(crd, CurlRequest::METHOD_POST,
         "Content-type: application/x-www-form-urlencoded", crd->getHostname(), ips);
@@ -2169,6 +2186,8 @@ void ServerAPI::handleConfirmEmailCurl(BaseRequest *rd, bool success)
 
 void ServerAPI::handleDebugLogCurl(BaseRequest *rd, bool success)
 {
+    auto *crd = dynamic_cast<DebugLogRequest*>(rd);
+    Q_ASSERT(crd);
     const int userRole = rd->getUserRole();
     const auto *curlRequest = rd->getCurlRequest();
     CURLcode curlRetCode = success ? curlRequest->getCurlRetCode() : CURLE_OPERATION_TIMEDOUT;
@@ -2178,6 +2197,15 @@ void ServerAPI::handleDebugLogCurl(BaseRequest *rd, bool success)
         qCDebug(LOG_SERVER_API) << "DebugLog request failed(" << curlRetCode << "):" << curl_easy_strerror(curlRetCode);
         emit debugLogAnswer(SERVER_RETURN_NETWORK_ERROR, userRole);
     }
+    else if (crd->isCompressed() && curlRequest->getHttpCode() >= 400)
+    {
+        // a server, or a proxy on the way, which doesn't take the gzip-encoded body gets the log as it is
+        qCDebug(LOG_SERVER_API) << "DebugLog request failed with HTTP status" << curlRequest->getHttpCode()
+                                << ", sending the log uncompressed";
+        submitDnsRequest(createRequest<DebugLogRequest>(
+            crd->getUsername(), crd->getWriteLog(), false, crd->getHostname(), REPLY_DEBUG_LOG,
+            NETWORK_TIMEOUT, userRole));
+    }
     else
     {
         QByteArray arr = curlRequest->getAnswer();
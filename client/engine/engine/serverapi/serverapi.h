@@ -13,6 +13,7 @@
 #include "dnscache.h"
 #include "curlnetworkmanager.h"
 
+#include <functional>
 #include <list>
 
 class INetworkStateManager;
@@ -58,7 +59,9 @@ public:
     void myIP(bool isDisconnected, uint userRole, bool isNeedCheckRequestsEnabled);
 
     void checkUpdate(const ProtoTypes::UpdateChannel updateChannel, uint userRole, bool isNeedCheckRequestsEnabled);
-    void debugLog(const QString &username, const QString &strLog, uint userRole, bool isNeedCheckRequestsEnabled);
+    // |writeLog| writes the log text to the device given and returns false on failure; it's called when the
+    // request body is made, so the log is never kept in memory as a whole
+    void debugLog(const QString &username, const std::function<bool(QIODevice *)> &writeLog, uint userRole, bool isNeedCheckRequestsEnabled);
     void speedRating(const QString &authHash, const QString &speedRatingHostname, const QString &ip, int rating, uint userRole, bool isNeedCheckRequestsEnabled);
 
     void staticIps(const QString &authHash, const QString &deviceId, uint userRole, bool isNeedCheckRequestsEnabled);
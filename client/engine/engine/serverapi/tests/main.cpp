@@ -0,0 +1,14 @@
+#include <QtTest>
+#include <QCoreApplication>
+
+#include "tst_debuglogbody.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int status = 0;
+
+    status |= QTest::qExec(new TestDebugLogBody(), argc, argv);
+
+    return status;
+}
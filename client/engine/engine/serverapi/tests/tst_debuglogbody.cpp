@@ -0,0 +1,243 @@
+#include "tst_debuglogbody.h"
+#include <QtTest>
+#include <QTcpSocket>
+#include <QStandardPaths>
+#include <QUrlQuery>
+#include <zlib.h>
+#include "serverapi/curlnetworkmanager.h"
+#include "serverapi/debuglogbody.h"
+
+namespace
+{
+const QByteArray ANSWER = "{\"data\":{\"success\":1}}";
+
+QByteArray gunzip(const QByteArray &data)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 15 + 16) != Z_OK)
+        return QByteArray();
+
+    QByteArray result;
+    char buffer[16 * 1024];
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    int ret;
+    do
+    {
+        stream.next_out = reinterpret_cast<Bytef *>(buffer);
+        stream.avail_out = sizeof(buffer);
+        ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END)
+        {
+            result.clear();
+            break;
+        }
+        result.append(buffer, static_cast<int>(sizeof(buffer) - stream.avail_out));
+    } while (ret != Z_STREAM_END);
+    inflateEnd(&stream);
+    return result;
+}
+
+// the log field of the form as the server decodes it
+QByteArray decodeLogField(const QByteArray &form)
+{
+    for (const QByteArray &field : form.split('&'))
+    {
+        if (field.startsWith("logfile="))
+            return QByteArray::fromBase64(QByteArray::fromPercentEncoding(field.mid(8)));
+    }
+    return QByteArray();
+}
+
+QByteArray makeLog(int size)
+{
+    // log-like text with some bytes outside of ASCII, so it doesn't compress too well either
+    QByteArray log;
+    log.reserve(size);
+    for (int i = 0; log.size() < size; ++i)
+    {
+        log += "[" + QByteArray::number(i) + "] [basic]\t some log line \xd0\xbf\xd1\x80\xd0\xb8 ";
+        log += QByteArray::number(qHash(i), 16);
+        log += '\n';
+    }
+    log.truncate(size);
+    return log;
+}
+
+// writes the log in pieces of different sizes, so the base64 groups are split between the writes
+bool writeLog(DebugLogBody *body, const QByteArray &log)
+{
+    int pos = 0;
+    int piece = 1;
+    while (pos < log.size())
+    {
+        const int size = qMin(piece, log.size() - pos);
+        if (body->write(log.constData() + pos, size) != size)
+            return false;
+        pos += size;
+        piece = piece * 3 + 1;
+    }
+    return true;
+}
+}
+
+LocalHttpServer::LocalHttpServer(QObject *parent) : QTcpServer(parent), isContinueSent_(false)
+{
+    connect(this, SIGNAL(newConnection()), SLOT(onNewConnection()));
+}
+
+void LocalHttpServer::onNewConnection()
+{
+    QTcpSocket *socket = nextPendingConnection();
+    data_.clear();
+    headers_.clear();
+    body_.clear();
+    isContinueSent_ = false;
+    connect(socket, SIGNAL(readyRead()), SLOT(onReadyRead()));
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+}
+
+void LocalHttpServer::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    data_ += socket->readAll();
+
+    const int headersEnd = data_.indexOf("\r\n\r\n");
+    if (headersEnd == -1)
+        return;
+    headers_ = data_.left(headersEnd).toLower();
+
+    int contentLength = 0;
+    for (const QByteArray &line : headers_.split('\n'))
+    {
+        if (line.startsWith("content-length:"))
+            contentLength = line.mid(15).trimmed().toInt();
+    }
+    if (!isContinueSent_ && headers_.contains("expect: 100-continue"))
+    {
+        socket->write("HTTP/1.1 100 Continue\r\n\r\n");
+        isContinueSent_ = true;
+    }
+    if (data_.size() - headersEnd - 4 < contentLength)
+        return;
+
+    body_ = data_.mid(headersEnd + 4, contentLength);
+    socket->write("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                  QByteArray::number(ANSWER.size()) + "\r\nConnection: close\r\n\r\n" + ANSWER);
+    socket->disconnectFromHost();
+    emit requestReceived();
+}
+
+TestDebugLogBody::TestDebugLogBody()
+{
+}
+
+TestDebugLogBody::~TestDebugLogBody()
+{
+}
+
+void TestDebugLogBody::upload(bool isCompressed, const QByteArray &log)
+{
+    LocalHttpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QUrlQuery fieldsBefore;
+    fieldsBefore.addQueryItem("time", "1600000000");
+    QUrlQuery fieldsAfter;
+    fieldsAfter.addQueryItem("platform", "test");
+    DebugLogBody body(isCompressed);
+    QVERIFY(body.begin(fieldsBefore, "logfile"));
+    QVERIFY(writeLog(&body, log));
+    QVERIFY(body.finish(fieldsAfter));
+    QCOMPARE(body.logSize(), qint64(log.size()));
+
+    CurlNetworkManager manager;
+    CurlRequest *request = new CurlRequest;
+    if (body.isCompressed())
+        request->addHeader("Content-Encoding: gzip");
+    const qint64 bodySize = body.bodySize();
+    request->setPostDataDevice(body.takeFile(), bodySize);
+    request->setUrl(QString("http://127.0.0.1:%1/Report/applog").arg(server.serverPort()));
+
+    bool isFinished = false;
+    connect(&manager, &CurlNetworkManager::finished, this, [&isFinished](CurlRequest *) {
+        isFinished = true;
+    });
+    QSignalSpy signalReceived(&server, SIGNAL(requestReceived()));
+    manager.post(request, 10000, "Content-type: application/x-www-form-urlencoded", QString(), QStringList());
+    QTRY_VERIFY_WITH_TIMEOUT(isFinished, 20000);
+    QCOMPARE(signalReceived.count(), 1);
+    QCOMPARE(request->getCurlRetCode(), CURLE_OK);
+    QCOMPARE(request->getAnswer(), ANSWER);
+
+    QCOMPARE(qint64(server.body().size()), bodySize);
+    QCOMPARE(server.headers().contains("content-encoding: gzip"), isCompressed);
+    const QByteArray form = isCompressed ? gunzip(server.body()) : server.body();
+    QVERIFY(form.startsWith("time=1600000000&logfile="));
+    QVERIFY(form.endsWith("&platform=test"));
+    QVERIFY(decodeLogField(form) == log);
+    if (isCompressed && log.size() > 1024)
+        QVERIFY(bodySize < form.size());
+    delete request;
+}
+
+void TestDebugLogBody::test_compressed_upload()
+{
+    upload(true, makeLog(5 * 1024 * 1024 + 1));
+    upload(true, makeLog(2));
+    upload(true, QByteArray());
+}
+
+void TestDebugLogBody::test_uncompressed_upload()
+{
+    upload(false, makeLog(1024 * 1024 + 2));
+    upload(false, makeLog(1));
+}
+
+void TestDebugLogBody::test_same_as_form()
+{
+    // the uncompressed body is the form which used to be sent, with the fields in the same order
+    const QByteArray log = makeLog(100000);
+    QUrlQuery fieldsBefore;
+    fieldsBefore.addQueryItem("time", "1600000000");
+    fieldsBefore.addQueryItem("client_auth_hash", "0123456789abcdef");
+    QUrlQuery fieldsAfter;
+    fieldsAfter.addQueryItem("username", "user name&=");
+    fieldsAfter.addQueryItem("platform", "linux");
+
+    DebugLogBody body(false);
+    QVERIFY(body.begin(fieldsBefore, "logfile"));
+    QVERIFY(writeLog(&body, log));
+    QVERIFY(body.finish(fieldsAfter));
+    QScopedPointer<QIODevice> file(body.takeFile());
+    QVERIFY(file);
+
+    QUrlQuery form;
+    form.addQueryItem("time", "1600000000");
+    form.addQueryItem("client_auth_hash", "0123456789abcdef");
+    form.addQueryItem("logfile", log.toBase64());
+    form.addQueryItem("username", "user name&=");
+    form.addQueryItem("platform", "linux");
+    QCOMPARE(file->readAll(), form.toString(QUrl::FullyEncoded).toUtf8());
+}
+
+void TestDebugLogBody::test_sensitive_info()
+{
+    // the home path is cut by the writes of one byte, it is replaced all the same
+    const QByteArray home = QStandardPaths::writableLocation(QStandardPaths::HomeLocation).toUtf8();
+    QVERIFY(!home.isEmpty());
+    const QByteArray log = "[basic] Settings path: " + home + "/.config/app.ini\n[basic] " + home;
+
+    DebugLogBody body(false);
+    QVERIFY(body.begin(QUrlQuery(), "logfile"));
+    for (int i = 0; i < log.size(); ++i)
+        QCOMPARE(body.write(log.constData() + i, 1), qint64(1));
+    QVERIFY(body.finish());
+    QCOMPARE(body.logSize(), qint64(log.size()));
+    QScopedPointer<QIODevice> file(body.takeFile());
+    QVERIFY(file);
+
+    const QByteArray decoded = decodeLogField(file->readAll());
+    QCOMPARE(decoded, QByteArray("[basic] Settings path: %HOMELOCATION%/.config/app.ini\n[basic] %HOMELOCATION%"));
+}
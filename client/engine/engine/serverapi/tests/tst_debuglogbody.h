@@ -0,0 +1,50 @@
+#ifndef TESTDEBUGLOGBODY_H
+#define TESTDEBUGLOGBODY_H
+
+#include <QObject>
+#include <QTcpServer>
+
+// HTTP server on the loopback interface which takes one request at a time and answers it as the API does
+class LocalHttpServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit LocalHttpServer(QObject *parent = nullptr);
+
+    QByteArray headers() const { return headers_; }
+    QByteArray body() const { return body_; }
+
+signals:
+    void requestReceived();
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    QByteArray data_;
+    QByteArray headers_;
+    QByteArray body_;
+    bool isContinueSent_;
+};
+
+class TestDebugLogBody : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestDebugLogBody();
+    ~TestDebugLogBody();
+
+private slots:
+    void test_compressed_upload();
+    void test_uncompressed_upload();
+    void test_same_as_form();
+    void test_sensitive_info();
+
+private:
+    void upload(bool isCompressed, const QByteArray &log);
+};
+
+
+#endif // TESTDEBUGLOGBODY_H
@@ -0,0 +1,158 @@
+#include "enginenotificationmailbox.h"
+#include <QScopedPointer>
+#include <algorithm>
+#include <limits>
+#include "utils/logger.h"
+
+EngineNotificationMailbox::EngineNotificationMailbox(QObject *parent) : QObject(parent),
+    pendingBytesIn_(0), pendingBytesOut_(0), statisticsCoalesced_(0), sequence_(0), connectStatesDropped_(0), isDrainPending_(0)
+{
+}
+
+void EngineNotificationMailbox::connectToEngine(QObject *engine, QObject *connectStateController)
+{
+    connect(engine, SIGNAL(statisticsUpdated(quint64,quint64, bool)), SLOT(onEngineStatisticsUpdated(quint64,quint64, bool)), Qt::DirectConnection);
+    connect(engine, SIGNAL(myIpUpdated(QString,bool,bool)), SLOT(onEngineMyIpUpdated(QString,bool,bool)), Qt::DirectConnection);
+    connect(engine, SIGNAL(firewallStateChanged(bool)), SLOT(onEngineFirewallStateChanged(bool)), Qt::DirectConnection);
+    connect(engine, SIGNAL(networkChanged(ProtoTypes::NetworkInterface)), SLOT(onEngineNetworkChanged(ProtoTypes::NetworkInterface)), Qt::DirectConnection);
+    connect(connectStateController, SIGNAL(stateChanged(CONNECT_STATE, DISCONNECT_REASON, ProtoTypes::ConnectError, LocationID)),
+            SLOT(onEngineConnectStateChanged(CONNECT_STATE, DISCONNECT_REASON, ProtoTypes::ConnectError, LocationID)), Qt::DirectConnection);
+}
+
+void EngineNotificationMailbox::logStatistics() const
+{
+    qCDebug(LOG_IPC) << "Engine notifications dropped as superseded: statistics" << statisticsCoalesced_.loadAcquire() + totalStatistics_.dropped()
+                     << "my ip" << myIp_.dropped() << "firewall" << firewallState_.dropped()
+                     << "network" << network_.dropped() << "connect state" << connectStatesDropped_.loadAcquire();
+}
+
+void EngineNotificationMailbox::onEngineStatisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes)
+{
+    if (isTotalBytes)
+    {
+        totalStatistics_.set(new TotalStatistics{ nextSequence(), bytesIn, bytesOut });
+    }
+    else
+    {
+        // increments are summed up until the next drain, so no bytes are lost when notifications are merged
+        if (pendingBytesIn_.fetchAndAddOrdered(bytesIn) != 0 || pendingBytesOut_.fetchAndAddOrdered(bytesOut) != 0)
+        {
+            statisticsCoalesced_.fetchAndAddRelaxed(1);
+        }
+    }
+    wakeUp();
+}
+
+void EngineNotificationMailbox::onEngineMyIpUpdated(const QString &ip, bool success, bool isDisconnected)
+{
+    myIp_.set(new MyIp{ nextSequence(), ip, success, isDisconnected });
+    wakeUp();
+}
+
+void EngineNotificationMailbox::onEngineFirewallStateChanged(bool isEnabled)
+{
+    firewallState_.set(new FirewallState{ nextSequence(), isEnabled });
+    wakeUp();
+}
+
+void EngineNotificationMailbox::onEngineNetworkChanged(ProtoTypes::NetworkInterface networkInterface)
+{
+    network_.set(new Network{ nextSequence(), networkInterface });
+    wakeUp();
+}
+
+void EngineNotificationMailbox::onEngineConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &location)
+{
+    {
+        QMutexLocker locker(&connectStatesMutex_);
+        // taken under the lock, so the queue stays in the order of the sequence
+        const ConnectState connectState{ nextSequence(), state, reason, err, location };
+        // a pending progress state is superseded by the next state, the others are kept
+        if (!connectStates_.isEmpty() && connectStates_.last().isReplaceable())
+        {
+            connectStates_.last() = connectState;
+            connectStatesDropped_.fetchAndAddRelaxed(1);
+        }
+        else
+        {
+            connectStates_ << connectState;
+        }
+    }
+    wakeUp();
+}
+
+void EngineNotificationMailbox::drain()
+{
+    // cleared before taking the values, so a value written from now on posts a new drain
+    isDrainPending_.storeRelease(0);
+
+    // the values first: a connect state written before one of them is in the queue taken after
+    QScopedPointer<FirewallState> firewallState(firewallState_.take());
+    QScopedPointer<Network> network(network_.take());
+    QScopedPointer<MyIp> myIp(myIp_.take());
+    QScopedPointer<TotalStatistics> totalStatistics(totalStatistics_.take());
+    QVector<ConnectState> connectStates;
+    {
+        QMutexLocker locker(&connectStatesMutex_);
+        connectStates.swap(connectStates_);
+    }
+
+    // the latest values of the topics are emitted among the connect states in the order they were written
+    const quint64 NONE = std::numeric_limits<quint64>::max();
+    int connectStateIndex = 0;
+    while (true)
+    {
+        const quint64 connectStateSequence = connectStateIndex < connectStates.count() ? connectStates[connectStateIndex].sequence : NONE;
+        const quint64 firewallSequence = firewallState ? firewallState->sequence : NONE;
+        const quint64 networkSequence = network ? network->sequence : NONE;
+        const quint64 myIpSequence = myIp ? myIp->sequence : NONE;
+        const quint64 totalStatisticsSequence = totalStatistics ? totalStatistics->sequence : NONE;
+        const quint64 first = std::min({ connectStateSequence, firewallSequence, networkSequence, myIpSequence, totalStatisticsSequence });
+        if (first == NONE)
+        {
+            break;
+        }
+
+        if (first == connectStateSequence)
+        {
+            const ConnectState &cs = connectStates[connectStateIndex++];
+            Q_EMIT connectStateChanged(cs.state, cs.reason, cs.err, cs.location);
+        }
+        else if (first == firewallSequence)
+        {
+            Q_EMIT firewallStateChanged(firewallState->isEnabled);
+            firewallState.reset();
+        }
+        else if (first == networkSequence)
+        {
+            Q_EMIT networkChanged(network->networkInterface);
+            network.reset();
+        }
+        else if (first == myIpSequence)
+        {
+            Q_EMIT myIpUpdated(myIp->ip, myIp->success, myIp->isDisconnected);
+            myIp.reset();
+        }
+        else
+        {
+            Q_EMIT statisticsUpdated(totalStatistics->bytesIn, totalStatistics->bytesOut, true);
+            totalStatistics.reset();
+        }
+    }
+
+    const quint64 bytesIn = pendingBytesIn_.fetchAndStoreOrdered(0);
+    const quint64 bytesOut = pendingBytesOut_.fetchAndStoreOrdered(0);
+    if (bytesIn != 0 || bytesOut != 0)
+    {
+        Q_EMIT statisticsUpdated(bytesIn, bytesOut, false);
+    }
+}
+
+void EngineNotificationMailbox::wakeUp()
+{
+    // only one drain is posted to the event loop, no matter how many values are written before it runs
+    if (isDrainPending_.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+    }
+}
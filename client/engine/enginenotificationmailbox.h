@@ -0,0 +1,139 @@
+#ifndef ENGINENOTIFICATIONMAILBOX_H
+#define ENGINENOTIFICATIONMAILBOX_H
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include "engine/types/types.h"
+#include "types/locationid.h"
+
+// Latest value of a state topic. The writer replaces the value without locking; a value which was not
+// taken by the reader before the next write is dropped and counted.
+template <typename T>
+class LatestValue
+{
+public:
+    LatestValue() : value_(nullptr), dropped_(0) {}
+    ~LatestValue() { delete value_.loadAcquire(); }
+
+    void set(T *value)
+    {
+        T *prev = value_.fetchAndStoreOrdered(value);
+        if (prev)
+        {
+            dropped_.fetchAndAddRelaxed(1);
+            delete prev;
+        }
+    }
+
+    // the caller owns the returned value, nullptr if there is nothing new
+    T *take()
+    {
+        return value_.fetchAndStoreOrdered(nullptr);
+    }
+
+    int dropped() const { return dropped_.loadAcquire(); }
+
+private:
+    QAtomicPointer<T> value_;
+    QAtomicInt dropped_;
+};
+
+// Coalesces the high-frequency state notifications of the engine before they reach the GUI thread.
+// The engine signals are connected directly, so the onEngine...() slots run in the engine thread; the
+// values are delivered by the signals of this object in its own thread, once per event loop turn,
+// and only the latest value of each topic is delivered. Traffic increments are summed, not replaced.
+// Connect state changes stay ordered: a pending CONNECTING or DISCONNECTING is replaced by the next state,
+// but CONNECTED, DISCONNECTED and a state carrying an error are never dropped.
+// The values delivered by a drain are emitted in the order they were written; the summed traffic increments
+// have no place in that order and come last.
+class EngineNotificationMailbox : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EngineNotificationMailbox(QObject *parent = nullptr);
+
+    void connectToEngine(QObject *engine, QObject *connectStateController);
+    void logStatistics() const;
+
+public slots:
+    // called in the engine thread
+    void onEngineStatisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes);
+    void onEngineMyIpUpdated(const QString &ip, bool success, bool isDisconnected);
+    void onEngineFirewallStateChanged(bool isEnabled);
+    void onEngineNetworkChanged(ProtoTypes::NetworkInterface networkInterface);
+    void onEngineConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &location);
+
+signals:
+    void statisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes);
+    void myIpUpdated(const QString &ip, bool success, bool isDisconnected);
+    void firewallStateChanged(bool isEnabled);
+    void networkChanged(ProtoTypes::NetworkInterface networkInterface);
+    void connectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &location);
+
+private slots:
+    void drain();
+
+private:
+    // the sequence numbers order the values of all the topics as they were written
+    struct TotalStatistics
+    {
+        quint64 sequence;
+        quint64 bytesIn;
+        quint64 bytesOut;
+    };
+    struct MyIp
+    {
+        quint64 sequence;
+        QString ip;
+        bool success;
+        bool isDisconnected;
+    };
+    struct FirewallState
+    {
+        quint64 sequence;
+        bool isEnabled;
+    };
+    struct Network
+    {
+        quint64 sequence;
+        ProtoTypes::NetworkInterface networkInterface;
+    };
+    struct ConnectState
+    {
+        quint64 sequence;
+        CONNECT_STATE state;
+        DISCONNECT_REASON reason;
+        ProtoTypes::ConnectError err;
+        LocationID location;
+
+        // only a progress state may be superseded before the GUI sees it
+        bool isReplaceable() const
+        {
+            return (state == CONNECT_STATE_CONNECTING || state == CONNECT_STATE_DISCONNECTING) &&
+                   err == ProtoTypes::NO_CONNECT_ERROR;
+        }
+    };
+
+    QAtomicInteger<quint64> pendingBytesIn_;
+    QAtomicInteger<quint64> pendingBytesOut_;
+    QAtomicInt statisticsCoalesced_;
+    LatestValue<TotalStatistics> totalStatistics_;
+    LatestValue<MyIp> myIp_;
+    LatestValue<FirewallState> firewallState_;
+    LatestValue<Network> network_;
+    QAtomicInteger<quint64> sequence_;
+
+    QMutex connectStatesMutex_;
+    QVector<ConnectState> connectStates_;
+    QAtomicInt connectStatesDropped_;
+
+    QAtomicInt isDrainPending_;
+
+    quint64 nextSequence() { return sequence_.fetchAndAddOrdered(1); }
+    void wakeUp();
+};
+
+#endif // ENGINENOTIFICATIONMAILBOX_H
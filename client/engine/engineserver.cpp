@@ -3,8 +3,10 @@
 #include "utils/logger.h"
 #include "ipc/server.h"
 #include "ipc/protobufcommand.h"
+#include "ipc/commandlog.h"
 #include "engine/openvpnversioncontroller.h"
 #include <QDateTime>
+#include <QScopedPointer>
 
 #ifdef Q_OS_WIN
     #include "engine/taputils/tapinstall_win.h"
@@ -15,13 +17,35 @@ EngineServer::EngineServer(QObject *parent) : QObject(parent)
   , engine_(NULL)
   , threadEngine_(NULL)
   , bClientAuthReceived_(false)
+  , isDaemon_(false)
+  , lastTotalBytesIn_(0)
+  , lastTotalBytesOut_(0)
 {
     curEngineSettings_.loadFromSettings();
+    trafficStatistics_.loadFromSettings();
+
+    trafficStatisticsTimer_.setInterval(1000);
+    connect(&trafficStatisticsTimer_, SIGNAL(timeout()), SLOT(onTrafficStatisticsTimer()));
+
+    notificationMailbox_ = new EngineNotificationMailbox(this);
+    connect(notificationMailbox_, SIGNAL(firewallStateChanged(bool)), SLOT(onEngineFirewallStateChanged(bool)));
+    connect(notificationMailbox_, SIGNAL(myIpUpdated(QString,bool,bool)), SLOT(onEngineMyIpUpdated(QString,bool,bool)));
+    connect(notificationMailbox_, SIGNAL(connectStateChanged(CONNECT_STATE, DISCONNECT_REASON, ProtoTypes::ConnectError, LocationID)),
+            SLOT(onEngineConnectStateChanged(CONNECT_STATE, DISCONNECT_REASON, ProtoTypes::ConnectError, LocationID)));
+    connect(notificationMailbox_, SIGNAL(statisticsUpdated(quint64,quint64, bool)), SLOT(onEngineStatisticsUpdated(quint64,quint64, bool)));
+    connect(notificationMailbox_, SIGNAL(networkChanged(ProtoTypes::NetworkInterface)), SLOT(onEngineNetworkChanged(ProtoTypes::NetworkInterface)));
 }
 
 EngineServer::~EngineServer()
 {
+    // a QThread must not be destroyed while it runs, the engine normally stops it on cleanup
+    if (threadEngine_ != NULL && threadEngine_->isRunning())
+    {
+        threadEngine_->quit();
+        threadEngine_->wait();
+    }
     curEngineSettings_.saveToSettings();
+    trafficStatistics_.saveToSettings();
 
     const auto connectionKeys = connections_.keys();
     for (auto connection : connectionKeys)
@@ -34,7 +58,7 @@ EngineServer::~EngineServer()
     qCDebug(LOG_IPC) << "IPC server stopped";
 }
 
-void EngineServer::run()
+bool EngineServer::run()
 {
     Q_ASSERT(server_ == NULL);
     server_ = new IPC::Server();
@@ -44,13 +68,94 @@ void EngineServer::run()
     {
         qCDebug(LOG_IPC) << "Can't start IPC server, exit";
         Q_EMIT finished();
+        return false;
+    }
+    qCDebug(LOG_IPC) << "IPC server started";
+    return true;
+}
+
+void EngineServer::startDaemon()
+{
+    qCDebug(LOG_IPC) << "Starting engine in headless daemon mode";
+    isDaemon_ = true;
+    // the daemon can only be controlled through the server, it exits without it
+    if (run())
+    {
+        buildEngine();
+    }
+}
+
+void EngineServer::stopDaemon()
+{
+    qCDebug(LOG_IPC) << "Stopping headless daemon";
+    if (engine_ == NULL)
+    {
+        Q_EMIT finished();
     }
     else
     {
-        qCDebug(LOG_IPC) << "IPC server started";
+        const bool isFirewallAlwaysOn = curEngineSettings_.firewallSettings().mode() == ProtoTypes::FIREWALL_MODE_ALWAYS_ON;
+        engine_->cleanup(false, engine_->isFirewallEnabled(), isFirewallAlwaysOn, false);
     }
 }
 
+void EngineServer::requestLocationsSnapshot()
+{
+    const locationsmodel::LocationsDelta delta = locationsDeltaBuilder_.fullSnapshot();
+    qCDebug(LOG_IPC) << "[LocationsUpdated] full snapshot requested, version:" << delta.version;
+    Q_EMIT locationsUpdated(delta);
+}
+
+void EngineServer::buildEngine()
+{
+    qCDebug(LOG_IPC) << "Building engine";
+    locationsDeltaBuilder_.reset();
+    threadEngine_ = new QThread(this);
+    engine_ = new Engine(curEngineSettings_);
+    engine_->moveToThread(threadEngine_);
+    connect(threadEngine_, SIGNAL(started()), engine_, SLOT(init()));
+    connect(engine_, SIGNAL(cleanupFinished()), threadEngine_, SLOT(quit()));
+    connect(threadEngine_, SIGNAL(finished()), SLOT(onEngineCleanupFinished()));
+
+    connect(engine_, SIGNAL(initFinished(ENGINE_INIT_RET_CODE)), SLOT(onEngineInitFinished(ENGINE_INIT_RET_CODE)));
+    connect(engine_, SIGNAL(bfeEnableFinished(ENGINE_INIT_RET_CODE)), SLOT(onEngineBfeEnableFinished(ENGINE_INIT_RET_CODE)));
+    connect(engine_, SIGNAL(loginFinished(bool, QString, apiinfo::PortMap)), SLOT(onEngineLoginFinished(bool, QString, apiinfo::PortMap)));
+    connect(engine_, SIGNAL(loginError(LOGIN_RET)), SLOT(onEngineLoginError(LOGIN_RET)));
+    connect(engine_, SIGNAL(loginStepMessage(LOGIN_MESSAGE)), SLOT(onEngineLoginMessage(LOGIN_MESSAGE)));
+    connect(engine_, SIGNAL(notificationsUpdated(QVector<apiinfo::Notification>)), SLOT(onEngineNotificationsUpdated(QVector<apiinfo::Notification>)));
+    connect(engine_, SIGNAL(checkUpdateUpdated(apiinfo::CheckUpdate)), SLOT(onEngineCheckUpdateUpdated(apiinfo::CheckUpdate)));
+    connect(engine_, SIGNAL(updateVersionChanged(uint, ProtoTypes::UpdateVersionState, ProtoTypes::UpdateVersionError)), SLOT(onEngineUpdateVersionChanged(uint, ProtoTypes::UpdateVersionState, ProtoTypes::UpdateVersionError)));
+    connect(engine_, SIGNAL(sessionStatusUpdated(apiinfo::SessionStatus)), SLOT(onEngineUpdateSessionStatus(apiinfo::SessionStatus)));
+    connect(engine_, SIGNAL(sessionDeleted()), SLOT(onEngineSessionDeleted()));
+    connect(engine_, SIGNAL(protocolPortChanged(ProtoTypes::Protocol, uint)), SLOT(onEngineProtocolPortChanged(ProtoTypes::Protocol, uint)));
+    connect(engine_, SIGNAL(emergencyConnected()), SLOT(onEngineEmergencyConnected()));
+    connect(engine_, SIGNAL(emergencyDisconnected()), SLOT(onEngineEmergencyDisconnected()));
+    connect(engine_, SIGNAL(emergencyConnectError(ProtoTypes::ConnectError)), SLOT(onEngineEmergencyConnectError(ProtoTypes::ConnectError)));
+    connect(engine_, SIGNAL(testTunnelResult(bool)), SLOT(onEngineTestTunnelResult(bool)));
+    connect(engine_, SIGNAL(lostConnectionToHelper()), SLOT(onEngineLostConnectionToHelper()));
+    connect(engine_, SIGNAL(proxySharingStateChanged(bool, PROXY_SHARING_TYPE)), SLOT(onEngineProxySharingStateChanged(bool, PROXY_SHARING_TYPE)));
+    connect(engine_, SIGNAL(wifiSharingStateChanged(bool, QString)), SLOT(onEngineWifiSharingStateChanged(bool, QString)));
+    connect(engine_, SIGNAL(vpnSharingConnectedWifiUsersCountChanged(int)), SLOT(onEngineConnectedWifiUsersCountChanged(int)));
+    connect(engine_, SIGNAL(vpnSharingConnectedProxyUsersCountChanged(int)), SLOT(onEngineConnectedProxyUsersCountChanged(int)));
+    connect(engine_, SIGNAL(signOutFinished()), SLOT(onEngineSignOutFinished()));
+    connect(engine_, SIGNAL(gotoCustomOvpnConfigModeFinished()), SLOT(onEngineGotoCustomOvpnConfigModeFinished()));
+    connect(engine_, SIGNAL(detectionCpuUsageAfterConnected(QStringList)), SLOT(onEngineDetectionCpuUsageAfterConnected(QStringList)));
+    connect(engine_, SIGNAL(requestUsername()), SLOT(onEngineRequestUsername()));
+    connect(engine_, SIGNAL(requestPassword()), SLOT(onEngineRequestPassword()));
+    connect(engine_, SIGNAL(confirmEmailFinished(bool)), SLOT(onEngineConfirmEmailFinished(bool)));
+    connect(engine_, SIGNAL(sendDebugLogFinished(bool)), SLOT(onEngineSendDebugLogFinished(bool)));
+    connect(engine_, SIGNAL(webSessionToken(ProtoTypes::WebSessionPurpose, QString)), SLOT(onEngineWebSessionToken(ProtoTypes::WebSessionPurpose, QString)));
+    connect(engine_, SIGNAL(macAddrSpoofingChanged(ProtoTypes::MacAddrSpoofing)), SLOT(onMacAddrSpoofingChanged(ProtoTypes::MacAddrSpoofing)));
+    connect(engine_, SIGNAL(sendUserWarning(ProtoTypes::UserWarningType)), SLOT(onEngineSendUserWarning(ProtoTypes::UserWarningType)));
+    connect(engine_, SIGNAL(internetConnectivityChanged(bool)), SLOT(onEngineInternetConnectivityChanged(bool)));
+    connect(engine_, SIGNAL(packetSizeChanged(bool, int)), SLOT(onEnginePacketSizeChanged(bool, int)));
+    connect(engine_, SIGNAL(packetSizeDetectionStateChanged(bool,bool)), SLOT(onEnginePacketSizeDetectionStateChanged(bool,bool)));
+    connect(engine_, SIGNAL(hostsFileBecameWritable()), SLOT(onHostsFileBecameWritable()));
+    // state notifications are coalesced, so only the latest values cross to this thread
+    notificationMailbox_->connectToEngine(engine_, engine_->getConnectStateController());
+    threadEngine_->start(QThread::LowPriority);
+}
+
 bool EngineServer::handleCommand(IPC::Command *command)
 {
     if (command->getStringId() == IPCClientCommands::Init::descriptor()->full_name())
@@ -62,55 +167,7 @@ bool EngineServer::handleCommand(IPC::Command *command)
 
         if (engine_ == NULL && threadEngine_ == NULL)
         {
-            qCDebug(LOG_IPC) << "Building engine";
-            threadEngine_ = new QThread(this);
-            engine_ = new Engine(curEngineSettings_);
-            engine_->moveToThread(threadEngine_);
-            connect(threadEngine_, SIGNAL(started()), engine_, SLOT(init()));
-            connect(engine_, SIGNAL(cleanupFinished()), threadEngine_, SLOT(quit()));
-            connect(threadEngine_, SIGNAL(finished()), SLOT(onEngineCleanupFinished()));
-
-            connect(engine_, SIGNAL(initFinished(ENGINE_INIT_RET_CODE)), SLOT(onEngineInitFinished(ENGINE_INIT_RET_CODE)));
-            connect(engine_, SIGNAL(bfeEnableFinished(ENGINE_INIT_RET_CODE)), SLOT(onEngineBfeEnableFinished(ENGINE_INIT_RET_CODE)));
-            connect(engine_, SIGNAL(firewallStateChanged(bool)), SLOT(onEngineFirewallStateChanged(bool)));
-            connect(engine_, SIGNAL(loginFinished(bool, QString, apiinfo::PortMap)), SLOT(onEngineLoginFinished(bool, QString, apiinfo::PortMap)));
-            connect(engine_, SIGNAL(loginError(LOGIN_RET)), SLOT(onEngineLoginError(LOGIN_RET)));
-            connect(engine_, SIGNAL(loginStepMessage(LOGIN_MESSAGE)), SLOT(onEngineLoginMessage(LOGIN_MESSAGE)));
-            connect(engine_, SIGNAL(notificationsUpdated(QVector<apiinfo::Notification>)), SLOT(onEngineNotificationsUpdated(QVector<apiinfo::Notification>)));
-            connect(engine_, SIGNAL(checkUpdateUpdated(apiinfo::CheckUpdate)), SLOT(onEngineCheckUpdateUpdated(apiinfo::CheckUpdate)));
-            connect(engine_, SIGNAL(updateVersionChanged(uint, ProtoTypes::UpdateVersionState, ProtoTypes::UpdateVersionError)), SLOT(onEngineUpdateVersionChanged(uint, ProtoTypes::UpdateVersionState, ProtoTypes::UpdateVersionError)));
-            connect(engine_, SIGNAL(myIpUpdated(QString,bool,bool)), SLOT(onEngineMyIpUpdated(QString,bool,bool)));
-            connect(engine_, SIGNAL(sessionStatusUpdated(apiinfo::SessionStatus)), SLOT(onEngineUpdateSessionStatus(apiinfo::SessionStatus)));
-            connect(engine_, SIGNAL(sessionDeleted()), SLOT(onEngineSessionDeleted()));
-            connect(engine_->getConnectStateController(), SIGNAL(stateChanged(CONNECT_STATE, DISCONNECT_REASON, ProtoTypes::ConnectError, LocationID)),
-                    SLOT(onEngineConnectStateChanged(CONNECT_STATE, DISCONNECT_REASON, ProtoTypes::ConnectError, LocationID)));
-            connect(engine_, SIGNAL(protocolPortChanged(ProtoTypes::Protocol, uint)), SLOT(onEngineProtocolPortChanged(ProtoTypes::Protocol, uint)));
-            connect(engine_, SIGNAL(statisticsUpdated(quint64,quint64, bool)), SLOT(onEngineStatisticsUpdated(quint64,quint64, bool)));
-            connect(engine_, SIGNAL(emergencyConnected()), SLOT(onEngineEmergencyConnected()));
-            connect(engine_, SIGNAL(emergencyDisconnected()), SLOT(onEngineEmergencyDisconnected()));
-            connect(engine_, SIGNAL(emergencyConnectError(ProtoTypes::ConnectError)), SLOT(onEngineEmergencyConnectError(ProtoTypes::ConnectError)));
-            connect(engine_, SIGNAL(testTunnelResult(bool)), SLOT(onEngineTestTunnelResult(bool)));
-            connect(engine_, SIGNAL(lostConnectionToHelper()), SLOT(onEngineLostConnectionToHelper()));
-            connect(engine_, SIGNAL(proxySharingStateChanged(bool, PROXY_SHARING_TYPE)), SLOT(onEngineProxySharingStateChanged(bool, PROXY_SHARING_TYPE)));
-            connect(engine_, SIGNAL(wifiSharingStateChanged(bool, QString)), SLOT(onEngineWifiSharingStateChanged(bool, QString)));
-            connect(engine_, SIGNAL(vpnSharingConnectedWifiUsersCountChanged(int)), SLOT(onEngineConnectedWifiUsersCountChanged(int)));
-            connect(engine_, SIGNAL(vpnSharingConnectedProxyUsersCountChanged(int)), SLOT(onEngineConnectedProxyUsersCountChanged(int)));
-            connect(engine_, SIGNAL(signOutFinished()), SLOT(onEngineSignOutFinished()));
-            connect(engine_, SIGNAL(gotoCustomOvpnConfigModeFinished()), SLOT(onEngineGotoCustomOvpnConfigModeFinished()));
-            connect(engine_, SIGNAL(detectionCpuUsageAfterConnected(QStringList)), SLOT(onEngineDetectionCpuUsageAfterConnected(QStringList)));
-            connect(engine_, SIGNAL(requestUsername()), SLOT(onEngineRequestUsername()));
-            connect(engine_, SIGNAL(requestPassword()), SLOT(onEngineRequestPassword()));
-            connect(engine_, SIGNAL(networkChanged(ProtoTypes::NetworkInterface)), SLOT(onEngineNetworkChanged(ProtoTypes::NetworkInterface)));
-            connect(engine_, SIGNAL(confirmEmailFinished(bool)), SLOT(onEngineConfirmEmailFinished(bool)));
-            connect(engine_, SIGNAL(sendDebugLogFinished(bool)), SLOT(onEngineSendDebugLogFinished(bool)));
-            connect(engine_, SIGNAL(webSessionToken(ProtoTypes::WebSessionPurpose, QString)), SLOT(onEngineWebSessionToken(ProtoTypes::WebSessionPurpose, QString)));
-            connect(engine_, SIGNAL(macAddrSpoofingChanged(ProtoTypes::MacAddrSpoofing)), SLOT(onMacAddrSpoofingChanged(ProtoTypes::MacAddrSpoofing)));
-            connect(engine_, SIGNAL(sendUserWarning(ProtoTypes::UserWarningType)), SLOT(onEngineSendUserWarning(ProtoTypes::UserWarningType)));
-            connect(engine_, SIGNAL(internetConnectivityChanged(bool)), SLOT(onEngineInternetConnectivityChanged(bool)));
-            connect(engine_, SIGNAL(packetSizeChanged(bool, int)), SLOT(onEnginePacketSizeChanged(bool, int)));
-            connect(engine_, SIGNAL(packetSizeDetectionStateChanged(bool,bool)), SLOT(onEnginePacketSizeDetectionStateChanged(bool,bool)));
-            connect(engine_, SIGNAL(hostsFileBecameWritable()), SLOT(onHostsFileBecameWritable()));
-            threadEngine_->start(QThread::LowPriority);
+            buildEngine();
         }
         else
         {
@@ -128,7 +185,9 @@ bool EngineServer::handleCommand(IPC::Command *command)
             cmd.getProtoObj().set_is_saved_api_settings_exists(engine_->isApiSavedSettingsExists());
             cmd.getProtoObj().set_auth_hash(engine_->getAuthHash().toStdString());
 
-            ///sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, true, ProtoTypes::CLIENT_ID_CLI);
+            // the engine is shared, so only the newly attached out-of-process clients need the reply
+            IPC::logCommand(cmd);
+            sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, ProtoTypes::CLIENT_ID_CLI);
         }
 
         return true;
@@ -174,7 +233,7 @@ bool EngineServer::handleCommand(IPC::Command *command)
         // hide password for logging
         IPC::ProtobufCommand<IPCClientCommands::Login> loggedCmd = *loginCmd;
         loggedCmd.getProtoObj().set_password("*****");
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(loggedCmd.getDebugString());
+        IPC::logCommand(loggedCmd);
 
         // login with last login settings
         if (loginCmd->getProtoObj().use_last_login_settings() == true)
@@ -364,7 +423,7 @@ bool EngineServer::handleCommand(IPC::Command *command)
         IPC::ProtobufCommand<IPCClientCommands::SetBlockConnect> *blockConnectCmd = static_cast<IPC::ProtobufCommand<IPCClientCommands::SetBlockConnect> *>(command);
         if (engine_->isBlockConnect() != blockConnectCmd->getProtoObj().is_block_connect())
         {
-            qCDebugMultiline(LOG_IPC) << QString::fromStdString(command->getDebugString());
+            IPC::logCommand(*command);
             engine_->setBlockConnect(blockConnectCmd->getProtoObj().is_block_connect());
         }
         return true;
@@ -467,6 +526,23 @@ void EngineServer::sendEngineInitReturnCode(ENGINE_INIT_RET_CODE retCode)
         sendCmdToAllAuthorizedAndGetStateClients(&cmd, true);
 
         engine_->updateCurrentInternetConnectivity();
+
+        // there is no GUI to drive the login in the daemon, so restore the last session ourselves
+        if (isDaemon_)
+        {
+            if (engine_->isApiSavedSettingsExists())
+            {
+                engine_->loginWithLastLoginSettings();
+            }
+            else if (!engine_->getAuthHash().isEmpty())
+            {
+                engine_->loginWithAuthHash(engine_->getAuthHash());
+            }
+            else
+            {
+                qCDebug(LOG_IPC) << "No saved session, login from the GUI first to use the daemon";
+            }
+        }
     }
     else if (retCode == ENGINE_INIT_HELPER_FAILED)
     {
@@ -499,16 +575,72 @@ void EngineServer::onServerCallbackAcceptFunction(IPC::IConnection *connection)
     connect(dynamic_cast<QObject*>(connection), SIGNAL(stateChanged(int, IPC::IConnection *)), SLOT(onConnectionStateCallback(int, IPC::IConnection *)), Qt::QueuedConnection);
 }
 
-void EngineServer::sendCommand(IPC::Command *command)
+void EngineServer::onConnectionCommandCallback(IPC::Command *command, IPC::IConnection *connection)
+{
+    QScopedPointer<IPC::Command> commandHolder(command);
+
+    auto it = connections_.find(connection);
+    if (it == connections_.end())
+    {
+        return;
+    }
+
+    if (!it->bClientAuthReceived_)
+    {
+        // wait for command ClientAuth for authorization of client
+        if (command->getStringId() == IPCClientCommands::ClientAuth::descriptor()->full_name())
+        {
+            IPC::ProtobufCommand<IPCClientCommands::ClientAuth> *cmdClientAuth = static_cast<IPC::ProtobufCommand<IPCClientCommands::ClientAuth> *>(command);
+            IPC::logCommand(*command);
+
+            it->bClientAuthReceived_ = true;
+            it->protocolVersion_ = cmdClientAuth->getProtoObj().protocol_version();
+            it->clientId_ = cmdClientAuth->getProtoObj().client_id();
+            it->pid_ = cmdClientAuth->getProtoObj().pid();
+            it->name_ = QString::fromStdString(cmdClientAuth->getProtoObj().name());
+            it->latestCommandTimeMs_ = QDateTime::currentMSecsSinceEpoch();
+
+            IPC::ProtobufCommand<IPCServerCommands::AuthReply> cmdReply;
+            connection->sendCommand(cmdReply);
+        }
+        return;
+    }
+
+    it->latestCommandTimeMs_ = QDateTime::currentMSecsSinceEpoch();
+
+    if (command->getStringId() == IPCClientCommands::SubscribeTrafficStatistics::descriptor()->full_name())
+    {
+        // the subscription belongs to the connection, so it is handled here rather than in handleCommand()
+        IPC::logCommand(*command);
+        IPC::ProtobufCommand<IPCClientCommands::SubscribeTrafficStatistics> *cmd = static_cast<IPC::ProtobufCommand<IPCClientCommands::SubscribeTrafficStatistics> *>(command);
+        setTrafficSubscription(connection, cmd->getProtoObj().interval_ms());
+    }
+    // ClientPing is sent by every client every few seconds and only keeps the connection alive
+    else if (command->getStringId() != IPCClientCommands::ClientPing::descriptor()->full_name())
+    {
+        logReceivedCommand(*command);
+        handleCommand(command);
+    }
+}
+
+void EngineServer::logReceivedCommand(const IPC::Command &command)
 {
-    if ((command->getStringId() != IPCClientCommands::Login::descriptor()->full_name()) &&
-        (command->getStringId() != IPCClientCommands::SetBlockConnect::descriptor()->full_name()))
+    if ((command.getStringId() != IPCClientCommands::Login::descriptor()->full_name()) &&
+        (command.getStringId() != IPCClientCommands::SetBlockConnect::descriptor()->full_name()) &&
+        (command.getStringId() != IPCClientCommands::ApplicationActivated::descriptor()->full_name()) &&
+        (command.getStringId() != IPCClientCommands::GetIpv6StateInOS::descriptor()->full_name()))
     {
         // The SetBlockConnect command is received every minute.  handleCommand will log it if the value
         // has changed, so that we don't flood the log with this entry when the app is up for an
-        // extended period of time.
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(command->getDebugString());
+        // extended period of time.  ApplicationActivated and GetIpv6StateInOS are sent on every
+        // window focus change and are not logged either.
+        IPC::logCommand(command);
     }
+}
+
+void EngineServer::sendCommand(IPC::Command *command)
+{
+    logReceivedCommand(*command);
 
 
     // check if the client is made authorization
@@ -537,14 +669,15 @@ void EngineServer::onConnectionStateCallback(int state, IPC::IConnection *connec
         qCDebug(LOG_IPC) << "Client disconnected:" << connection;
 
         int removed = connections_.remove(connection);
+        setTrafficSubscription(connection, 0);
         if (removed > 0)
         {
             dynamic_cast<QObject*>(connection)->disconnect();
             SAFE_DELETE(connection);
         }
 
-        // close engine, if all of the clients are disconnected
-        if (connections_.isEmpty())
+        // close engine, if all of the clients are disconnected; the daemon keeps running without clients
+        if (connections_.isEmpty() && !isDaemon_)
         {
             qCDebug(LOG_IPC) << "All of the clients are disconnected";
             Q_EMIT finished();
@@ -558,8 +691,15 @@ void EngineServer::onConnectionStateCallback(int state, IPC::IConnection *connec
 
 void EngineServer::onEngineCleanupFinished()
 {
+    notificationMailbox_->logStatistics();
+
     IPC::ProtobufCommand<IPCServerCommands::CleanupFinished> cmd;
     sendCmdToAllAuthorizedAndGetStateClients(&cmd, true);
+
+    if (isDaemon_)
+    {
+        Q_EMIT finished();
+    }
 }
 
 void EngineServer::onEngineInitFinished(ENGINE_INIT_RET_CODE retCode)
@@ -583,9 +723,15 @@ void EngineServer::onEngineBfeEnableFinished(ENGINE_INIT_RET_CODE retCode)
 
 void EngineServer::sendFirewallStateChanged(bool isEnabled)
 {
-    IPC::ProtobufCommand<IPCServerCommands::FirewallStateChanged> cmd;
-    cmd.getProtoObj().set_is_firewall_enabled(isEnabled);
-    sendCmdToAllAuthorizedAndGetStateClients(&cmd, true);
+    qCDebug(LOG_IPC) << "[FirewallStateChanged] is_firewall_enabled:" << isEnabled;
+    Q_EMIT firewallStateChanged(isEnabled);
+
+    if (hasAuthorizedClientsOfType(ProtoTypes::CLIENT_ID_CLI))
+    {
+        IPC::ProtobufCommand<IPCServerCommands::FirewallStateChanged> cmd;
+        cmd.getProtoObj().set_is_firewall_enabled(isEnabled);
+        sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, ProtoTypes::CLIENT_ID_CLI);
+    }
 }
 
 void EngineServer::onEngineFirewallStateChanged(bool isEnabled)
@@ -598,7 +744,6 @@ void EngineServer::onEngineLoginFinished(bool isLoginFromSavedSettings, const QS
     IPC::ProtobufCommand<IPCServerCommands::LoginFinished> cmd;
     cmd.getProtoObj().set_is_login_from_saved_settings(isLoginFromSavedSettings);
     cmd.getProtoObj().set_auth_hash(authHash.toStdString());
-    qCDebugMultiline(LOG_IPC) << "Engine Settings Changed -- Updating client: " << QString::fromStdString(cmd.getDebugString());
 
     ProtoTypes::ArrayPortMap arrPortMap;
     for (int i = 0; i < portMap.getPortItemCount(); ++i)
@@ -696,39 +841,39 @@ void EngineServer::onEngineMyIpUpdated(const QString &ip, bool /*success*/, bool
     {
         int index = ip.lastIndexOf('.');
         QString censoredIp = ip.mid(0,index+1) + "###"; // censor last octet
-        IPC::ProtobufCommand<IPCServerCommands::MyIpUpdated> cmdLoggingOnly;
-        cmdLoggingOnly.getProtoObj().mutable_my_ip_info()->set_ip(censoredIp.toStdString());
-        cmdLoggingOnly.getProtoObj().mutable_my_ip_info()->set_is_disconnected_state(isDisconnected);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmdLoggingOnly.getDebugString());
+        qCDebug(LOG_IPC) << "[MyIpUpdated] ip:" << censoredIp << "is_disconnected_state:" << isDisconnected;
     }
 
-    IPC::ProtobufCommand<IPCServerCommands::MyIpUpdated> cmd;
-    cmd.getProtoObj().mutable_my_ip_info()->set_ip(ip.toStdString());
-    cmd.getProtoObj().mutable_my_ip_info()->set_is_disconnected_state(isDisconnected);
+    Q_EMIT myIpUpdated(ip, isDisconnected);
 
-    sendCmdToAllAuthorizedAndGetStateClients(&cmd, false); // only non-user IP
+    if (hasAuthorizedClientsOfType(ProtoTypes::CLIENT_ID_CLI))
+    {
+        IPC::ProtobufCommand<IPCServerCommands::MyIpUpdated> cmd;
+        cmd.getProtoObj().mutable_my_ip_info()->set_ip(ip.toStdString());
+        cmd.getProtoObj().mutable_my_ip_info()->set_is_disconnected_state(isDisconnected);
+        sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, ProtoTypes::CLIENT_ID_CLI);
+    }
 }
 
 void EngineServer::sendConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &locationId)
 {
-    IPC::ProtobufCommand<IPCServerCommands::ConnectStateChanged> cmd;
+    ProtoTypes::ConnectState connectState;
 
-    //ProtoTypes::ConnectState c;
     if (state == CONNECT_STATE_DISCONNECTED)
     {
-        cmd.getProtoObj().mutable_connect_state()->set_connect_state_type(ProtoTypes::DISCONNECTED);
+        connectState.set_connect_state_type(ProtoTypes::DISCONNECTED);
     }
     else if (state == CONNECT_STATE_CONNECTED)
     {
-        cmd.getProtoObj().mutable_connect_state()->set_connect_state_type(ProtoTypes::CONNECTED);
+        connectState.set_connect_state_type(ProtoTypes::CONNECTED);
     }
     else if (state == CONNECT_STATE_CONNECTING)
     {
-        cmd.getProtoObj().mutable_connect_state()->set_connect_state_type(ProtoTypes::CONNECTING);
+        connectState.set_connect_state_type(ProtoTypes::CONNECTING);
     }
     else if (state == CONNECT_STATE_DISCONNECTING)
     {
-        cmd.getProtoObj().mutable_connect_state()->set_connect_state_type(ProtoTypes::DISCONNECTING);
+        connectState.set_connect_state_type(ProtoTypes::DISCONNECTING);
     }
     else
     {
@@ -737,35 +882,71 @@ void EngineServer::sendConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASO
 
     if (state == CONNECT_STATE_DISCONNECTED)
     {
-        cmd.getProtoObj().mutable_connect_state()->set_disconnect_reason((ProtoTypes::DisconnectReason)reason);
+        connectState.set_disconnect_reason((ProtoTypes::DisconnectReason)reason);
         if (reason == DISCONNECTED_WITH_ERROR)
         {
-            cmd.getProtoObj().mutable_connect_state()->set_connect_error(err);
+            connectState.set_connect_error(err);
         }
     }
     else if (state == CONNECT_STATE_CONNECTED || state == CONNECT_STATE_CONNECTING)
     {
         if (locationId.isValid())
         {
-            *cmd.getProtoObj().mutable_connect_state()->mutable_location() = locationId.toProtobuf();
+            *connectState.mutable_location() = locationId.toProtobuf();
         }
     }
 
-    sendCmdToAllAuthorizedAndGetStateClients(&cmd, true);
+    qCDebug(LOG_IPC) << "[ConnectStateChanged]" << QString::fromStdString(connectState.ShortDebugString());
+    Q_EMIT connectStateChanged(connectState);
+
+    if (hasAuthorizedClientsOfType(ProtoTypes::CLIENT_ID_CLI))
+    {
+        IPC::ProtobufCommand<IPCServerCommands::ConnectStateChanged> cmd;
+        *cmd.getProtoObj().mutable_connect_state() = connectState;
+        sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, ProtoTypes::CLIENT_ID_CLI);
+    }
 }
 
 void EngineServer::onEngineConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &locationId)
 {
+    if (state == CONNECT_STATE_CONNECTED && !trafficStatistics_.isSessionActive())
+    {
+        trafficStatistics_.startSession();
+        lastTotalBytesIn_ = 0;
+        lastTotalBytesOut_ = 0;
+    }
+    else if (state == CONNECT_STATE_DISCONNECTED && trafficStatistics_.isSessionActive())
+    {
+        trafficStatistics_.stopSession();
+        // saved at the end of each session as well as on exit, so a crash doesn't lose the whole history
+        trafficStatistics_.saveToSettings();
+    }
+
     sendConnectStateChanged(state, reason, err, locationId);
 }
 
 void EngineServer::onEngineStatisticsUpdated(quint64 bytesIn, quint64 bytesOut, bool isTotalBytes)
 {
-    IPC::ProtobufCommand<IPCServerCommands::StatisticsUpdated> cmd;
-    cmd.getProtoObj().set_bytes_in(bytesIn);
-    cmd.getProtoObj().set_bytes_out(bytesOut);
-    cmd.getProtoObj().set_is_total_bytes(isTotalBytes);
-    sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+    if (hasAuthorizedClientsOfType(ProtoTypes::CLIENT_ID_CLI))
+    {
+        IPC::ProtobufCommand<IPCServerCommands::StatisticsUpdated> cmd;
+        cmd.getProtoObj().set_bytes_in(bytesIn);
+        cmd.getProtoObj().set_bytes_out(bytesOut);
+        cmd.getProtoObj().set_is_total_bytes(isTotalBytes);
+        sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, ProtoTypes::CLIENT_ID_CLI);
+    }
+
+    if (isTotalBytes)
+    {
+        // a counter restart (e.g. reconnect of the tunnel) starts the totals from zero
+        const quint64 totalIn = bytesIn;
+        const quint64 totalOut = bytesOut;
+        bytesIn = totalIn >= lastTotalBytesIn_ ? totalIn - lastTotalBytesIn_ : totalIn;
+        bytesOut = totalOut >= lastTotalBytesOut_ ? totalOut - lastTotalBytesOut_ : totalOut;
+        lastTotalBytesIn_ = totalIn;
+        lastTotalBytesOut_ = totalOut;
+    }
+    trafficStatistics_.addBytes(QDateTime::currentMSecsSinceEpoch() / 1000, bytesIn, bytesOut);
 }
 
 void EngineServer::onEngineProtocolPortChanged(const ProtoTypes::Protocol &protocol, const uint port)
@@ -923,6 +1104,20 @@ void EngineServer::onEngineWebSessionToken(ProtoTypes::WebSessionPurpose purpose
 
 void EngineServer::onEngineLocationsModelItemsUpdated(const LocationID &bestLocation,  const QString &staticIpDeviceName, QSharedPointer<QVector<locationsmodel::LocationItem> > items)
 {
+    const locationsmodel::LocationsDelta delta = locationsDeltaBuilder_.update(bestLocation, staticIpDeviceName, items);
+    if (!delta.isEmpty())
+    {
+        qCDebug(LOG_IPC) << "[LocationsUpdated] version:" << delta.version << "full:" << delta.isFullSnapshot
+                         << "changed:" << delta.changedLocations.size() << "removed:" << delta.removedLocations.size();
+        Q_EMIT locationsUpdated(delta);
+    }
+
+    // the protobuf copy of the list is only needed by out-of-process clients
+    if (!hasAuthorizedClientsOfType(ProtoTypes::CLIENT_ID_CLI))
+    {
+        return;
+    }
+
     IPC::ProtobufCommand<IPCServerCommands::LocationsUpdated> cmd;
 
     *cmd.getProtoObj().mutable_best_location() = bestLocation.toProtobuf();
@@ -934,11 +1129,16 @@ void EngineServer::onEngineLocationsModelItemsUpdated(const LocationID &bestLoca
         li.fillProtobuf(l);
     }
 
-    sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+    sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, ProtoTypes::CLIENT_ID_CLI);
 }
 
 void EngineServer::onEngineLocationsModelItemsUpdatedCliOnly(const LocationID &bestLocation, QSharedPointer<QVector<locationsmodel::LocationItem> > items)
 {
+    if (!hasAuthorizedClientsOfType(ProtoTypes::CLIENT_ID_CLI))
+    {
+        return;
+    }
+
     IPC::ProtobufCommand<IPCServerCommands::LocationsUpdated> cmd;
     *cmd.getProtoObj().mutable_best_location() = bestLocation.toProtobuf();
 
@@ -947,7 +1147,7 @@ void EngineServer::onEngineLocationsModelItemsUpdatedCliOnly(const LocationID &b
         ProtoTypes::Location *l = cmd.getProtoObj().mutable_locations()->add_locations();
         li.fillProtobuf(l);
     }
-    ///sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, false, ProtoTypes::CLIENT_ID_CLI);
+    sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, ProtoTypes::CLIENT_ID_CLI);
 }
 
 void EngineServer::onEngineLocationsModelBestLocationUpdated(const LocationID &bestLocation)
@@ -959,6 +1159,14 @@ void EngineServer::onEngineLocationsModelBestLocationUpdated(const LocationID &b
 
 void EngineServer::onEngineLocationsModelCustomConfigItemsUpdated(QSharedPointer<QVector<locationsmodel::LocationItem> > items)
 {
+    qCDebug(LOG_IPC) << "[CustomConfigLocationsUpdated] locations:" << items->size();
+    Q_EMIT customConfigLocationsUpdated(items);
+
+    if (!hasAuthorizedClientsOfType(ProtoTypes::CLIENT_ID_CLI))
+    {
+        return;
+    }
+
     IPC::ProtobufCommand<IPCServerCommands::CustomConfigLocationsUpdated> cmd;
 
     for (const locationsmodel::LocationItem &li : *items)
@@ -967,15 +1175,20 @@ void EngineServer::onEngineLocationsModelCustomConfigItemsUpdated(QSharedPointer
         li.fillProtobuf(l);
     }
 
-    sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+    sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, ProtoTypes::CLIENT_ID_CLI);
 }
 
 void EngineServer::onEngineLocationsModelPingChangedChanged(const LocationID &id, PingTime timeMs)
 {
-    IPC::ProtobufCommand<IPCServerCommands::LocationSpeedChanged> cmd;
-    *cmd.getProtoObj().mutable_id() = id.toProtobuf();
-    cmd.getProtoObj().set_pingtime(timeMs.toInt());
-    sendCmdToAllAuthorizedAndGetStateClients(&cmd, false);
+    Q_EMIT locationSpeedChanged(id, timeMs);
+
+    if (hasAuthorizedClientsOfType(ProtoTypes::CLIENT_ID_CLI))
+    {
+        IPC::ProtobufCommand<IPCServerCommands::LocationSpeedChanged> cmd;
+        *cmd.getProtoObj().mutable_id() = id.toProtobuf();
+        cmd.getProtoObj().set_pingtime(timeMs.toInt());
+        sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, ProtoTypes::CLIENT_ID_CLI);
+    }
 }
 
 void EngineServer::onMacAddrSpoofingChanged(const ProtoTypes::MacAddrSpoofing &macAddrSpoofing)
@@ -1026,14 +1239,145 @@ void EngineServer::onHostsFileBecameWritable()
 void EngineServer::sendCmdToAllAuthorizedAndGetStateClients(IPC::Command *cmd, bool bWithLog)
 {
     if (bWithLog) {
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd->getDebugString());
+        IPC::logCommand(*cmd);
     }
 
     Q_EMIT emitCommand(cmd);
 
-    ///sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, bWithLog, ProtoTypes::CLIENT_ID_GUI, &bLogged);
-    ///sendCmdToAllAuthorizedAndGetStateClientsOfType(cmd, bWithLog, ProtoTypes::CLIENT_ID_CLI, &bLogged);
+    sendCmdToAllAuthorizedAndGetStateClientsOfType(*cmd, ProtoTypes::CLIENT_ID_CLI);
+}
+
+void EngineServer::sendCmdToAllAuthorizedAndGetStateClientsOfType(const IPC::Command &cmd, unsigned int clientId)
+{
+    for (auto it = connections_.begin(); it != connections_.end(); ++it)
+    {
+        if (it->bClientAuthReceived_ && it->clientId_ == clientId)
+        {
+            it.key()->sendCommand(cmd);
+        }
+    }
+}
 
+bool EngineServer::hasAuthorizedClientsOfType(unsigned int clientId) const
+{
+    for (auto it = connections_.begin(); it != connections_.end(); ++it)
+    {
+        if (it->bClientAuthReceived_ && it->clientId_ == clientId)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
+void EngineServer::subscribeTrafficStatistics(uint intervalMs)
+{
+    setTrafficSubscription(nullptr, intervalMs);
+}
 
+void EngineServer::onTrafficStatisticsTimer()
+{
+    const qint64 nowSecs = QDateTime::currentMSecsSinceEpoch() / 1000;
+    for (auto it = trafficSubscriptions_.begin(); it != trafficSubscriptions_.end(); ++it)
+    {
+        if (nowSecs >= it->nextSendSecs)
+        {
+            sendTrafficStatisticsBatch(it.key(), it.value(), nowSecs);
+        }
+    }
+}
+
+void EngineServer::setTrafficSubscription(IPC::IConnection *connection, uint intervalMs)
+{
+    if (intervalMs == 0)
+    {
+        trafficSubscriptions_.remove(connection);
+    }
+    else
+    {
+        // the interval is limited by the history of the per-second tier
+        const int maxIntervalSecs = trafficStatistics_.historySecs(TrafficStatistics::TIER_SECONDS);
+        const int intervalSecs = qBound(1, static_cast<int>((intervalMs + 999) / 1000), maxIntervalSecs);
+        const qint64 nowSecs = QDateTime::currentMSecsSinceEpoch() / 1000;
+
+        auto it = trafficSubscriptions_.find(connection);
+        if (it == trafficSubscriptions_.end())
+        {
+            // the samples stored before the subscription are never delivered, the totals stand for them: a subscriber
+            // which subscribes again, e.g. after a restart, replaces its totals and doesn't count those bytes twice
+            it = trafficSubscriptions_.insert(connection, TrafficSubscription{ intervalSecs, 0, nowSecs });
+            sendTrafficStatisticsTotals(connection, nowSecs);
+        }
+        it->intervalSecs = intervalSecs;
+        it->nextSendSecs = nowSecs + intervalSecs;
+    }
+
+    // the timer runs only while there is anybody to deliver to
+    if (trafficSubscriptions_.isEmpty())
+    {
+        trafficStatisticsTimer_.stop();
+    }
+    else if (!trafficStatisticsTimer_.isActive())
+    {
+        trafficStatisticsTimer_.start();
+    }
+}
+
+void EngineServer::sendTrafficStatisticsBatch(IPC::IConnection *connection, TrafficSubscription &subscription, qint64 nowSecs)
+{
+    // the current second is not complete yet, it goes into the next batch
+    const qint64 fromSecs = qMax(subscription.sentUpToSecs,
+                                 nowSecs - trafficStatistics_.historySecs(TrafficStatistics::TIER_SECONDS) + 1);
+    const QVector<TrafficStatistics::Sample> samples = trafficStatistics_.samples(TrafficStatistics::TIER_SECONDS, fromSecs, nowSecs);
+
+    subscription.sentUpToSecs = qMax(subscription.sentUpToSecs, nowSecs);
+    subscription.nextSendSecs = nowSecs + subscription.intervalSecs;
+
+    IPC::ProtobufCommand<IPCServerCommands::TrafficStatisticsBatch> cmd;
+    IPCServerCommands::TrafficStatisticsBatch &batch = cmd.getProtoObj();
+    batch.set_session_bytes_in(trafficStatistics_.sessionBytesIn());
+    batch.set_session_bytes_out(trafficStatistics_.sessionBytesOut());
+    batch.set_first_second(fromSecs);
+
+    bool isIdle = true;
+    for (const TrafficStatistics::Sample &sample : samples)
+    {
+        batch.add_bytes_in(sample.bytesIn);
+        batch.add_bytes_out(sample.bytesOut);
+        if (sample.bytesIn != 0 || sample.bytesOut != 0)
+        {
+            isIdle = false;
+        }
+    }
+    // nothing is sent while there is no traffic
+    if (isIdle)
+    {
+        return;
+    }
+    deliverTrafficStatisticsBatch(connection, cmd);
+}
+
+// the first batch of a subscription: the session totals, without samples
+void EngineServer::sendTrafficStatisticsTotals(IPC::IConnection *connection, qint64 nowSecs)
+{
+    IPC::ProtobufCommand<IPCServerCommands::TrafficStatisticsBatch> cmd;
+    IPCServerCommands::TrafficStatisticsBatch &batch = cmd.getProtoObj();
+    batch.set_session_bytes_in(trafficStatistics_.sessionBytesIn());
+    batch.set_session_bytes_out(trafficStatistics_.sessionBytesOut());
+    batch.set_first_second(nowSecs);
+    deliverTrafficStatisticsBatch(connection, cmd);
+}
+
+void EngineServer::deliverTrafficStatisticsBatch(IPC::IConnection *connection,
+                                                 IPC::ProtobufCommand<IPCServerCommands::TrafficStatisticsBatch> &cmd)
+{
+    const IPCServerCommands::TrafficStatisticsBatch &batch = cmd.getProtoObj();
+    if (connection == nullptr)
+    {
+        Q_EMIT trafficStatisticsUpdated(batch);
+    }
+    else
+    {
+        connection->sendCommand(cmd);
+    }
+}
@@ -3,9 +3,14 @@
 
 #include <QObject>
 #include <QHash>
+#include <QTimer>
 #include "ipc/iserver.h"
+#include "ipc/protobufcommand.h"
 #include "clientconnectiondescr.h"
 #include "engine/engine.h"
+#include "engine/locationsmodel/locationsdelta.h"
+#include "enginenotificationmailbox.h"
+#include "trafficstatistics.h"
 
 class EngineServer : public QObject
 {
@@ -16,17 +21,38 @@ public:
 
     void sendCommand(IPC::Command *command);
     void sendCmdToAllAuthorizedAndGetStateClients(IPC::Command *cmd, bool bWithLog);
-    //void sendCmdToAllAuthorizedAndGetStateClientsOfType(const IPC::Command &cmd, bool bWithLog, unsigned int clientId, bool* bLogged = nullptr);
+    void sendCmdToAllAuthorizedAndGetStateClientsOfType(const IPC::Command &cmd, unsigned int clientId);
 
 public slots:
-    void run();
+    // false if the IPC server can't be started, finished() is emitted then
+    bool run();
+
+    // headless mode: starts the local socket server and the engine without waiting for a GUI client
+    void startDaemon();
+    void stopDaemon();
+
+    // re-sends the whole API locations list, used by the GUI when a delta doesn't match its version
+    void requestLocationsSnapshot();
+
+    // in-process subscription of the GUI, batches are delivered by trafficStatisticsUpdated(); 0 - unsubscribe
+    void subscribeTrafficStatistics(uint intervalMs);
 
 signals:
     void finished();
     void emitCommand(IPC::Command *command);
 
+    // typed in-process notifications, delivered without wrapping into an IPC::Command
+    void connectStateChanged(const ProtoTypes::ConnectState &connectState);
+    void firewallStateChanged(bool isEnabled);
+    void trafficStatisticsUpdated(const IPCServerCommands::TrafficStatisticsBatch &batch);
+    void locationSpeedChanged(const LocationID &id, PingTime timeMs);
+    void myIpUpdated(const QString &ip, bool isDisconnected);
+    void locationsUpdated(const locationsmodel::LocationsDelta &delta);
+    void customConfigLocationsUpdated(locationsmodel::LocationsSnapshot locations);
+
 private slots:
     void onServerCallbackAcceptFunction(IPC::IConnection *connection);
+    void onConnectionCommandCallback(IPC::Command *command, IPC::IConnection *connection);
     void onConnectionStateCallback(int state, IPC::IConnection *connection);
 
     void onEngineCleanupFinished();
@@ -86,6 +112,8 @@ private slots:
 
     void onHostsFileBecameWritable();
 
+    void onTrafficStatisticsTimer();
+
 private:
     IPC::IServer *server_;
 
@@ -95,13 +123,38 @@ private:
 
     bool bClientAuthReceived_;
     QHash<IPC::IConnection *, ClientConnectionDescr> connections_;
+    bool isDaemon_;
+    locationsmodel::LocationsDeltaBuilder locationsDeltaBuilder_;
+    EngineNotificationMailbox *notificationMailbox_;
+
+    struct TrafficSubscription
+    {
+        int intervalSecs;
+        qint64 nextSendSecs;
+        qint64 sentUpToSecs;    // the samples before this second are already delivered
+    };
+    TrafficStatistics trafficStatistics_;
+    quint64 lastTotalBytesIn_;
+    quint64 lastTotalBytesOut_;
+    // nullptr key - the in-process GUI
+    QHash<IPC::IConnection *, TrafficSubscription> trafficSubscriptions_;
+    QTimer trafficStatisticsTimer_;
 
     //void serverCallbackAcceptFunction(IPC::IConnection *connection);
+    void buildEngine();
     bool handleCommand(IPC::Command *command);
+    void logReceivedCommand(const IPC::Command &command);
+    bool hasAuthorizedClientsOfType(unsigned int clientId) const;
     void sendEngineInitReturnCode(ENGINE_INIT_RET_CODE retCode);
     void sendConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, ProtoTypes::ConnectError err, const LocationID &locationId);
 
     void sendFirewallStateChanged(bool isEnabled);
+
+    void setTrafficSubscription(IPC::IConnection *connection, uint intervalMs);
+    void sendTrafficStatisticsBatch(IPC::IConnection *connection, TrafficSubscription &subscription, qint64 nowSecs);
+    void sendTrafficStatisticsTotals(IPC::IConnection *connection, qint64 nowSecs);
+    void deliverTrafficStatisticsBatch(IPC::IConnection *connection,
+                                       IPC::ProtobufCommand<IPCServerCommands::TrafficStatisticsBatch> &cmd);
 };
 
 #endif // ENGINESERVER_H
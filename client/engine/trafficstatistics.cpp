@@ -0,0 +1,179 @@
+#include "trafficstatistics.h"
+#include <QSettings>
+#include "utils/logger.h"
+#include "utils/protobuf_includes.h"
+
+namespace {
+const char *SETTINGS_KEY = "trafficStatistics";
+
+const int TIER_PERIODS[TrafficStatistics::TIERS_COUNT] = { 1, 60, 3600 };
+const int TIER_SIZES[TrafficStatistics::TIERS_COUNT] = { 300, 1440, 720 };
+}
+
+TrafficStatistics::TrafficStatistics() : isSessionActive_(false), sessionBytesIn_(0), sessionBytesOut_(0)
+{
+    for (int i = 0; i < TIERS_COUNT; ++i)
+    {
+        tiers_ << Ring(TIER_PERIODS[i], TIER_SIZES[i]);
+    }
+}
+
+void TrafficStatistics::addBytes(qint64 nowSecs, quint64 bytesIn, quint64 bytesOut)
+{
+    for (Ring &ring : tiers_)
+    {
+        ring.add(nowSecs, bytesIn, bytesOut);
+    }
+    if (isSessionActive_)
+    {
+        sessionBytesIn_ += bytesIn;
+        sessionBytesOut_ += bytesOut;
+    }
+}
+
+QVector<TrafficStatistics::Sample> TrafficStatistics::samples(TIER tier, qint64 fromSecs, qint64 toSecs) const
+{
+    Q_ASSERT(tier >= 0 && tier < TIERS_COUNT);
+    const Ring &ring = tiers_[tier];
+
+    QVector<Sample> result;
+    if (toSecs <= fromSecs)
+    {
+        return result;
+    }
+    result.reserve(static_cast<int>((toSecs - fromSecs + ring.periodSecs - 1) / ring.periodSecs));
+    for (qint64 t = fromSecs - fromSecs % ring.periodSecs; t < toSecs; t += ring.periodSecs)
+    {
+        result << ring.at(t);
+    }
+    return result;
+}
+
+int TrafficStatistics::historySecs(TIER tier) const
+{
+    Q_ASSERT(tier >= 0 && tier < TIERS_COUNT);
+    return tiers_[tier].periodSecs * tiers_[tier].buckets.size();
+}
+
+void TrafficStatistics::startSession()
+{
+    isSessionActive_ = true;
+    sessionBytesIn_ = 0;
+    sessionBytesOut_ = 0;
+}
+
+void TrafficStatistics::stopSession()
+{
+    isSessionActive_ = false;
+    sessionBytesIn_ = 0;
+    sessionBytesOut_ = 0;
+}
+
+void TrafficStatistics::saveToSettings() const
+{
+    ProtoApiInfo::TrafficStatisticsStorage storage;
+    for (const Ring &ring : tiers_)
+    {
+        ProtoApiInfo::TrafficStatisticsTier *tier = storage.add_tiers();
+        tier->set_period_secs(ring.periodSecs);
+        tier->set_latest_time(ring.latestTime);
+        for (const Sample &sample : ring.buckets)
+        {
+            tier->add_bytes_in(sample.bytesIn);
+            tier->add_bytes_out(sample.bytesOut);
+        }
+    }
+
+    size_t size = storage.ByteSizeLong();
+    QByteArray arr(size, Qt::Uninitialized);
+    storage.SerializeToArray(arr.data(), size);
+
+    QSettings settings;
+    settings.setValue(SETTINGS_KEY, arr);
+}
+
+void TrafficStatistics::loadFromSettings()
+{
+    QSettings settings;
+    if (!settings.contains(SETTINGS_KEY))
+    {
+        return;
+    }
+
+    QByteArray arr = settings.value(SETTINGS_KEY).toByteArray();
+    ProtoApiInfo::TrafficStatisticsStorage storage;
+    if (!storage.ParseFromArray(arr.data(), arr.size()))
+    {
+        qCDebug(LOG_BASIC) << "Can't parse the saved traffic statistics, ignored";
+        return;
+    }
+
+    // a tier whose layout has changed since it was saved is dropped rather than reinterpreted
+    for (int i = 0; i < storage.tiers_size() && i < tiers_.size(); ++i)
+    {
+        const ProtoApiInfo::TrafficStatisticsTier &tier = storage.tiers(i);
+        Ring &ring = tiers_[i];
+        if (static_cast<int>(tier.period_secs()) != ring.periodSecs ||
+            tier.bytes_in_size() != ring.buckets.size() || tier.bytes_out_size() != ring.buckets.size())
+        {
+            continue;
+        }
+        ring.latestTime = tier.latest_time();
+        for (int b = 0; b < ring.buckets.size(); ++b)
+        {
+            ring.buckets[b].bytesIn = tier.bytes_in(b);
+            ring.buckets[b].bytesOut = tier.bytes_out(b);
+        }
+    }
+}
+
+void TrafficStatistics::Ring::add(qint64 timeSecs, quint64 bytesIn, quint64 bytesOut)
+{
+    const qint64 bucketTime = timeSecs - timeSecs % periodSecs;
+    const qint64 historySecs = static_cast<qint64>(periodSecs) * buckets.size();
+
+    if (latestTime < 0 || bucketTime - latestTime >= historySecs)
+    {
+        // empty or the whole ring is stale
+        buckets.fill(Sample());
+        latestTime = bucketTime;
+    }
+    else if (bucketTime > latestTime)
+    {
+        // clear the buckets skipped while there was no traffic
+        for (qint64 t = latestTime + periodSecs; t <= bucketTime; t += periodSecs)
+        {
+            buckets[indexOf(t)] = Sample();
+        }
+        latestTime = bucketTime;
+    }
+    else if (!isInHistory(bucketTime))
+    {
+        // the clock went back further than the history of this tier
+        return;
+    }
+
+    Sample &sample = buckets[indexOf(bucketTime)];
+    sample.bytesIn += bytesIn;
+    sample.bytesOut += bytesOut;
+}
+
+TrafficStatistics::Sample TrafficStatistics::Ring::at(qint64 bucketTime) const
+{
+    if (!isInHistory(bucketTime))
+    {
+        return Sample();
+    }
+    return buckets[indexOf(bucketTime)];
+}
+
+bool TrafficStatistics::Ring::isInHistory(qint64 bucketTime) const
+{
+    return latestTime >= 0 && bucketTime <= latestTime &&
+           bucketTime > latestTime - static_cast<qint64>(periodSecs) * buckets.size();
+}
+
+int TrafficStatistics::Ring::indexOf(qint64 bucketTime) const
+{
+    return static_cast<int>((bucketTime / periodSecs) % buckets.size());
+}
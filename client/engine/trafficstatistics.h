@@ -0,0 +1,64 @@
+#ifndef TRAFFICSTATISTICS_H
+#define TRAFFICSTATISTICS_H
+
+#include <QVector>
+
+// Traffic counters history with fixed memory: 5 minutes of per-second buckets, 24 hours of per-minute
+// buckets and 30 days of per-hour buckets. Every tier is a ring buffer indexed by the bucket time, so
+// adding bytes is O(1) and stale buckets are cleared lazily when the ring moves forward.
+// The history is persistent between runs of the program.
+class TrafficStatistics
+{
+public:
+    enum TIER { TIER_SECONDS, TIER_MINUTES, TIER_HOURS, TIERS_COUNT };
+
+    struct Sample
+    {
+        quint64 bytesIn;
+        quint64 bytesOut;
+
+        Sample() : bytesIn(0), bytesOut(0) {}
+    };
+
+    TrafficStatistics();
+
+    // |nowSecs| - seconds since epoch (UTC)
+    void addBytes(qint64 nowSecs, quint64 bytesIn, quint64 bytesOut);
+
+    // samples of the tier for the buckets in [fromSecs, toSecs), one per period; buckets outside of
+    // the tier history are returned as zero
+    QVector<Sample> samples(TIER tier, qint64 fromSecs, qint64 toSecs) const;
+    int historySecs(TIER tier) const;
+
+    // per-session totals, zero outside of a session; they are not saved, a session doesn't outlive the program
+    void startSession();
+    void stopSession();
+    bool isSessionActive() const { return isSessionActive_; }
+    quint64 sessionBytesIn() const { return sessionBytesIn_; }
+    quint64 sessionBytesOut() const { return sessionBytesOut_; }
+
+    void saveToSettings() const;
+    void loadFromSettings();
+
+private:
+    struct Ring
+    {
+        int periodSecs;
+        QVector<Sample> buckets;
+        qint64 latestTime;      // start of the latest bucket, -1 if empty
+
+        Ring(int period, int size) : periodSecs(period), buckets(size), latestTime(-1) {}
+
+        void add(qint64 timeSecs, quint64 bytesIn, quint64 bytesOut);
+        Sample at(qint64 bucketTime) const;
+        bool isInHistory(qint64 bucketTime) const;
+        int indexOf(qint64 bucketTime) const;
+    };
+
+    QVector<Ring> tiers_;
+    bool isSessionActive_;
+    quint64 sessionBytesIn_;
+    quint64 sessionBytesOut_;
+};
+
+#endif // TRAFFICSTATISTICS_H
@@ -18,6 +18,9 @@ Backend::Backend(QObject *parent) : QObject(parent),
     bLastLoginWithAuthHash_(false),
     isCleanupFinished_(false),
     cmdId_(0),
+    pendingLocationsUpdates_(0),
+    isLocationsSnapshotRequested_(false),
+    isFirstTrafficStatisticsBatch_(true),
     isFirewallEnabled_(false),
     isExternalConfigMode_(false)
 {
@@ -31,6 +34,13 @@ Backend::Backend(QObject *parent) : QObject(parent),
 
     engineServer_ = new EngineServer(this);
     connect(engineServer_, SIGNAL(emitCommand(IPC::Command*)), SLOT(onConnectionNewCommand(IPC::Command*)));
+    connect(engineServer_, SIGNAL(connectStateChanged(ProtoTypes::ConnectState)), SLOT(onEngineConnectStateChanged(ProtoTypes::ConnectState)));
+    connect(engineServer_, SIGNAL(firewallStateChanged(bool)), SLOT(onEngineFirewallStateChanged(bool)));
+    connect(engineServer_, SIGNAL(trafficStatisticsUpdated(IPCServerCommands::TrafficStatisticsBatch)), SLOT(onEngineTrafficStatisticsUpdated(IPCServerCommands::TrafficStatisticsBatch)));
+    connect(engineServer_, SIGNAL(locationSpeedChanged(LocationID, PingTime)), SLOT(onEngineLocationSpeedChanged(LocationID, PingTime)));
+    connect(engineServer_, SIGNAL(myIpUpdated(QString, bool)), SIGNAL(myIpChanged(QString, bool)));
+    connect(engineServer_, SIGNAL(locationsUpdated(locationsmodel::LocationsDelta)), SLOT(onEngineLocationsUpdated(locationsmodel::LocationsDelta)));
+    connect(engineServer_, SIGNAL(customConfigLocationsUpdated(locationsmodel::LocationsSnapshot)), SLOT(onEngineCustomConfigLocationsUpdated(locationsmodel::LocationsSnapshot)));
 }
 
 Backend::~Backend()
@@ -49,7 +59,6 @@ void Backend::init()
     cmd.getProtoObj().set_client_id(0);
     cmd.getProtoObj().set_pid(0);
     cmd.getProtoObj().set_name("gui");
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -94,7 +103,6 @@ void Backend::cleanup(bool isExitWithRestart, bool isFirewallChecked, bool isFir
         cmd.getProtoObj().set_is_firewall_checked(isFirewallChecked);
         cmd.getProtoObj().set_is_firewall_always_on(isFirewallAlwaysOn);
         cmd.getProtoObj().set_is_launch_on_start(isLaunchOnStart);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
         engineServer_->sendCommand(&cmd);
     }
 }
@@ -102,7 +110,6 @@ void Backend::cleanup(bool isExitWithRestart, bool isFirewallChecked, bool isFir
 void Backend::enableBFE_win()
 {
     IPC::ProtobufCommand<IPCClientCommands::EnableBfe_win> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -115,11 +122,6 @@ void Backend::login(const QString &username, const QString &password, const QStr
     cmd.getProtoObj().set_code2fa(code2fa.toStdString());
     cmd.getProtoObj().set_auth_hash("");
 
-    // hide password for logging
-    IPC::ProtobufCommand<IPCClientCommands::Login> loggedCmd = cmd;
-    loggedCmd.getProtoObj().set_password("*****");
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(loggedCmd.getDebugString());
-
     engineServer_->sendCommand(&cmd);
 }
 
@@ -138,7 +140,6 @@ void Backend::loginWithAuthHash(const QString &authHash)
     bLastLoginWithAuthHash_ = true;
     IPC::ProtobufCommand<IPCClientCommands::Login> cmd;
     cmd.getProtoObj().set_auth_hash(authHash.toStdString());
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -151,7 +152,6 @@ void Backend::loginWithLastLoginSettings()
 {
     IPC::ProtobufCommand<IPCClientCommands::Login> cmd;
     cmd.getProtoObj().set_use_last_login_settings(true);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -163,7 +163,6 @@ bool Backend::isLastLoginWithAuthHash() const
 void Backend::signOut()
 {
     IPC::ProtobufCommand<IPCClientCommands::SignOut> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -172,7 +171,6 @@ void Backend::sendConnect(const LocationID &lid)
     connectStateHelper_.connectClickFromUser();
     IPC::ProtobufCommand<IPCClientCommands::Connect> cmd;
     *cmd.getProtoObj().mutable_locationdid() = lid.toProtobuf();
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -180,7 +178,6 @@ void Backend::sendDisconnect()
 {
     connectStateHelper_.disconnectClickFromUser();
     IPC::ProtobufCommand<IPCClientCommands::Disconnect> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -197,7 +194,6 @@ ProtoTypes::ConnectStateType Backend::currentConnectState() const
 void Backend::forceCliStateUpdate()
 {
     IPC::ProtobufCommand<IPCClientCommands::ForceCliStateUpdate> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -206,7 +202,6 @@ void Backend::firewallOn(bool updateHelperFirst)
     if (updateHelperFirst) firewallStateHelper_.firewallOnClickFromGUI();
     IPC::ProtobufCommand<IPCClientCommands::Firewall> cmd;
     cmd.getProtoObj().set_is_enable(true);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -215,7 +210,6 @@ void Backend::firewallOff(bool updateHelperFirst)
     if (updateHelperFirst) firewallStateHelper_.firewallOffClickFromGUI();
     IPC::ProtobufCommand<IPCClientCommands::Firewall> cmd;
     cmd.getProtoObj().set_is_enable(false);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -233,7 +227,6 @@ void Backend::emergencyConnectClick()
 {
     emergencyConnectStateHelper_.connectClickFromUser();
     IPC::ProtobufCommand<IPCClientCommands::EmergencyConnect> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -241,7 +234,6 @@ void Backend::emergencyDisconnectClick()
 {
     emergencyConnectStateHelper_.disconnectClickFromUser();
     IPC::ProtobufCommand<IPCClientCommands::EmergencyDisconnect> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -255,14 +247,12 @@ void Backend::startWifiSharing(const QString &ssid, const QString &password)
     IPC::ProtobufCommand<IPCClientCommands::StartWifiSharing> cmd;
     cmd.getProtoObj().set_ssid(ssid.toStdString());
     cmd.getProtoObj().set_password(password.toStdString());
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::stopWifiSharing()
 {
     IPC::ProtobufCommand<IPCClientCommands::StopWifiSharing> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -270,14 +260,12 @@ void Backend::startProxySharing(ProtoTypes::ProxySharingMode proxySharingMode)
 {
     IPC::ProtobufCommand<IPCClientCommands::StartProxySharing> cmd;
     cmd.getProtoObj().set_sharing_mode(proxySharingMode);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::stopProxySharing()
 {
    IPC::ProtobufCommand<IPCClientCommands::StopProxySharing> cmd;
-   qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
    engineServer_->sendCommand(&cmd);
 }
 
@@ -285,42 +273,36 @@ void Backend::setIPv6StateInOS(bool bEnabled)
 {
     IPC::ProtobufCommand<IPCClientCommands::SetIpv6StateInOS> cmd;
     cmd.getProtoObj().set_is_enabled(bEnabled);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::getAndUpdateIPv6StateInOS()
 {
     IPC::ProtobufCommand<IPCClientCommands::GetIpv6StateInOS> cmd;
-    // qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString()); // hidden because it's a bit spammy
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::gotoCustomOvpnConfigMode()
 {
     IPC::ProtobufCommand<IPCClientCommands::GotoCustomOvpnConfigMode> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::recordInstall()
 {
     IPC::ProtobufCommand<IPCClientCommands::RecordInstall> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::sendConfirmEmail()
 {
     IPC::ProtobufCommand<IPCClientCommands::SendConfirmEmail> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::sendDebugLog()
 {
     IPC::ProtobufCommand<IPCClientCommands::SendDebugLog> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -328,7 +310,6 @@ void Backend::getWebSessionTokenForEditAccountDetails()
 {
     IPC::ProtobufCommand<IPCClientCommands::GetWebSessionToken> cmd;
     cmd.getProtoObj().set_purpose(ProtoTypes::WEB_SESSION_PURPOSE_EDIT_ACCOUNT_DETAILS);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -336,7 +317,6 @@ void Backend::getWebSessionTokenForAddEmail()
 {
     IPC::ProtobufCommand<IPCClientCommands::GetWebSessionToken> cmd;
     cmd.getProtoObj().set_purpose(ProtoTypes::WEB_SESSION_PURPOSE_ADD_EMAIL);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -345,7 +325,6 @@ void Backend::speedRating(int rating, const QString &localExternalIp)
     IPC::ProtobufCommand<IPCClientCommands::SpeedRating> cmd;
     cmd.getProtoObj().set_rating(rating);
     cmd.getProtoObj().set_local_external_ip(localExternalIp.toStdString());
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -353,14 +332,12 @@ void Backend::setBlockConnect(bool isBlockConnect)
 {
     IPC::ProtobufCommand<IPCClientCommands::SetBlockConnect> cmd;
     cmd.getProtoObj().set_is_block_connect(isBlockConnect);
-    // qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString()); // a bit spammy
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::clearCredentials()
 {
     IPC::ProtobufCommand<IPCClientCommands::ClearCredentials> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -376,14 +353,12 @@ void Backend::continueWithCredentialsForOvpnConfig(const QString &username, cons
     cmd.getProtoObj().set_username(username.toStdString());
     cmd.getProtoObj().set_password(password.toStdString());
     cmd.getProtoObj().set_is_save(bSave);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::sendAdvancedParametersChanged()
 {
     IPC::ProtobufCommand<IPCClientCommands::AdvancedParametersChanged> cmd;
-    qCDebug(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -395,7 +370,6 @@ void Backend::sendEngineSettingsIfChanged()
         latestEngineSettings_ = preferences_.getEngineSettings();
         IPC::ProtobufCommand<IPCClientCommands::SetSettings> cmd;
         *cmd.getProtoObj().mutable_enginesettings() = latestEngineSettings_;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
         engineServer_->sendCommand(&cmd);
     }
 }
@@ -424,7 +398,6 @@ void Backend::applicationActivated()
 {
     IPC::ProtobufCommand<IPCClientCommands::ApplicationActivated> cmd;
     cmd.getProtoObj().set_is_activated(true);
-    // qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -432,7 +405,6 @@ void Backend::applicationDeactivated()
 {
     IPC::ProtobufCommand<IPCClientCommands::ApplicationActivated> cmd;
     cmd.getProtoObj().set_is_activated(false);
-    // qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -446,7 +418,6 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
     if (command->getStringId() == IPCServerCommands::AuthReply::descriptor()->full_name())
     {
         IPC::ProtobufCommand<IPCClientCommands::Init> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
         engineServer_->sendCommand(&cmd);
     }
     else if (command->getStringId() == IPCServerCommands::InitFinished::descriptor()->full_name())
@@ -472,12 +443,6 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
             Q_EMIT initFinished(cmd->getProtoObj().init_state());
         }
     }
-    else if (command->getStringId() == IPCServerCommands::FirewallStateChanged::descriptor()->full_name())
-    {
-        IPC::ProtobufCommand<IPCServerCommands::FirewallStateChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::FirewallStateChanged> *>(command);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd->getDebugString());
-        firewallStateHelper_.setFirewallStateFromEngine(cmd->getProtoObj().is_firewall_enabled());
-    }
     else if (command->getStringId() == IPCServerCommands::LoginFinished::descriptor()->full_name())
     {
         IPC::ProtobufCommand<IPCServerCommands::LoginFinished> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::LoginFinished> *>(command);
@@ -511,34 +476,11 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
         updateAccountInfo();
         Q_EMIT sessionStatusChanged(latestSessionStatus_);
     }
-    else if (command->getStringId() == IPCServerCommands::LocationsUpdated::descriptor()->full_name())
-    {
-        IPC::ProtobufCommand<IPCServerCommands::LocationsUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::LocationsUpdated> *>(command);
-        locationsModel_->updateApiLocations(cmd->getProtoObj().best_location(), QString::fromStdString(cmd->getProtoObj().static_ip_device_name()), cmd->getProtoObj().locations());
-        Q_EMIT locationsUpdated();
-    }
     else if (command->getStringId() == IPCServerCommands::BestLocationUpdated::descriptor()->full_name())
     {
         IPC::ProtobufCommand<IPCServerCommands::BestLocationUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::BestLocationUpdated> *>(command);
         locationsModel_->updateBestLocation(cmd->getProtoObj().best_location());
     }
-    else if (command->getStringId() == IPCServerCommands::CustomConfigLocationsUpdated::descriptor()->full_name())
-    {
-        IPC::ProtobufCommand<IPCServerCommands::CustomConfigLocationsUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::CustomConfigLocationsUpdated> *>(command);
-        locationsModel_->updateCustomConfigLocations(cmd->getProtoObj().locations());
-        Q_EMIT locationsUpdated();
-    }
-    else if (command->getStringId() == IPCServerCommands::LocationSpeedChanged::descriptor()->full_name())
-    {
-        IPC::ProtobufCommand<IPCServerCommands::LocationSpeedChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::LocationSpeedChanged> *>(command);
-        locationsModel_->changeConnectionSpeed(LocationID::createFromProtoBuf(cmd->getProtoObj().id()), (int)cmd->getProtoObj().pingtime());
-    }
-    else if (command->getStringId() == IPCServerCommands::ConnectStateChanged::descriptor()->full_name())
-    {
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(command->getDebugString());
-        IPC::ProtobufCommand<IPCServerCommands::ConnectStateChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::ConnectStateChanged> *>(command);
-        connectStateHelper_.setConnectStateFromEngine(cmd->getProtoObj().connect_state());
-    }
     else if (command->getStringId() == IPCServerCommands::EmergencyConnectStateChanged::descriptor()->full_name())
     {
         IPC::ProtobufCommand<IPCServerCommands::EmergencyConnectStateChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::EmergencyConnectStateChanged> *>(command);
@@ -561,23 +503,19 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
     else if (command->getStringId() == IPCServerCommands::NotificationsUpdated::descriptor()->full_name())
     {
         IPC::ProtobufCommand<IPCServerCommands::NotificationsUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::NotificationsUpdated> *>(command);
-        Q_EMIT notificationsChanged(cmd->getProtoObj().array_notifications());
+        // not urgent, let the pending locations and state updates go first
+        const ProtoTypes::ArrayApiNotification notifications = cmd->getProtoObj().array_notifications();
+        workScheduler_.post("notifications", GuiWorkScheduler::PRIORITY_LOW, [this, notifications]()
+        {
+            Q_EMIT notificationsChanged(notifications);
+            return true;
+        });
     }
     else if (command->getStringId() == IPCServerCommands::CheckUpdateInfoUpdated::descriptor()->full_name())
     {
         IPC::ProtobufCommand<IPCServerCommands::CheckUpdateInfoUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::CheckUpdateInfoUpdated> *>(command);
         Q_EMIT checkUpdateChanged(cmd->getProtoObj().check_update_info());
     }
-    else if (command->getStringId() == IPCServerCommands::MyIpUpdated::descriptor()->full_name())
-    {
-        IPC::ProtobufCommand<IPCServerCommands::MyIpUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::MyIpUpdated> *>(command);
-        Q_EMIT myIpChanged(QString::fromStdString(cmd->getProtoObj().my_ip_info().ip()), cmd->getProtoObj().my_ip_info().is_disconnected_state());
-    }
-    else if (command->getStringId() == IPCServerCommands::StatisticsUpdated::descriptor()->full_name())
-    {
-        IPC::ProtobufCommand<IPCServerCommands::StatisticsUpdated> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::StatisticsUpdated> *>(command);
-        Q_EMIT statisticsUpdated(cmd->getProtoObj().bytes_in(), cmd->getProtoObj().bytes_out(), cmd->getProtoObj().is_total_bytes());
-    }
     else if (command->getStringId() == IPCServerCommands::RequestCredentialsForOvpnConfig::descriptor()->full_name())
     {
         Q_EMIT requestCustomOvpnConfigCredentials();
@@ -605,7 +543,6 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
     }
     else if (command->getStringId() == IPCServerCommands::EngineSettingsChanged::descriptor()->full_name())
     {
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(command->getDebugString());
         latestEngineSettings_ = static_cast<IPC::ProtobufCommand<IPCServerCommands::EngineSettingsChanged> *>(command)->getProtoObj().enginesettings();
         preferences_.setEngineSettings(latestEngineSettings_);
     }
@@ -616,7 +553,6 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
     }
     else if (command->getStringId() == IPCServerCommands::NetworkChanged::descriptor()->full_name())
     {
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(command->getDebugString());
         IPC::ProtobufCommand<IPCServerCommands::NetworkChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::NetworkChanged> *>(command);
 
         ProtoTypes::NetworkInterface networkInterface;
@@ -701,6 +637,123 @@ void Backend::onConnectionNewCommand(IPC::Command *command)
     }
 }
 
+void Backend::onEngineConnectStateChanged(const ProtoTypes::ConnectState &connectState)
+{
+    // the traffic is shown only while connected, it is delivered once per second in batches instead of every
+    // byte counter tick of the tunnel
+    if (connectState.connect_state_type() == ProtoTypes::CONNECTED)
+    {
+        engineServer_->subscribeTrafficStatistics(1000);
+    }
+    else if (connectState.connect_state_type() == ProtoTypes::DISCONNECTED)
+    {
+        engineServer_->subscribeTrafficStatistics(0);
+        isFirstTrafficStatisticsBatch_ = true;
+    }
+    connectStateHelper_.setConnectStateFromEngine(connectState);
+}
+
+void Backend::onEngineFirewallStateChanged(bool isEnabled)
+{
+    firewallStateHelper_.setFirewallStateFromEngine(isEnabled);
+}
+
+void Backend::onEngineLocationSpeedChanged(const LocationID &id, PingTime timeMs)
+{
+    // a queued update carries the pings as they were when the engine sent it, and may add the location
+    if (pendingLocationsUpdates_ > 0)
+    {
+        pendingLocationSpeeds_.insert(id, timeMs);
+        return;
+    }
+    locationsModel_->changeConnectionSpeed(id, timeMs);
+}
+
+void Backend::onEngineLocationsUpdated(const locationsmodel::LocationsDelta &delta)
+{
+    struct State
+    {
+        locationsmodel::LocationsDelta delta;
+        QVector< QSharedPointer<LocationModelItem> > items;
+    };
+    QSharedPointer<State> state(new State());
+    state->delta = delta;
+    state->items.reserve(delta.changedLocations.size());
+
+    // convert one location per step, then apply the whole delta to the models in the last step;
+    // the favorites are taken from the storage then, so a switch made meanwhile is kept
+    pendingLocationsUpdates_++;
+    workScheduler_.post("locations", GuiWorkScheduler::PRIORITY_NORMAL, [this, state]()
+    {
+        // the snapshot requested replaces whatever these deltas would change
+        if (isLocationsSnapshotRequested_ && !state->delta.isFullSnapshot)
+        {
+            onLocationsUpdateApplied();
+            return true;
+        }
+
+        if (state->items.size() < state->delta.changedLocations.size())
+        {
+            state->items << locationsModel_->makeLocationModelItem(state->delta.changedLocations[state->items.size()]);
+            return false;
+        }
+
+        if (!locationsModel_->updateApiLocations(state->delta, state->items))
+        {
+            qCDebug(LOG_BASIC) << "Locations delta doesn't match the current version, requesting a full snapshot";
+            isLocationsSnapshotRequested_ = true;
+            engineServer_->requestLocationsSnapshot();
+            onLocationsUpdateApplied();
+            return true;
+        }
+        if (state->delta.isFullSnapshot)
+        {
+            isLocationsSnapshotRequested_ = false;
+        }
+        Q_EMIT locationsUpdated();
+        onLocationsUpdateApplied();
+        return true;
+    });
+}
+
+void Backend::onEngineCustomConfigLocationsUpdated(locationsmodel::LocationsSnapshot locations)
+{
+    pendingLocationsUpdates_++;
+    workScheduler_.post("custom config locations", GuiWorkScheduler::PRIORITY_NORMAL, [this, locations]()
+    {
+        locationsModel_->updateCustomConfigLocations(*locations);
+        Q_EMIT locationsUpdated();
+        onLocationsUpdateApplied();
+        return true;
+    });
+}
+
+void Backend::onEngineTrafficStatisticsUpdated(const IPCServerCommands::TrafficStatisticsBatch &batch)
+{
+    // the totals replace what was counted before the subscription, the samples of the next batches add to them
+    if (isFirstTrafficStatisticsBatch_)
+    {
+        isFirstTrafficStatisticsBatch_ = false;
+        Q_EMIT statisticsUpdated(batch.session_bytes_in(), batch.session_bytes_out(), true);
+        return;
+    }
+
+    quint64 bytesIn = 0;
+    quint64 bytesOut = 0;
+    for (int i = 0; i < batch.bytes_in_size(); ++i)
+    {
+        bytesIn += batch.bytes_in(i);
+    }
+    for (int i = 0; i < batch.bytes_out_size(); ++i)
+    {
+        bytesOut += batch.bytes_out(i);
+    }
+    if (bytesIn != 0 || bytesOut != 0)
+    {
+        Q_EMIT statisticsUpdated(bytesIn, bytesOut, false);
+    }
+}
+
 void Backend::abortInitialization()
 {
     /*if (ipcState_ != IPC_CONNECTING)
@@ -825,7 +878,6 @@ void Backend::cycleMacAddress()
 void Backend::sendDetectPacketSize()
 {
     IPC::ProtobufCommand<IPCClientCommands::DetectPacketSize> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -833,7 +885,6 @@ void Backend::sendSplitTunneling(ProtoTypes::SplitTunneling st)
 {
     IPC::ProtobufCommand<IPCClientCommands::SplitTunneling> cmd;
     *cmd.getProtoObj().mutable_split_tunneling() = st;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
     Q_EMIT splitTunnelingStateChanged(st.settings().active());
 }
@@ -843,7 +894,6 @@ void Backend::sendUpdateWindowInfo(qint32 mainWindowCenterX, qint32 mainWindowCe
     IPC::ProtobufCommand<IPCClientCommands::UpdateWindowInfo> cmd;
     cmd.getProtoObj().set_window_center_x(mainWindowCenterX);
     cmd.getProtoObj().set_window_center_y(mainWindowCenterY);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -851,7 +901,6 @@ void Backend::sendUpdateVersion(qint32 mainWindowHandle)
 {
     IPC::ProtobufCommand<IPCClientCommands::UpdateVersion> cmd;
     cmd.getProtoObj().set_hwnd(mainWindowHandle);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -859,14 +908,12 @@ void Backend::cancelUpdateVersion()
 {
     IPC::ProtobufCommand<IPCClientCommands::UpdateVersion> cmd;
     cmd.getProtoObj().set_cancel_download(true);
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
 void Backend::sendMakeHostsFilesWritableWin()
 {
     IPC::ProtobufCommand<IPCClientCommands::MakeHostsWritableWin> cmd;
-    qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
     engineServer_->sendCommand(&cmd);
 }
 
@@ -891,6 +938,22 @@ QString Backend::generateNewFriendlyName()
     return newFriendlyName;
 }
 
+void Backend::onLocationsUpdateApplied()
+{
+    Q_ASSERT(pendingLocationsUpdates_ > 0);
+    if (--pendingLocationsUpdates_ > 0)
+    {
+        return;
+    }
+    // newer than the pings of the updates applied
+    const QHash<LocationID, PingTime> speeds = pendingLocationSpeeds_;
+    pendingLocationSpeeds_.clear();
+    for (auto it = speeds.constBegin(); it != speeds.constEnd(); ++it)
+    {
+        locationsModel_->changeConnectionSpeed(it.key(), it.value());
+    }
+}
+
 void Backend::updateAccountInfo()
 {
     accountInfo_.setEmail(QString::fromStdString(latestSessionStatus_.email()));
@@ -16,6 +16,7 @@
 #include "preferences/accountinfo.h"
 #include "connectstatehelper.h"
 #include "firewallstatehelper.h"
+#include "utils/guiworkscheduler.h"
 //#include "engine/engineserver.h"
 
 class EngineServer;
@@ -111,6 +112,12 @@ public:
 
 private slots:
     void onConnectionNewCommand(IPC::Command *command);
+    void onEngineConnectStateChanged(const ProtoTypes::ConnectState &connectState);
+    void onEngineFirewallStateChanged(bool isEnabled);
+    void onEngineLocationSpeedChanged(const LocationID &id, PingTime timeMs);
+    void onEngineLocationsUpdated(const locationsmodel::LocationsDelta &delta);
+    void onEngineCustomConfigLocationsUpdated(locationsmodel::LocationsSnapshot locations);
+    void onEngineTrafficStatisticsUpdated(const IPCServerCommands::TrafficStatisticsBatch &batch);
 
 signals:
     // emited when connected to engine and received the engine settings, or error in initState variable
@@ -178,6 +185,17 @@ private:
 
     LocationsModel *locationsModel_;
 
+    // large payloads from the engine are applied in small steps, between the user input and paint events
+    GuiWorkScheduler workScheduler_;
+    // the pings which came while a locations update was queued, applied after it so they aren't reverted
+    int pendingLocationsUpdates_;
+    QHash<LocationID, PingTime> pendingLocationSpeeds_;
+    // set from a delta which didn't match the version until the full snapshot comes, the deltas queued meanwhile
+    // are dropped
+    bool isLocationsSnapshotRequested_;
+    // the first traffic batch of the subscription carries the totals of the session only
+    bool isFirstTrafficStatisticsBatch_;
+
     bool isFirewallEnabled_;
 
     PreferencesHelper preferencesHelper_;
@@ -191,6 +209,7 @@ private:
 
     QString generateNewFriendlyName();
     void updateAccountInfo();
+    void onLocationsUpdateApplied();
     void getOpenVpnVersionsFromInitCommand(const IPCServerCommands::InitFinished &state);
 };
 
@@ -1,5 +1,7 @@
 #include "alllocationsmodel.h"
 
+#include <QHash>
+
 
 AllLocationsModel::AllLocationsModel(QObject *parent) : BasicLocationsModel(parent)
 {
@@ -7,7 +9,16 @@ AllLocationsModel::AllLocationsModel(QObject *parent) : BasicLocationsModel(pare
 
 void AllLocationsModel::update(QVector<QSharedPointer<LocationModelItem> > locations)
 {
-    clearLocations();
+    // keep the items which did not change, so the views can keep their widgets for them
+    QHash<LocationID, LocationModelItem *> prevLocations;
+    for (LocationModelItem *lmi : qAsConst(locations_))
+    {
+        prevLocations.insert(lmi->id, lmi);
+    }
+
+    const QVector<LocationModelItem *> prevOrder = locations_;
+    locations_.clear();
+    bool isChanged = false;
 
     for (QSharedPointer<LocationModelItem> lmi : qAsConst(locations))
     {
@@ -21,12 +32,26 @@ void AllLocationsModel::update(QVector<QSharedPointer<LocationModelItem> > locat
             continue;
         }
 
+        LocationModelItem *prev = prevLocations.take(lmi->id);
+        if (prev != nullptr && *prev == *lmi)
+        {
+            locations_ << prev;
+            continue;
+        }
+        delete prev;
+        isChanged = true;
+
         LocationModelItem *nlmi = new LocationModelItem();
         *nlmi = *lmi;
         locations_ << nlmi;
     }
 
+    isChanged = isChanged || !prevLocations.isEmpty();
+    qDeleteAll(prevLocations);
 
     sort();
-    emit itemsUpdated(locations_);
+    if (isChanged || locations_ != prevOrder)
+    {
+        emit itemsUpdated(locations_);
+    }
 }
@@ -21,7 +21,7 @@ void FavoriteLocationsStorage::removeFromFavorites(const LocationID &locationId)
     }
 }
 
-bool FavoriteLocationsStorage::isFavorite(const LocationID &locationId)
+bool FavoriteLocationsStorage::isFavorite(const LocationID &locationId) const
 {
     return favoriteLocations_.find(locationId) != favoriteLocations_.end();
 }
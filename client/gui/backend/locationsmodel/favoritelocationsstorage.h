@@ -12,7 +12,7 @@ public:
 
     void addToFavorites(const LocationID &locationId);
     void removeFromFavorites(const LocationID &locationId);
-    bool isFavorite(const LocationID &locationId);
+    bool isFavorite(const LocationID &locationId) const;
     int size() const;
 
     void readFromSettings();
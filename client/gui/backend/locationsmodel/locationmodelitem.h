@@ -45,6 +45,18 @@ struct CityModelItem
             return city + " - " + nick;
         }
     }
+
+    // compares the displayed data, initialInd_ is not taken into account
+    bool operator==(const CityModelItem &other) const
+    {
+        return id == other.id && city == other.city && nick == other.nick && countryCode == other.countryCode &&
+               pingTimeMs.toInt() == other.pingTimeMs.toInt() && bShowPremiumStarOnly == other.bShowPremiumStarOnly &&
+               isFavorite == other.isFavorite && staticIpCountryCode == other.staticIpCountryCode &&
+               staticIpType == other.staticIpType && staticIp == other.staticIp && isDisabled == other.isDisabled &&
+               isCustomConfigCorrect == other.isCustomConfigCorrect && customConfigType == other.customConfigType &&
+               customConfigErrorMessage == other.customConfigErrorMessage &&
+               linkSpeed == other.linkSpeed && locationLoad == other.locationLoad;
+    }
 };
 
 struct LocationModelItem
@@ -59,6 +71,12 @@ struct LocationModelItem
     int locationLoad;
     QVector<CityModelItem> cities;
 
+    bool operator==(const LocationModelItem &other) const
+    {
+        return initialInd_ == other.initialInd_ && id == other.id && title == other.title && countryCode == other.countryCode &&
+               isShowP2P == other.isShowP2P && isPremiumOnly == other.isPremiumOnly && is10gbps == other.is10gbps &&
+               locationLoad == other.locationLoad && cities == other.cities;
+    }
 
     qint32 calcAveragePing() const
     {
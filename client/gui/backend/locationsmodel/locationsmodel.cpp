@@ -12,7 +12,7 @@
 
 
 LocationsModel::LocationsModel(QObject *parent) : QObject(parent),
-    numStaticIPLocations_(0), numStaticIPLocationCities_(0)
+    apiLocationsVersion_(0), numStaticIPLocations_(0), numStaticIPLocationCities_(0)
 {
     favoriteLocationsStorage_.readFromSettings();
     allLocations_ = new AllLocationsModel(this);
@@ -26,102 +26,86 @@ LocationsModel::~LocationsModel()
     favoriteLocationsStorage_.writeToSettings();
 }
 
-void LocationsModel::updateApiLocations(const ProtoTypes::LocationId &bestLocation, const QString &staticIpDeviceName,
-                                        const ProtoTypes::ArrayLocations &locations)
+bool LocationsModel::updateApiLocations(const locationsmodel::LocationsDelta &delta,
+                                        const QVector< QSharedPointer<LocationModelItem> > &changedItems)
 {
+    if (!delta.isFullSnapshot && delta.baseVersion != apiLocationsVersion_)
+    {
+        return false;
+    }
+    Q_ASSERT(changedItems.size() == delta.changedLocations.size());
+
+    // only the added and changed locations are converted, the rest of the items are kept as is
+    if (delta.isFullSnapshot)
+    {
+        apiLocationsById_.clear();
+    }
+    for (const LocationID &id : delta.removedLocations)
+    {
+        apiLocationsById_.remove(id);
+    }
+    for (const QSharedPointer<LocationModelItem> &lmi : changedItems)
+    {
+        // favorites could be switched after the item was made
+        for (CityModelItem &cmi : lmi->cities)
+        {
+            cmi.isFavorite = favoriteLocationsStorage_.isFavorite(cmi.id);
+        }
+        apiLocationsById_.insert(lmi->id, lmi);
+    }
+    apiLocationsVersion_ = delta.version;
+
     apiLocations_.clear();
+    apiLocations_.reserve(delta.order.size() + 1);
 
     bool isBestLocationInserted = false;
-    bestLocationId_ = LocationID::createFromProtoBuf(bestLocation);
+    bestLocationId_ = delta.bestLocation;
     numStaticIPLocations_ = numStaticIPLocationCities_ = 0;
 
-    int cnt = locations.locations_size();
+    int cnt = delta.order.size();
     for (int i = 0; i < cnt; ++i)
     {
-        const ProtoTypes::Location &location = locations.locations(i);
-
-        QSharedPointer<LocationModelItem> lmi(new LocationModelItem());
+        QSharedPointer<LocationModelItem> lmi = apiLocationsById_.value(delta.order[i]);
+        if (lmi.isNull())
+        {
+            Q_ASSERT(false);
+            continue;
+        }
         lmi->initialInd_ = i;
-        lmi->id = LocationID::createFromProtoBuf(location.id());
-        lmi->title = QString::fromStdString(location.name());
-        lmi->isShowP2P = location.is_p2p_supported();
-        lmi->countryCode = QString::fromStdString(location.country_code()).toLower();
-        lmi->isPremiumOnly = location.is_premium_only();
-        lmi->is10gbps = false;
 
-        qreal locationLoadSum = 0.0;
-        int locationLoadCount = 0;
-
-        for (int c = 0; c < location.cities_size(); ++c)
+        // if this is the best location then insert it to top list
+        if (!isBestLocationInserted && !lmi->id.isStaticIpsLocation() && !lmi->id.isCustomConfigsLocation())
         {
-            const ProtoTypes::City &city = location.cities(c);
-            CityModelItem cmi;
-            cmi.id = LocationID::createFromProtoBuf(city.id());
-            cmi.city = QString::fromStdString(city.name());
-            cmi.nick = QString::fromStdString(city.nick());
-            cmi.countryCode = lmi->id.isStaticIpsLocation() ? QString::fromStdString(city.static_ip_country_code()) : lmi->countryCode;
-            cmi.pingTimeMs = city.ping_time();
-            cmi.bShowPremiumStarOnly = city.is_premium_only();
-            cmi.isFavorite = favoriteLocationsStorage_.isFavorite(cmi.id);
-            cmi.isDisabled = city.is_disabled();
-            cmi.staticIpCountryCode = QString::fromStdString(city.static_ip_country_code());
-            cmi.staticIpType = QString::fromStdString(city.static_ip_type());
-            cmi.staticIp = QString::fromStdString(city.static_ip());
-            cmi.linkSpeed = city.link_speed();
-
-            // Engine is using -1 to indicate to us that the load (health) value was invalid/missing,
-            // and therefore this location should be excluded when calculating the region's average
-            // load value.
-            cmi.locationLoad = city.health();
-            if (cmi.locationLoad >= 0 && cmi.locationLoad <= 100)
-            {
-                locationLoadSum += cmi.locationLoad;
-                locationLoadCount += 1;
-            }
-            else {
-                cmi.locationLoad = 0;
-            }
-
-            lmi->cities << cmi;
-
-            // if this is the best location then insert it to top list
-            if (!isBestLocationInserted && !lmi->id.isStaticIpsLocation() && !lmi->id.isCustomConfigsLocation() && cmi.id.apiLocationToBestLocation() == bestLocationId_)
+            for (const CityModelItem &cmi : qAsConst(lmi->cities))
             {
-                QSharedPointer<LocationModelItem> lmiBestLocation(new LocationModelItem());
-                lmiBestLocation->initialInd_ = lmi->initialInd_;
-                lmiBestLocation->id = bestLocationId_;
-                lmiBestLocation->title = tr("Best Location");
-                lmiBestLocation->countryCode = lmi->countryCode;
-                lmiBestLocation->isShowP2P = lmi->isShowP2P;
-                lmiBestLocation->isPremiumOnly = lmi->isPremiumOnly;
-                lmiBestLocation->is10gbps = (city.link_speed() == 10000);
-                lmiBestLocation->locationLoad = cmi.locationLoad;
-
-                apiLocations_.insert(0, lmiBestLocation);
-                isBestLocationInserted = true;
+                if (cmi.id.apiLocationToBestLocation() == bestLocationId_)
+                {
+                    QSharedPointer<LocationModelItem> lmiBestLocation(new LocationModelItem());
+                    lmiBestLocation->initialInd_ = lmi->initialInd_;
+                    lmiBestLocation->id = bestLocationId_;
+                    lmiBestLocation->title = tr("Best Location");
+                    lmiBestLocation->countryCode = lmi->countryCode;
+                    lmiBestLocation->isShowP2P = lmi->isShowP2P;
+                    lmiBestLocation->isPremiumOnly = lmi->isPremiumOnly;
+                    lmiBestLocation->is10gbps = (cmi.linkSpeed == 10000);
+                    lmiBestLocation->locationLoad = cmi.locationLoad;
+
+                    apiLocations_.insert(0, lmiBestLocation);
+                    isBestLocationInserted = true;
+                    break;
+                }
             }
         }
 
-        if (locationLoadCount > 0) {
-            lmi->locationLoad = qRound(locationLoadSum / locationLoadCount);
-        }
-        else {
-            lmi->locationLoad = 0;
-        }
-
         if (lmi->id.isStaticIpsLocation()) {
             ++numStaticIPLocations_;
             numStaticIPLocationCities_ += lmi->cities.count();
         }
 
-        // sort cities alphabetically
-        std::sort(lmi->cities.begin(), lmi->cities.end(), SortLocationsAlgorithms::lessThanByAlphabeticallyCityItem);
-
         apiLocations_ << lmi;
-
     }
 
-    emit deviceNameChanged(staticIpDeviceName);
+    emit deviceNameChanged(delta.staticIpDeviceName);
 
 
     allLocations_->update(apiLocations_);
@@ -129,6 +113,68 @@ void LocationsModel::updateApiLocations(const ProtoTypes::LocationId &bestLocati
     favoriteLocations_->update(apiLocations_);
 
     emit bestLocationChanged(bestLocationId_);
+    return true;
+}
+
+QSharedPointer<LocationModelItem> LocationsModel::makeLocationModelItem(const locationsmodel::LocationItem &location) const
+{
+    // the strings are implicitly shared with the engine snapshot, only the GUI-specific fields are computed here
+    QSharedPointer<LocationModelItem> lmi(new LocationModelItem());
+    lmi->initialInd_ = 0;
+    lmi->id = location.id;
+    lmi->title = location.name;
+    lmi->isShowP2P = (location.p2p == 0);
+    lmi->countryCode = location.countryCode.toLower();
+    lmi->isPremiumOnly = location.isPremiumOnly;
+    lmi->is10gbps = false;
+    lmi->cities.reserve(location.cities.size());
+
+    qreal locationLoadSum = 0.0;
+    int locationLoadCount = 0;
+
+    for (const locationsmodel::CityItem &city : location.cities)
+    {
+        CityModelItem cmi;
+        cmi.id = city.id;
+        cmi.city = city.city;
+        cmi.nick = city.nick;
+        cmi.countryCode = lmi->id.isStaticIpsLocation() ? city.staticIpCountryCode : lmi->countryCode;
+        cmi.pingTimeMs = city.pingTimeMs;
+        cmi.bShowPremiumStarOnly = city.isPro;
+        cmi.isFavorite = favoriteLocationsStorage_.isFavorite(cmi.id);
+        cmi.isDisabled = city.isDisabled;
+        cmi.staticIpCountryCode = city.staticIpCountryCode;
+        cmi.staticIpType = city.staticIpType;
+        cmi.staticIp = city.staticIp;
+        cmi.linkSpeed = city.link_speed;
+
+        // Engine is using -1 to indicate to us that the load (health) value was invalid/missing,
+        // and therefore this location should be excluded when calculating the region's average
+        // load value.
+        cmi.locationLoad = city.health;
+        if (cmi.locationLoad >= 0 && cmi.locationLoad <= 100)
+        {
+            locationLoadSum += cmi.locationLoad;
+            locationLoadCount += 1;
+        }
+        else {
+            cmi.locationLoad = 0;
+        }
+
+        lmi->cities << cmi;
+    }
+
+    if (locationLoadCount > 0) {
+        lmi->locationLoad = qRound(locationLoadSum / locationLoadCount);
+    }
+    else {
+        lmi->locationLoad = 0;
+    }
+
+    // sort cities alphabetically
+    std::sort(lmi->cities.begin(), lmi->cities.end(), SortLocationsAlgorithms::lessThanByAlphabeticallyCityItem);
+
+    return lmi;
 }
 
 void LocationsModel::updateBestLocation(const ProtoTypes::LocationId &bestLocation)
@@ -173,54 +219,54 @@ void LocationsModel::updateBestLocation(const ProtoTypes::LocationId &bestLocati
     }
 }
 
-void LocationsModel::updateCustomConfigLocations(const ProtoTypes::ArrayLocations &locations)
+void LocationsModel::updateCustomConfigLocations(const QVector<locationsmodel::LocationItem> &locations)
 {
     customConfigLocations_.clear();
+    customConfigLocations_.reserve(locations.size());
 
-    int cnt = locations.locations_size();
+    int cnt = locations.size();
     for (int i = 0; i < cnt; ++i)
     {
-        const ProtoTypes::Location &location = locations.locations(i);
+        const locationsmodel::LocationItem &location = locations[i];
 
         QSharedPointer<LocationModelItem> lmi(new LocationModelItem());
         lmi->initialInd_ = i;
-        lmi->id = LocationID::createFromProtoBuf(location.id());
-        lmi->title = QString::fromStdString(location.name());
-        lmi->isShowP2P = location.is_p2p_supported();
-        lmi->countryCode = QString::fromStdString(location.country_code()).toLower();
-        lmi->isPremiumOnly = location.is_premium_only();
+        lmi->id = location.id;
+        lmi->title = location.name;
+        lmi->isShowP2P = (location.p2p == 0);
+        lmi->countryCode = location.countryCode.toLower();
+        lmi->isPremiumOnly = location.isPremiumOnly;
         lmi->is10gbps = false;
         lmi->locationLoad = 0;
+        lmi->cities.reserve(location.cities.size());
 
-        int cities_cnt = location.cities_size();
-        for (int c = 0; c < cities_cnt; ++c)
+        for (const locationsmodel::CityItem &city : location.cities)
         {
-            const ProtoTypes::City &city = location.cities(c);
             CityModelItem cmi;
-            cmi.id = LocationID::createFromProtoBuf(city.id());
-            cmi.city = QString::fromStdString(city.name());
-            cmi.nick = QString::fromStdString(city.nick());
-            cmi.countryCode = lmi->id.isStaticIpsLocation() ? QString::fromStdString(city.static_ip_country_code()) : lmi->countryCode;
-            cmi.pingTimeMs = city.ping_time();
-            cmi.bShowPremiumStarOnly = city.is_premium_only();
+            cmi.id = city.id;
+            cmi.city = city.city;
+            cmi.nick = city.nick;
+            cmi.countryCode = lmi->id.isStaticIpsLocation() ? city.staticIpCountryCode : lmi->countryCode;
+            cmi.pingTimeMs = city.pingTimeMs;
+            cmi.bShowPremiumStarOnly = city.isPro;
             cmi.isFavorite = favoriteLocationsStorage_.isFavorite(cmi.id);
-            cmi.isDisabled = city.is_disabled();
-            cmi.staticIpCountryCode = QString::fromStdString(city.static_ip_country_code());
-            cmi.staticIpType = QString::fromStdString(city.static_ip_type());
-            cmi.staticIp = QString::fromStdString(city.static_ip());
-            cmi.isCustomConfigCorrect = city.custom_config_is_correct();
-            switch (city.custom_config_type()) {
-            case ProtoTypes::CustomConfigType::CUSTOM_CONFIG_OPENVPN:
+            cmi.isDisabled = city.isDisabled;
+            cmi.staticIpCountryCode = city.staticIpCountryCode;
+            cmi.staticIpType = city.staticIpType;
+            cmi.staticIp = city.staticIp;
+            cmi.isCustomConfigCorrect = city.customConfigIsCorrect;
+            switch (city.customConfigType) {
+            case customconfigs::CUSTOM_CONFIG_OPENVPN:
                 cmi.customConfigType = "ovpn";
                 break;
-            case ProtoTypes::CustomConfigType::CUSTOM_CONFIG_WIREGUARD:
+            case customconfigs::CUSTOM_CONFIG_WIREGUARD:
                 cmi.customConfigType = "wg";
                 break;
             default:
                 Q_ASSERT(false);
                 break;
             }
-            cmi.customConfigErrorMessage = QString::fromStdString(city.custom_config_error_message());
+            cmi.customConfigErrorMessage = city.customConfigErrorMessage;
             cmi.linkSpeed = 0;
             cmi.locationLoad = 0;
             lmi->cities << cmi;
@@ -277,6 +323,19 @@ void LocationsModel::switchFavorite(const LocationID &id, bool isFavorite)
     {
         favoriteLocationsStorage_.removeFromFavorites(id);
     }
+
+    // keep the cached items in sync, they are reused by the next locations delta
+    for (auto lmi : qAsConst(apiLocations_))
+    {
+        for (auto &cmi : lmi->cities)
+        {
+            if (cmi.id == id)
+            {
+                cmi.isFavorite = isFavorite;
+            }
+        }
+    }
+
     allLocations_->setIsFavorite(id, isFavorite);
     configuredLocations_->setIsFavorite(id, isFavorite);
     staticIpsLocations_->setIsFavorite(id, isFavorite);
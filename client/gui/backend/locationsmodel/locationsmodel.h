@@ -6,6 +6,7 @@
 #include "basiccitiesmodel.h"
 #include "favoritelocationsstorage.h"
 #include "ipc/protobufcommand.h"
+#include "engine/locationsmodel/locationsdelta.h"
 
 class LocationsModel : public QObject
 {
@@ -24,10 +25,15 @@ public:
     explicit LocationsModel(QObject *parent = nullptr);
     virtual ~LocationsModel();
 
-    void updateApiLocations(const ProtoTypes::LocationId &bestLocation, const QString &staticIpDeviceName,
-                            const ProtoTypes::ArrayLocations &locations);
+    // Applies a locations delta from the engine in place; returns false if the delta doesn't match
+    // the current version, in which case a full snapshot must be requested.
+    // changedItems are the delta's changedLocations converted with makeLocationModelItem(), this
+    // can be done beforehand in small steps.
+    bool updateApiLocations(const locationsmodel::LocationsDelta &delta,
+                            const QVector< QSharedPointer<LocationModelItem> > &changedItems);
+    QSharedPointer<LocationModelItem> makeLocationModelItem(const locationsmodel::LocationItem &location) const;
     void updateBestLocation(const ProtoTypes::LocationId &bestLocation);
-    void updateCustomConfigLocations(const ProtoTypes::ArrayLocations &locations);
+    void updateCustomConfigLocations(const QVector<locationsmodel::LocationItem> &locations);
 
     BasicLocationsModel *getAllLocationsModel();
     BasicCitiesModel *getConfiguredLocationsModel();
@@ -75,6 +81,8 @@ private:
 
     ProtoTypes::OrderLocationType orderLocationsType_;
     QVector< QSharedPointer<LocationModelItem> > apiLocations_;
+    QHash<LocationID, QSharedPointer<LocationModelItem> > apiLocationsById_;    // without the best location item
+    quint64 apiLocationsVersion_;
     LocationID bestLocationId_;
     QVector< QSharedPointer<LocationModelItem> > customConfigLocations_;
     int numStaticIPLocations_;
@@ -147,6 +147,7 @@ SOURCES += $$PWD/backend/backend.cpp \
     $$PWD/tooltips/tooltipcontroller.cpp \
     $$PWD/tooltips/tooltipdescriptive.cpp \
     $$PWD/tooltips/tooltiputil.cpp \
+    $$PWD/utils/guiworkscheduler.cpp \
     $$PWD/utils/imagewithshadow.cpp \
     $$PWD/utils/protoenumtostring.cpp \
     $$PWD/commonwidgets/custommenuwidget.cpp \
@@ -373,6 +374,7 @@ HEADERS += $$PWD/backend/backend.h \
     $$PWD/tooltips/tooltiputil.h \
     $$PWD/utils/authcheckerfactory.h \
     $$PWD/utils/iauthchecker.h \
+    $$PWD/utils/guiworkscheduler.h \
     $$PWD/utils/imagewithshadow.h \
     $$PWD/utils/protoenumtostring.h \
     $$PWD/commonwidgets/custommenuwidget.h \
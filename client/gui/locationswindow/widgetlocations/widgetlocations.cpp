@@ -524,6 +524,7 @@ void WidgetLocations::onConnectionSpeedChanged(LocationID id, PingTime timeMs)
             break;
         }
     }
+    widgetLocationsList_->updateCityPing(id, timeMs);
 }
 
 void WidgetLocations::onIsFavoriteChanged(LocationID id, bool isFavorite)
@@ -538,6 +539,7 @@ void WidgetLocations::onIsFavoriteChanged(LocationID id, bool isFavorite)
             break;
         }
     }
+    widgetLocationsList_->updateCityFavorite(id, isFavorite);
 }
 
 void WidgetLocations::onFreeSessionStatusChanged(bool isFreeSessionStatus)
@@ -659,18 +661,13 @@ void WidgetLocations::updateWidgetList(QVector<LocationModelItem *> items)
     LocationID lastAccentedLocationId = widgetLocationsList_->lastAccentedLocationId();
 
     //qCDebug(LOG_LOCATION_LIST) << name_ << " caching previous display state ";
-    widgetLocationsList_->clearWidgets();
+    widgetLocationsList_->beginUpdate();
     for (LocationModelItem *item: qAsConst(items))
     {
         if (item->title.contains(filterString_, Qt::CaseInsensitive))
         {
-            // add item and all children to list
-            widgetLocationsList_->addRegionWidget(item);
-
-            for (const CityModelItem &cityItem: qAsConst(item->cities))
-            {
-                widgetLocationsList_->addCityToRegion(cityItem, item);
-            }
+            // add item and all children to list, the widget of an unchanged region is reused
+            widgetLocationsList_->addRegionWidgetWithCities(item);
         }
         else
         {
@@ -684,6 +681,7 @@ void WidgetLocations::updateWidgetList(QVector<LocationModelItem *> items)
             }
         }
     }
+    widgetLocationsList_->endUpdate();
     // qCDebug(LOG_LOCATION_LIST) << name_ << " restoring display state";
 
     // restoring previous widget state
@@ -13,6 +13,7 @@ namespace GuiLocations {
 WidgetLocationsList::WidgetLocationsList(IWidgetLocationsInfo * widgetLocationsInfo, QWidget *parent) : QWidget(parent)
   , height_(0)
   , lastAccentedItemWidget_(nullptr)
+  , isUpdating_(false)
   , widgetLocationsInfo_(widgetLocationsInfo)
 {
     setFocusPolicy(Qt::NoFocus);
@@ -32,12 +33,72 @@ void WidgetLocationsList::clearWidgets()
     recentlyAccentedWidgets_.clear();
     for (auto *regionWidget : qAsConst(itemWidgets_))
     {
-        regionWidget->disconnect();
-        regionWidget->deleteLater();
+        deleteRegionWidget(regionWidget);
     }
     itemWidgets_.clear();
 }
 
+void WidgetLocationsList::beginUpdate()
+{
+    isUpdating_ = true;
+    lastAccentedItemWidget_ = nullptr;
+    recentlyAccentedWidgets_.clear();
+    for (auto *regionWidget : qAsConst(itemWidgets_))
+    {
+        unusedWidgets_.insert(regionWidget->getId(), regionWidget);
+    }
+    itemWidgets_.clear();
+}
+
+void WidgetLocationsList::addRegionWidgetWithCities(LocationModelItem *item)
+{
+    ItemWidgetRegion *regionWidget = unusedWidgets_.value(item->id, nullptr);
+    if (regionWidget != nullptr)
+    {
+        auto it = completeRegionItems_.constFind(regionWidget);
+        if (it != completeRegionItems_.constEnd() && it.value() == *item)
+        {
+            unusedWidgets_.remove(item->id);
+            itemWidgets_.append(regionWidget);
+            return;
+        }
+    }
+
+    addRegionWidget(item);
+    for (const CityModelItem &city : qAsConst(item->cities))
+    {
+        itemWidgets_.last()->addCity(city);
+    }
+    completeRegionItems_.insert(itemWidgets_.last(), *item);
+}
+
+void WidgetLocationsList::endUpdate()
+{
+    for (auto *regionWidget : qAsConst(unusedWidgets_))
+    {
+        deleteRegionWidget(regionWidget);
+    }
+    unusedWidgets_.clear();
+    isUpdating_ = false;
+    recalcItemPositions();
+}
+
+void WidgetLocationsList::updateCityPing(LocationID id, PingTime timeMs)
+{
+    if (CityModelItem *city = completeCityItem(id))
+    {
+        city->pingTimeMs = timeMs;
+    }
+}
+
+void WidgetLocationsList::updateCityFavorite(LocationID id, bool isFavorite)
+{
+    if (CityModelItem *city = completeCityItem(id))
+    {
+        city->isFavorite = isFavorite;
+    }
+}
+
 void WidgetLocationsList::addRegionWidget(LocationModelItem *item)
 {
     auto regionWidget = new ItemWidgetRegion(widgetLocationsInfo_, item, this);
@@ -476,6 +537,11 @@ void WidgetLocationsList::onSelectableLocationItemAccented(IItemWidget *itemWidg
 
 void WidgetLocationsList::recalcItemPositions()
 {
+    // a batch of regions is positioned once by endUpdate()
+    if (isUpdating_)
+    {
+        return;
+    }
     // qDebug() << "List repositioning items";
     int heightSoFar = 0;
     for (auto *itemWidget : qAsConst(itemWidgets_))
@@ -491,4 +557,30 @@ void WidgetLocationsList::recalcItemPositions()
     }
 }
 
+CityModelItem *WidgetLocationsList::completeCityItem(LocationID id)
+{
+    for (auto it = completeRegionItems_.begin(); it != completeRegionItems_.end(); ++it)
+    {
+        if (it.key()->getId().toTopLevelLocation() != id.toTopLevelLocation())
+        {
+            continue;
+        }
+        for (CityModelItem &city : it.value().cities)
+        {
+            if (city.id == id)
+            {
+                return &city;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void WidgetLocationsList::deleteRegionWidget(ItemWidgetRegion *regionWidget)
+{
+    completeRegionItems_.remove(regionWidget);
+    regionWidget->disconnect();
+    regionWidget->deleteLater();
+}
+
 } // namespace
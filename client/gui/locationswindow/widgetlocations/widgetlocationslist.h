@@ -1,6 +1,7 @@
 #ifndef LOCATIONITEMLISTWIDGET_H
 #define LOCATIONITEMLISTWIDGET_H
 
+#include <QHash>
 #include <QWidget>
 #include "itemwidgetregion.h"
 #include "cursorupdatehelper.h"
@@ -19,6 +20,18 @@ public:
 
     void addCityToRegion(const CityModelItem &city, LocationModelItem *region);
 
+    // Rebuilding the list while keeping the widgets of unchanged regions (with their expanded state):
+    // beginUpdate() sets the current widgets aside, addRegionWidgetWithCities() takes one back if it was
+    // built from an equal item, endUpdate() deletes the widgets that were not taken back and positions the
+    // items once for the whole batch.
+    void beginUpdate();
+    void addRegionWidgetWithCities(LocationModelItem *item);
+    void endUpdate();
+
+    // keep the items the regions were built from in step with the pings and favorites set on their widgets
+    void updateCityPing(LocationID id, PingTime timeMs);
+    void updateCityFavorite(LocationID id, bool isFavorite);
+
     void updateScaling();
     void accentWidgetContainingCursor();
     void selectWidgetContainingGlobalPt(const QPoint &pt);
@@ -75,9 +88,15 @@ private:
     IItemWidget *lastAccentedItemWidget_;
     QVector<IItemWidget *> recentlyAccentedWidgets_;
 
+    QHash<LocationID, ItemWidgetRegion *> unusedWidgets_;           // valid between beginUpdate() and endUpdate()
+    bool isUpdating_;                                                // between beginUpdate() and endUpdate()
+    QHash<ItemWidgetRegion *, LocationModelItem> completeRegionItems_;   // items of the regions built with all their cities
+
     IWidgetLocationsInfo *widgetLocationsInfo_; // deleted elsewhere
 
     void recalcItemPositions();
+    CityModelItem *completeCityItem(LocationID id);
+    void deleteRegionWidget(ItemWidgetRegion *regionWidget);
     void updateCursorWithSelectableWidget(IItemWidget *widget);
 
     void safeEmitLocationIdSelected(IItemWidget *widget);
@@ -92,17 +92,16 @@ void LogViewerWindow::onExportClick()
     QString fileName = QFileDialog::getSaveFileName(this, tr("Save log"), QString(), tr("Text files (*.txt)"));
     if (!fileName.isEmpty())
     {
-        QString log = MergeLog::mergePrevLogs(true);
-        log += "================================================================================================================================================================================================\n";
-        log += "================================================================================================================================================================================================\n";
-        log += MergeLog::mergeLogs(true);
-
+        // the logs are merged straight into the file, they are never held in memory as a whole
         QFile file(fileName);
-        if (file.open(QIODevice::WriteOnly))
+        bool isSuccess = file.open(QIODevice::WriteOnly) && MergeLog::mergePrevLogsTo(&file, true);
+        if (isSuccess)
         {
-            file.write(log.toLocal8Bit());
+            file.write("================================================================================================================================================================================================\n");
+            file.write("================================================================================================================================================================================================\n");
+            isSuccess = MergeLog::mergeLogsTo(&file, true);
         }
-        else
+        if (!isSuccess)
         {
             QMessageBox::information(this, "Export log", "Failed to export log");
         }
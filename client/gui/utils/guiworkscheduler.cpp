@@ -0,0 +1,147 @@
+#include "guiworkscheduler.h"
+#include "utils/logger.h"
+
+GuiWorkScheduler::GuiWorkScheduler(QObject *parent, int sliceMs) : QObject(parent),
+    sliceMs_(sliceMs), slicesCount_(0), maxEventLoopLatencyUs_(0), nextTaskId_(0)
+{
+    timer_.setSingleShot(true);
+    timer_.setInterval(0);
+    connect(&timer_, SIGNAL(timeout()), SLOT(onRunSlice()));
+}
+
+void GuiWorkScheduler::post(const QString &name, PRIORITY priority, TaskStep step)
+{
+    Q_ASSERT(priority >= PRIORITY_NORMAL && priority < PRIORITY_COUNT);
+    Task task;
+    task.id = nextTaskId_++;
+    task.name = name;
+    task.step = step;
+    task.slices = 0;
+    task.runTimeUs = 0;
+    task.maxSliceUs = 0;
+    task.lastSlice = -1;
+    queues_[priority].enqueue(task);
+    scheduleSlice();
+}
+
+bool GuiWorkScheduler::isIdle() const
+{
+    for (int i = 0; i < PRIORITY_COUNT; ++i)
+    {
+        if (!queues_[i].isEmpty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GuiWorkScheduler::onRunSlice()
+{
+    // how long the slice waited behind the other events, i.e. how busy the event loop is
+    const qint64 latencyUs = sinceScheduled_.nsecsElapsed() / 1000;
+    if (latencyUs > maxEventLoopLatencyUs_)
+    {
+        maxEventLoopLatencyUs_ = latencyUs;
+    }
+    slicesCount_++;
+
+    QElapsedTimer sliceTimer;
+    sliceTimer.start();
+
+    // a higher priority task posted from a step is picked up on the next iteration
+    while (sliceTimer.elapsed() < sliceMs_)
+    {
+        Task *task = nextTask();
+        if (task == nullptr)
+        {
+            break;
+        }
+
+        // copy the step, it may post new tasks and so reallocate the queue
+        const quint64 taskId = task->id;
+        TaskStep step = task->step;
+
+        QElapsedTimer stepTimer;
+        stepTimer.start();
+        const bool isFinished = step();
+        const qint64 stepUs = stepTimer.nsecsElapsed() / 1000;
+
+        task = findTask(taskId);
+        Q_ASSERT(task != nullptr);
+        task->runTimeUs += stepUs;
+        if (task->lastSlice != static_cast<int>(slicesCount_))
+        {
+            task->lastSlice = static_cast<int>(slicesCount_);
+            task->slices++;
+        }
+        if (stepUs > task->maxSliceUs)
+        {
+            task->maxSliceUs = stepUs;
+        }
+
+        if (isFinished)
+        {
+            // only a task whose step held the event loop for longer than a slice is worth a line in the log
+            if (task->maxSliceUs > sliceMs_ * 1000)
+            {
+                qCDebug(LOG_BASIC) << "GUI task" << task->name << "finished:" << task->slices << "slices,"
+                                   << task->runTimeUs / 1000.0 << "ms total, longest step" << task->maxSliceUs / 1000.0
+                                   << "ms, worst event loop latency" << maxEventLoopLatencyUs_ / 1000.0 << "ms";
+            }
+            dropTask(taskId);
+        }
+    }
+
+    if (!isIdle())
+    {
+        scheduleSlice();
+    }
+}
+
+void GuiWorkScheduler::scheduleSlice()
+{
+    if (!timer_.isActive())
+    {
+        sinceScheduled_.start();
+        timer_.start();
+    }
+}
+
+GuiWorkScheduler::Task *GuiWorkScheduler::nextTask()
+{
+    for (int i = 0; i < PRIORITY_COUNT; ++i)
+    {
+        if (!queues_[i].isEmpty())
+        {
+            return &queues_[i].head();
+        }
+    }
+    return nullptr;
+}
+
+GuiWorkScheduler::Task *GuiWorkScheduler::findTask(quint64 id)
+{
+    // a running task is always at the head of its queue
+    for (int i = 0; i < PRIORITY_COUNT; ++i)
+    {
+        if (!queues_[i].isEmpty() && queues_[i].head().id == id)
+        {
+            return &queues_[i].head();
+        }
+    }
+    return nullptr;
+}
+
+void GuiWorkScheduler::dropTask(quint64 id)
+{
+    for (int i = 0; i < PRIORITY_COUNT; ++i)
+    {
+        if (!queues_[i].isEmpty() && queues_[i].head().id == id)
+        {
+            queues_[i].dequeue();
+            return;
+        }
+    }
+    Q_ASSERT(false);
+}
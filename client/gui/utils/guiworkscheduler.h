@@ -0,0 +1,59 @@
+#ifndef GUIWORKSCHEDULER_H
+#define GUIWORKSCHEDULER_H
+
+#include <functional>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QQueue>
+#include <QTimer>
+
+// Cooperative scheduler for heavy work on the GUI thread. A task is a step function called repeatedly
+// until it returns true; steps are run in slices of a few milliseconds, and the event loop gets control
+// back between the slices, so input and painting are not blocked for the whole update.
+// Tasks of the same priority are run in the order they were posted.
+class GuiWorkScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    enum PRIORITY { PRIORITY_NORMAL, PRIORITY_LOW, PRIORITY_COUNT };
+
+    // returns true when the task is finished; the step is copied before every call, so the task state
+    // must be kept outside of it (e.g. in a QSharedPointer captured by the lambda)
+    typedef std::function<bool()> TaskStep;
+
+    explicit GuiWorkScheduler(QObject *parent = nullptr, int sliceMs = 4);
+
+    void post(const QString &name, PRIORITY priority, TaskStep step);
+    bool isIdle() const;
+
+private slots:
+    void onRunSlice();
+
+private:
+    struct Task
+    {
+        quint64 id;
+        QString name;
+        TaskStep step;
+        int slices;
+        qint64 runTimeUs;
+        qint64 maxSliceUs;
+        int lastSlice;          // number of the scheduler slice the task was last run in
+    };
+
+    QQueue<Task> queues_[PRIORITY_COUNT];
+    QTimer timer_;
+    int sliceMs_;
+
+    QElapsedTimer sinceScheduled_;      // time the next slice waited in the event loop
+    quint64 slicesCount_;
+    qint64 maxEventLoopLatencyUs_;
+    quint64 nextTaskId_;
+
+    void scheduleSlice();
+    Task *nextTask();
+    Task *findTask(quint64 id);
+    void dropTask(quint64 id);
+};
+
+#endif // GUIWORKSCHEDULER_H
@@ -2,6 +2,7 @@
 #define COMMAND_H
 
 #include <vector>
+#include "../utils/logrecord.h"
 
 namespace IPC
 {
@@ -19,6 +20,13 @@ public:
 
     // return debug string of command
     virtual std::string getDebugString() const = 0;
+
+    // return compact one-line debug string of command, with large repeated fields truncated
+    virtual std::string getShortDebugString() const = 0;
+
+    // the same strings as arguments of a structured log record, built by the log writer thread
+    virtual LogRecord::Deferred getDeferredDebugString() const = 0;
+    virtual LogRecord::Deferred getDeferredShortDebugString() const = 0;
 };
 
 } // namespace IPC
@@ -162,6 +162,10 @@ Command *CommandFactory::makeCommand(const std::string strId, char *buf, int siz
     {
         return new ProtobufCommand<IPCClientCommands::AdvancedParametersChanged>(buf, size);
     }
+    else if (strId == IPCClientCommands::SubscribeTrafficStatistics::descriptor()->full_name())
+    {
+        return new ProtobufCommand<IPCClientCommands::SubscribeTrafficStatistics>(buf, size);
+    }
     // servers commands
     else if (strId == IPCServerCommands::AuthReply::descriptor()->full_name())
     {
@@ -323,6 +327,10 @@ Command *CommandFactory::makeCommand(const std::string strId, char *buf, int siz
     {
         return new ProtobufCommand<IPCServerCommands::WebSessionToken>(buf, size);
     }
+    else if (strId == IPCServerCommands::TrafficStatisticsBatch::descriptor()->full_name())
+    {
+        return new ProtobufCommand<IPCServerCommands::TrafficStatisticsBatch>(buf, size);
+    }
 
     Q_ASSERT(false);
     return NULL;
@@ -0,0 +1,28 @@
+#ifndef COMMANDLOG_H
+#define COMMANDLOG_H
+
+#include "command.h"
+#include "../utils/logger.h"
+
+namespace IPC
+{
+
+// Logs a command as a compact one-line summary to the "ipc" category. The full multi-line dump is
+// written only when the "ipc.verbose" category is enabled (e.g. "ipc.verbose.debug=true" in the
+// QT_LOGGING_RULES). Nothing is formatted when the categories are disabled, and otherwise the text is
+// built by the log writer thread: only a serialized copy of the message is made here.
+inline void logCommand(const Command &command)
+{
+    if (LOG_IPC_VERBOSE().isDebugEnabled())
+    {
+        qCDebugRecord(LOG_IPC_VERBOSE, "%1", command.getDeferredDebugString());
+    }
+    else
+    {
+        qCDebugRecord(LOG_IPC, "%1", command.getDeferredShortDebugString());
+    }
+}
+
+} // namespace IPC
+
+#endif // COMMANDLOG_H
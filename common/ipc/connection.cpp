@@ -134,11 +134,19 @@ void Connection::onSocketBytesWritten(qint64 bytes)
 void Connection::onReadyRead()
 {
     readBuf_.append(localSocket_->readAll());
-    while (canReadCommand())
+
+    // parse all complete commands first and drop them from the buffer at once, instead of shifting
+    // the rest of the buffer after every command
+    int offset = 0;
+    while (canReadCommand(offset))
     {
-        Command *cmd = readCommand();
+        Command *cmd = readCommand(offset);
         emit newCommand(cmd, this);
     }
+    if (offset > 0)
+    {
+        readBuf_.remove(0, offset);
+    }
 }
 
 void Connection::onSocketError(QLocalSocket::LocalSocketError socketError)
@@ -148,16 +156,17 @@ void Connection::onSocketError(QLocalSocket::LocalSocketError socketError)
     emit stateChanged(CONNECTION_ERROR, this);
 }
 
-bool Connection::canReadCommand()
+bool Connection::canReadCommand(int offset)
 {
-    if (readBuf_.size() > (int)(sizeof(int) * 2))
+    const int available = readBuf_.size() - offset;
+    if (available > (int)(sizeof(int) * 2))
     {
         int sizeOfCmd;
         int sizeOfId;
-        memcpy(&sizeOfCmd, readBuf_.data(), sizeof(int));
-        memcpy(&sizeOfId, readBuf_.data() + sizeof(int), sizeof(int));
+        memcpy(&sizeOfCmd, readBuf_.data() + offset, sizeof(int));
+        memcpy(&sizeOfId, readBuf_.data() + offset + sizeof(int), sizeof(int));
 
-        if (readBuf_.size() >= (int)(sizeof(int) * 2 + sizeOfCmd + sizeOfId))
+        if (available >= (int)(sizeof(int) * 2 + sizeOfCmd + sizeOfId))
         {
             return true;
         }
@@ -165,17 +174,17 @@ bool Connection::canReadCommand()
     return false;
 }
 
-Command *Connection::readCommand()
+Command *Connection::readCommand(int &offset)
 {
     int sizeOfCmd;
     int sizeOfId;
-    memcpy(&sizeOfCmd, readBuf_.data(), sizeof(int));
-    memcpy(&sizeOfId, readBuf_.data() + sizeof(int), sizeof(int));
+    memcpy(&sizeOfCmd, readBuf_.data() + offset, sizeof(int));
+    memcpy(&sizeOfId, readBuf_.data() + offset + sizeof(int), sizeof(int));
 
-    std::string strId(readBuf_.data() + sizeof(int) * 2, sizeOfId);
+    std::string strId(readBuf_.data() + offset + sizeof(int) * 2, sizeOfId);
 
-    Command *cmd = CommandFactory::makeCommand(strId, readBuf_.data() + sizeof(int) * 2 + sizeOfId, sizeOfCmd);
-    readBuf_.remove(0, sizeof(int) * 2 + sizeOfId + sizeOfCmd);
+    Command *cmd = CommandFactory::makeCommand(strId, readBuf_.data() + offset + sizeof(int) * 2 + sizeOfId, sizeOfCmd);
+    offset += sizeof(int) * 2 + sizeOfId + sizeOfCmd;
     return cmd;
 }
 
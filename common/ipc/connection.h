@@ -39,8 +39,8 @@ private:
     QByteArray readBuf_;
     qint64 bytesWrittingInProgress_;
 
-    bool canReadCommand();
-    Command *readCommand();
+    bool canReadCommand(int offset);
+    Command *readCommand(int &offset);
 
     void safeDeleteSocket();
 };
@@ -3,6 +3,8 @@
 
 #include "command.h"
 #include "../utils/clean_sensitive_info.h"
+#include "../utils/logrecord.h"
+#include "../utils/protobuf_summary.h"
 
 namespace IPC
 {
@@ -41,10 +43,41 @@ public:
                + Utils::cleanSensitiveInfo(protoObj.DebugString());
     }
 
+    std::string getShortDebugString() const override
+    {
+        return "[" + protoObj.descriptor()->name() + "] "
+               + Utils::cleanSensitiveInfo(Utils::protobufSummary(protoObj));
+    }
+
+    // the debug string for a structured log record, built by the log writer thread from a copy of the message
+    LogRecord::Deferred getDeferredDebugString() const override
+    {
+        return LogRecord::Deferred(&renderDebugString, QByteArray::fromStdString(protoObj.SerializeAsString()));
+    }
+
+    LogRecord::Deferred getDeferredShortDebugString() const override
+    {
+        return LogRecord::Deferred(&renderShortDebugString, QByteArray::fromStdString(protoObj.SerializeAsString()));
+    }
+
     T &getProtoObj() { return protoObj; }
 
 private:
     T protoObj;
+
+    static QString renderDebugString(const QByteArray &data)
+    {
+        T obj;
+        obj.ParseFromArray(data.constData(), data.size());
+        return QString::fromStdString("[" + obj.descriptor()->name() + "] " + Utils::cleanSensitiveInfo(obj.DebugString()));
+    }
+
+    static QString renderShortDebugString(const QByteArray &data)
+    {
+        T obj;
+        obj.ParseFromArray(data.constData(), data.size());
+        return QString::fromStdString("[" + obj.descriptor()->name() + "] " + Utils::cleanSensitiveInfo(Utils::protobufSummary(obj)));
+    }
 };
 
 } // namespace IPC
@@ -108,11 +108,17 @@ void TcpConnection::onSocketBytesWritten(qint64 bytes)
 void TcpConnection::onReadyRead()
 {
     readBuf_.append(socket_->readAll());
-    while (canReadCommand())
+
+    int offset = 0;
+    while (canReadCommand(offset))
     {
-        Command *cmd = readCommand();
+        Command *cmd = readCommand(offset);
         emit newCommand(cmd, this);
     }
+    if (offset > 0)
+    {
+        readBuf_.remove(0, offset);
+    }
 }
 
 void TcpConnection::onSocketError(QAbstractSocket::SocketError /*socketError*/)
@@ -122,16 +128,17 @@ void TcpConnection::onSocketError(QAbstractSocket::SocketError /*socketError*/)
     emit stateChanged(CONNECTION_ERROR, this);
 }
 
-bool TcpConnection::canReadCommand()
+bool TcpConnection::canReadCommand(int offset)
 {
-    if (readBuf_.size() > (int)(sizeof(int) * 2))
+    const int available = readBuf_.size() - offset;
+    if (available > (int)(sizeof(int) * 2))
     {
         int sizeOfCmd;
         int sizeOfId;
-        memcpy(&sizeOfCmd, readBuf_.data(), sizeof(int));
-        memcpy(&sizeOfId, readBuf_.data() + sizeof(int), sizeof(int));
+        memcpy(&sizeOfCmd, readBuf_.data() + offset, sizeof(int));
+        memcpy(&sizeOfId, readBuf_.data() + offset + sizeof(int), sizeof(int));
 
-        if (readBuf_.size() >= (int)(sizeof(int) * 2 + sizeOfCmd + sizeOfId))
+        if (available >= (int)(sizeof(int) * 2 + sizeOfCmd + sizeOfId))
         {
             return true;
         }
@@ -139,17 +146,17 @@ bool TcpConnection::canReadCommand()
     return false;
 }
 
-Command *TcpConnection::readCommand()
+Command *TcpConnection::readCommand(int &offset)
 {
     int sizeOfCmd;
     int sizeOfId;
-    memcpy(&sizeOfCmd, readBuf_.data(), sizeof(int));
-    memcpy(&sizeOfId, readBuf_.data() + sizeof(int), sizeof(int));
+    memcpy(&sizeOfCmd, readBuf_.data() + offset, sizeof(int));
+    memcpy(&sizeOfId, readBuf_.data() + offset + sizeof(int), sizeof(int));
 
-    std::string strId(readBuf_.data() + sizeof(int) * 2, sizeOfId);
+    std::string strId(readBuf_.data() + offset + sizeof(int) * 2, sizeOfId);
 
-    Command *cmd = CommandFactory::makeCommand(strId, readBuf_.data() + sizeof(int) * 2 + sizeOfId, sizeOfCmd);
-    readBuf_.remove(0, sizeof(int) * 2 + sizeOfId + sizeOfCmd);
+    Command *cmd = CommandFactory::makeCommand(strId, readBuf_.data() + offset + sizeof(int) * 2 + sizeOfId, sizeOfCmd);
+    offset += sizeof(int) * 2 + sizeOfId + sizeOfCmd;
     return cmd;
 }
 
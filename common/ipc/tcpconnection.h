@@ -38,8 +38,8 @@ private:
     QByteArray writeBuf_;
     QByteArray readBuf_;
 
-    bool canReadCommand();
-    Command *readCommand();
+    bool canReadCommand(int offset);
+    Command *readCommand(int &offset);
 
     void safeDeleteSocket();
 };
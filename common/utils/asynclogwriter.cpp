@@ -0,0 +1,389 @@
+#include "asynclogwriter.h"
+#include <QDateTime>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+
+#ifndef Q_OS_WIN
+    #include <sys/uio.h>
+#endif
+
+namespace {
+// lines are written at least this often
+const std::chrono::milliseconds FLUSH_INTERVAL(200);
+// the writer is woken up earlier when this many lines are queued
+const int WAKE_UP_PENDING_LINES = 256;
+// lines per batched write
+const int MAX_BATCH_LINES = 64;
+const char *TIME_PLACEHOLDER = "{gmt_time}";
+// size of the ring of recent lines
+const quint32 RING_CAPACITY = 4 * 1024 * 1024;
+}
+
+AsyncLogWriter::AsyncLogWriter() : head_(&stub_), tail_(&stub_), postedCount_(0), pendingCount_(0),
+    fileSize_(0), fileOpenedMs_(0), rotator_(nullptr), isWakeRequested_(false), isStopping_(false),
+    writtenCount_(0), cachedSecond_(-1)
+{
+    stub_.next.store(nullptr, std::memory_order_relaxed);
+    stub_.timeMs = 0;
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    close();
+}
+
+bool AsyncLogWriter::open(const QString &path, const QString &ringPath, bool append, LogRotator *rotator)
+{
+    Q_ASSERT(!thread_.joinable());
+    file_.setFileName(path);
+    // the file is written directly, bypassing the QFile buffer, so a line is on disk as soon as its batch is
+    if (!file_.open((append ? QIODevice::Append : QIODevice::WriteOnly) | QIODevice::Unbuffered))
+    {
+        return false;
+    }
+    // the age of an appended file counts from now, its creation time is not available on every platform
+    fileSize_ = file_.size();
+    fileOpenedMs_ = QDateTime::currentMSecsSinceEpoch();
+    rotator_ = rotator;
+    // without the ring only the recent lines are unavailable, the file log is still written
+    ring_.open(ringPath, RING_CAPACITY, append);
+    isStopping_ = false;
+    thread_ = std::thread(&AsyncLogWriter::run, this);
+    return true;
+}
+
+void AsyncLogWriter::close()
+{
+    if (thread_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            isStopping_ = true;
+        }
+        wakeCondition_.notify_one();
+        thread_.join();
+    }
+    file_.close();
+    ring_.close();
+}
+
+void AsyncLogWriter::post(QtMsgType type, qint64 timeMs, const QString &line)
+{
+    Node *node = new Node;
+    node->timeMs = timeMs;
+    node->line = line;
+    enqueue(type, node);
+}
+
+void AsyncLogWriter::postRecord(QtMsgType type, const QByteArray &record)
+{
+    Node *node = new Node;
+    node->timeMs = 0;
+    node->record = record;
+    enqueue(type, node);
+}
+
+void AsyncLogWriter::enqueue(QtMsgType type, Node *node)
+{
+    postedCount_.fetch_add(1, std::memory_order_relaxed);
+    push(node);
+
+    const int pending = pendingCount_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (type != QtDebugMsg && type != QtInfoMsg)
+    {
+        // warnings and errors should be on disk before whatever comes next
+        if (type == QtFatalMsg)
+        {
+            flush();
+        }
+        else
+        {
+            wakeUp();
+        }
+    }
+    else if (pending == WAKE_UP_PENDING_LINES)
+    {
+        wakeUp();
+    }
+}
+
+void AsyncLogWriter::flush()
+{
+    if (!thread_.joinable())
+    {
+        return;
+    }
+    const quint64 target = postedCount_.load(std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    isWakeRequested_ = true;
+    wakeCondition_.notify_one();
+    // re-checked periodically, a producer may be in the middle of pushing a line which is counted already
+    while (writtenCount_ < target && !isStopping_)
+    {
+        writtenCondition_.wait_for(lock, FLUSH_INTERVAL);
+    }
+}
+
+void AsyncLogWriter::drainOnCrash()
+{
+    // the writer thread may be the one that crashed while holding the lock, so don't wait for it forever
+    for (int i = 0; i < 50; ++i)
+    {
+        if (consumerMutex_.try_lock())
+        {
+            std::lock_guard<std::mutex> lock(consumerMutex_, std::adopt_lock);
+            drain();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+QString AsyncLogWriter::recentLines() const
+{
+    return QString::fromUtf8(ring_.snapshot());
+}
+
+void AsyncLogWriter::push(Node *node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+AsyncLogWriter::Node *AsyncLogWriter::pop()
+{
+    Node *tail = tail_;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_)
+    {
+        if (next == nullptr)
+        {
+            return nullptr;
+        }
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr)
+    {
+        tail_ = next;
+        return tail;
+    }
+    if (tail != head_.load(std::memory_order_acquire))
+    {
+        // a producer has taken the head but not linked its node yet, it is picked up on the next drain
+        return nullptr;
+    }
+    push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr)
+    {
+        tail_ = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+void AsyncLogWriter::wakeUp()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        isWakeRequested_ = true;
+    }
+    wakeCondition_.notify_one();
+}
+
+void AsyncLogWriter::run()
+{
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (!isStopping_)
+    {
+        wakeCondition_.wait_for(lock, FLUSH_INTERVAL, [this]() { return isWakeRequested_ || isStopping_; });
+        isWakeRequested_ = false;
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> consumerLock(consumerMutex_);
+            drain();
+            rotateIfNeeded();
+        }
+        lock.lock();
+        writtenCondition_.notify_all();
+    }
+    lock.unlock();
+
+    std::lock_guard<std::mutex> consumerLock(consumerMutex_);
+    drain();
+}
+
+void AsyncLogWriter::drain()
+{
+    QByteArray batch[MAX_BATCH_LINES];
+    int count = 0;
+    quint64 written = 0;
+
+    auto addLine = [&](const QString &line) {
+        batch[count] = line.toLocal8Bit();
+        batch[count] += "\r\n";
+        QByteArray utf8 = line.toUtf8();
+        utf8 += '\n';
+        ring_.append(utf8);
+
+        if (++count == MAX_BATCH_LINES)
+        {
+            writeBatch(batch, count);
+            count = 0;
+        }
+    };
+
+    while (Node *node = pop())
+    {
+        if (node->record.isEmpty())
+        {
+            QString &line = node->line;
+            const int ind = line.indexOf(QLatin1String(TIME_PLACEHOLDER));
+            if (ind >= 0)
+            {
+                line.replace(ind, static_cast<int>(strlen(TIME_PLACEHOLDER)), formatTime(node->timeMs));
+            }
+            addLine(line);
+        }
+        else
+        {
+            for (const QString &line : renderRecord(node->record))
+            {
+                addLine(line);
+            }
+        }
+        delete node;
+        ++written;
+    }
+    if (count > 0)
+    {
+        writeBatch(batch, count);
+    }
+
+    if (written > 0)
+    {
+        pendingCount_.fetch_sub(static_cast<int>(written), std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        writtenCount_ += written;
+    }
+}
+
+void AsyncLogWriter::writeBatch(const QByteArray *lines, int count)
+{
+    if (!file_.isOpen())
+    {
+        return;
+    }
+#ifdef Q_OS_WIN
+    QByteArray buf;
+    for (int i = 0; i < count; ++i)
+    {
+        buf += lines[i];
+    }
+    const qint64 ret = file_.write(buf);
+    if (ret > 0)
+    {
+        fileSize_ += ret;
+    }
+#else
+    struct iovec iov[MAX_BATCH_LINES];
+    for (int i = 0; i < count; ++i)
+    {
+        iov[i].iov_base = const_cast<char *>(lines[i].constData());
+        iov[i].iov_len = static_cast<size_t>(lines[i].size());
+    }
+    int first = 0;
+    while (first < count)
+    {
+        const ssize_t ret = ::writev(file_.handle(), iov + first, count - first);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        fileSize_ += ret;
+        // a short write continues from where it stopped
+        size_t written = static_cast<size_t>(ret);
+        while (first < count && written >= iov[first].iov_len)
+        {
+            written -= iov[first].iov_len;
+            ++first;
+        }
+        if (first < count)
+        {
+            iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + written;
+            iov[first].iov_len -= written;
+        }
+    }
+#endif
+}
+
+void AsyncLogWriter::rotateIfNeeded()
+{
+    if (!rotator_)
+    {
+        return;
+    }
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    // the log goes on in the same file until the generation rotated last is compressed
+    if (!rotator_->isRotationDue(fileSize_, (nowMs - fileOpenedMs_) / 1000) || !rotator_->isReadyToRotate())
+    {
+        return;
+    }
+    // the file is closed for the rename, the lines posted meanwhile wait in the queue
+    file_.close();
+    if (!rotator_->rotate())
+    {
+        // the log is still in place, the lines go on at its end and the rotation is tried again with the next ones
+        file_.open(QIODevice::Append | QIODevice::Unbuffered);
+        return;
+    }
+    file_.open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    fileSize_ = 0;
+    fileOpenedMs_ = nowMs;
+}
+
+QString AsyncLogWriter::formatTime(qint64 timeMs)
+{
+    // the date and time down to the second only change once a second, the milliseconds are appended
+    const qint64 second = timeMs / 1000;
+    if (second != cachedSecond_)
+    {
+        cachedSecond_ = second;
+        cachedSecondStr_ = QDateTime::fromMSecsSinceEpoch(second * 1000, Qt::UTC).toString("ddMMyy hh:mm:ss:");
+    }
+    const int ms = static_cast<int>(timeMs % 1000);
+    QString str = cachedSecondStr_;
+    str += QLatin1Char('0' + ms / 100);
+    str += QLatin1Char('0' + (ms / 10) % 10);
+    str += QLatin1Char('0' + ms % 10);
+    return str;
+}
+
+QStringList AsyncLogWriter::renderRecord(const QByteArray &record)
+{
+    QStringList lines;
+    LogRecord::Rendered rendered;
+    if (!LogRecord::render(record, &rendered))
+    {
+        return lines;
+    }
+    // the same layout as the message pattern set in main(): "[{gmt_time} %{time process}] [%{category}]\t %{message}",
+    // a multiline message gets a line per line, as with qCDebugMultiline
+    const QString prefix = "[" + formatTime(rendered.timeMs)
+        + QString::asprintf(" %6d.%03d] [", static_cast<uint>(rendered.processTimeMs / 1000),
+                            static_cast<uint>(rendered.processTimeMs % 1000))
+        + rendered.category + "]\t ";
+    for (const QString &line : rendered.message.split('\n', QString::SkipEmptyParts))
+    {
+        lines << prefix + line;
+    }
+    return lines;
+}
@@ -0,0 +1,94 @@
+#ifndef ASYNCLOGWRITER_H
+#define ASYNCLOGWRITER_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "logring.h"
+#include "logrecord.h"
+#include "logrotator.h"
+
+// Writes log lines to a file from a dedicated thread. Producers only push the line into a lock-free
+// multi-producer/single-consumer queue; the writer thread wakes up on a timer, when enough lines are
+// queued or when a warning or worse is logged, and writes the queued lines with a single batched write.
+// The "{gmt_time}" placeholder of the message pattern is substituted by the writer from the time
+// captured by the producer. Structured records (see LogRecord) are rendered to text by the writer as well. The recent lines are also kept in a bounded memory-mapped ring, see LogRing.
+// With a LogRotator the writer thread rotates the file once it is too big or too old, see LogRotator.
+class AsyncLogWriter
+{
+public:
+    AsyncLogWriter();
+    ~AsyncLogWriter();
+
+    // |ringPath| - file of the in-memory ring of the recent lines, continued as well when |append| is set
+    // |rotator| - optional, must outlive the writer
+    bool open(const QString &path, const QString &ringPath, bool append, LogRotator *rotator = nullptr);
+    // writes everything still queued and stops the writer thread
+    void close();
+
+    // thread-safe and lock-free, |timeMs| - milliseconds since epoch (UTC)
+    void post(QtMsgType type, qint64 timeMs, const QString &line);
+    // the same for an encoded LogRecord
+    void postRecord(QtMsgType type, const QByteArray &record);
+
+    // blocks until all the lines posted before the call are written
+    void flush();
+    // best effort from a crash handler: writes the queued lines from the calling thread, unless the
+    // writer thread can't be stopped from writing in a short time
+    void drainOnCrash();
+
+    // the recent lines, lock-free
+    QString recentLines() const;
+
+private:
+    struct Node
+    {
+        std::atomic<Node *> next;
+        qint64 timeMs;
+        QString line;
+        QByteArray record;      // a LogRecord, rendered by the writer, instead of the line
+    };
+
+    // Vyukov's intrusive MPSC queue
+    std::atomic<Node *> head_;
+    Node *tail_;
+    Node stub_;
+    std::atomic<quint64> postedCount_;
+    std::atomic<int> pendingCount_;
+
+    QFile file_;
+    qint64 fileSize_;
+    qint64 fileOpenedMs_;
+    LogRotator *rotator_;
+    std::thread thread_;
+    std::mutex consumerMutex_;          // held while the queue is drained, the queue has one consumer
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCondition_;
+    std::condition_variable writtenCondition_;
+    bool isWakeRequested_;
+    bool isStopping_;
+    quint64 writtenCount_;
+
+    LogRing ring_;
+
+    // cache of the timestamp formatting, only used by the consumer
+    qint64 cachedSecond_;
+    QString cachedSecondStr_;
+
+    void enqueue(QtMsgType type, Node *node);
+    void push(Node *node);
+    Node *pop();
+    void wakeUp();
+    void run();
+    void drain();
+    void writeBatch(const QByteArray *lines, int count);
+    void rotateIfNeeded();
+    QString formatTime(qint64 timeMs);
+    QStringList renderRecord(const QByteArray &record);
+};
+
+#endif // ASYNCLOGWRITER_H
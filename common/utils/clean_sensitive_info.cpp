@@ -2,66 +2,98 @@
 #include <QStandardPaths>
 #include <QString>
 #include <string>
-#include <vector>
+#include "replacement_matcher.h"
 
 namespace Utils {
 
 namespace {
 
-template<typename T> T QStringCast(QString source) { return source; }
-template<> std::string QStringCast(QString source) { return source.toStdString(); }
-template<> std::wstring QStringCast(QString source) { return source.toStdWString(); }
-
 #define REGISTER_SENSITIVE_REPLACEMENT(x) \
-    replacements.push_back(std::make_pair( \
-        QStringCast<T>(QStandardPaths::writableLocation(QStandardPaths::x)), \
-        QStringCast<T>(QString("%" #x "%").toUpper())))
+    matcher.add(Traits::fromQString(QStandardPaths::writableLocation(QStandardPaths::x)), \
+                Traits::fromQString(QString("%" #x "%").toUpper()))
 
 template<typename T>
-const std::vector<std::pair<T, T>> &GetSensitiveReplacements()
+ReplacementMatcher<T> CreateSensitiveInfoMatcher()
 {
-    static std::vector<std::pair<T,T>> replacements;
-    static bool is_replacements_init = false;
-    if (!is_replacements_init) {
-        // This will clean most home-related OS paths ("~" and "C:/Users/<USER>").
-        REGISTER_SENSITIVE_REPLACEMENT(HomeLocation);
-        // This is important for Linux: cleans "/run/user/<USER>". On Mac and Windows, probably is
-        // under "~" or "C:/Users/<USER>".
-        REGISTER_SENSITIVE_REPLACEMENT(RuntimeLocation);
-        // This is important for Android: cleans "<USER>". On desktop OSes, most likely is under "~"
-        // or "C:/Users/<USER>".
-        REGISTER_SENSITIVE_REPLACEMENT(GenericDataLocation);
-        is_replacements_init = true;
-    }
-    return replacements;
+    using Traits = StringTraits<T>;
+    ReplacementMatcher<T> matcher;
+    // This will clean most home-related OS paths ("~" and "C:/Users/<USER>").
+    REGISTER_SENSITIVE_REPLACEMENT(HomeLocation);
+    // This is important for Linux: cleans "/run/user/<USER>". On Mac and Windows, probably is
+    // under "~" or "C:/Users/<USER>".
+    REGISTER_SENSITIVE_REPLACEMENT(RuntimeLocation);
+    // This is important for Android: cleans "<USER>". On desktop OSes, most likely is under "~"
+    // or "C:/Users/<USER>".
+    REGISTER_SENSITIVE_REPLACEMENT(GenericDataLocation);
+    matcher.build();
+    return matcher;
 }
 
 #undef REGISTER_SENSITIVE_REPLACEMENT
-}  // namespace
 
 template<typename T>
-typename std::enable_if<std::is_base_of<QString,T>::value>::type
-ReplaceInString(T& str, const std::pair<T, T>& rep)
+const ReplacementMatcher<T> &GetSensitiveInfoMatcher()
 {
-    str.replace(rep.first, rep.second);
+    static const ReplacementMatcher<T> matcher = CreateSensitiveInfoMatcher<T>();
+    return matcher;
 }
 
-template<typename T>
-typename std::enable_if<
-    std::is_base_of<std::basic_string<typename T::traits_type::char_type>, T>::value>::type
-ReplaceInString(T& str, const std::pair<T,T>& rep)
+size_t ScanUtf8(const QByteArray &text, bool isFinal, QByteArray *out)
 {
-    const auto start_pos = str.find(rep.first);
-    if (start_pos != T::npos)
-        str.replace(start_pos, rep.first.length(), rep.second);
+    const auto &matcher = GetSensitiveInfoMatcher<std::string>();
+    return matcher.scan(text.constData(), static_cast<size_t>(text.size()), isFinal,
+        [out](const char *begin, const char *end) { out->append(begin, static_cast<int>(end - begin)); },
+        [out, &matcher](int pattern) {
+            const std::string &replacement = matcher.replacement(pattern);
+            out->append(replacement.data(), static_cast<int>(replacement.size()));
+        });
 }
+}  // namespace
 
 template <typename T>
 T CleanSensitiveInfoHelper<T>::process()
 {
-    T result{ value_ };
-    for (const auto &replacement : GetSensitiveReplacements<T>())
-        ReplaceInString(result, replacement);
+    using Traits = StringTraits<T>;
+    using CharT = typename Traits::CharT;
+    const auto &matcher = GetSensitiveInfoMatcher<T>();
+    const CharT *data = Traits::data(value_);
+    // Before the first replacement only the end of the kept text is tracked, the result is built once
+    // something is replaced.
+    const CharT *keptEnd = data;
+    bool isReplaced = false;
+    T result;
+    matcher.scan(data, Traits::size(value_), true,
+        [&](const CharT *begin, const CharT *end) {
+            if (isReplaced)
+                Traits::append(result, begin, end - begin);
+            else
+                keptEnd = end;
+        },
+        [&](int pattern) {
+            if (!isReplaced) {
+                Traits::append(result, data, keptEnd - data);
+                isReplaced = true;
+            }
+            const T &replacement = matcher.replacement(pattern);
+            Traits::append(result, Traits::data(replacement), Traits::size(replacement));
+        });
+    return isReplaced ? result : value_;
+}
+
+QByteArray SensitiveInfoStreamFilter::process(const QByteArray &chunk)
+{
+    pending_.append(chunk);
+    QByteArray result;
+    const size_t processed = ScanUtf8(pending_, false, &result);
+    pending_.remove(0, static_cast<int>(processed));
+    return result;
+}
+
+QByteArray SensitiveInfoStreamFilter::finish()
+{
+    QByteArray result;
+    ScanUtf8(pending_, true, &result);
+    pending_.clear();
     return result;
 }
 
@@ -71,4 +103,3 @@ template class CleanSensitiveInfoHelper<std::string>;
 template class CleanSensitiveInfoHelper<std::wstring>;
 
 }  // namespace Utils
-
@@ -1,8 +1,12 @@
 #ifndef CLEAN_SENSITIVE_INFO_H
 #define CLEAN_SENSITIVE_INFO_H
 
+#include <QByteArray>
+
 namespace Utils {
 
+// Replaces all the sensitive paths (home, runtime and data locations) with their placeholders in one pass
+// over the string; the string is returned as is, without a copy of its data, when there is nothing to replace.
 template<typename T>
 class CleanSensitiveInfoHelper
 {
@@ -22,6 +26,24 @@ T cleanSensitiveInfo(const T &value)
     return CleanSensitiveInfoHelper<T>(value).process();
 }
 
+// The same for a stream of UTF-8 text split into chunks, e.g. a log being uploaded. A path split between two
+// chunks is still replaced: the tail of a chunk which may start a path is held back until the next one.
+class SensitiveInfoStreamFilter
+{
+public:
+    SensitiveInfoStreamFilter() = default;
+    SensitiveInfoStreamFilter(const SensitiveInfoStreamFilter&) = delete;
+    SensitiveInfoStreamFilter& operator=(const SensitiveInfoStreamFilter&) = delete;
+
+    // returns the cleaned text which is complete so far
+    QByteArray process(const QByteArray &chunk);
+    // returns the rest of the text, at the end of the stream
+    QByteArray finish();
+
+private:
+    QByteArray pending_;
+};
+
 }  // namespace Utils
 
 #endif  // CLEAN_SENSITIVE_INFO_H
@@ -343,6 +343,10 @@ void CrashHandler::handleException(ExceptionInfo info)
                              info.exceptionPointers))
         CRASH_LOG("Wrote minidump: %ls", filename.c_str());
 
+#if !defined(WINDSCRIBE_SERVICE)
+    // the log is written by a background thread, get the queued lines and the crash report on disk
+    Logger::instance().flushOnCrash();
+#endif
     TerminateProcess(GetCurrentProcess(), 1);
 }
 
@@ -17,6 +17,14 @@ const QString WS_TT_TIMEOUT_STR     = WS_PREFIX + "tunnel-test-timeout";
 const QString WS_TT_RETRY_DELAY_STR = WS_PREFIX + "tunnel-test-retry-delay";
 const QString WS_TT_ATTEMPTS_STR    = WS_PREFIX + "tunnel-test-attempts";
 
+const QString WS_LOG_MAX_SIZE_STR   = WS_PREFIX + "log-max-size-mb";
+const QString WS_LOG_MAX_AGE_STR    = WS_PREFIX + "log-max-age-hours";
+const QString WS_LOG_GENERATIONS_STR = WS_PREFIX + "log-generations";
+const QString WS_LOG_RATE_LIMIT_STR  = WS_PREFIX + "log-rate-limit";
+const QString WS_LOG_RATE_BURST_STR  = WS_PREFIX + "log-rate-burst";
+const QString WS_LOG_CATEGORY_RATE_LIMIT_STR = WS_PREFIX + "log-category-rate-limit-";
+const QString WS_DEBUG_LOG_UNCOMPRESSED = WS_PREFIX + "debug-log-uncompressed";
+
 
 void ExtraConfig::writeConfig(const QString &cfg)
 {
@@ -183,6 +191,64 @@ bool ExtraConfig::getOverrideUpdateChannelToInternal()
     return getFlagFromExtraConfigLines(WS_UPDATE_CHANNEL_INTERNAL);
 }
 
+int ExtraConfig::getLogMaxFileSizeMb(bool &success)
+{
+    return getIntFromExtraConfigLines(WS_LOG_MAX_SIZE_STR, success, false);
+}
+
+int ExtraConfig::getLogMaxAgeHours(bool &success)
+{
+    return getIntFromExtraConfigLines(WS_LOG_MAX_AGE_STR, success, false);
+}
+
+int ExtraConfig::getLogGenerations(bool &success)
+{
+    return getIntFromExtraConfigLines(WS_LOG_GENERATIONS_STR, success, false);
+}
+
+int ExtraConfig::getLogRateLimit(bool &success)
+{
+    return getIntFromExtraConfigLines(WS_LOG_RATE_LIMIT_STR, success, false);
+}
+
+int ExtraConfig::getLogRateBurst(bool &success)
+{
+    return getIntFromExtraConfigLines(WS_LOG_RATE_BURST_STR, success, false);
+}
+
+QHash<QString, int> ExtraConfig::getLogCategoryRateLimits()
+{
+    QHash<QString, int> limits;
+    const QStringList strs = getExtraConfig(false).split("\n");
+    for (const QString &line : strs)
+    {
+        const QString lineTrimmed = line.trimmed();
+        if (!lineTrimmed.startsWith(WS_LOG_CATEGORY_RATE_LIMIT_STR, Qt::CaseInsensitive))
+        {
+            continue;
+        }
+        const int equals = lineTrimmed.indexOf("=");
+        if (equals == -1)
+        {
+            continue;
+        }
+        const QString category = lineTrimmed.mid(WS_LOG_CATEGORY_RATE_LIMIT_STR.length(),
+                                                 equals - WS_LOG_CATEGORY_RATE_LIMIT_STR.length()).trimmed();
+        bool success = false;
+        const int limit = lineTrimmed.mid(equals + 1).trimmed().toInt(&success);
+        if (success && !category.isEmpty() && limit >= 0)
+        {
+            limits[category.toLower()] = limit;
+        }
+    }
+    return limits;
+}
+
+bool ExtraConfig::getDebugLogUncompressed()
+{
+    return getFlagFromExtraConfigLines(WS_DEBUG_LOG_UNCOMPRESSED);
+}
+
 int ExtraConfig::getIntFromLineWithString(const QString &line, const QString &str, bool &success)
 {
     int endOfId = line.indexOf(str, Qt::CaseInsensitive) + str.length();
@@ -198,11 +264,11 @@ int ExtraConfig::getIntFromLineWithString(const QString &line, const QString &st
     return result;
 }
 
-int ExtraConfig::getIntFromExtraConfigLines(const QString &variableName, bool &success)
+int ExtraConfig::getIntFromExtraConfigLines(const QString &variableName, bool &success, bool bWithLog)
 {
     success = false;
 
-    const QString strExtraConfig = getExtraConfig();
+    const QString strExtraConfig = getExtraConfig(bWithLog);
     const QStringList strs = strExtraConfig.split("\n");
 
     for (const QString &line : strs)
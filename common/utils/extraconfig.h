@@ -1,6 +1,7 @@
 #ifndef EXTRACONFIG_H
 #define EXTRACONFIG_H
 
+#include <QHash>
 #include <QString>
 #include <QMutex>
 #include <QRegularExpression>
@@ -42,6 +43,19 @@ public:
 
     bool getOverrideUpdateChannelToInternal();
 
+    // log rotation, read before the logger is installed so nothing is logged
+    int getLogMaxFileSizeMb(bool &success);
+    int getLogMaxAgeHours(bool &success);
+    int getLogGenerations(bool &success);
+    // log rate limiting, lines per second (0 - no limit) and the burst size; the per category limits are
+    // "ws-log-category-rate-limit-<category>=<lines per second>"
+    int getLogRateLimit(bool &success);
+    int getLogRateBurst(bool &success);
+    QHash<QString, int> getLogCategoryRateLimits();
+
+    // send the debug log without the gzip compression, for the servers which don't accept it
+    bool getDebugLogUncompressed();
+
 private:
     ExtraConfig();
 
@@ -51,7 +65,7 @@ private:
     QString detectedIp_;
 
     int getIntFromLineWithString(const QString &line, const QString &str, bool &success);
-    int getIntFromExtraConfigLines(const QString &variableName, bool &success);
+    int getIntFromExtraConfigLines(const QString &variableName, bool &success, bool bWithLog = true);
     bool getFlagFromExtraConfigLines(const QString &flagName);
 
     bool isLegalOpenVpnCommand(const QString &command) const;
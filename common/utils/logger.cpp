@@ -2,10 +2,12 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QDateTime>
+#include "extraconfig.h"
 
-QFile *Logger::file_ = NULL;
+AsyncLogWriter *Logger::writer_ = NULL;
+LogRotator *Logger::rotator_ = NULL;
+LogRateLimiter *Logger::rateLimiter_ = NULL;
 QMutex Logger::mutex_;
-QString Logger::strLog_;
 QString Logger::logPath_;
 QString Logger::prevLogPath_;
 bool Logger::consoleOutput_;
@@ -13,6 +15,7 @@ QtMessageHandler Logger::prevMessageHandler_ = NULL;
 
 Q_LOGGING_CATEGORY(LOG_BASIC, "basic")
 Q_LOGGING_CATEGORY(LOG_IPC, "ipc")
+Q_LOGGING_CATEGORY(LOG_IPC_VERBOSE, "ipc.verbose", QtInfoMsg)   // full command dumps, disabled by default
 Q_LOGGING_CATEGORY(LOG_CONNECTION, "connection")
 Q_LOGGING_CATEGORY(LOG_SERVER_API, "server_api")
 Q_LOGGING_CATEGORY(LOG_CURL_MANAGER, "curl_manager")
@@ -52,18 +55,22 @@ void Logger::install(const QString &name, bool consoleOutput, bool recoveryMode)
     logFilePath += "/log_" + name + ".txt";
     logPath_ = logFilePath;
 
+    QMutexLocker lock(&mutex_);
+    rotator_ = new LogRotator(logPath_, prevLogPath_, rotationSettings());
+
     // in recovery mode do not move the log_engine to be prev_log_engine to preserve the potential crash log
     // recovery mode only relevant for engine
     QIODevice::OpenModeFlag openModeFlag = QIODevice::Append;
     if (!recoveryMode)
     {
-        copyToPrevLog();
+        rotator_->rotate();
         openModeFlag = QIODevice::WriteOnly;
     }
 
-    QMutexLocker lock(&mutex_);
-    file_ = new QFile(logFilePath);
-    file_->open(openModeFlag);
+    rateLimiter_ = new LogRateLimiter(rateLimiterSettings());
+    writer_ = new AsyncLogWriter();
+    // the ring of the recent lines continues together with the file in recovery mode
+    writer_->open(logFilePath, dir.filePath("log_" + name + ".ring"), openModeFlag == QIODevice::Append, rotator_);
     consoleOutput_ = consoleOutput;
     prevMessageHandler_ = qInstallMessageHandler(myMessageHandler);
 }
@@ -74,43 +81,139 @@ Logger::Logger()
 
 Logger::~Logger()
 {
+    // lines logged from now on only go to the previous handler
+    if (prevMessageHandler_)
+    {
+        qInstallMessageHandler(prevMessageHandler_);
+    }
     QMutexLocker lock(&mutex_);
-    if (file_)
+    if (writer_)
     {
-        file_->close();
-        delete file_;
+        writer_->close();
+        delete writer_;
+        writer_ = NULL;
     }
+    delete rateLimiter_;
+    rateLimiter_ = NULL;
+    // waits for the generation being compressed
+    delete rotator_;
+    rotator_ = NULL;
 }
 
-void Logger::copyToPrevLog()
+LogRotator::Settings Logger::rotationSettings()
 {
-    if (QFile::exists(logPath_))
+    LogRotator::Settings settings;
+    bool success = false;
+    const int maxSizeMb = ExtraConfig::instance().getLogMaxFileSizeMb(success);
+    if (success && maxSizeMb > 0)
+    {
+        // a generation is read into memory as a whole when the log is sent
+        settings.maxFileSize = static_cast<qint64>(qMin(maxSizeMb, 1024)) * 1024 * 1024;
+    }
+    const int maxAgeHours = ExtraConfig::instance().getLogMaxAgeHours(success);
+    if (success && maxAgeHours >= 0)
+    {
+        // 0 disables the rotation by age
+        settings.maxAgeSecs = static_cast<qint64>(maxAgeHours) * 60 * 60;
+    }
+    const int generations = ExtraConfig::instance().getLogGenerations(success);
+    if (success && generations > 0)
     {
-        QFile::remove(prevLogPath_);
-        QFile::copy(logPath_, prevLogPath_);
+        settings.generations = qMin(generations, 100);
     }
+    return settings;
+}
+
+LogRateLimiter::Settings Logger::rateLimiterSettings()
+{
+    LogRateLimiter::Settings settings;
+    bool success = false;
+    const int rate = ExtraConfig::instance().getLogRateLimit(success);
+    if (success && rate >= 0)
+    {
+        settings.rate = rate;
+    }
+    const int burst = ExtraConfig::instance().getLogRateBurst(success);
+    if (success && burst > 0)
+    {
+        settings.burst = burst;
+    }
+    // on top of the flood categories limited by default
+    const QHash<QString, int> rates = ExtraConfig::instance().getLogCategoryRateLimits();
+    for (auto it = rates.constBegin(); it != rates.constEnd(); ++it)
+    {
+        settings.rates[it.key()] = it.value();
+    }
+    return settings;
+}
+
+bool Logger::checkRateLimit(const char *category, QtMsgType type, const QString &message)
+{
+    // the limiter lives until the exit too, see myMessageHandler()
+    if (!rateLimiter_ || !writer_)
+    {
+        return true;
+    }
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    QVector<LogRateLimiter::Summary> summaries;
+    const bool isAllowed = rateLimiter_->check(category, type, message, nowMs, &summaries);
+    for (const auto &summary : summaries)
+    {
+        const QMessageLogContext summaryContext(nullptr, 0, nullptr, summary.category);
+        writer_->post(QtInfoMsg, nowMs, qFormatLogMessage(QtInfoMsg, summaryContext, summary.message));
+    }
+    return isAllowed;
 }
 
 void Logger::myMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &s)
 {
+    // a multiline dump (settings, a command, ...) is kept whole
+    if (!isMultilineMessage() && !checkRateLimit(context.category, type, s))
+    {
+        return;
+    }
+    // the writer is created once in install() and lives until the exit, so no lock is needed here;
+    // the time placeholder and the file I/O are handled by the writer thread
+    if (writer_)
     {
-        QMutexLocker lock(&mutex_);
+        writer_->post(type, QDateTime::currentMSecsSinceEpoch(), qFormatLogMessage(type, context, s));
+    }
+    if (consoleOutput_)
+    {
+        prevMessageHandler_(type, context, s);
+    }
+}
 
-        if (file_)
+void Logger::logRecord(const LogRecord &record)
+{
+    // the records are only limited by the rate, their text is not rendered here to detect the repeats
+    if (!checkRateLimit(LogRecord::categoryKey(record.categoryId()), record.type(), QString()))
+    {
+        return;
+    }
+    if (writer_)
+    {
+        writer_->postRecord(record.type(), record.data());
+        if (!consoleOutput_)
         {
-            QString str = qFormatLogMessage(type, context, s);
-            QString strDateTime = QDateTime::currentDateTimeUtc().toString("ddMMyy hh:mm:ss:zzz");
-            str.replace("{gmt_time}", strDateTime);
-
-            file_->write(str.toLocal8Bit());
-            file_->write("\r\n");
-            file_->flush();
-            strLog_ += str + "\n";
+            return;
         }
     }
-    if (consoleOutput_)
+    // rendered right away for the console, or for the default handler when the logger is not installed
+    LogRecord::Rendered rendered;
+    if (!LogRecord::render(record.data(), &rendered))
     {
-        prevMessageHandler_(type, context, s);
+        return;
+    }
+    const QByteArray category = rendered.category.toLatin1();
+    const QMessageLogContext context(nullptr, 0, nullptr, category.constData());
+    if (writer_)
+    {
+        prevMessageHandler_(rendered.type, context, rendered.message);
+    }
+    else
+    {
+        qt_message_output(rendered.type, context, rendered.message);
     }
 }
 
@@ -118,19 +221,51 @@ QString Logger::getLogStr()
 {
     QMutexLocker lock(&mutex_);
     QString ret;
-    QFile prevFileLog(prevLogPath_);
-    if (prevFileLog.open(QIODevice::ReadOnly))
+    const QByteArray prevLog = LogRotator::readLogFile(LogRotator::existingPrevLogPath(prevLogPath_));
+    if (!prevLog.isEmpty())
     {
-        ret = prevFileLog.readAll();
+        ret = prevLog;
         ret += "----------------------------------------------------------------\n";
-        prevFileLog.close();
     }
-    ret += strLog_;
+    if (writer_)
+    {
+        writer_->flush();
+        ret += writer_->recentLines();
+    }
     return ret;
 }
 
 QString Logger::getCurrentLogStr()
 {
     QMutexLocker lock(&mutex_);
-    return strLog_;
+    if (!writer_)
+    {
+        return QString();
+    }
+    writer_->flush();
+    return writer_->recentLines();
+}
+
+QMap<QString, quint64> Logger::suppressedLineCounts()
+{
+    QMutexLocker lock(&mutex_);
+    return rateLimiter_ ? rateLimiter_->suppressedCounts() : QMap<QString, quint64>();
+}
+
+void Logger::flush()
+{
+    QMutexLocker lock(&mutex_);
+    if (writer_)
+    {
+        writer_->flush();
+    }
+}
+
+void Logger::flushOnCrash()
+{
+    // no locking, the crashed thread might hold the mutex
+    if (writer_)
+    {
+        writer_->drainOnCrash();
+    }
 }
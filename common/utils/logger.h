@@ -1,16 +1,20 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#include <QFile>
 #include <QMutex>
 #include <QLoggingCategory>
 
+#include "asynclogwriter.h"
+#include "logratelimiter.h"
+#include "logrecord.h"
+#include "logrotator.h"
 #include "clean_sensitive_info.h"
 #include "multiline_message_logger.h"
 
 // log categories
 Q_DECLARE_LOGGING_CATEGORY(LOG_BASIC)
 Q_DECLARE_LOGGING_CATEGORY(LOG_IPC)
+Q_DECLARE_LOGGING_CATEGORY(LOG_IPC_VERBOSE)
 Q_DECLARE_LOGGING_CATEGORY(LOG_CONNECTION)
 Q_DECLARE_LOGGING_CATEGORY(LOG_SERVER_API)
 Q_DECLARE_LOGGING_CATEGORY(LOG_CURL_MANAGER)
@@ -41,6 +45,22 @@ Q_DECLARE_LOGGING_CATEGORY(LOG_USER)
 Q_DECLARE_LOGGING_CATEGORY(LOG_LOCATION_LIST)
 Q_DECLARE_LOGGING_CATEGORY(LOG_PREFERENCES)
 
+// Structured logging for the hot paths: the message is recorded as a LogRecord and rendered to text by the
+// log writer thread. The format is a string literal with the placeholders %1..%9, as for QString::arg():
+//   qCDebugRecord(LOG_PING, "Ping failed for node: %1", ip);
+#define LOG_RECORD_IMPL(category, isEnabled, msgType, ...) \
+    do { \
+        if (category().isEnabled()) { \
+            static const quint16 logRecordCategoryId = LogRecord::registerCategory(category().categoryName()); \
+            static const quint32 logRecordFormatId = LogRecord::registerFormat(LogRecord::formatOf(__VA_ARGS__)); \
+            Logger::logRecord(LogRecord::create(logRecordCategoryId, msgType, logRecordFormatId, __VA_ARGS__)); \
+        } \
+    } while (false)
+
+#define qCDebugRecord(category, ...) LOG_RECORD_IMPL(category, isDebugEnabled, QtDebugMsg, __VA_ARGS__)
+#define qCInfoRecord(category, ...) LOG_RECORD_IMPL(category, isInfoEnabled, QtInfoMsg, __VA_ARGS__)
+#define qCWarningRecord(category, ...) LOG_RECORD_IMPL(category, isWarningEnabled, QtWarningMsg, __VA_ARGS__)
+
 
 class Logger
 {
@@ -56,23 +76,37 @@ public:
     QString getLogStr();
     QString getCurrentLogStr();
 
+    // blocks until everything logged so far is written to the file
+    void flush();
+    // called by the crash handler, writes the queued lines from the crashing thread
+    void flushOnCrash();
+
+    // see qCDebugRecord()
+    static void logRecord(const LogRecord &record);
+
+    // lines dropped by the rate limiting so far, per category
+    QMap<QString, quint64> suppressedLineCounts();
+
 private:
     Logger();
     ~Logger();
 
     static void myMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &s);
+    static bool checkRateLimit(const char *category, QtMsgType type, const QString &message);
 
 private:
     static QtMessageHandler prevMessageHandler_;
 
-    static QFile *file_;
+    static AsyncLogWriter *writer_;
+    static LogRotator *rotator_;
+    static LogRateLimiter *rateLimiter_;
     static QMutex mutex_;
-    static QString strLog_;
     static QString logPath_;
     static QString prevLogPath_;
     static bool consoleOutput_;
 
-    static void copyToPrevLog();
+    static LogRotator::Settings rotationSettings();
+    static LogRateLimiter::Settings rateLimiterSettings();
 };
 
 
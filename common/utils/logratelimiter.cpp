@@ -0,0 +1,205 @@
+#include "logratelimiter.h"
+
+namespace {
+// the summaries of a category are logged once it is quiet for this long, if no line of it comes meanwhile
+const qint64 SUMMARY_DELAY_MS = 1000;
+// the categories limited by default, the chatty ones during a failure storm
+const int FLOOD_CATEGORY_RATE = 50;
+}
+
+LogRateLimiter::Settings::Settings() : rate(0), burst(200)
+{
+    rates["ping"] = FLOOD_CATEGORY_RATE;
+    rates["connection"] = FLOOD_CATEGORY_RATE;
+    rates["openvpn"] = FLOOD_CATEGORY_RATE;
+}
+
+LogRateLimiter::LogRateLimiter(const Settings &settings) : settings_(settings), lastSweepMs_(0)
+{
+    for (int i = 0; i < MAX_CATEGORIES; ++i)
+    {
+        categories_[i].store(nullptr, std::memory_order_relaxed);
+        states_[i].rate.store(-1, std::memory_order_relaxed);
+    }
+}
+
+bool LogRateLimiter::check(const char *category, QtMsgType type, const QString &message, qint64 nowMs,
+                           QVector<Summary> *summaries)
+{
+    CategoryState *st = state(category, nowMs);
+    if (!st)
+    {
+        return true;
+    }
+    // the categories which are not limited take no lock
+    if (st->rate.load(std::memory_order_acquire) == 0)
+    {
+        return true;
+    }
+
+    // one thread at a time sweeps the quiet categories
+    qint64 lastSweepMs = lastSweepMs_.load(std::memory_order_relaxed);
+    if (nowMs - lastSweepMs >= SUMMARY_DELAY_MS &&
+        lastSweepMs_.compare_exchange_strong(lastSweepMs, nowMs, std::memory_order_relaxed))
+    {
+        sweep(nowMs, summaries);
+    }
+
+    const quint64 hash = (type == QtDebugMsg || type == QtInfoMsg) && !message.isEmpty() ? messageHash(message) : 0;
+
+    std::lock_guard<std::mutex> lock(st->mutex);
+    if (type != QtDebugMsg && type != QtInfoMsg)
+    {
+        // the summaries go first, to keep the order of the lines
+        takeSummaries(category, *st, nowMs, true, summaries);
+        st->hasLastMessage = false;
+        return true;
+    }
+
+    st->lastLineMs = nowMs;
+    if (!message.isEmpty() && st->hasLastMessage && hash == st->lastMessageHash)
+    {
+        ++st->repeated;
+        ++st->suppressedTotal;
+        return false;
+    }
+
+    refill(*st, nowMs);
+    if (st->tokens < 1.0)
+    {
+        ++st->suppressed;
+        ++st->suppressedTotal;
+        return false;
+    }
+    st->tokens -= 1.0;
+    takeSummaries(category, *st, nowMs, false, summaries);
+    st->hasLastMessage = !message.isEmpty();
+    st->lastMessageHash = hash;
+    return true;
+}
+
+QMap<QString, quint64> LogRateLimiter::suppressedCounts() const
+{
+    QMap<QString, quint64> counts;
+    for (int i = 0; i < MAX_CATEGORIES; ++i)
+    {
+        const char *category = categories_[i].load(std::memory_order_acquire);
+        if (!category)
+        {
+            continue;
+        }
+        const CategoryState &st = states_[i];
+        if (st.rate.load(std::memory_order_acquire) <= 0)
+        {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(st.mutex);
+        if (st.suppressedTotal > 0)
+        {
+            counts[QString::fromLatin1(category).trimmed()] += st.suppressedTotal;
+        }
+    }
+    return counts;
+}
+
+LogRateLimiter::CategoryState *LogRateLimiter::state(const char *category, qint64 nowMs)
+{
+    const int start = static_cast<int>((reinterpret_cast<quintptr>(category) >> 3) % MAX_CATEGORIES);
+    for (int n = 0; n < MAX_CATEGORIES; ++n)
+    {
+        const int i = (start + n) % MAX_CATEGORIES;
+        const char *slotCategory = categories_[i].load(std::memory_order_acquire);
+        // a free slot is taken, unless another category took it meanwhile
+        if (!slotCategory && categories_[i].compare_exchange_strong(slotCategory, category,
+                                                                    std::memory_order_acq_rel))
+        {
+            slotCategory = category;
+        }
+        if (slotCategory != category)
+        {
+            continue;
+        }
+
+        CategoryState &st = states_[i];
+        if (st.rate.load(std::memory_order_acquire) < 0)
+        {
+            std::lock_guard<std::mutex> lock(st.mutex);
+            if (st.rate.load(std::memory_order_relaxed) < 0)
+            {
+                st.tokens = settings_.burst;
+                st.refilledMs = nowMs;
+                st.suppressed = 0;
+                st.repeated = 0;
+                st.suppressedTotal = 0;
+                st.lastLineMs = nowMs;
+                st.summaryMs = nowMs;
+                st.hasLastMessage = false;
+                st.lastMessageHash = 0;
+                // some category names are padded with spaces for the alignment of the log
+                st.rate.store(settings_.rates.value(QString::fromLatin1(category).trimmed().toLower(),
+                                                    settings_.rate), std::memory_order_release);
+            }
+        }
+        return &st;
+    }
+    return nullptr;
+}
+
+void LogRateLimiter::refill(CategoryState &st, qint64 nowMs) const
+{
+    if (nowMs > st.refilledMs)
+    {
+        const int rate = st.rate.load(std::memory_order_relaxed);
+        st.tokens = qMin<double>(settings_.burst, st.tokens + (nowMs - st.refilledMs) * rate / 1000.0);
+        st.refilledMs = nowMs;
+    }
+}
+
+void LogRateLimiter::takeSummaries(const char *category, CategoryState &st, qint64 nowMs, bool force,
+                                   QVector<Summary> *summaries)
+{
+    if (st.repeated > 0)
+    {
+        summaries->append({ category, QString("Last message repeated %1 times").arg(st.repeated) });
+        st.repeated = 0;
+    }
+    if (st.suppressed > 0 && (force || nowMs - st.summaryMs >= SUMMARY_DELAY_MS))
+    {
+        st.summaryMs = nowMs;
+        summaries->append({ category, QString("%1 similar messages suppressed (rate limit %2 lines/s, %3 in total)")
+                                          .arg(st.suppressed).arg(st.rate.load(std::memory_order_relaxed))
+                                          .arg(st.suppressedTotal) });
+        st.suppressed = 0;
+    }
+}
+
+void LogRateLimiter::sweep(qint64 nowMs, QVector<Summary> *summaries)
+{
+    // the categories gone quiet while lines were being dropped get their summaries without waiting for
+    // their next line
+    for (int i = 0; i < MAX_CATEGORIES; ++i)
+    {
+        const char *category = categories_[i].load(std::memory_order_acquire);
+        if (!category)
+        {
+            continue;
+        }
+        CategoryState &st = states_[i];
+        if (st.rate.load(std::memory_order_acquire) <= 0)
+        {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(st.mutex);
+        if ((st.repeated > 0 || st.suppressed > 0) && nowMs - st.lastLineMs >= SUMMARY_DELAY_MS)
+        {
+            takeSummaries(category, st, nowMs, true, summaries);
+            st.hasLastMessage = false;
+        }
+    }
+}
+
+quint64 LogRateLimiter::messageHash(const QString &message)
+{
+    // two 32-bit hashes with different seeds, a collision only collapses a line into a repeat
+    return (static_cast<quint64>(qHash(message, 0)) << 32) | qHash(message, 0x9e3779b9U);
+}
@@ -0,0 +1,81 @@
+#ifndef LOGRATELIMITER_H
+#define LOGRATELIMITER_H
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <mutex>
+
+// Limits the debug and info lines of the categories known to flood the log during a failure storm (every
+// node timing out, a reconnect loop, the OpenVPN output, ...) with a token bucket, so they don't take the
+// disk and the CPU with them. A line identical to the previous one of its category is collapsed into a
+// repeat count. What was dropped is logged as a summary line once the category calms down. The other
+// categories, warnings and errors are never dropped.
+// Each category has its own state and lock, the lines of different categories don't wait for each other.
+class LogRateLimiter
+{
+public:
+    struct Settings
+    {
+        Settings();
+        int rate;                       // lines per second of the categories not in |rates|, 0 - no limit
+        int burst;                      // lines allowed at once above the rate
+        QHash<QString, int> rates;      // per category name, overrides |rate|
+    };
+
+    // a summary line of the dropped lines of a category
+    struct Summary
+    {
+        const char *category;
+        QString message;
+    };
+
+    explicit LogRateLimiter(const Settings &settings);
+
+    // |category| - the category name, the pointer identifies the category
+    // |message| - without the time and the category, for the identical line detection; empty to skip it
+    // The summaries to log before the line are added to |summaries|. Returns false if the line is dropped.
+    bool check(const char *category, QtMsgType type, const QString &message, qint64 nowMs,
+               QVector<Summary> *summaries);
+
+    // lines dropped so far, per category name
+    QMap<QString, quint64> suppressedCounts() const;
+
+private:
+    // more than all the categories of the app, the categories past it are not limited
+    static constexpr int MAX_CATEGORIES = 128;
+
+    struct CategoryState
+    {
+        std::atomic<int> rate;          // -1 until the state is set up, 0 - the category is not limited
+        mutable std::mutex mutex;       // guards the rest
+        double tokens;
+        qint64 refilledMs;
+        quint64 suppressed;             // dropped by the rate limit since the last summary
+        quint64 repeated;               // collapsed identical lines since the last summary
+        quint64 suppressedTotal;
+        qint64 lastLineMs;
+        qint64 summaryMs;               // of the last summary of the suppressed lines
+        bool hasLastMessage;
+        quint64 lastMessageHash;        // of the last line, a copy of each line is not kept
+    };
+
+    // lock-free, nullptr once the table is full
+    CategoryState *state(const char *category, qint64 nowMs);
+    void refill(CategoryState &st, qint64 nowMs) const;
+    // the summary of the suppressed lines is logged at most once a second, unless |force| is set
+    void takeSummaries(const char *category, CategoryState &st, qint64 nowMs, bool force,
+                       QVector<Summary> *summaries);
+    void sweep(qint64 nowMs, QVector<Summary> *summaries);
+    static quint64 messageHash(const QString &message);
+
+    const Settings settings_;
+    // open addressing by the category pointer, a slot is never freed
+    std::atomic<const char *> categories_[MAX_CATEGORIES];
+    CategoryState states_[MAX_CATEGORIES];
+    std::atomic<qint64> lastSweepMs_;
+};
+
+#endif // LOGRATELIMITER_H
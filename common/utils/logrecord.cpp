@@ -0,0 +1,316 @@
+#include "logrecord.h"
+#include <QDateTime>
+#include <QMutex>
+#include <QVector>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// The tables are only written when a call site logs for the first time.
+QMutex g_tablesMutex;
+QVector<const char *> g_formats;
+QVector<QString> g_categories;
+QVector<const char *> g_categoryKeys;
+
+// The reference for converting the monotonic timestamps to the process time.
+const std::chrono::steady_clock::time_point g_startTime = std::chrono::steady_clock::now();
+
+const int HEADER_SIZE = sizeof(quint8) + sizeof(quint16) + sizeof(qint64) + sizeof(qint64) + sizeof(quint32);
+
+class Reader
+{
+public:
+    explicit Reader(const QByteArray &data) : p_(data.constData()), end_(data.constData() + data.size()) {}
+
+    bool atEnd() const { return p_ == end_; }
+
+    template<typename T>
+    bool read(T *value)
+    {
+        if (end_ - p_ < static_cast<int>(sizeof(T)))
+            return false;
+        memcpy(value, p_, sizeof(T));
+        p_ += sizeof(T);
+        return true;
+    }
+
+    bool readSized(const char **data, quint32 *size)
+    {
+        if (!read(size) || static_cast<quint32>(end_ - p_) < *size)
+            return false;
+        *data = p_;
+        p_ += *size;
+        return true;
+    }
+
+private:
+    const char *p_;
+    const char *end_;
+};
+
+// Substitutes %1..%9 in one pass, unlike chained QString::arg() calls an argument containing "%2" is kept as is.
+QString substitute(const char *format, const QVector<QString> &args)
+{
+    QString result;
+    const QString str = QString::fromUtf8(format);
+    result.reserve(str.size() + 32 * args.size());
+    for (int i = 0; i < str.size(); ++i)
+    {
+        if (str[i] == QLatin1Char('%') && i + 1 < str.size() && str[i + 1] >= QLatin1Char('1') && str[i + 1] <= QLatin1Char('9'))
+        {
+            const int ind = str[i + 1].unicode() - '1';
+            if (ind < args.size())
+            {
+                result += args[ind];
+                ++i;
+                continue;
+            }
+        }
+        result += str[i];
+    }
+    return result;
+}
+
+}  // namespace
+
+LogRecord::LogRecord(quint16 categoryId, QtMsgType type, quint32 formatId) : type_(type), categoryId_(categoryId)
+{
+    // the wall clock as the qDebug() lines have it, the steady clock doesn't follow a suspend or a clock step
+    const qint64 timeMs = QDateTime::currentMSecsSinceEpoch();
+    const qint64 timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - g_startTime).count();
+    data_.reserve(64);
+    const quint8 msgType = static_cast<quint8>(type);
+    appendBytes(&msgType, sizeof(msgType));
+    appendBytes(&categoryId, sizeof(categoryId));
+    appendBytes(&timeMs, sizeof(timeMs));
+    appendBytes(&timeUs, sizeof(timeUs));
+    appendBytes(&formatId, sizeof(formatId));
+}
+
+LogRecord &LogRecord::arg(qint64 value)
+{
+    appendArgType(ARG_INT);
+    appendBytes(&value, sizeof(value));
+    return *this;
+}
+
+LogRecord &LogRecord::arg(quint64 value)
+{
+    appendArgType(ARG_UINT);
+    appendBytes(&value, sizeof(value));
+    return *this;
+}
+
+LogRecord &LogRecord::arg(double value)
+{
+    appendArgType(ARG_DOUBLE);
+    appendBytes(&value, sizeof(value));
+    return *this;
+}
+
+LogRecord &LogRecord::arg(bool value)
+{
+    appendArgType(ARG_BOOL);
+    const quint8 b = value ? 1 : 0;
+    appendBytes(&b, sizeof(b));
+    return *this;
+}
+
+LogRecord &LogRecord::arg(const QString &value)
+{
+    // the UTF-16 data is copied as is, the conversion is left to the rendering
+    appendArgType(ARG_UTF16);
+    appendSized(value.constData(), value.size() * static_cast<int>(sizeof(QChar)));
+    return *this;
+}
+
+LogRecord &LogRecord::arg(const char *value)
+{
+    appendArgType(ARG_UTF8);
+    appendSized(value, value ? static_cast<int>(strlen(value)) : 0);
+    return *this;
+}
+
+LogRecord &LogRecord::arg(const QByteArray &value)
+{
+    appendArgType(ARG_UTF8);
+    appendSized(value.constData(), value.size());
+    return *this;
+}
+
+LogRecord &LogRecord::arg(const std::string &value)
+{
+    appendArgType(ARG_UTF8);
+    appendSized(value.data(), static_cast<int>(value.size()));
+    return *this;
+}
+
+LogRecord &LogRecord::arg(const Deferred &value)
+{
+    appendArgType(ARG_DEFERRED);
+    appendBytes(&value.renderer, sizeof(value.renderer));
+    appendSized(value.data.constData(), value.data.size());
+    return *this;
+}
+
+quint16 LogRecord::registerCategory(const char *name)
+{
+    QMutexLocker lock(&g_tablesMutex);
+    const QString str = QString::fromLatin1(name);
+    int ind = g_categories.indexOf(str);
+    if (ind < 0)
+    {
+        ind = g_categories.size();
+        g_categories.append(str);
+        g_categoryKeys.append(name);
+    }
+    return static_cast<quint16>(ind);
+}
+
+quint32 LogRecord::registerFormat(const char *format)
+{
+    QMutexLocker lock(&g_tablesMutex);
+    g_formats.append(format);
+    return static_cast<quint32>(g_formats.size() - 1);
+}
+
+QString LogRecord::categoryName(quint16 categoryId)
+{
+    QMutexLocker lock(&g_tablesMutex);
+    return categoryId < g_categories.size() ? g_categories[categoryId] : QString();
+}
+
+const char *LogRecord::categoryKey(quint16 categoryId)
+{
+    QMutexLocker lock(&g_tablesMutex);
+    return categoryId < g_categoryKeys.size() ? g_categoryKeys[categoryId] : nullptr;
+}
+
+bool LogRecord::render(const QByteArray &data, Rendered *rendered)
+{
+    if (data.size() < HEADER_SIZE)
+    {
+        return false;
+    }
+    Reader reader(data);
+    quint8 msgType;
+    quint16 categoryId;
+    qint64 timeMs;
+    qint64 timeUs;
+    quint32 formatId;
+    reader.read(&msgType);
+    reader.read(&categoryId);
+    reader.read(&timeMs);
+    reader.read(&timeUs);
+    reader.read(&formatId);
+
+    const char *format = nullptr;
+    {
+        QMutexLocker lock(&g_tablesMutex);
+        if (categoryId >= g_categories.size() || formatId >= static_cast<quint32>(g_formats.size()))
+        {
+            return false;
+        }
+        rendered->category = g_categories[categoryId];
+        format = g_formats[formatId];
+    }
+
+    QVector<QString> args;
+    while (!reader.atEnd())
+    {
+        quint8 argType;
+        reader.read(&argType);
+        const char *p = nullptr;
+        quint32 size = 0;
+        bool ok = true;
+        switch (argType)
+        {
+            case ARG_INT:
+            {
+                qint64 value;
+                ok = reader.read(&value);
+                args.append(QString::number(value));
+                break;
+            }
+            case ARG_UINT:
+            {
+                quint64 value;
+                ok = reader.read(&value);
+                args.append(QString::number(value));
+                break;
+            }
+            case ARG_DOUBLE:
+            {
+                double value;
+                ok = reader.read(&value);
+                args.append(QString::number(value));
+                break;
+            }
+            case ARG_BOOL:
+            {
+                quint8 value;
+                ok = reader.read(&value);
+                args.append(value ? QStringLiteral("true") : QStringLiteral("false"));
+                break;
+            }
+            case ARG_UTF16:
+                ok = reader.readSized(&p, &size);
+                // the data may be unaligned in the buffer
+                if (ok)
+                {
+                    QString str(static_cast<int>(size / sizeof(QChar)), Qt::Uninitialized);
+                    memcpy(str.data(), p, str.size() * sizeof(QChar));
+                    args.append(str);
+                }
+                break;
+            case ARG_UTF8:
+                ok = reader.readSized(&p, &size);
+                args.append(QString::fromUtf8(p, static_cast<int>(size)));
+                break;
+            case ARG_DEFERRED:
+            {
+                Renderer renderer = nullptr;
+                ok = reader.read(&renderer) && reader.readSized(&p, &size);
+                if (ok)
+                {
+                    args.append(renderer(QByteArray::fromRawData(p, static_cast<int>(size))));
+                }
+                break;
+            }
+            default:
+                ok = false;
+                break;
+        }
+        if (!ok)
+        {
+            return false;
+        }
+    }
+
+    const qint64 processTimeMs = timeUs / 1000;
+    rendered->type = static_cast<QtMsgType>(msgType);
+    rendered->timeMs = timeMs;
+    rendered->processTimeMs = processTimeMs;
+    rendered->message = substitute(format, args);
+    return true;
+}
+
+void LogRecord::appendArgType(ArgType type)
+{
+    const quint8 t = type;
+    appendBytes(&t, sizeof(t));
+}
+
+void LogRecord::appendBytes(const void *data, int size)
+{
+    data_.append(static_cast<const char *>(data), size);
+}
+
+void LogRecord::appendSized(const void *data, int size)
+{
+    const quint32 sz = static_cast<quint32>(size);
+    appendBytes(&sz, sizeof(sz));
+    appendBytes(data, size);
+}
@@ -0,0 +1,111 @@
+#ifndef LOGRECORD_H
+#define LOGRECORD_H
+
+#include <QByteArray>
+#include <QLoggingCategory>
+#include <QString>
+#include <string>
+#include <utility>
+
+// A log message kept as a compact binary record instead of a formatted string: the category id, the
+// severity, the wall clock and monotonic timestamps, the id of the format string and the typed arguments.
+// Building a record is a few appends to one buffer; the text is only rendered by the log writer thread (or
+// by whoever reads the record), so the hot logging paths don't pay for QString formatting and QDebug streaming.
+// The encoding is native-endian and refers to the process-local format and category tables, a record is
+// not meant to leave the process.
+class LogRecord
+{
+public:
+    // renders an argument from its data when the record is rendered, e.g. a serialized protobuf message
+    // into its debug string
+    typedef QString (*Renderer)(const QByteArray &data);
+    struct Deferred
+    {
+        Deferred(Renderer renderer, const QByteArray &data) : renderer(renderer), data(data) {}
+        Renderer renderer;
+        QByteArray data;
+    };
+
+    // a record rendered to text
+    struct Rendered
+    {
+        QtMsgType type;
+        qint64 timeMs;          // milliseconds since epoch (UTC)
+        qint64 processTimeMs;   // milliseconds since the start of the process
+        QString category;
+        QString message;
+    };
+
+    LogRecord(quint16 categoryId, QtMsgType type, quint32 formatId);
+
+    LogRecord &arg(int value) { return arg(static_cast<qint64>(value)); }
+    LogRecord &arg(uint value) { return arg(static_cast<quint64>(value)); }
+    LogRecord &arg(long value) { return arg(static_cast<qint64>(value)); }
+    LogRecord &arg(ulong value) { return arg(static_cast<quint64>(value)); }
+    LogRecord &arg(qint64 value);
+    LogRecord &arg(quint64 value);
+    LogRecord &arg(double value);
+    LogRecord &arg(bool value);
+    LogRecord &arg(const QString &value);
+    LogRecord &arg(const char *value);          // UTF-8
+    LogRecord &arg(const QByteArray &value);    // UTF-8
+    LogRecord &arg(const std::string &value);   // UTF-8
+    LogRecord &arg(const Deferred &value);
+
+    // the record of a call site, |format| is already registered as |formatId|
+    template<typename... Args>
+    static LogRecord create(quint16 categoryId, QtMsgType type, quint32 formatId, const char *format,
+                            Args &&... args)
+    {
+        Q_UNUSED(format);
+        LogRecord record(categoryId, type, formatId);
+        record.args(std::forward<Args>(args)...);
+        return record;
+    }
+
+    LogRecord &args() { return *this; }
+    template<typename Arg, typename... Rest>
+    LogRecord &args(Arg &&value, Rest &&... rest)
+    {
+        arg(std::forward<Arg>(value));
+        return args(std::forward<Rest>(rest)...);
+    }
+
+    QtMsgType type() const { return type_; }
+    quint16 categoryId() const { return categoryId_; }
+    const QByteArray &data() const { return data_; }
+
+    // Register the category and the format string of a call site, once. |format| - a string literal with
+    // the placeholders %1..%9, as for QString::arg().
+    static quint16 registerCategory(const char *name);
+    static quint32 registerFormat(const char *format);
+    template<typename... Args>
+    static const char *formatOf(const char *format, Args &&...) { return format; }
+    static QString categoryName(quint16 categoryId);
+    // the name as registered, the same pointer as QLoggingCategory::categoryName() of the category
+    static const char *categoryKey(quint16 categoryId);
+
+    // false if |data| is not a valid record
+    static bool render(const QByteArray &data, Rendered *rendered);
+
+private:
+    enum ArgType : quint8 {
+        ARG_INT,
+        ARG_UINT,
+        ARG_DOUBLE,
+        ARG_BOOL,
+        ARG_UTF16,
+        ARG_UTF8,
+        ARG_DEFERRED
+    };
+
+    void appendArgType(ArgType type);
+    void appendBytes(const void *data, int size);
+    void appendSized(const void *data, int size);
+
+    QByteArray data_;
+    QtMsgType type_;
+    quint16 categoryId_;
+};
+
+#endif // LOGRECORD_H
@@ -0,0 +1,152 @@
+#include "logring.h"
+#include <cstring>
+
+namespace {
+const quint32 RING_MAGIC = 0x474C5357;      // "WSLG"
+const quint32 RING_VERSION = 1;
+const int SNAPSHOT_ATTEMPTS = 3;
+}
+
+LogRing::LogRing() : header_(nullptr), data_(nullptr), capacity_(0)
+{
+}
+
+LogRing::~LogRing()
+{
+    close();
+}
+
+bool LogRing::open(const QString &path, quint32 capacity, bool keepContents)
+{
+    Q_ASSERT(!isOpen());
+    Q_ASSERT(capacity > 0);
+
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadWrite))
+    {
+        return false;
+    }
+    const qint64 fileSize = static_cast<qint64>(sizeof(Header)) + capacity;
+    const bool isSameLayout = file_.size() == fileSize;
+    if (!isSameLayout && !file_.resize(fileSize))
+    {
+        file_.close();
+        return false;
+    }
+
+    uchar *map = file_.map(0, fileSize);
+    if (!map)
+    {
+        file_.close();
+        return false;
+    }
+    header_ = reinterpret_cast<Header *>(map);
+    data_ = reinterpret_cast<char *>(map + sizeof(Header));
+    capacity_ = capacity;
+
+    const bool isValid = isSameLayout && header_->magic == RING_MAGIC && header_->version == RING_VERSION &&
+                         header_->capacity == capacity;
+    if (keepContents && isValid)
+    {
+        // a line which was being written at the time of a crash is dropped
+        header_->reservePos.store(header_->writePos.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    else
+    {
+        header_->magic = RING_MAGIC;
+        header_->version = RING_VERSION;
+        header_->capacity = capacity;
+        header_->reserved = 0;
+        header_->reservePos.store(0, std::memory_order_relaxed);
+        header_->writePos.store(0, std::memory_order_release);
+    }
+    return true;
+}
+
+void LogRing::close()
+{
+    if (header_)
+    {
+        file_.unmap(reinterpret_cast<uchar *>(header_));
+        header_ = nullptr;
+        data_ = nullptr;
+    }
+    file_.close();
+}
+
+void LogRing::append(const QByteArray &line)
+{
+    if (!header_ || line.isEmpty())
+    {
+        return;
+    }
+    // a line longer than the ring keeps its tail, with the terminating '\n'
+    const char *src = line.constData();
+    quint64 len = static_cast<quint64>(line.size());
+    if (len > capacity_)
+    {
+        src += len - capacity_;
+        len = capacity_;
+    }
+
+    const quint64 pos = header_->writePos.load(std::memory_order_relaxed);
+    header_->reservePos.store(pos + len, std::memory_order_relaxed);
+    // readers which see any of the bytes below also see the new reserve position
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const quint64 offset = pos % capacity_;
+    const quint64 first = qMin(len, capacity_ - offset);
+    memcpy(data_ + offset, src, first);
+    if (first < len)
+    {
+        memcpy(data_, src + first, len - first);
+    }
+
+    header_->writePos.store(pos + len, std::memory_order_release);
+}
+
+QByteArray LogRing::snapshot() const
+{
+    if (!header_)
+    {
+        return QByteArray();
+    }
+
+    for (int attempt = 0; attempt < SNAPSHOT_ATTEMPTS; ++attempt)
+    {
+        const quint64 end = header_->writePos.load(std::memory_order_acquire);
+        const quint64 start = end > capacity_ ? end - capacity_ : 0;
+        QByteArray buf(static_cast<int>(end - start), Qt::Uninitialized);
+        copyOut(start, buf.data(), end - start);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const quint64 reserved = header_->reservePos.load(std::memory_order_relaxed);
+        const quint64 validStart = reserved > capacity_ ? qMax(start, reserved - capacity_) : start;
+        if (validStart >= end && end != 0)
+        {
+            // the writer went around the whole ring during the copy
+            continue;
+        }
+
+        buf.remove(0, static_cast<int>(validStart - start));
+        if (validStart > 0)
+        {
+            // the oldest line is cut, it starts after the first line break
+            const int ind = buf.indexOf('\n');
+            buf.remove(0, ind >= 0 ? ind + 1 : buf.size());
+        }
+        return buf;
+    }
+    return QByteArray();
+}
+
+void LogRing::copyOut(quint64 pos, char *dst, quint64 len) const
+{
+    const quint64 offset = pos % capacity_;
+    const quint64 first = qMin(len, capacity_ - offset);
+    memcpy(dst, data_ + offset, first);
+    if (first < len)
+    {
+        memcpy(dst + first, data_, len - first);
+    }
+}
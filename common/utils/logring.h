@@ -0,0 +1,49 @@
+#ifndef LOGRING_H
+#define LOGRING_H
+
+#include <QByteArray>
+#include <QFile>
+#include <atomic>
+
+// Fixed-size ring of the most recent log lines (UTF-8, '\n'-terminated), kept in a memory-mapped file.
+// The memory use is bounded by the capacity, and the lines already appended survive a crash of the
+// process without flushing, since the pages belong to the file.
+// There is a single writer; snapshot() can be taken from any thread without locking: the copy is checked
+// against the write position afterwards and the part overwritten meanwhile is dropped.
+class LogRing
+{
+public:
+    LogRing();
+    ~LogRing();
+
+    // |keepContents| - continue the ring left by the previous run (e.g. the engine restarted after a crash)
+    bool open(const QString &path, quint32 capacity, bool keepContents);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    // writer thread only
+    void append(const QByteArray &line);
+
+    // the complete lines currently in the ring, oldest first
+    QByteArray snapshot() const;
+
+private:
+    struct Header
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 capacity;
+        quint32 reserved;
+        std::atomic<quint64> reservePos;    // bytes being written end here, the data before can be overwritten
+        std::atomic<quint64> writePos;      // bytes up to here are complete
+    };
+
+    QFile file_;
+    Header *header_;
+    char *data_;
+    quint32 capacity_;
+
+    void copyOut(quint64 pos, char *dst, quint64 len) const;
+};
+
+#endif // LOGRING_H
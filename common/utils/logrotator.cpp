@@ -0,0 +1,218 @@
+#include "logrotator.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+
+namespace {
+const char *COMPRESSED_SUFFIX = ".qz";
+const int COMPRESSION_LEVEL = 6;
+// the log is compressed and uncompressed in pieces of this size
+const int COMPRESSION_BLOCK_SIZE = 1024 * 1024;
+
+bool readBlockSize(QFile &file, quint32 *size)
+{
+    uchar header[4];
+    if (file.read(reinterpret_cast<char *>(header), sizeof(header)) != sizeof(header))
+    {
+        return false;
+    }
+    *size = qFromBigEndian<quint32>(header);
+    return true;
+}
+}
+
+LogRotator::Settings::Settings() : maxFileSize(50 * 1024 * 1024), maxAgeSecs(7 * 24 * 60 * 60), generations(5)
+{
+}
+
+LogRotator::LogRotator(const QString &logPath, const QString &prevLogPath, const Settings &settings) :
+    logPath_(logPath), prevLogPath_(prevLogPath), settings_(settings), isCompressing_(false)
+{
+    Q_ASSERT(settings_.generations >= 1);
+}
+
+LogRotator::~LogRotator()
+{
+    waitForCompression();
+}
+
+bool LogRotator::isRotationDue(qint64 fileSize, qint64 ageSecs) const
+{
+    return (settings_.maxFileSize > 0 && fileSize >= settings_.maxFileSize) ||
+           (settings_.maxAgeSecs > 0 && ageSecs >= settings_.maxAgeSecs && fileSize > 0);
+}
+
+bool LogRotator::isReadyToRotate() const
+{
+    return !isCompressing_;
+}
+
+bool LogRotator::rotate()
+{
+    // the generations are only shifted for a new one
+    if (!QFile::exists(logPath_))
+    {
+        return false;
+    }
+    // the writer isn't held up by the compression, it rotates the log a bit later instead
+    if (!isReadyToRotate())
+    {
+        return false;
+    }
+    // the thread is done, the join doesn't block
+    waitForCompression();
+
+    const QString firstGeneration = generationPath(prevLogPath_, 1);
+    // a plain generation 1 is left by a run which exited before compressing it, or by an older version
+    if (QFile::exists(prevLogPath_))
+    {
+        QFile::remove(firstGeneration);
+        compressFile(prevLogPath_, firstGeneration);
+        QFile::remove(prevLogPath_);
+    }
+
+    QFile::remove(generationPath(prevLogPath_, settings_.generations));
+    for (int generation = settings_.generations - 1; generation >= 1; --generation)
+    {
+        const QString path = generationPath(prevLogPath_, generation);
+        if (QFile::exists(path))
+        {
+            QFile::rename(path, generationPath(prevLogPath_, generation + 1));
+        }
+    }
+
+    // a rename doesn't depend on the size of the log, the copy is only for a file locked by another program
+    if (!QFile::rename(logPath_, prevLogPath_) && !QFile::copy(logPath_, prevLogPath_))
+    {
+        return false;
+    }
+
+    const QString srcPath = prevLogPath_;
+    isCompressing_ = true;
+    compressThread_ = std::thread([this, srcPath, firstGeneration]()
+    {
+        if (compressFile(srcPath, firstGeneration))
+        {
+            QFile::remove(srcPath);
+        }
+        isCompressing_ = false;
+    });
+    return true;
+}
+
+void LogRotator::waitForCompression()
+{
+    if (compressThread_.joinable())
+    {
+        compressThread_.join();
+    }
+}
+
+QString LogRotator::generationPath(const QString &prevLogPath, int generation)
+{
+    if (generation <= 1)
+    {
+        return prevLogPath + COMPRESSED_SUFFIX;
+    }
+    const int extInd = prevLogPath.lastIndexOf('.');
+    const int sepInd = qMax(prevLogPath.lastIndexOf('/'), prevLogPath.lastIndexOf('\\'));
+    if (extInd <= sepInd)
+    {
+        return prevLogPath + "." + QString::number(generation) + COMPRESSED_SUFFIX;
+    }
+    return prevLogPath.left(extInd) + "." + QString::number(generation) + prevLogPath.mid(extInd) + COMPRESSED_SUFFIX;
+}
+
+QByteArray LogRotator::readLogFile(const QString &path)
+{
+    const bool isCompressed = path.endsWith(QLatin1String(COMPRESSED_SUFFIX));
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        // the plain generation 1 may have been compressed and removed meanwhile
+        if (!isCompressed && QFile::exists(path + COMPRESSED_SUFFIX))
+        {
+            return readLogFile(path + COMPRESSED_SUFFIX);
+        }
+        return QByteArray();
+    }
+    if (!isCompressed)
+    {
+        return file.readAll();
+    }
+    QByteArray text;
+    quint32 blockSize;
+    while (readBlockSize(file, &blockSize))
+    {
+        const QByteArray block = file.read(blockSize);
+        if (block.size() != static_cast<int>(blockSize))
+        {
+            break;
+        }
+        text += qUncompress(block);
+    }
+    return text;
+}
+
+qint64 LogRotator::logFileSize(const QString &path)
+{
+    if (!path.endsWith(QLatin1String(COMPRESSED_SUFFIX)))
+    {
+        return QFileInfo(path).size();
+    }
+    // each block is preceded by its size, and the qCompress() output starts with the uncompressed size, big-endian
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return 0;
+    }
+    qint64 size = 0;
+    quint32 blockSize, textSize;
+    while (readBlockSize(file, &blockSize) && readBlockSize(file, &textSize))
+    {
+        size += textSize;
+        if (!file.seek(file.pos() + static_cast<qint64>(blockSize) - static_cast<qint64>(sizeof(textSize))))
+        {
+            break;
+        }
+    }
+    return size;
+}
+
+QString LogRotator::existingPrevLogPath(const QString &prevLogPath)
+{
+    return QFile::exists(prevLogPath) ? prevLogPath : generationPath(prevLogPath, 1);
+}
+
+bool LogRotator::compressFile(const QString &srcPath, const QString &dstPath)
+{
+    QFile src(srcPath);
+    if (!src.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    // written under a temporary name, so readers never see a partial generation
+    const QString tmpPath = dstPath + ".tmp";
+    QFile dst(tmpPath);
+    bool isOk = dst.open(QIODevice::WriteOnly);
+    while (isOk && !src.atEnd())
+    {
+        const QByteArray block = qCompress(src.read(COMPRESSION_BLOCK_SIZE), COMPRESSION_LEVEL);
+        uchar header[4];
+        qToBigEndian<quint32>(static_cast<quint32>(block.size()), header);
+        isOk = !block.isEmpty() &&
+               dst.write(reinterpret_cast<const char *>(header), sizeof(header)) == sizeof(header) &&
+               dst.write(block) == block.size();
+    }
+    isOk = isOk && src.error() == QFileDevice::NoError;
+    src.close();
+    dst.close();
+    if (!isOk)
+    {
+        QFile::remove(tmpPath);
+        return false;
+    }
+    QFile::remove(dstPath);
+    return QFile::rename(tmpPath, dstPath);
+}
@@ -0,0 +1,62 @@
+#ifndef LOGROTATOR_H
+#define LOGROTATOR_H
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+#include <thread>
+
+// Rotation of a log file into numbered generations:
+//   log_<name>.txt                 - the current log
+//   prev_log_<name>.txt.qz         - generation 1, the log of the previous run (or the previous part of this run)
+//   prev_log_<name>.<N>.txt.qz     - older generations, N = 2 .. generations
+// A generation is moved out of the current log by a rename and then compressed in the background; until the
+// compression is done it stays as the plain prev_log_<name>.txt. A compressed generation is a sequence of blocks,
+// each the qCompress() (zlib) of a piece of the log preceded by its size, so the log is never compressed in memory
+// as a whole. readLogFile() gives the same text for the plain and the compressed file.
+class LogRotator
+{
+public:
+    struct Settings
+    {
+        Settings();
+        qint64 maxFileSize;     // bytes, the current log is rotated once it gets bigger
+        qint64 maxAgeSecs;      // the current log is rotated once it is written for longer
+        int generations;        // rotated generations kept, the oldest one is removed
+    };
+
+    LogRotator(const QString &logPath, const QString &prevLogPath, const Settings &settings);
+    ~LogRotator();
+
+    const Settings &settings() const { return settings_; }
+
+    // |fileSize| and |ageSecs| - of the current log
+    bool isRotationDue(qint64 fileSize, qint64 ageSecs) const;
+    // false while the generation moved out by the last rotate() is being compressed, a rotation waits for it then
+    bool isReadyToRotate() const;
+    // moves the current log to generation 1, the current log must not be open for writing; false if there is no
+    // current log, or the compression of the last generation has not finished yet
+    bool rotate();
+    // blocks until the generation moved out by the last rotate() is compressed
+    void waitForCompression();
+
+    // path of the compressed generation |generation| (1-based) of the log with |prevLogPath| generation 1
+    static QString generationPath(const QString &prevLogPath, int generation);
+    // the text of a plain or compressed log file, empty if it can't be read
+    static QByteArray readLogFile(const QString &path);
+    // the size of the text of a plain or compressed log file, without reading it all
+    static qint64 logFileSize(const QString &path);
+    // generation 1 of the log as it is on disk now: plain while its compression is pending, compressed after
+    static QString existingPrevLogPath(const QString &prevLogPath);
+
+private:
+    QString logPath_;
+    QString prevLogPath_;
+    Settings settings_;
+    std::thread compressThread_;
+    std::atomic<bool> isCompressing_;
+
+    static bool compressFile(const QString &srcPath, const QString &dstPath);
+};
+
+#endif // LOGROTATOR_H
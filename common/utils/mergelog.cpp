@@ -1,15 +1,14 @@
 #include "mergelog.h"
+#include "logger.h"
+#include "logrotator.h"
+#include <QBuffer>
 #include <QCoreApplication>
-#include <QDateTime>
+#include <QDate>
 #include <QFile>
 #include <QStandardPaths>
-#include <QTextStream>
 #include <QFileInfo>
-#include <fstream>
-#include <iostream>
-#include <sstream>
-#include <thread>
-#include <future>
+#include <cstring>
+#include <vector>
 
 namespace
 {
@@ -20,65 +19,308 @@ namespace
 // Even at 500MB, application is very slow to load (5-10s) and UI background glitches are obivous
 const quint64 MAX_COMBINED_LOG_SIZE = 500000000; // 500MB
 
-bool isYearInDatePresent(const std::string &dateline)
+// the merged log is written to the output device in chunks of this size
+const int OUTPUT_CHUNK_SIZE = 64 * 1024;
+
+enum class LineSource { GUI, ENGINE, SERVICE, NUM_LINE_SOURCES };
+
+const char *sourcePrefix(LineSource source)
 {
-    const int scan = qMin(6, (int)dateline.size());
-    for (int i = 0; i < scan; ++i)
-        if (dateline[i] == ' ')
+    switch (source) {
+    case LineSource::GUI:
+        return "G ";
+    case LineSource::ENGINE:
+        return "E ";
+    case LineSource::SERVICE:
+        return "S ";
+    default:
+        return "";
+    }
+}
+
+bool parseDigits(const char *p, int count, int *value)
+{
+    int v = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (p[i] < '0' || p[i] > '9')
             return false;
+        v = v * 10 + (p[i] - '0');
+    }
+    *value = v;
     return true;
 }
 
-// parse date from string "ddMMyy hh:mm:ss:zzz"
-QDateTime parseDateTimeFormat1(const std::string &datestr)
+// Parses the time of a line starting with "[ddMMyy hh:mm:ss:zzz" or, in older logs, "[ddMM hh:mm:ss:zzz" (the
+// current year is assumed) into yyyyMMddhhmmsszzz, which orders the same way as the time.
+bool parseLineTime(const char *line, int len, int currentYear, qint64 *key)
 {
-    int dd,MM,yy;
-    int hh, mm, ss, zzz;
-    if (sscanf(datestr.c_str(),"%02d%02d%02d %02d:%02d:%02d:%03d", &dd, &MM, &yy, &hh, &mm, &ss, &zzz) == 7)
+    int dd, MM, yy, hh, mm, ss, zzz;
+    const char *p = line + 1;
+    const char *end = line + len;
+    if (len < 18 || !parseDigits(p, 4, &dd))
+        return false;
+    MM = dd % 100;
+    dd /= 100;
+    p += 4;
+    if (*p == ' ')
     {
-        return QDateTime(QDate(yy + 1900, MM, dd), QTime(hh, mm, ss, zzz));
+        yy = currentYear;
     }
     else
     {
-        return QDateTime();
+        if (end - p < 2 || !parseDigits(p, 2, &yy))
+            return false;
+        yy += 2000;
+        p += 2;
     }
+    if (end - p < 13 || p[0] != ' ' || p[3] != ':' || p[6] != ':' || p[9] != ':' ||
+        !parseDigits(p + 1, 2, &hh) || !parseDigits(p + 4, 2, &mm) || !parseDigits(p + 7, 2, &ss) ||
+        !parseDigits(p + 10, 3, &zzz))
+        return false;
+
+    *key = ((((static_cast<qint64>(yy) * 100 + MM) * 100 + dd) * 100 + hh) * 100 + mm) * 100000 + ss * 1000 + zzz;
+    return true;
 }
 
-// parse date from string "ddMM hh:mm:ss:zzz"
-QDateTime parseDateTimeFormat2(const std::string &datestr)
+// A log file mapped into memory, or the unpacked text of a compressed generation.
+class LogInput
 {
-    int dd,MM;
-    int hh, mm, ss, zzz;
-    if (sscanf(datestr.c_str(),"%02d%02d %02d:%02d:%02d:%03d", &dd, &MM, &hh, &mm, &ss, &zzz) == 6)
+public:
+    explicit LogInput(const QString &path) : begin_(nullptr), end_(nullptr)
+    {
+        if (path.isEmpty())
+            return;
+        file_.setFileName(path);
+        if (path.endsWith(".qz") || !file_.open(QIODevice::ReadOnly))
+        {
+            // a compressed generation, or the plain one which has just been compressed
+            text_ = LogRotator::readLogFile(path);
+            setRange(text_.constData(), text_.size());
+            return;
+        }
+        // a file which is still written (the log of this process) is merged up to its size at this moment
+        const qint64 size = file_.size();
+        if (size <= 0)
+            return;
+        if (const uchar *map = file_.map(0, size))
+        {
+            setRange(reinterpret_cast<const char *>(map), size);
+        }
+        else
+        {
+            text_ = file_.readAll();
+            setRange(text_.constData(), text_.size());
+        }
+    }
+
+    const char *begin() const { return begin_; }
+    const char *end() const { return end_; }
+
+private:
+    QFile file_;
+    QByteArray text_;
+    const char *begin_;
+    const char *end_;
+
+    void setRange(const char *data, qint64 size)
     {
-        return QDateTime(QDate(1900, MM, dd), QTime(hh, mm, ss, zzz));
+        begin_ = data;
+        end_ = data + size;
     }
-    else
+};
+
+// The timestamped lines of one log in the file order. Lines which don't start with a timestamp are skipped.
+class LineCursor
+{
+public:
+    LineCursor(const LogInput &input, LineSource source, int currentYear)
+        : pos_(input.begin()), end_(input.end()), line_(nullptr), lineLen_(0), key_(0), source_(source),
+          currentYear_(currentYear), isRange_(false), minKey_(0), maxKey_(0)
+    {
+    }
+
+    // only the lines from |minKey| to |maxKey| are taken
+    void setRange(qint64 minKey, qint64 maxKey)
+    {
+        isRange_ = true;
+        minKey_ = minKey;
+        maxKey_ = maxKey;
+    }
+
+    bool next()
+    {
+        while (pos_ && pos_ < end_)
+        {
+            const char *lineEnd = static_cast<const char *>(memchr(pos_, '\n', end_ - pos_));
+            if (!lineEnd)
+                lineEnd = end_;
+            const char *line = pos_;
+            int len = static_cast<int>(lineEnd - line);
+            pos_ = lineEnd + 1;
+            if (len > 0 && line[len - 1] == '\r')
+                --len;
+
+            qint64 key;
+            if (len == 0 || line[0] != '[' || !parseLineTime(line, len, currentYear_, &key))
+                continue;
+            if (isRange_ && (key < minKey_ || key > maxKey_))
+                continue;
+            line_ = line;
+            lineLen_ = len;
+            key_ = key;
+            return true;
+        }
+        line_ = nullptr;
+        return false;
+    }
+
+    bool hasLine() const { return line_ != nullptr; }
+    const char *line() const { return line_; }
+    int lineLength() const { return lineLen_; }
+    qint64 key() const { return key_; }
+    LineSource source() const { return source_; }
+
+    // the time of the first and of the last timestamped line, false if there are none
+    static bool timeRange(const LogInput &input, int currentYear, qint64 *firstKey, qint64 *lastKey)
+    {
+        LineCursor cursor(input, LineSource::GUI, currentYear);
+        if (!cursor.next())
+            return false;
+        *firstKey = cursor.key();
+        // the last line is searched for from the end, the log is not scanned as a whole
+        const char *end = input.end();
+        while (end > input.begin())
+        {
+            const char *lineEnd = end;
+            const char *p = end - 1;
+            if (p >= input.begin() && *p == '\n')
+                --p;
+            while (p >= input.begin() && *p != '\n')
+                --p;
+            const char *line = p + 1;
+            int len = static_cast<int>(lineEnd - line);
+            while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+                --len;
+            if (len > 0 && line[0] == '[' && parseLineTime(line, len, currentYear, lastKey))
+                return true;
+            end = line;
+        }
+        *lastKey = *firstKey;
+        return true;
+    }
+
+private:
+    const char *pos_;
+    const char *end_;
+    const char *line_;
+    int lineLen_;
+    qint64 key_;
+    LineSource source_;
+    int currentYear_;
+    bool isRange_;
+    qint64 minKey_;
+    qint64 maxKey_;
+};
+
+// k-way merge of the cursors by time; the inputs are at most a few files, so the earliest line is picked by
+// a linear scan; equal times keep the order of the cursors (GUI, engine, service)
+template<typename Visitor>
+void mergeCursors(std::vector<LineCursor> &cursors, Visitor visit)
+{
+    for (LineCursor &cursor : cursors)
+        cursor.next();
+    for (;;)
     {
-        return QDateTime();
+        LineCursor *earliest = nullptr;
+        for (LineCursor &cursor : cursors)
+        {
+            if (cursor.hasLine() && (!earliest || cursor.key() < earliest->key()))
+                earliest = &cursor;
+        }
+        if (!earliest)
+            return;
+        visit(*earliest);
+        earliest->next();
     }
 }
 
+// Buffers the output, so the device is written in big chunks.
+class ChunkedWriter
+{
+public:
+    explicit ChunkedWriter(QIODevice *out) : out_(out), isFailed_(false)
+    {
+        buf_.reserve(OUTPUT_CHUNK_SIZE + 1024);
+    }
+
+    void append(const char *data, int len)
+    {
+        buf_.append(data, len);
+        if (buf_.size() >= OUTPUT_CHUNK_SIZE)
+            flush();
+    }
+
+    void appendLine(const LineCursor &cursor)
+    {
+        const char *prefix = sourcePrefix(cursor.source());
+        buf_.append(prefix, static_cast<int>(strlen(prefix)));
+        append(cursor.line(), cursor.lineLength());
+        append("\n", 1);
+    }
+
+    bool flush()
+    {
+        if (!buf_.isEmpty() && !isFailed_)
+            isFailed_ = out_->write(buf_) != buf_.size();
+        buf_.clear();
+        return !isFailed_;
+    }
+
+private:
+    QIODevice *out_;
+    QByteArray buf_;
+    bool isFailed_;
+};
 
 }  // namespace
 
 QString MergeLog::mergeLogs(bool doMergePerLine)
 {
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    mergeLogsTo(&buffer, doMergePerLine);
+    return QString::fromLocal8Bit(buffer.data());
+}
+
+QString MergeLog::mergePrevLogs(bool doMergePerLine)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    mergePrevLogsTo(&buffer, doMergePerLine);
+    return QString::fromLocal8Bit(buffer.data());
+}
+
+bool MergeLog::mergeLogsTo(QIODevice *out, bool doMergePerLine)
+{
+    // the log of this process is written in the background, get the lines logged so far into the file
+    Logger::instance().flush();
+
     const QString guiLogFilename = guiLogLocation();
     const QString engineLogFilename = engineLogLocation();
     const QString serviceLogFilename1 = serviceLogLocation();
     const QString serviceLogFilename2 = prevServiceLogLocation();
-    return merge(guiLogFilename, engineLogFilename, serviceLogFilename1, serviceLogFilename2,
+    return merge(out, guiLogFilename, engineLogFilename, serviceLogFilename1, serviceLogFilename2,
                  doMergePerLine);
 }
 
-QString MergeLog::mergePrevLogs(bool doMergePerLine)
+bool MergeLog::mergePrevLogsTo(QIODevice *out, bool doMergePerLine)
 {
-    const QString guiLogFilename = prevGuiLogLocation();
-    const QString engineLogFilename = prevEngineLogLocation();
+    const QString guiLogFilename = LogRotator::existingPrevLogPath(prevGuiLogLocation());
+    const QString engineLogFilename = LogRotator::existingPrevLogPath(prevEngineLogLocation());
     const QString serviceLogFilename1 = serviceLogLocation();
     const QString serviceLogFilename2 = prevServiceLogLocation();
-    return merge(guiLogFilename, engineLogFilename, serviceLogFilename1, serviceLogFilename2,
+    return merge(out, guiLogFilename, engineLogFilename, serviceLogFilename1, serviceLogFilename2,
                  doMergePerLine);
 }
 
@@ -94,13 +336,11 @@ bool MergeLog::canMerge()
     QFileInfo engineLogInfo(engineLogLocation());
     mergedFileSize += engineLogInfo.size();
 
-    // prev gui
-    QFileInfo prevGuiLogInfo(prevGuiLogLocation());
-    mergedFileSize += prevGuiLogInfo.size();
+    // prev gui, the size of the text if the generation is compressed already
+    mergedFileSize += LogRotator::logFileSize(LogRotator::existingPrevLogPath(prevGuiLogLocation()));
 
     // prev engine
-    QFileInfo prevEngineLogInfo(prevEngineLogLocation());
-    mergedFileSize += prevEngineLogInfo.size();
+    mergedFileSize += LogRotator::logFileSize(LogRotator::existingPrevLogPath(prevEngineLogLocation()));
 
     // service (twice)
     QFileInfo serviceLogInfo(serviceLogLocation());
@@ -113,59 +353,6 @@ bool MergeLog::canMerge()
     return mergedFileSize < MAX_COMBINED_LOG_SIZE;
 }
 
-int MergeLog::mergeTask(QMutex *mutex, QMultiMap<quint64, QPair<LineSource, QString>> *lines, const QString *filename, LineSource source, bool useMinMax, QDateTime min, QDateTime max)
-{
-    int datasize = 0;
-    const int kCurrentYearOffset = QDateTime::currentDateTime().date().year() - 1900;
-    QDateTime prevDateTime;
-
-    std::ifstream file;
-    file.open(filename->toStdString());
-    if (file.fail())
-    {
-        return 0;
-    }
-
-    int timestamp = 0;
-    std::string line;
-    while (std::getline(file, line))
-    {
-        if (line[0] != '[')
-            continue;
-        const auto datestr = line.substr(1, 19);
-
-        const auto datetime = isYearInDatePresent(datestr)
-            ? parseDateTimeFormat1(datestr)
-                .addYears(100)
-            : parseDateTimeFormat2(datestr)
-                .addYears(kCurrentYearOffset);
-
-        if (useMinMax && (datetime < min || datetime > max))
-            continue;
-        if (prevDateTime != datetime) {
-            prevDateTime = datetime;
-            timestamp = 0;
-        }
-
-        // In QMultiMap, elements with the same key will be placed in a reverse order.
-        // https://doc.qt.io/qt-5/qmap-iterator.html#details
-        // To deal with the issue, we create a compound key: 44 bits for a timestamp, 2 bits
-        // for the source, and 18 additional lower bits for a "timestamp" (line serial
-        // number). We assume the maximum number of lines with unique timestamp never
-        // exceeds 262143, which is quite reasonable (it looks infeasible to output 250k+
-        // lines to a log file within 1 ms).
-        const auto key = (static_cast<quint64>(datetime.toMSecsSinceEpoch()) << 20)
-                       | (static_cast<quint64>(source) << 18) | qMin(timestamp++, 0x3ffff);
-
-        {
-            QMutexLocker locker(mutex);
-            lines->insert(key, qMakePair(source, QString::fromStdString(line)));
-        }
-        datasize += line.length() + 3;
-    }
-    return datasize;
-}
-
 const QString MergeLog::guiLogLocation()
 {
     QString path = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
@@ -216,107 +403,105 @@ const QString MergeLog::prevServiceLogLocation()
 #endif
 }
 
-QString MergeLog::merge(const QString &guiLogFilename, const QString &engineLogFilename,
-                        const QString &serviceLogFilename, const QString &servicePrevLogFilename,
-                        bool doMergePerLine)
-{
-    QMutex mutex;
-    QMultiMap<quint64, QPair<LineSource, QString>> lines;
-    int estimatedLogSize = 0;
 
-    auto futureGuiLog = std::async(MergeLog::mergeTask, &mutex, &lines, &guiLogFilename, LineSource::GUI, false, QDateTime(), QDateTime());
-    auto futureEngineLog = std::async(MergeLog::mergeTask, &mutex, &lines, &engineLogFilename, LineSource::ENGINE, false, QDateTime(), QDateTime());
-    estimatedLogSize += futureGuiLog.get();
-    estimatedLogSize += futureEngineLog.get();
+bool MergeLog::merge(QIODevice *out, const QString &guiLogFilename, const QString &engineLogFilename,
+                     const QString &serviceLogFilename, const QString &servicePrevLogFilename,
+                     bool doMergePerLine)
+{
+    const int currentYear = QDate::currentDate().year();
+    const LogInput guiLog(guiLogFilename);
+    const LogInput engineLog(engineLogFilename);
+    const LogInput serviceLog(serviceLogFilename);
+    const LogInput servicePrevLog(servicePrevLogFilename);
 
-    QDateTime minDate, maxDate;
+    // the service lines are only taken within the time of the GUI and engine logs
     bool isUseMinMaxDate = false;
-    if (lines.count() > 1)
+    qint64 minKey = 0, maxKey = 0;
+    for (const LogInput *input : { &guiLog, &engineLog })
     {
-        minDate = QDateTime::fromMSecsSinceEpoch(lines.firstKey() >> 20); // Strip source and timestamp.
-        maxDate = QDateTime::fromMSecsSinceEpoch(lines.lastKey() >> 20);
-        isUseMinMaxDate = true;
+        qint64 first, last;
+        if (LineCursor::timeRange(*input, currentYear, &first, &last))
+        {
+            minKey = isUseMinMaxDate ? qMin(minKey, first) : first;
+            maxKey = isUseMinMaxDate ? qMax(maxKey, last) : last;
+            isUseMinMaxDate = true;
+        }
     }
 
-    auto futureService = std::async(MergeLog::mergeTask, &mutex, &lines, &serviceLogFilename, LineSource::SERVICE, isUseMinMaxDate, minDate, maxDate);
-    auto futureServicePrev = std::async(MergeLog::mergeTask, &mutex, &lines, &servicePrevLogFilename, LineSource::SERVICE, isUseMinMaxDate, minDate, maxDate);
-    estimatedLogSize += futureService.get() + futureServicePrev.get();
-
-    if (!doMergePerLine)
-        estimatedLogSize += 400;  // Account for log separation lines.
-
-    QString result;
-    result.reserve(estimatedLogSize);
-    auto logAppendFun = [&result](const QPair<LineSource, QString> &data) {
-        switch (data.first) {
-        case LineSource::GUI:
-            result.append("G ");
-            break;
-        case LineSource::ENGINE:
-            result.append("E ");
-            break;
-        case LineSource::SERVICE:
-            result.append("S ");
-            break;
-        default:
-            break;
+    const auto makeCursors = [&]()
+    {
+        std::vector<LineCursor> cursors;
+        cursors.emplace_back(guiLog, LineSource::GUI, currentYear);
+        cursors.emplace_back(engineLog, LineSource::ENGINE, currentYear);
+        cursors.emplace_back(serviceLog, LineSource::SERVICE, currentYear);
+        cursors.emplace_back(servicePrevLog, LineSource::SERVICE, currentYear);
+        if (isUseMinMaxDate)
+        {
+            cursors[2].setRange(minKey, maxKey);
+            cursors[3].setRange(minKey, maxKey);
         }
-        result.append(data.second);
-        result.append("\n");
+        return cursors;
     };
 
+    // the lines are counted in a first pass, which only parses the timestamps
+    int linesCount = 0;
+    {
+        std::vector<LineCursor> cursors = makeCursors();
+        mergeCursors(cursors, [&linesCount](const LineCursor &) { ++linesCount; });
+    }
+
     // cut out the part of the log if the count of lines  exceeds MAX_COUNT_OF_LINES (keep 10% begin and 90% end of log)
     int cutCount = 0;
     int cutBeginInd = 0;
-    int cutEndInd = lines.count();
-    if (lines.count() > MAX_COUNT_OF_LINES)
+    int cutEndInd = linesCount;
+    if (linesCount > MAX_COUNT_OF_LINES)
     {
-        cutCount = lines.count() - MAX_COUNT_OF_LINES;
+        cutCount = linesCount - MAX_COUNT_OF_LINES;
         cutBeginInd = MAX_COUNT_OF_LINES / 10;
-        cutEndInd = lines.count() - MAX_COUNT_OF_LINES * 0.9;
+        cutEndInd = linesCount - MAX_COUNT_OF_LINES * 0.9;
     }
 
-    if (doMergePerLine) {
-        int ind = 0;
-        for (auto it = lines.constBegin(); it != lines.constEnd(); ++it)
+    ChunkedWriter writer(out);
+    int ind = 0;
+    const auto writeLine = [&](const LineCursor &cursor)
+    {
+        // cut out middle
+        if (cutCount == 0 || ind < cutBeginInd || ind > cutEndInd)
         {
-            // cut out middle
-            if (cutCount == 0 || ind < cutBeginInd || ind > cutEndInd)
-            {
-                logAppendFun(it.value());
-            }
-            ind++;
+            writer.appendLine(cursor);
         }
+        ind++;
+    };
+
+    std::vector<LineCursor> cursors = makeCursors();
+    if (doMergePerLine) {
+        mergeCursors(cursors, writeLine);
     } else {
+        // the logs one after another, each merged with the other files of the same source
         const char *separators[] = { nullptr, "Engine", "Service" };
+        const QByteArray separatorTail(189, '-');
         for (int i = 0; i < static_cast<int>(LineSource::NUM_LINE_SOURCES); ++i) {
             const auto current_source = static_cast<LineSource>(i);
+            std::vector<LineCursor> sourceCursors;
+            for (const LineCursor &cursor : cursors)
+            {
+                if (cursor.source() == current_source)
+                    sourceCursors.push_back(cursor);
+            }
             bool is_first_line = true;
-            int ind = 0;
-            for (auto it = lines.constBegin(); it != lines.constEnd(); ++it) {
-                if (it.value().first != current_source)
-                {
-                    ind++;
-                    continue;
-                }
+            mergeCursors(sourceCursors, [&](const LineCursor &cursor) {
                 if (is_first_line) {
                     is_first_line = false;
                     if (separators[i]) {
-                        result.append("---");
-                        result.append(separators[i]);
-                        result.append(QString().fill('-',189));
-                        result.append("\n");
+                        writer.append("---", 3);
+                        writer.append(separators[i], static_cast<int>(strlen(separators[i])));
+                        writer.append(separatorTail.constData(), separatorTail.size());
+                        writer.append("\n", 1);
                     }
                 }
-                // cut out middle
-                if (cutCount == 0 || ind < cutBeginInd || ind > cutEndInd)
-                {
-                    logAppendFun(it.value());
-                }
-                ind++;
-            }
+                writeLine(cursor);
+            });
         }
     }
-    return result;
+    return writer.flush();
 }
-
@@ -1,28 +1,30 @@
 #ifndef MERGELOG_H
 #define MERGELOG_H
 
-#include <QDateTime>
+#include <QIODevice>
 #include <QString>
-#include <QMutex>
-#include <vector>
 
 // merge logs files log_gui.txt, log_engine.txt, windscribeservice.log to one, cut out the middle of the log if the count of lines  exceeds MAX_COUNT_OF_LINES
+// Every log file is already ordered by time, so the files are merged as streams: the inputs are memory-mapped and
+// the output is written to a device in chunks, the memory used doesn't depend on the size of the logs.
 class MergeLog
 {
 public:
     static QString mergeLogs(bool doMergePerLine);
     static QString mergePrevLogs(bool doMergePerLine);
 
+    // streaming versions, |out| - an open file, socket or any other device; false if writing to it failed
+    static bool mergeLogsTo(QIODevice *out, bool doMergePerLine);
+    static bool mergePrevLogsTo(QIODevice *out, bool doMergePerLine);
+
     // This is a quick hack to prevent GUI crash as result of merging files that are too large for the program
+    // only needed by the callers which keep the whole merged log in memory
     static bool canMerge();
 private:
     static constexpr int MAX_COUNT_OF_LINES = 100000;
-    static QString merge(const QString &guiLogFilename, const QString &engineLogFilename,
-                         const QString &serviceLogFilename, const QString &servicePrevLogFilename,
-                         bool doMergePerLine);
-
-    enum class LineSource { GUI, ENGINE, SERVICE, NUM_LINE_SOURCES };
-    static int mergeTask(QMutex *mutex, QMultiMap<quint64, QPair<LineSource, QString>> *lines, const QString *filename, LineSource source, bool useMinMax, QDateTime min, QDateTime max);
+    static bool merge(QIODevice *out, const QString &guiLogFilename, const QString &engineLogFilename,
+                      const QString &serviceLogFilename, const QString &servicePrevLogFilename,
+                      bool doMergePerLine);
 
     static const QString guiLogLocation();
     static const QString engineLogLocation();
@@ -4,6 +4,19 @@
 #include <QDebug>
 #include <QLoggingCategory>
 
+// the depth of the multiline messages being logged by the calling thread
+inline int &multilineMessageDepth()
+{
+    static thread_local int depth = 0;
+    return depth;
+}
+
+// true while the lines of a multiline message are logged, the message handler keeps them together
+inline bool isMultilineMessage()
+{
+    return multilineMessageDepth() > 0;
+}
+
 // MultilineMessageLogger: helper class to enable printing of each stream argument on a new line.
 // String lists are printed line by line; strings are split into lists by a newline (\n) character.
 template<typename OutputHelper>
@@ -12,8 +25,9 @@ class MultilineMessageLogger
     Q_DISABLE_COPY(MultilineMessageLogger)
 
 public:
-    Q_DECL_CONSTEXPR explicit MultilineMessageLogger(const QMessageLogger &logger)
-        : logger_(logger) {}
+    explicit MultilineMessageLogger(const QMessageLogger &logger)
+        : logger_(logger) { ++multilineMessageDepth(); }
+    ~MultilineMessageLogger() { --multilineMessageDepth(); }
 
     template<typename U>
     const MultilineMessageLogger &operator<<(U value) const
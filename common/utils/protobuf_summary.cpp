@@ -0,0 +1,103 @@
+#include "protobuf_summary.h"
+#include <vector>
+
+#ifdef _MSC_VER
+  #pragma warning(push)
+  #pragma warning(disable: 4018 4100 4267)
+#endif
+
+#include <google/protobuf/message.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/text_format.h>
+
+#ifdef _MSC_VER
+  #pragma warning(pop)
+#endif
+
+namespace Utils {
+
+namespace {
+
+using google::protobuf::FieldDescriptor;
+using google::protobuf::Message;
+using google::protobuf::Reflection;
+
+void appendMessage(std::string &out, const Message &message, int maxRepeatedItems, int maxStringLength);
+
+void appendValue(std::string &out, const Message &message, const FieldDescriptor *field, int index,
+                 int maxRepeatedItems, int maxStringLength)
+{
+    const Reflection *reflection = message.GetReflection();
+
+    if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE)
+    {
+        const Message &sub = field->is_repeated() ? reflection->GetRepeatedMessage(message, field, index)
+                                                  : reflection->GetMessage(message, field);
+        out += "{ ";
+        appendMessage(out, sub, maxRepeatedItems, maxStringLength);
+        out += "}";
+        return;
+    }
+
+    std::string value;
+    google::protobuf::TextFormat::PrintFieldValueToString(message, field, field->is_repeated() ? index : -1, &value);
+    if (maxStringLength > 0 && static_cast<int>(value.size()) > maxStringLength)
+    {
+        const size_t fullSize = value.size();
+        value.resize(maxStringLength);
+        value += "...(" + std::to_string(fullSize) + " chars)";
+    }
+    out += value;
+}
+
+void appendMessage(std::string &out, const Message &message, int maxRepeatedItems, int maxStringLength)
+{
+    const Reflection *reflection = message.GetReflection();
+    std::vector<const FieldDescriptor *> fields;
+    reflection->ListFields(message, &fields);
+
+    for (const FieldDescriptor *field : fields)
+    {
+        out += field->name();
+        out += ": ";
+        if (field->is_repeated())
+        {
+            const int size = reflection->FieldSize(message, field);
+            const int shown = (maxRepeatedItems >= 0 && size > maxRepeatedItems) ? maxRepeatedItems : size;
+            out += "[";
+            for (int i = 0; i < shown; ++i)
+            {
+                if (i > 0)
+                {
+                    out += ", ";
+                }
+                appendValue(out, message, field, i, maxRepeatedItems, maxStringLength);
+            }
+            if (shown < size)
+            {
+                out += (shown > 0 ? ", ... " : "... ") + std::to_string(size) + " items";
+            }
+            out += "] ";
+        }
+        else
+        {
+            appendValue(out, message, field, -1, maxRepeatedItems, maxStringLength);
+            out += " ";
+        }
+    }
+}
+
+}  // namespace
+
+std::string protobufSummary(const google::protobuf::Message &message, int maxRepeatedItems, int maxStringLength)
+{
+    std::string out;
+    appendMessage(out, message, maxRepeatedItems, maxStringLength);
+    if (!out.empty() && out.back() == ' ')
+    {
+        out.pop_back();
+    }
+    return out;
+}
+
+}  // namespace Utils
@@ -0,0 +1,22 @@
+#ifndef PROTOBUF_SUMMARY_H
+#define PROTOBUF_SUMMARY_H
+
+#include <string>
+
+namespace google {
+namespace protobuf {
+class Message;
+}  // namespace protobuf
+}  // namespace google
+
+namespace Utils {
+
+// Returns a compact one-line description of a protobuf message, suitable for the log.
+// Repeated fields longer than |maxRepeatedItems| are cut to their first items followed by the
+// total count, and string values longer than |maxStringLength| are truncated.
+std::string protobufSummary(const google::protobuf::Message &message,
+                            int maxRepeatedItems = 3, int maxStringLength = 64);
+
+}  // namespace Utils
+
+#endif  // PROTOBUF_SUMMARY_H
@@ -0,0 +1,193 @@
+#ifndef REPLACEMENT_MATCHER_H
+#define REPLACEMENT_MATCHER_H
+
+#include <QString>
+#include <algorithm>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace Utils {
+
+// Access to the code units of the supported string types.
+template<typename T> struct StringTraits;
+
+template<> struct StringTraits<QString>
+{
+    using CharT = ushort;
+    static QString fromQString(const QString &source) { return source; }
+    static const CharT *data(const QString &str) { return str.utf16(); }
+    static size_t size(const QString &str) { return static_cast<size_t>(str.size()); }
+    static void append(QString &str, const CharT *data, size_t size)
+    {
+        str.append(reinterpret_cast<const QChar *>(data), static_cast<int>(size));
+    }
+};
+
+template<typename T> struct StdStringTraits
+{
+    using CharT = typename T::value_type;
+    static const CharT *data(const T &str) { return str.data(); }
+    static size_t size(const T &str) { return str.size(); }
+    static void append(T &str, const CharT *data, size_t size) { str.append(data, size); }
+};
+
+template<> struct StringTraits<std::string> : StdStringTraits<std::string>
+{
+    static std::string fromQString(const QString &source) { return source.toStdString(); }
+};
+
+template<> struct StringTraits<std::wstring> : StdStringTraits<std::wstring>
+{
+    static std::wstring fromQString(const QString &source) { return source.toStdWString(); }
+};
+
+// Aho-Corasick automaton over all the patterns, so a string is scanned once whatever the number of patterns.
+// The matches don't overlap; of the matches starting at the same position, the pattern added first wins.
+template<typename T>
+class ReplacementMatcher
+{
+public:
+    using Traits = StringTraits<T>;
+    using CharT = typename Traits::CharT;
+
+    ReplacementMatcher() : nodes_(1) {}
+
+    void add(const T &pattern, const T &replacement)
+    {
+        const CharT *data = Traits::data(pattern);
+        const size_t size = Traits::size(pattern);
+        if (size == 0)
+            return;
+        int state = 0;
+        for (size_t i = 0; i < size; ++i) {
+            int next = edge(state, data[i]);
+            if (next < 0) {
+                next = static_cast<int>(nodes_.size());
+                nodes_.push_back(Node());
+                nodes_.back().depth = nodes_[state].depth + 1;
+                auto &edges = nodes_[state].edges;
+                edges.insert(std::lower_bound(edges.begin(), edges.end(), std::make_pair(data[i], 0)),
+                             std::make_pair(data[i], next));
+            }
+            state = next;
+        }
+        // The same path may be registered under several names, the first one is used.
+        if (nodes_[state].pattern < 0) {
+            nodes_[state].pattern = static_cast<int>(replacements_.size());
+            replacements_.push_back(replacement);
+            lengths_.push_back(size);
+        }
+    }
+
+    // Sets up the failure links, once all the patterns are added.
+    void build()
+    {
+        std::queue<int> queue;
+        for (const auto &e : nodes_[0].edges)
+            queue.push(e.second);
+        while (!queue.empty()) {
+            const int state = queue.front();
+            queue.pop();
+            for (const auto &e : nodes_[state].edges) {
+                const int child = e.second;
+                int fail = nodes_[state].fail;
+                while (fail > 0 && edge(fail, e.first) < 0)
+                    fail = nodes_[fail].fail;
+                const int next = edge(fail, e.first);
+                nodes_[child].fail = (next >= 0 && next != child) ? next : 0;
+                const auto &failNode = nodes_[nodes_[child].fail];
+                nodes_[child].outputLink = failNode.pattern >= 0 ? nodes_[child].fail : failNode.outputLink;
+                queue.push(child);
+            }
+        }
+    }
+
+    const T &replacement(int pattern) const { return replacements_[pattern]; }
+
+    // Calls |copy|(begin, end) for the text kept and |replace|(pattern) for each match, in order. Returns the
+    // length of the processed part of |text|: all of it if |isFinal| is set, otherwise the tail which may
+    // still start a match is left out.
+    template<typename CopyFn, typename ReplaceFn>
+    size_t scan(const CharT *text, size_t length, bool isFinal, CopyFn copy, ReplaceFn replace) const
+    {
+        const size_t npos = static_cast<size_t>(-1);
+        size_t pos = 0;
+        size_t i = 0;
+        int state = 0;
+        size_t bestStart = npos;
+        int bestPattern = -1;
+        auto commit = [&]() {
+            if (bestStart > pos)
+                copy(text + pos, text + bestStart);
+            replace(bestPattern);
+            pos = i = bestStart + lengths_[bestPattern];
+            state = 0;
+            bestStart = npos;
+            bestPattern = -1;
+        };
+        for (;;) {
+            while (i < length) {
+                state = step(state, text[i]);
+                ++i;
+                const int first = nodes_[state].pattern >= 0 ? state : nodes_[state].outputLink;
+                for (int n = first; n > 0; n = nodes_[n].outputLink) {
+                    const int pattern = nodes_[n].pattern;
+                    const size_t start = i - lengths_[pattern];
+                    if (start < bestStart || (start == bestStart && pattern < bestPattern)) {
+                        bestStart = start;
+                        bestPattern = pattern;
+                    }
+                }
+                // No match can start at or before the best one any more.
+                if (bestPattern >= 0 && i - nodes_[state].depth > bestStart)
+                    commit();
+            }
+            if (bestPattern < 0 || !isFinal)
+                break;
+            commit();
+        }
+        const size_t end = isFinal ? length : length - nodes_[state].depth;
+        if (end > pos)
+            copy(text + pos, text + end);
+        return std::max(pos, end);
+    }
+
+private:
+    struct Node
+    {
+        Node() : fail(0), outputLink(-1), pattern(-1), depth(0) {}
+        std::vector<std::pair<CharT, int>> edges;   // sorted by the code unit
+        int fail;
+        int outputLink;     // the nearest node on the failure chain which ends a pattern
+        int pattern;        // the pattern ending in this node, -1 for none
+        size_t depth;
+    };
+
+    int edge(int state, CharT c) const
+    {
+        const auto &edges = nodes_[state].edges;
+        const auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(c, 0));
+        return (it != edges.end() && it->first == c) ? it->second : -1;
+    }
+
+    int step(int state, CharT c) const
+    {
+        for (;;) {
+            const int next = edge(state, c);
+            if (next >= 0)
+                return next;
+            if (state == 0)
+                return 0;
+            state = nodes_[state].fail;
+        }
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<T> replacements_;
+    std::vector<size_t> lengths_;
+};
+
+}  // namespace Utils
+
+#endif  // REPLACEMENT_MATCHER_H
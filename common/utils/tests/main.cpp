@@ -0,0 +1,16 @@
+#include <QtTest>
+#include <QCoreApplication>
+
+#include "tst_logrotator.h"
+#include "tst_replacementmatcher.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int status = 0;
+
+    status |= QTest::qExec(new TestReplacementMatcher(), argc, argv);
+    status |= QTest::qExec(new TestLogRotator(), argc, argv);
+
+    return status;
+}
@@ -0,0 +1,102 @@
+#include "tst_logrotator.h"
+#include <QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include "utils/logrotator.h"
+
+namespace
+{
+bool writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+// log-like text which doesn't compress too well, so it makes several blocks
+QByteArray makeLog(int size)
+{
+    QByteArray log;
+    log.reserve(size);
+    for (int i = 0; log.size() < size; ++i)
+    {
+        log += "[" + QByteArray::number(i) + "] [basic]\t some log line ";
+        log += QByteArray::number(qHash(i), 16);
+        log += '\n';
+    }
+    log.truncate(size);
+    return log;
+}
+}
+
+TestLogRotator::TestLogRotator()
+{
+}
+
+TestLogRotator::~TestLogRotator()
+{
+}
+
+void TestLogRotator::test_no_current_log()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString logPath = dir.filePath("log_test.txt");
+    const QString prevLogPath = dir.filePath("prev_log_test.txt");
+    LogRotator::Settings settings;
+    settings.generations = 2;
+    LogRotator rotator(logPath, prevLogPath, settings);
+
+    QVERIFY(writeFile(logPath, "first"));
+    QVERIFY(rotator.rotate());
+    rotator.waitForCompression();
+
+    // the generations are kept as they are while there is nothing to rotate
+    QVERIFY(!rotator.rotate());
+    QCOMPARE(LogRotator::readLogFile(LogRotator::generationPath(prevLogPath, 1)), QByteArray("first"));
+    QVERIFY(!QFile::exists(LogRotator::generationPath(prevLogPath, 2)));
+}
+
+void TestLogRotator::test_generations()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString logPath = dir.filePath("log_test.txt");
+    const QString prevLogPath = dir.filePath("prev_log_test.txt");
+    LogRotator::Settings settings;
+    settings.generations = 2;
+    LogRotator rotator(logPath, prevLogPath, settings);
+
+    for (const QByteArray &text : { QByteArray("first"), QByteArray("second"), QByteArray("third") })
+    {
+        QVERIFY(writeFile(logPath, text));
+        QTRY_VERIFY(rotator.isReadyToRotate());
+        QVERIFY(rotator.rotate());
+    }
+    rotator.waitForCompression();
+    QVERIFY(rotator.isReadyToRotate());
+
+    QCOMPARE(LogRotator::readLogFile(LogRotator::existingPrevLogPath(prevLogPath)), QByteArray("third"));
+    QCOMPARE(LogRotator::readLogFile(LogRotator::generationPath(prevLogPath, 2)), QByteArray("second"));
+    QVERIFY(!QFile::exists(LogRotator::generationPath(prevLogPath, 3)));
+}
+
+void TestLogRotator::test_compressed_blocks()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString logPath = dir.filePath("log_test.txt");
+    const QString prevLogPath = dir.filePath("prev_log_test.txt");
+    LogRotator rotator(logPath, prevLogPath, LogRotator::Settings());
+
+    // more than a few blocks, the last one partial
+    const QByteArray log = makeLog(3 * 1024 * 1024 + 17);
+    QVERIFY(writeFile(logPath, log));
+    QVERIFY(rotator.rotate());
+    rotator.waitForCompression();
+
+    const QString firstGeneration = LogRotator::generationPath(prevLogPath, 1);
+    QVERIFY(!QFile::exists(prevLogPath));
+    QVERIFY(QFile(firstGeneration).size() < log.size());
+    QCOMPARE(LogRotator::logFileSize(firstGeneration), qint64(log.size()));
+    QVERIFY(LogRotator::readLogFile(firstGeneration) == log);
+}
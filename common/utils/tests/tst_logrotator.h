@@ -0,0 +1,21 @@
+#ifndef TESTLOGROTATOR_H
+#define TESTLOGROTATOR_H
+
+#include <QObject>
+
+class TestLogRotator : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestLogRotator();
+    ~TestLogRotator();
+
+private slots:
+    void test_no_current_log();
+    void test_generations();
+    void test_compressed_blocks();
+};
+
+
+#endif // TESTLOGROTATOR_H
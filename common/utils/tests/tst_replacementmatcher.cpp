@@ -0,0 +1,140 @@
+#include "tst_replacementmatcher.h"
+#include <QtTest>
+#include <string>
+#include "utils/replacement_matcher.h"
+
+namespace
+{
+typedef Utils::ReplacementMatcher<std::string> Matcher;
+
+Matcher makeMatcher(const std::vector<std::pair<std::string, std::string>> &patterns)
+{
+    Matcher matcher;
+    for (const auto &p : patterns)
+        matcher.add(p.first, p.second);
+    matcher.build();
+    return matcher;
+}
+
+// the text scanned by |matcher|, |out| gets the result; returns the length processed
+size_t scan(const Matcher &matcher, const std::string &text, bool isFinal, std::string *out)
+{
+    return matcher.scan(text.data(), text.size(), isFinal,
+        [out](const char *begin, const char *end) { out->append(begin, end - begin); },
+        [out, &matcher](int pattern) { out->append(matcher.replacement(pattern)); });
+}
+
+std::string replace(const Matcher &matcher, const std::string &text)
+{
+    std::string result;
+    const size_t processed = scan(matcher, text, true, &result);
+    return processed == text.size() ? result : "<not all processed>";
+}
+
+// the text in chunks of |chunkSize|, the tail which may start a match is held back as the stream filter does
+std::string replaceInChunks(const Matcher &matcher, const std::string &text, size_t chunkSize)
+{
+    std::string result;
+    std::string pending;
+    for (size_t pos = 0; pos < text.size(); pos += chunkSize)
+    {
+        pending += text.substr(pos, chunkSize);
+        pending.erase(0, scan(matcher, pending, false, &result));
+    }
+    scan(matcher, pending, true, &result);
+    return result;
+}
+}
+
+TestReplacementMatcher::TestReplacementMatcher()
+{
+}
+
+TestReplacementMatcher::~TestReplacementMatcher()
+{
+}
+
+void TestReplacementMatcher::test_no_match()
+{
+    const Matcher matcher = makeMatcher({ { "/home/user", "%HOME%" } });
+    QCOMPARE(replace(matcher, ""), std::string());
+    QCOMPARE(replace(matcher, "nothing here"), std::string("nothing here"));
+    // a prefix of a pattern left at the end of the text is kept as it is
+    QCOMPARE(replace(matcher, "path /home/use"), std::string("path /home/use"));
+    QCOMPARE(replace(matcher, "/home/use/home/user"), std::string("/home/use%HOME%"));
+
+    // no pattern at all
+    const Matcher empty = makeMatcher({});
+    QCOMPARE(replace(empty, "text"), std::string("text"));
+}
+
+void TestReplacementMatcher::test_overlapping_patterns()
+{
+    // the leftmost match wins, the matches don't overlap
+    const Matcher matcher = makeMatcher({ { "abc", "1" }, { "bcd", "2" }, { "b", "3" } });
+    QCOMPARE(replace(matcher, "abcd"), std::string("1d"));
+    QCOMPARE(replace(matcher, "xbcd"), std::string("x2"));
+    QCOMPARE(replace(matcher, "xbx"), std::string("x3x"));
+    QCOMPARE(replace(matcher, "abcbcd"), std::string("12"));
+
+    // the patterns found through the failure links
+    const Matcher suffixes = makeMatcher({ { "he", "<he>" }, { "she", "<she>" }, { "hers", "<hers>" } });
+    QCOMPARE(replace(suffixes, "ushers"), std::string("u<she>rs"));
+    QCOMPARE(replace(suffixes, "hers she he"), std::string("<he>rs <she> <he>"));
+}
+
+void TestReplacementMatcher::test_same_start()
+{
+    // of the matches starting at the same position, the pattern added first wins, the shorter or the longer one
+    const Matcher shortFirst = makeMatcher({ { "/home/u", "%HOME%" }, { "/home/u/data", "%DATA%" } });
+    QCOMPARE(replace(shortFirst, "x /home/u/data/file"), std::string("x %HOME%/data/file"));
+    const Matcher longFirst = makeMatcher({ { "/home/u/data", "%DATA%" }, { "/home/u", "%HOME%" } });
+    QCOMPARE(replace(longFirst, "x /home/u/data/file"), std::string("x %DATA%/file"));
+    QCOMPARE(replace(longFirst, "x /home/u/dat"), std::string("x %HOME%/dat"));
+
+    // the same pattern added again keeps its first replacement
+    const Matcher twice = makeMatcher({ { "/run/user/1000", "%RUNTIME%" }, { "/run/user/1000", "%OTHER%" } });
+    QCOMPARE(replace(twice, "/run/user/1000/x"), std::string("%RUNTIME%/x"));
+}
+
+void TestReplacementMatcher::test_chunk_boundaries()
+{
+    const Matcher matcher = makeMatcher({ { "/home/user", "%HOME%" }, { "/home/user/.local/share", "%DATA%" },
+                                          { "/run/user/1000", "%RUNTIME%" }, { "ser", "%SER%" } });
+    const std::string text = "log /home/user/.local/share/x /home/use /home/user/.local/shar\n"
+                             "/run/user/1000/home/user/home/us /run/user/100 user /home/user";
+    const std::string expected = replace(matcher, text);
+    QCOMPARE(expected, std::string("log %HOME%/.local/share/x /home/use %HOME%/.local/shar\n"
+                                   "%RUNTIME%%HOME%/home/us /run/u%SER%/100 u%SER% %HOME%"));
+
+    // every split of the text gives the same result as the text as a whole
+    for (size_t chunkSize = 1; chunkSize <= text.size(); ++chunkSize)
+    {
+        QCOMPARE(replaceInChunks(matcher, text, chunkSize), expected);
+    }
+
+    // a match held back at the end of a chunk is completed by the next one
+    std::string result;
+    const std::string first = "abc /home/us";
+    const size_t processed = scan(matcher, first, false, &result);
+    QCOMPARE(result, std::string("abc "));
+    QCOMPARE(processed, size_t(4));
+    scan(matcher, first.substr(processed) + "er/x", true, &result);
+    QCOMPARE(result, std::string("abc %HOME%/x"));
+}
+
+void TestReplacementMatcher::test_qstring()
+{
+    Utils::ReplacementMatcher<QString> matcher;
+    matcher.add(QString::fromUtf8("/home/\xd0\xbf\xd1\x80\xd0\xb8"), "%HOME%");
+    matcher.build();
+
+    QString result;
+    const QString text = QString::fromUtf8("\xd1\x84 /home/\xd0\xbf\xd1\x80\xd0\xb8/log.txt");
+    matcher.scan(text.utf16(), text.size(), true,
+        [&result](const ushort *begin, const ushort *end) {
+            result.append(reinterpret_cast<const QChar *>(begin), static_cast<int>(end - begin));
+        },
+        [&result, &matcher](int pattern) { result += matcher.replacement(pattern); });
+    QCOMPARE(result, QString::fromUtf8("\xd1\x84 %HOME%/log.txt"));
+}
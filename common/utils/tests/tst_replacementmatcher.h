@@ -0,0 +1,23 @@
+#ifndef TESTREPLACEMENTMATCHER_H
+#define TESTREPLACEMENTMATCHER_H
+
+#include <QObject>
+
+class TestReplacementMatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestReplacementMatcher();
+    ~TestReplacementMatcher();
+
+private slots:
+    void test_no_match();
+    void test_overlapping_patterns();
+    void test_same_start();
+    void test_chunk_boundaries();
+    void test_qstring();
+};
+
+
+#endif // TESTREPLACEMENTMATCHER_H
@@ -2,6 +2,7 @@
 
 #include "utils/logger.h"
 #include "utils/utils.h"
+#include "ipc/commandlog.h"
 #include "ipc/connection.h"
 #include "ipc/protobufcommand.h"
 #include "utils/utils.h"
@@ -144,7 +145,7 @@ void Backend::cleanup(bool isExitWithRestart, bool isFirewallChecked, bool isFir
         cmd.getProtoObj().set_is_firewall_checked(isFirewallChecked);
         cmd.getProtoObj().set_is_firewall_always_on(isFirewallAlwaysOn);
         cmd.getProtoObj().set_is_launch_on_start(isLaunchOnStart);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         ipcState_ = IPC_DOING_CLEANUP;
         connection_->sendCommand(cmd);
     }
@@ -156,7 +157,7 @@ void Backend::enableBFE_win()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::EnableBfe_win> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -176,7 +177,7 @@ void Backend::login(const QString &username, const QString &password, const QStr
         // hide password for logging
         IPC::ProtobufCommand<IPCClientCommands::Login> loggedCmd = cmd;
         loggedCmd.getProtoObj().set_password("*****");
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(loggedCmd.getDebugString());
+        IPC::logCommand(loggedCmd);
 
         connection_->sendCommand(cmd);
     }
@@ -200,7 +201,11 @@ void Backend::loginWithAuthHash(const QString &authHash)
         bLastLoginWithAuthHash_ = true;
         IPC::ProtobufCommand<IPCClientCommands::Login> cmd;
         cmd.getProtoObj().set_auth_hash(authHash.toStdString());
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+
+        // hide auth hash for logging
+        IPC::ProtobufCommand<IPCClientCommands::Login> loggedCmd = cmd;
+        loggedCmd.getProtoObj().set_auth_hash("*****");
+        IPC::logCommand(loggedCmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -217,7 +222,7 @@ void Backend::loginWithLastLoginSettings()
     {
         IPC::ProtobufCommand<IPCClientCommands::Login> cmd;
         cmd.getProtoObj().set_use_last_login_settings(true);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -233,7 +238,7 @@ void Backend::signOut()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::SignOut> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -246,7 +251,7 @@ void Backend::sendConnect(const LocationID &lid)
         connectStateHelper_.connectClickFromUser();
         IPC::ProtobufCommand<IPCClientCommands::Connect> cmd;
         *cmd.getProtoObj().mutable_locationdid() = lid.toProtobuf();
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -258,7 +263,7 @@ void Backend::sendDisconnect()
     {
         connectStateHelper_.disconnectClickFromUser();
         IPC::ProtobufCommand<IPCClientCommands::Disconnect> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -279,7 +284,7 @@ void Backend::forceCliStateUpdate()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::ForceCliStateUpdate> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -292,7 +297,7 @@ void Backend::firewallOn(bool updateHelperFirst)
         if (updateHelperFirst) firewallStateHelper_.firewallOnClickFromGUI();
         IPC::ProtobufCommand<IPCClientCommands::Firewall> cmd;
         cmd.getProtoObj().set_is_enable(true);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -305,7 +310,7 @@ void Backend::firewallOff(bool updateHelperFirst)
         if (updateHelperFirst) firewallStateHelper_.firewallOffClickFromGUI();
         IPC::ProtobufCommand<IPCClientCommands::Firewall> cmd;
         cmd.getProtoObj().set_is_enable(false);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -327,7 +332,7 @@ void Backend::emergencyConnectClick()
     {
         emergencyConnectStateHelper_.connectClickFromUser();
         IPC::ProtobufCommand<IPCClientCommands::EmergencyConnect> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -339,7 +344,7 @@ void Backend::emergencyDisconnectClick()
     {
         emergencyConnectStateHelper_.disconnectClickFromUser();
         IPC::ProtobufCommand<IPCClientCommands::EmergencyDisconnect> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -357,7 +362,11 @@ void Backend::startWifiSharing(const QString &ssid, const QString &password)
         IPC::ProtobufCommand<IPCClientCommands::StartWifiSharing> cmd;
         cmd.getProtoObj().set_ssid(ssid.toStdString());
         cmd.getProtoObj().set_password(password.toStdString());
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+
+        // hide password for logging
+        IPC::ProtobufCommand<IPCClientCommands::StartWifiSharing> loggedCmd = cmd;
+        loggedCmd.getProtoObj().set_password("*****");
+        IPC::logCommand(loggedCmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -368,7 +377,7 @@ void Backend::stopWifiSharing()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::StopWifiSharing> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -380,7 +389,7 @@ void Backend::startProxySharing(ProtoTypes::ProxySharingMode proxySharingMode)
     {
         IPC::ProtobufCommand<IPCClientCommands::StartProxySharing> cmd;
         cmd.getProtoObj().set_sharing_mode(proxySharingMode);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -391,7 +400,7 @@ void Backend::stopProxySharing()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::StopProxySharing> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -403,7 +412,7 @@ void Backend::setIPv6StateInOS(bool bEnabled)
     {
         IPC::ProtobufCommand<IPCClientCommands::SetIpv6StateInOS> cmd;
         cmd.getProtoObj().set_is_enabled(bEnabled);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -425,7 +434,7 @@ void Backend::gotoCustomOvpnConfigMode()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::GotoCustomOvpnConfigMode> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -436,7 +445,7 @@ void Backend::recordInstall()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::RecordInstall> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -447,7 +456,7 @@ void Backend::sendConfirmEmail()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::SendConfirmEmail> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -458,7 +467,7 @@ void Backend::sendDebugLog()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::SendDebugLog> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -470,7 +479,7 @@ void Backend::getWebSessionTokenForEditAccountDetails()
     {
         IPC::ProtobufCommand<IPCClientCommands::GetWebSessionToken> cmd;
         cmd.getProtoObj().set_purpose(ProtoTypes::WEB_SESSION_PURPOSE_EDIT_ACCOUNT_DETAILS);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -482,7 +491,7 @@ void Backend::getWebSessionTokenForAddEmail()
     {
         IPC::ProtobufCommand<IPCClientCommands::GetWebSessionToken> cmd;
         cmd.getProtoObj().set_purpose(ProtoTypes::WEB_SESSION_PURPOSE_ADD_EMAIL);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -495,7 +504,7 @@ void Backend::speedRating(int rating, const QString &localExternalIp)
         IPC::ProtobufCommand<IPCClientCommands::SpeedRating> cmd;
         cmd.getProtoObj().set_rating(rating);
         cmd.getProtoObj().set_local_external_ip(localExternalIp.toStdString());
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -517,7 +526,7 @@ void Backend::clearCredentials()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::ClearCredentials> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -542,7 +551,11 @@ void Backend::continueWithCredentialsForOvpnConfig(const QString &username, cons
         cmd.getProtoObj().set_username(username.toStdString());
         cmd.getProtoObj().set_password(password.toStdString());
         cmd.getProtoObj().set_is_save(bSave);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+
+        // hide password for logging
+        IPC::ProtobufCommand<IPCClientCommands::ContinueWithCredentialsForOvpnConfig> loggedCmd = cmd;
+        loggedCmd.getProtoObj().set_password("*****");
+        IPC::logCommand(loggedCmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -550,7 +563,7 @@ void Backend::continueWithCredentialsForOvpnConfig(const QString &username, cons
 void Backend::sendAdvancedParametersChanged()
 {
     IPC::ProtobufCommand<IPCClientCommands::AdvancedParametersChanged> cmd;
-    qCDebug(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+    IPC::logCommand(cmd);
     connection_->sendCommand(cmd);
 }
 
@@ -565,7 +578,7 @@ void Backend::sendEngineSettingsIfChanged()
             latestEngineSettings_ = preferences_.getEngineSettings();
             IPC::ProtobufCommand<IPCClientCommands::SetSettings> cmd;
             *cmd.getProtoObj().mutable_enginesettings() = latestEngineSettings_;
-            qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+            IPC::logCommand(cmd);
             connection_->sendCommand(cmd);
         }
     }
@@ -672,7 +685,7 @@ void Backend::onConnectionNewCommand(IPC::Command *command, IPC::IConnection * /
         {
             ipcState_ = IPC_INIT_SENDING;
             IPC::ProtobufCommand<IPCClientCommands::Init> cmd;
-            qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+            IPC::logCommand(cmd);
             connection_->sendCommand(cmd);
         }
     }
@@ -704,7 +717,7 @@ void Backend::onConnectionNewCommand(IPC::Command *command, IPC::IConnection * /
     else if (command->getStringId() == IPCServerCommands::FirewallStateChanged::descriptor()->full_name())
     {
         IPC::ProtobufCommand<IPCServerCommands::FirewallStateChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::FirewallStateChanged> *>(command);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd->getDebugString());
+        IPC::logCommand(*cmd);
         firewallStateHelper_.setFirewallStateFromEngine(cmd->getProtoObj().is_firewall_enabled());
     }
     else if (command->getStringId() == IPCServerCommands::LoginFinished::descriptor()->full_name())
@@ -765,7 +778,7 @@ void Backend::onConnectionNewCommand(IPC::Command *command, IPC::IConnection * /
     }
     else if (command->getStringId() == IPCServerCommands::ConnectStateChanged::descriptor()->full_name())
     {
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(command->getDebugString());
+        IPC::logCommand(*command);
         IPC::ProtobufCommand<IPCServerCommands::ConnectStateChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::ConnectStateChanged> *>(command);
         connectStateHelper_.setConnectStateFromEngine(cmd->getProtoObj().connect_state());
     }
@@ -835,7 +848,7 @@ void Backend::onConnectionNewCommand(IPC::Command *command, IPC::IConnection * /
     }
     else if (command->getStringId() == IPCServerCommands::EngineSettingsChanged::descriptor()->full_name())
     {
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(command->getDebugString());
+        IPC::logCommand(*command);
         latestEngineSettings_ = static_cast<IPC::ProtobufCommand<IPCServerCommands::EngineSettingsChanged> *>(command)->getProtoObj().enginesettings();
         preferences_.setEngineSettings(latestEngineSettings_);
     }
@@ -850,7 +863,7 @@ void Backend::onConnectionNewCommand(IPC::Command *command, IPC::IConnection * /
     }
     else if (command->getStringId() == IPCServerCommands::NetworkChanged::descriptor()->full_name())
     {
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(command->getDebugString());
+        IPC::logCommand(*command);
         IPC::ProtobufCommand<IPCServerCommands::NetworkChanged> *cmd = static_cast<IPC::ProtobufCommand<IPCServerCommands::NetworkChanged> *>(command);
 
         ProtoTypes::NetworkInterface networkInterface;
@@ -963,7 +976,7 @@ void Backend::onConnectionStateChanged(int state, IPC::IConnection * /*connectio
         cmd.getProtoObj().set_client_id(clientId_);
         cmd.getProtoObj().set_pid(clientPid_);
         cmd.getProtoObj().set_name(clientName_.toStdString());
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
     else if (state == IPC::CONNECTION_DISCONNECTED)
@@ -1138,7 +1151,7 @@ void Backend::sendDetectPacketSize()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::DetectPacketSize> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -1149,7 +1162,7 @@ void Backend::sendSplitTunneling(ProtoTypes::SplitTunneling st)
     {
          IPC::ProtobufCommand<IPCClientCommands::SplitTunneling> cmd;
          *cmd.getProtoObj().mutable_split_tunneling() = st;
-         qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+         IPC::logCommand(cmd);
          connection_->sendCommand(cmd);
          emit splitTunnelingStateChanged(st.settings().active());
     }
@@ -1162,7 +1175,7 @@ void Backend::sendUpdateWindowInfo(qint32 mainWindowCenterX, qint32 mainWindowCe
         IPC::ProtobufCommand<IPCClientCommands::UpdateWindowInfo> cmd;
         cmd.getProtoObj().set_window_center_x(mainWindowCenterX);
         cmd.getProtoObj().set_window_center_y(mainWindowCenterY);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -1173,7 +1186,7 @@ void Backend::sendUpdateVersion(qint32 mainWindowHandle)
     {
         IPC::ProtobufCommand<IPCClientCommands::UpdateVersion> cmd;
         cmd.getProtoObj().set_hwnd(mainWindowHandle);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -1184,7 +1197,7 @@ void Backend::cancelUpdateVersion()
     {
         IPC::ProtobufCommand<IPCClientCommands::UpdateVersion> cmd;
         cmd.getProtoObj().set_cancel_download(true);
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
@@ -1194,7 +1207,7 @@ void Backend::sendMakeHostsFilesWritableWin()
     if (isInitFinished())
     {
         IPC::ProtobufCommand<IPCClientCommands::MakeHostsWritableWin> cmd;
-        qCDebugMultiline(LOG_IPC) << QString::fromStdString(cmd.getDebugString());
+        IPC::logCommand(cmd);
         connection_->sendCommand(cmd);
     }
 }
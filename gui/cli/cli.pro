@@ -116,13 +116,19 @@ SOURCES += \
         ../backend/types/upgrademodetype.cpp \
         $$COMMON_PATH/utils/extraconfig.cpp \
         $$COMMON_PATH/utils/languagesutil.cpp \
+        $$COMMON_PATH/utils/asynclogwriter.cpp \
         $$COMMON_PATH/utils/logger.cpp \
+        $$COMMON_PATH/utils/logratelimiter.cpp \
+        $$COMMON_PATH/utils/logrecord.cpp \
+        $$COMMON_PATH/utils/logring.cpp \
+        $$COMMON_PATH/utils/logrotator.cpp \
         $$COMMON_PATH/utils/utils.cpp \
         $$COMMON_PATH/utils/hardcodedsettings.cpp \
         $$COMMON_PATH/utils/simplecrypt.cpp \
         $$COMMON_PATH/version/appversion.cpp \
         $$COMMON_PATH/utils/executable_signature/executable_signature.cpp \
         $$COMMON_PATH/utils/clean_sensitive_info.cpp \
+        $$COMMON_PATH/utils/protobuf_summary.cpp \
         ../backend/persistentstate.cpp \
         backendcommander.cpp \
         cliapplication.cpp \
@@ -142,6 +148,7 @@ HEADERS += \
     ../backend/notificationscontroller.h \
     $$COMMON_PATH/ipc/command.h \
     $$COMMON_PATH/ipc/commandfactory.h \
+    $$COMMON_PATH/ipc/commandlog.h \
     $$COMMON_PATH/ipc/connection.h \
     $$COMMON_PATH/ipc/generated_proto/clientcommands.pb.h \
     $$COMMON_PATH/ipc/generated_proto/servercommands.pb.h \
@@ -174,7 +181,12 @@ HEADERS += \
     ../backend/types/upgrademodetype.h \
     $$COMMON_PATH/utils/extraconfig.h \
     $$COMMON_PATH/utils/languagesutil.h \
+    $$COMMON_PATH/utils/asynclogwriter.h \
     $$COMMON_PATH/utils/logger.h \
+    $$COMMON_PATH/utils/logratelimiter.h \
+    $$COMMON_PATH/utils/logrecord.h \
+    $$COMMON_PATH/utils/logring.h \
+    $$COMMON_PATH/utils/logrotator.h \
     $$COMMON_PATH/utils/utils.h \
     $$COMMON_PATH/utils/hardcodedsettings.h \
     $$COMMON_PATH/utils/simplecrypt.h \
@@ -182,6 +194,8 @@ HEADERS += \
     $$COMMON_PATH/version/windscribe_version.h \
     $$COMMON_PATH/utils/executable_signature/executable_signature.h \
     $$COMMON_PATH/utils/clean_sensitive_info.h \
+    $$COMMON_PATH/utils/replacement_matcher.h \
+    $$COMMON_PATH/utils/protobuf_summary.h \
     ../backend/persistentstate.h \
     backendcommander.h \
     cliapplication.h
@@ -16,6 +16,9 @@ enum LogDataType {
     LOG_TYPE_MIXED,
 };
 
+// Titles of the log types, translated where they are shown.
+const char *const kLogTitles[NUM_LOG_TYPES] = { "GUI", "Engine", "Service" };
+
 enum class LogRangeCheckType {
     NONE,        // Don't do a range check.
     MIN_TO_MAX,  // Range is between minimum and maximum data timestamps.
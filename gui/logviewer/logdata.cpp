@@ -1,41 +1,51 @@
 #include "logdata.h"
 
 #include <QFile>
-#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+#include <future>
 
 
 namespace
 {
-bool isYearInDatePresent(const QString &dateline)
+// Filtering is split between threads from this number of rows.
+const int kParallelFilterRows = 200000;
+// The saved log is written in chunks of this size.
+const int kSaveChunkSize = 1024 * 1024;
+}  // namespace
+
+LogData::LogData() : maxLineLength_(0), unchangedRowCount_(0)
 {
-    const int scan = qMin(7, dateline.length());
-    for (int i = 1; i < scan; ++i)
-        if (dateline[i] == ' ')
-            return false;
-    return true;
+    memset(typeLineCount_, 0, sizeof(typeLineCount_));
 }
 
-int getLogDataEntryStringSize(const LogDataEntry &entry)
+LogData::~LogData()
 {
-    return entry.label.length() + entry.text.length();
 }
-}  // namespace
 
-LogData::LogData() : timestampCounter_(0)
+int LogData::numTypes() const
 {
+    int count = 0;
+    for (int i = 0; i < NUM_LOG_TYPES; ++i)
+        if (typeLineCount_[i] > 0)
+            ++count;
+    return count;
 }
 
-QPair<int, int> LogData::getDataSizeForType(LogDataType type) const
+const LogLine &LogData::line(int row) const
 {
-    Q_ASSERT(type < NUM_LOG_TYPES || type == LOG_TYPE_MIXED);
-    if (type < NUM_LOG_TYPES)
-        return typeInfo_[type];
-    QPair<int, int> result;
-    for (auto it = typeInfo_.begin(); it != typeInfo_.end(); ++it) {
-        result.first += it.value().first;
-        result.second += it.value().second;
-    }
-    return result;
+    Q_ASSERT(row >= 0 && row < lineCount());
+    return lineOf(order_[row]);
+}
+
+LogLineParts LogData::lineParts(int row) const
+{
+    const auto &ref = order_[row];
+    const auto &file = *files_[ref.file];
+    const auto &entry = file.lines[ref.line];
+    return LogIndex::split(file.data() + entry.offset, entry.length,
+                           static_cast<LogDataType>(entry.type));
 }
 
 bool LogData::save(const QString &filename) const
@@ -45,169 +55,211 @@ bool LogData::save(const QString &filename) const
         return false;
 
     const char *kTypeMarker[] = { "G", "E", "S" };
-    QTextStream qts(&qf);
-    qts.setFieldAlignment(QTextStream::AlignRight);
-    for (auto it = data_.constBegin(); it != data_.constEnd(); ++it) {
-        const auto timestamp =
-            QDateTime::fromMSecsSinceEpoch(it.key() >> 20).toString("ddMMyy hh:mm:ss:zzz");
-        if (it->type == LOG_TYPE_AUX) {
-            qts << it->text + "\n";
+    QByteArray buf;
+    buf.reserve(kSaveChunkSize + 4096);
+    for (int row = 0; row < lineCount(); ++row) {
+        const auto &entry = line(row);
+        const auto parts = lineParts(row);
+        if (entry.type == LOG_TYPE_AUX) {
+            buf.append(parts.text, parts.textLength);
         } else {
-            qts << kTypeMarker[it->type] << " [" << timestamp
-                << qSetFieldWidth(11) << it->label << qSetFieldWidth(0)
-                << "] " << it->text + "\n";
+            buf.append(kTypeMarker[entry.type]);
+            buf.append(" [");
+            buf.append(LogIndex::timeToLogString(entry.time));
+            // The label is right-aligned in 11 characters.
+            if (parts.labelLength < 11)
+                buf.append(QByteArray(11 - parts.labelLength, ' '));
+            buf.append(parts.label, parts.labelLength);
+            buf.append("] ");
+            buf.append(parts.text, parts.textLength);
+        }
+        buf.append('\n');
+        if (buf.size() >= kSaveChunkSize) {
+            if (qf.write(buf) != buf.size())
+                return false;
+            buf.clear();
         }
     }
+    const bool result = qf.write(buf) == buf.size();
     qf.close();
-    return true;
+    return result;
+}
+
+int LogData::takeUnchangedRowCount()
+{
+    const int result = unchangedRowCount_;
+    unchangedRowCount_ = lineCount();
+    return result;
+}
+
+QVector<int> LogData::findMatches(const QByteArray &needle, bool isCaseInsensitive, int fromRow) const
+{
+    const int count = lineCount() - fromRow;
+    if (count <= 0)
+        return QVector<int>();
+
+    auto searchRows = [&](int begin, int end) {
+        QVector<int> matches;
+        for (int row = begin; row < end; ++row) {
+            const auto &entry = line(row);
+            if (entry.type == LOG_TYPE_AUX) {
+                matches.append(row);
+                continue;
+            }
+            const auto parts = lineParts(row);
+            if (LogIndex::contains(parts.text, parts.textLength, needle, isCaseInsensitive))
+                matches.append(row);
+        }
+        return matches;
+    };
+
+    const int parts = count >= kParallelFilterRows ? qBound(1, QThread::idealThreadCount(), 16) : 1;
+    if (parts == 1)
+        return searchRows(fromRow, lineCount());
+
+    std::vector<std::future<QVector<int>>> futures;
+    for (int i = 0; i < parts; ++i) {
+        const int begin = fromRow + static_cast<int>(static_cast<qint64>(count) * i / parts);
+        const int end = fromRow + static_cast<int>(static_cast<qint64>(count) * (i + 1) / parts);
+        futures.push_back(std::async(std::launch::async, searchRows, begin, end));
+    }
+    QVector<int> matches;
+    for (auto &future : futures)
+        matches += future.get();
+    return matches;
 }
 
 void LogData::clearDataByLogType(LogDataType type)
 {
     Q_ASSERT(type < NUM_LOG_TYPES || type == LOG_TYPE_MIXED);
-    bool updated = false;
     if (type == LOG_TYPE_MIXED) {
-        typeInfo_.clear();
-        data_.clear();
-        timestampCounter_ = 0;
-        updated = true;
-    } else {
-        typeInfo_.remove(type);
-        LogDataMutableIterator it(data_);
-        while (it.hasNext()) {
-            it.next();
-            if (it.value().type == type) {
-                it.remove();
-                updated = true;
-            }
-        }
+        const bool updated = !order_.empty();
+        order_.clear();
+        files_.clear();
+        memset(typeLineCount_, 0, sizeof(typeLineCount_));
+        maxLineLength_ = 0;
+        unchangedRowCount_ = 0;
+        if (updated)
+            emit dataUpdated();
+        return;
     }
-    if (updated)
+    const auto rowCount = order_.size();
+    removeRows([&](const LineRef &ref) {
+        return lineOf(ref).type == type || files_[ref.file]->type == type;
+    });
+    for (auto &file : files_) {
+        if (file && file->type == type)
+            file.reset();
+    }
+    if (order_.size() != rowCount)
         emit dataUpdated();
 }
 
 void LogData::clearDataByLogIndex(quint32 index)
 {
-    bool updated = false;
-    typeInfo_.clear();
-    LogDataMutableIterator it(data_);
-    while (it.hasNext()) {
-        it.next();
-        if (it.value().logindex == index) {
-            it.remove();
-            updated = true;
-        } else {
-            auto &info = typeInfo_[it.value().type];
-            ++info.first;
-            info.second += getLogDataEntryStringSize(it.value());
-        }
+    for (quint32 slot = 0; slot < files_.size(); ++slot) {
+        if (!files_[slot] || files_[slot]->index != index)
+            continue;
+        const auto rowCount = order_.size();
+        removeRows([slot](const LineRef &ref) { return ref.file == slot; });
+        files_[slot].reset();
+        if (order_.size() != rowCount)
+            emit dataUpdated();
+        return;
     }
-    if (updated)
-        emit dataUpdated();
 }
 
-void LogData::addLines(QStringList lines, LogDataType type, quint32 index,
-                       LogRangeCheckType rangeCheck)
+void LogData::addLines(quint32 index, LogDataType type, LogRangeCheckType rangeCheck,
+                       QVector<LogLine> lines, QByteArray text)
 {
+    Q_ASSERT(type < NUM_LOG_TYPES || type == LOG_TYPE_MIXED);
+    quint32 slot = 0;
+    while (slot < files_.size() && !(files_[slot] && files_[slot]->index == index))
+        ++slot;
+    if (slot == files_.size()) {
+        std::unique_ptr<LogFile> file(new LogFile);
+        file->index = index;
+        file->type = type;
+        files_.push_back(std::move(file));
+    }
+    LogFile *file = files_[slot].get();
+    // The text comes in the order it was indexed, so the line offsets hold in the joined text.
+    file->text += text;
     if (lines.empty())
         return;
+    Q_ASSERT(lines.last().offset + lines.last().length <= file->text.size());
 
-    Q_ASSERT(type < NUM_LOG_TYPES || type == LOG_TYPE_MIXED);
-    const int kCurrentYearOffset = QDateTime::currentDateTime().date().year() - 1900;
-    QDateTime range[2];
-    if (data_.isEmpty())
+    qint64 range[2] = { 0, 0 };
+    if (order_.empty())
         rangeCheck = LogRangeCheckType::NONE;
     switch (rangeCheck) {
     case LogRangeCheckType::MIN_TO_MAX:
-        range[0] = QDateTime::fromMSecsSinceEpoch(data_.firstKey() >> 20);
-        range[1] = QDateTime::fromMSecsSinceEpoch(data_.lastKey() >> 20);
+        range[0] = lineOf(order_.front()).time;
+        range[1] = lineOf(order_.back()).time;
         break;
     case LogRangeCheckType::MIN_TO_NOW:
-        range[0] = QDateTime::fromMSecsSinceEpoch(data_.firstKey() >> 20);
-        range[1] = QDateTime::currentDateTimeUtc();
-        range[1].setTimeSpec(Qt::LocalTime);
+        range[0] = lineOf(order_.front()).time;
+        range[1] = LogIndex::currentTime();
         break;
     default:
         break;
     }
-    for (auto &line : qAsConst(lines)) {
-        processLine(line, type, index, kCurrentYearOffset,
-            (rangeCheck != LogRangeCheckType::NONE) ? range : nullptr);
+
+    const quint32 firstLine = static_cast<quint32>(file->lines.size());
+    file->lines += lines;
+    std::vector<LineRef> added;
+    added.reserve(lines.size());
+    for (quint32 i = 0; i < static_cast<quint32>(lines.size()); ++i) {
+        const auto &entry = lines[i];
+        if (rangeCheck != LogRangeCheckType::NONE && (entry.time < range[0] || entry.time > range[1]))
+            continue;
+        added.push_back({ slot, firstLine + i });
+        if (entry.type < NUM_LOG_TYPES)
+            ++typeLineCount_[entry.type];
+        maxLineLength_ = qMax(maxLineLength_, static_cast<int>(qMin<quint32>(entry.length, 0x7fffffff)));
     }
+    if (added.empty())
+        return;
+
+    // A log is ordered by time already, unless the clock went back.
+    const auto isEarlierFn = [this](const LineRef &a, const LineRef &b) { return isEarlier(a, b); };
+    if (!std::is_sorted(added.begin(), added.end(), isEarlierFn))
+        std::stable_sort(added.begin(), added.end(), isEarlierFn);
+
+    // The new lines usually go after all the others (a log being written); otherwise the two ordered
+    // sequences are merged, in linear time.
+    const auto mid = order_.size();
+    const auto firstChanged = static_cast<int>(
+        std::upper_bound(order_.begin(), order_.end(), added.front(), isEarlierFn) - order_.begin());
+    order_.insert(order_.end(), added.begin(), added.end());
+    if (static_cast<size_t>(firstChanged) < mid)
+        std::inplace_merge(order_.begin() + firstChanged, order_.begin() + mid, order_.end(), isEarlierFn);
+    unchangedRowCount_ = qMin(unchangedRowCount_, firstChanged);
     emit dataUpdated();
 }
 
-void LogData::processLine(const QString &line, LogDataType type, quint32 index, int yoffset,
-                          QDateTime *range)
+void LogData::removeRows(const std::function<bool(const LineRef &)> &predicate)
 {
-    if (line.isEmpty())
-        return;
-
-    // Verify type.
-    QString processingLine;
-    if (line.startsWith("G [")) {
-        Q_ASSERT(type == LOG_TYPE_MIXED);
-        processingLine = line.mid(2);
-        type = LOG_TYPE_GUI;
-    } else if (line.startsWith("E [")) {
-        Q_ASSERT(type == LOG_TYPE_MIXED);
-        type = LOG_TYPE_ENGINE;
-        processingLine = line.mid(2);
-    } else if (line.startsWith("S [")) {
-        Q_ASSERT(type == LOG_TYPE_MIXED);
-        type = LOG_TYPE_SERVICE;
-        processingLine = line.mid(2);
-    } else if (line.startsWith("===") || line.startsWith("---")) {
-        type = LOG_TYPE_AUX;
-        processingLine = line;
-    } else {
-        Q_ASSERT(type != LOG_TYPE_MIXED);
-        processingLine = line;
-    }
-
-    int processingLineOffset = 0;
-    QDateTime datetime{ lastDateTime_ };
-    if (type != LOG_TYPE_AUX) {
-        ++processingLineOffset;
-        if (isYearInDatePresent(processingLine)) {
-            const auto datestr = processingLine.mid(processingLineOffset, 19);
-            processingLineOffset += 19;
-            datetime = QDateTime::fromString(datestr, "ddMMyy hh:mm:ss:zzz").addYears(100);
-        }
-        else {
-            const auto datestr = processingLine.mid(processingLineOffset, 17);
-            processingLineOffset += 17;
-            datetime = QDateTime::fromString(datestr, "ddMM hh:mm:ss:zzz").addYears(yoffset);
-        }
-    }
-    if (range && (datetime < range[0] || datetime > range[1]))
-        return;
-    if (lastDateTime_ != datetime) {
-        lastDateTime_ = datetime;
-        timestampCounter_ = 0;
-    }
+    const auto first = std::find_if(order_.begin(), order_.end(), predicate);
+    unchangedRowCount_ = qMin(unchangedRowCount_, static_cast<int>(first - order_.begin()));
+    order_.erase(std::remove_if(first, order_.end(), predicate), order_.end());
 
-    // In QMultiMap, elements with the same key will be placed in a reverse order.
-    // https://doc.qt.io/qt-5/qmap-iterator.html#details
-    // To deal with the issue, we create a compound key: 44 bits for a timestamp, 2 bits for the
-    // source, and 18 additional lower bits for a "timestamp" (line serial number). We assume the
-    // maximum number of lines with unique timestamp never exceeds 262143, which is quite reasonable
-    // (it looks infeasible to output 250k+ lines to a log file within 1 ms).
-    const auto key = (static_cast<quint64>(datetime.toMSecsSinceEpoch()) << 20)
-        | (static_cast<quint64>(type & 3) << 18) | qMin(timestampCounter_++, 0x3ffff);
-
-    LogDataEntry entry;
-    entry.type = type;
-    entry.logindex = index;
-    entry.timestamp = datetime.toString("dd.MM.yy hh:mm:ss:zzz");
-    if (type != LOG_TYPE_AUX) {
-        entry.label = processingLine.mid(processingLineOffset, 11).trimmed();
-        processingLineOffset += 12;
+    memset(typeLineCount_, 0, sizeof(typeLineCount_));
+    maxLineLength_ = 0;
+    for (const auto &ref : order_) {
+        const auto &entry = lineOf(ref);
+        if (entry.type < NUM_LOG_TYPES)
+            ++typeLineCount_[entry.type];
+        maxLineLength_ = qMax(maxLineLength_, static_cast<int>(qMin<quint32>(entry.length, 0x7fffffff)));
     }
-    entry.text = processingLine.mid(processingLineOffset).trimmed();
+}
 
-    auto &info = typeInfo_[type];
-    ++info.first;
-    info.second += getLogDataEntryStringSize(entry);
-    data_.insert(key, entry);
+bool LogData::isEarlier(const LineRef &a, const LineRef &b) const
+{
+    // Equal times: GUI, engine, then service lines, each in the file order.
+    const auto &lineA = lineOf(a);
+    const auto &lineB = lineOf(b);
+    if (lineA.time != lineB.time)
+        return lineA.time < lineB.time;
+    return (lineA.type & 3) < (lineB.type & 3);
 }
@@ -1,56 +1,77 @@
 #ifndef LOGDATA_H
 #define LOGDATA_H
 
-#include <QDateTime>
-#include <QHash>
-#include <QMultiMap>
 #include <QObject>
 #include <QString>
+#include <QVector>
+#include <functional>
+#include <memory>
+#include <vector>
 #include "common.h"
+#include "logindex.h"
 
-struct LogDataEntry
-{
-    LogDataType type;   // Log entry type (GUI, engine, etc.)
-    quint32 logindex;   // Log watcher file index.
-    QString timestamp;  // Timestamp in human-readable form.
-    QString label;      // Prefix label (e.g. [E 60.44])
-    QString text;       // Actual log entry text.
-};
-
+// Lines of all the loaded logs ordered by time. The text of the lines is a copy of the logs taken as they are
+// indexed, the files themselves are not kept open, so the logs being written can be rotated while shown.
 class LogData final : public QObject
 {
     Q_OBJECT
 
 public:
-    using LogDataMutableIterator = QMutableMapIterator<quint64, LogDataEntry>;
-    using LogDataStorage = QMultiMap<quint64, LogDataEntry>;
-
     LogData();
+    ~LogData();
     LogData(const LogData&) = delete;
     LogData &operator=(const LogData&) = delete;
 
-    int numTypes() const { return typeInfo_.size(); }
-    bool hasType(LogDataType type) const { return typeInfo_.contains(type); }
-    QPair<int, int> getDataSizeForType(LogDataType type) const;
-    const LogDataStorage &data() const { return data_; }
+    int numTypes() const;
+    bool hasType(LogDataType type) const { return type < NUM_LOG_TYPES && typeLineCount_[type] > 0; }
+    int lineCount() const { return static_cast<int>(order_.size()); }
+    const LogLine &line(int row) const;
+    // label and text of the line, valid until the data is updated
+    LogLineParts lineParts(int row) const;
+    int maxLineLength() const { return maxLineLength_; }
     bool save(const QString &filename) const;
 
+    // The number of leading rows that are unchanged since the previous call; the rows after it were
+    // inserted or removed.
+    int takeUnchangedRowCount();
+    // Rows from |fromRow| whose text contains |needle|, in order; aux lines always match. The rows are
+    // searched in parallel chunks.
+    QVector<int> findMatches(const QByteArray &needle, bool isCaseInsensitive, int fromRow) const;
+
 signals:
     void dataUpdated();
 
 private slots:
-    void addLines(QStringList lines, LogDataType type, quint32 index, LogRangeCheckType rangeCheck);
+    void addLines(quint32 index, LogDataType type, LogRangeCheckType rangeCheck, QVector<LogLine> lines,
+                  QByteArray text);
     void clearDataByLogType(LogDataType type);
     void clearDataByLogIndex(quint32 index);
 
 private:
-    void processLine(const QString &line, LogDataType type, quint32 index, int yoffset,
-                     QDateTime *range);
+    struct LogFile
+    {
+        LogFile() : index(0), type(LOG_TYPE_UNKNOWN) {}
+        quint32 index;      // Log watcher file index.
+        LogDataType type;
+        QByteArray text;    // The text indexed so far, the line offsets point into it.
+        QVector<LogLine> lines;
+        const char *data() const { return text.constData(); }
+    };
+    struct LineRef
+    {
+        quint32 file;
+        quint32 line;
+    };
+
+    void removeRows(const std::function<bool(const LineRef &)> &predicate);
+    const LogLine &lineOf(const LineRef &ref) const { return files_[ref.file]->lines[ref.line]; }
+    bool isEarlier(const LineRef &a, const LineRef &b) const;
 
-    QHash<LogDataType, QPair<int, int>> typeInfo_;
-    LogDataStorage data_;
-    QDateTime lastDateTime_;
-    qint32 timestampCounter_;
+    std::vector<std::unique_ptr<LogFile>> files_;   // nullptr for the removed files
+    std::vector<LineRef> order_;
+    int typeLineCount_[NUM_LOG_TYPES];
+    int maxLineLength_;
+    int unchangedRowCount_;
 };
 
 #endif  // LOGDATA_H
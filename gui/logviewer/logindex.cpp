@@ -0,0 +1,276 @@
+#include "logindex.h"
+
+#include <QDateTime>
+#include <QThread>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <vector>
+
+
+namespace
+{
+// Inputs of this size and above are indexed in parallel chunks.
+const qint64 kParallelIndexSize = 4 * 1024 * 1024;
+// Marks a line which takes the time of the line before.
+const qint64 kInheritTime = -1;
+
+bool isYearInDatePresent(const char *line, int length)
+{
+    const int scan = qMin(7, length);
+    for (int i = 1; i < scan; ++i)
+        if (line[i] == ' ')
+            return false;
+    return true;
+}
+
+bool parseDigits(const char *p, int count, int *value)
+{
+    int v = 0;
+    for (int i = 0; i < count; ++i) {
+        if (p[i] < '0' || p[i] > '9')
+            return false;
+        v = v * 10 + (p[i] - '0');
+    }
+    *value = v;
+    return true;
+}
+
+qint64 makeTime(int year, int month, int day, int hour, int minute, int second, int msec)
+{
+    return ((((static_cast<qint64>(year) * 100 + month) * 100 + day) * 100 + hour) * 100 + minute)
+        * 100000 + second * 1000 + msec;
+}
+
+// Parses "[ddMMyy hh:mm:ss:zzz" or "[ddMM hh:mm:ss:zzz" (the current year is assumed).
+bool parseTime(const char *line, int length, int currentYear, qint64 *time)
+{
+    int dd, MM, yy, hh, mm, ss, zzz;
+    if (length < 18 || line[0] != '[')
+        return false;
+    const char *p = line + 1;
+    const char *end = line + length;
+    if (isYearInDatePresent(line, length)) {
+        if (!parseDigits(p, 2, &dd) || !parseDigits(p + 2, 2, &MM) || !parseDigits(p + 4, 2, &yy))
+            return false;
+        yy += 2000;
+        p += 6;
+    } else {
+        if (!parseDigits(p, 2, &dd) || !parseDigits(p + 2, 2, &MM))
+            return false;
+        yy = currentYear;
+        p += 4;
+    }
+    if (end - p < 13 || p[0] != ' ' || p[3] != ':' || p[6] != ':' || p[9] != ':' ||
+        !parseDigits(p + 1, 2, &hh) || !parseDigits(p + 4, 2, &mm) ||
+        !parseDigits(p + 7, 2, &ss) || !parseDigits(p + 10, 3, &zzz))
+        return false;
+    *time = makeTime(yy, MM, dd, hh, mm, ss, zzz);
+    return true;
+}
+
+// Length of the "G " prefix of the lines of a merged log.
+int mixedPrefixLength(const char *line, quint32 length)
+{
+    if (length >= 3 && line[1] == ' ' && line[2] == '[' &&
+        (line[0] == 'G' || line[0] == 'E' || line[0] == 'S'))
+        return 2;
+    return 0;
+}
+
+LogDataType lineType(const char *line, quint32 length, LogDataType fileType)
+{
+    if (mixedPrefixLength(line, length)) {
+        switch (line[0]) {
+        case 'G': return LOG_TYPE_GUI;
+        case 'E': return LOG_TYPE_ENGINE;
+        default: return LOG_TYPE_SERVICE;
+        }
+    }
+    if (length >= 3 && (!memcmp(line, "===", 3) || !memcmp(line, "---", 3)))
+        return LOG_TYPE_AUX;
+    return fileType == LOG_TYPE_MIXED ? LOG_TYPE_AUX : fileType;
+}
+
+void indexRange(const char *data, qint64 begin, qint64 end, qint64 offset, LogDataType fileType,
+                int currentYear, QVector<LogLine> *lines)
+{
+    qint64 pos = begin;
+    while (pos < end) {
+        const char *line = data + pos;
+        const char *lineEnd = static_cast<const char *>(memchr(line, '\n', end - pos));
+        const qint64 length = lineEnd ? lineEnd - line : end - pos;
+        quint32 textLength = static_cast<quint32>(qMin<qint64>(length, 0xffffffff));
+        if (textLength > 0 && line[textLength - 1] == '\r')
+            --textLength;
+        pos += length + 1;
+        if (textLength == 0)
+            continue;
+
+        LogLine entry;
+        entry.offset = offset + (line - data);
+        entry.length = textLength;
+        const LogDataType type = lineType(line, textLength, fileType);
+        entry.type = static_cast<quint8>(type);
+        entry.time = kInheritTime;
+        if (type != LOG_TYPE_AUX) {
+            const int prefix = mixedPrefixLength(line, textLength);
+            parseTime(line + prefix, static_cast<int>(qMin<quint32>(textLength - prefix, 64)),
+                      currentYear, &entry.time);
+        }
+        lines->append(entry);
+    }
+}
+
+const char *trimmed(const char *p, int *length)
+{
+    int begin = 0, end = *length;
+    while (begin < end && isspace(static_cast<unsigned char>(p[begin])))
+        ++begin;
+    while (end > begin && isspace(static_cast<unsigned char>(p[end - 1])))
+        --end;
+    *length = end - begin;
+    return p + begin;
+}
+
+inline char toLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+}  // namespace
+
+namespace LogIndex
+{
+QVector<LogLine> build(const char *data, qint64 size, qint64 offset, LogDataType fileType,
+                       qint64 *lastTime)
+{
+    const int currentYear = QDate::currentDate().year();
+    QVector<LogLine> lines;
+    const int parts = size >= kParallelIndexSize ? qBound(1, QThread::idealThreadCount(), 16) : 1;
+    if (parts == 1) {
+        indexRange(data, 0, size, offset, fileType, currentYear, &lines);
+    } else {
+        // Chunks start at line boundaries.
+        std::vector<qint64> bounds(parts + 1, size);
+        bounds[0] = 0;
+        for (int i = 1; i < parts; ++i) {
+            const qint64 pos = qMax(bounds[i - 1], size * i / parts);
+            const char *lineEnd = static_cast<const char *>(memchr(data + pos, '\n', size - pos));
+            bounds[i] = lineEnd ? lineEnd - data + 1 : size;
+        }
+        std::vector<std::future<QVector<LogLine>>> futures;
+        for (int i = 0; i < parts; ++i) {
+            futures.push_back(std::async(std::launch::async, [=]() {
+                QVector<LogLine> chunk;
+                indexRange(data, bounds[i], bounds[i + 1], offset, fileType, currentYear, &chunk);
+                return chunk;
+            }));
+        }
+        for (auto &future : futures)
+            lines += future.get();
+    }
+
+    // Aux lines and lines without a timestamp go with the line before.
+    qint64 time = qMax<qint64>(*lastTime, 0);
+    for (auto &line : lines) {
+        if (line.time == kInheritTime)
+            line.time = time;
+        else
+            time = line.time;
+    }
+    *lastTime = time;
+    return lines;
+}
+
+LogLineParts split(const char *line, quint32 length, LogDataType type)
+{
+    LogLineParts parts = { line, 0, line, 0 };
+    if (type == LOG_TYPE_AUX) {
+        parts.textLength = static_cast<int>(length);
+        parts.text = trimmed(line, &parts.textLength);
+        return parts;
+    }
+    const int prefix = mixedPrefixLength(line, length);
+    const char *p = line + prefix;
+    const int len = static_cast<int>(length) - prefix;
+    int offset = qMin(len, 1 + (isYearInDatePresent(p, len) ? 19 : 17));
+    parts.labelLength = qMin(11, len - offset);
+    parts.label = trimmed(p + offset, &parts.labelLength);
+    offset = qMin(len, offset + 12);
+    parts.textLength = len - offset;
+    parts.text = trimmed(p + offset, &parts.textLength);
+    return parts;
+}
+
+bool contains(const char *text, int length, const QByteArray &needle, bool isCaseInsensitive)
+{
+    const int n = needle.size();
+    if (n == 0)
+        return true;
+    if (n > length)
+        return false;
+    const char *p = text;
+    const char *end = text + length - n + 1;
+    const char *pattern = needle.constData();
+    if (!isCaseInsensitive) {
+        while (p < end) {
+            p = static_cast<const char *>(memchr(p, pattern[0], end - p));
+            if (!p)
+                return false;
+            if (!memcmp(p + 1, pattern + 1, n - 1))
+                return true;
+            ++p;
+        }
+        return false;
+    }
+
+    const char first = toLowerAscii(pattern[0]);
+    const char firstUpper = (first >= 'a' && first <= 'z') ? static_cast<char>(first - ('a' - 'A')) : first;
+    for (; p < end; ++p) {
+        if (*p != first && *p != firstUpper)
+            continue;
+        int i = 1;
+        while (i < n && toLowerAscii(p[i]) == toLowerAscii(pattern[i]))
+            ++i;
+        if (i == n)
+            return true;
+    }
+    return false;
+}
+
+QString timeToString(qint64 time)
+{
+    const int zzz = time % 1000;
+    const int ss = (time / 1000) % 100;
+    qint64 rest = time / 100000;
+    const int mm = rest % 100;
+    rest /= 100;
+    const int hh = rest % 100;
+    rest /= 100;
+    const int dd = rest % 100;
+    rest /= 100;
+    const int MM = rest % 100;
+    const int yy = (rest / 100) % 100;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%02d.%02d.%02d %02d:%02d:%02d:%03d", dd, MM, yy, hh, mm, ss, zzz);
+    return QString::fromLatin1(buf);
+}
+
+QByteArray timeToLogString(qint64 time)
+{
+    // "dd.MM.yy hh:mm:ss:zzz" -> "ddMMyy hh:mm:ss:zzz"
+    QByteArray str = timeToString(time).toLatin1();
+    str.remove(5, 1);
+    str.remove(2, 1);
+    return str;
+}
+
+qint64 currentTime()
+{
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QDate date = now.date();
+    const QTime t = now.time();
+    return makeTime(date.year(), date.month(), date.day(), t.hour(), t.minute(), t.second(), t.msec());
+}
+}  // namespace LogIndex
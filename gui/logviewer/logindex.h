@@ -0,0 +1,53 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+#include "common.h"
+
+// A line of a log file, the text itself is kept by LogData.
+struct LogLine
+{
+    qint64 offset;      // Offset of the line in the file.
+    qint64 time;        // Timestamp as yyyyMMddhhmmsszzz, orders the same way as the time.
+    quint32 length;     // Line length without the line break.
+    quint8 type;        // LogDataType of the line (GUI, engine, service or aux).
+};
+
+// The parts of a log line shown separately.
+struct LogLineParts
+{
+    const char *label;  // Prefix label (e.g. [E 60.44])
+    int labelLength;
+    const char *text;   // Actual log entry text.
+    int textLength;
+};
+
+namespace LogIndex
+{
+// Builds the line index of |size| bytes of complete lines starting at |offset| in the file. Lines without
+// a timestamp (aux lines) get the time of the line before, |lastTime| carries it between calls.
+// Big inputs are indexed in parallel chunks.
+QVector<LogLine> build(const char *data, qint64 size, qint64 offset, LogDataType fileType,
+                       qint64 *lastTime);
+
+// Splits a line into the label and the text, the same way the lines have always been displayed.
+LogLineParts split(const char *line, quint32 length, LogDataType type);
+
+// Substring search: memchr() for the first byte, then a comparison. The case-insensitive search only folds
+// ASCII letters.
+bool contains(const char *text, int length, const QByteArray &needle, bool isCaseInsensitive);
+
+// "dd.MM.yy hh:mm:ss:zzz" and "ddMMyy hh:mm:ss:zzz"
+QString timeToString(qint64 time);
+QByteArray timeToLogString(qint64 time);
+// the current UTC time in the index format, as the log lines are stamped
+qint64 currentTime();
+}  // namespace LogIndex
+
+Q_DECLARE_METATYPE(LogLine);
+Q_DECLARE_METATYPE(QVector<LogLine>);
+
+#endif  // LOGINDEX_H
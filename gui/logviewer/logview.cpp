@@ -0,0 +1,246 @@
+#include "logview.h"
+#include "logdata.h"
+#include "texthighlighter.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <algorithm>
+
+
+namespace
+{
+const int kTextMargin = 4;
+}  // namespace
+
+LogView::LogView(const LogData *data, QWidget *parent) : QAbstractScrollArea(parent), data_(data),
+    isAllRows_(true), isMultiColumn_(false), isHighlight_(true), currentRow_(-1), selectedRow_(-1)
+{
+    Q_ASSERT(data_);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    setFocusPolicy(Qt::StrongFocus);
+    verticalScrollBar()->setSingleStep(1);
+}
+
+void LogView::setRows(const QVector<int> &rows, bool isAllRows, const QVector<int> &matches)
+{
+    rows_ = isAllRows ? QVector<int>() : rows;
+    isAllRows_ = isAllRows;
+    matches_ = matches;
+    currentRow_ = -1;
+    selectedRow_ = -1;
+    updateScrollBars();
+    viewport()->update();
+}
+
+int LogView::rowCount() const
+{
+    return isAllRows_ ? data_->lineCount() : rows_.size();
+}
+
+void LogView::setMultiColumn(bool isMultiColumn)
+{
+    if (isMultiColumn_ == isMultiColumn)
+        return;
+    isMultiColumn_ = isMultiColumn;
+    updateScrollBars();
+    viewport()->update();
+}
+
+void LogView::setHighlight(bool isHighlight)
+{
+    if (isHighlight_ == isHighlight)
+        return;
+    isHighlight_ = isHighlight;
+    viewport()->update();
+}
+
+void LogView::setPlaceholderText(const QString &text)
+{
+    placeholderText_ = text;
+    viewport()->update();
+}
+
+void LogView::setTitle(const QString &title)
+{
+    title_ = title;
+    viewport()->update();
+}
+
+void LogView::setCurrentRow(int viewRow)
+{
+    currentRow_ = viewRow;
+    if (viewRow >= 0) {
+        // Only the scroll position changes, whatever the number of rows.
+        const int first = verticalScrollBar()->value();
+        const int visible = visibleRowCount();
+        if (viewRow < first || viewRow >= first + visible)
+            verticalScrollBar()->setValue(viewRow - visible / 2);
+    }
+    viewport()->update();
+}
+
+void LogView::scrollToBottom()
+{
+    updateScrollBars();
+    verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+
+void LogView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(viewport());
+    const QFontMetrics fm(font());
+    const int rowHeight = fm.height();
+    const int charWidth = qMax(1, fm.averageCharWidth());
+    const int timeWidth = fm.width("00.00.00 00:00:00:000") + 2 * kTextMargin;
+    const int hOffset = horizontalScrollBar()->value();
+    const auto cols = columns();
+    const TextHighlighter highlighter(isHighlight_);
+
+    // Header.
+    painter.fillRect(0, 0, viewport()->width(), rowHeight, palette().window());
+    painter.drawText(kTextMargin, fm.ascent(), tr("Timestamp") + ":");
+    for (const auto &col : cols) {
+        const QString title = col.type == LOG_TYPE_MIXED ? title_ : tr(kLogTitles[col.type]) + ":";
+        painter.drawText(col.x + kTextMargin, fm.ascent(), title);
+        painter.drawLine(col.x - 1, 0, col.x - 1, viewport()->height());
+    }
+
+    const int count = rowCount();
+    if (count == 0) {
+        painter.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+        painter.drawText(timeWidth + kTextMargin, rowHeight + fm.ascent(), placeholderText_);
+        return;
+    }
+
+    const int first = verticalScrollBar()->value();
+    const int last = qMin(count, first + visibleRowCount() + 1);
+    for (int viewRow = first; viewRow < last; ++viewRow) {
+        const int row = dataRow(viewRow);
+        const auto &entry = data_->line(row);
+        const auto type = static_cast<LogDataType>(entry.type);
+        const int y = rowHeight * (viewRow - first + 1);
+        const bool isMatchRow = isMatch(row);
+        const bool isCurrent = viewRow == currentRow_;
+
+        if (viewRow == selectedRow_)
+            painter.fillRect(0, y, timeWidth - 1, rowHeight, palette().highlight());
+        painter.setClipRect(0, y, timeWidth - 1, rowHeight);
+        painter.drawText(kTextMargin, y + fm.ascent(), LogIndex::timeToString(entry.time));
+
+        for (const auto &col : cols) {
+            // Aux lines are shown in all the columns.
+            if (col.type != LOG_TYPE_MIXED && type != LOG_TYPE_AUX && col.type != type)
+                continue;
+            const QRect rc(col.x, y, col.width, rowHeight);
+            painter.setClipRect(rc);
+            const QBrush brush = highlighter.lineBrush(type, isMatchRow, isCurrent);
+            if (brush.style() != Qt::NoBrush)
+                painter.fillRect(rc, brush);
+            const int maxLength = (hOffset + col.width) / charWidth + 8;
+            painter.drawText(col.x + kTextMargin - hOffset, y + fm.ascent(),
+                             rowText(row, col.type == LOG_TYPE_MIXED, maxLength));
+        }
+        painter.setClipping(false);
+    }
+}
+
+void LogView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LogView::keyPressEvent(QKeyEvent *event)
+{
+    if (event == QKeySequence::Copy && selectedRow_ >= 0 && selectedRow_ < rowCount()) {
+        const int row = dataRow(selectedRow_);
+        QApplication::clipboard()->setText(LogIndex::timeToString(data_->line(row).time) + " "
+                                           + rowText(row, true, -1));
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void LogView::mousePressEvent(QMouseEvent *event)
+{
+    const int rowHeight = QFontMetrics(font()).height();
+    const int viewRow = event->y() < rowHeight ? -1
+        : verticalScrollBar()->value() + (event->y() - rowHeight) / rowHeight;
+    selectedRow_ = viewRow < rowCount() ? viewRow : -1;
+    viewport()->update();
+    QAbstractScrollArea::mousePressEvent(event);
+}
+
+void LogView::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    viewport()->update();
+}
+
+QVector<LogView::Column> LogView::columns() const
+{
+    const QFontMetrics fm(font());
+    const int timeWidth = fm.width("00.00.00 00:00:00:000") + 2 * kTextMargin;
+    const int available = qMax(0, viewport()->width() - timeWidth);
+    QVector<Column> cols;
+    if (isMultiColumn_) {
+        for (int i = 0; i < NUM_LOG_TYPES; ++i) {
+            if (data_->hasType(static_cast<LogDataType>(i)))
+                cols.append({ 0, 0, static_cast<LogDataType>(i) });
+        }
+    }
+    if (cols.isEmpty())
+        cols.append({ 0, 0, LOG_TYPE_MIXED });
+    for (int i = 0; i < cols.size(); ++i) {
+        cols[i].x = timeWidth + available * i / cols.size();
+        cols[i].width = timeWidth + available * (i + 1) / cols.size() - cols[i].x;
+    }
+    return cols;
+}
+
+int LogView::visibleRowCount() const
+{
+    const int rowHeight = QFontMetrics(font()).height();
+    return qMax(1, viewport()->height() / rowHeight - 1);
+}
+
+bool LogView::isMatch(int dataRow) const
+{
+    return std::binary_search(matches_.constBegin(), matches_.constEnd(), dataRow);
+}
+
+QString LogView::rowText(int dataRow, bool withTypeMarker, int maxLength) const
+{
+    const char *kTypeMarker[] = { "G", "E", "S" };
+    const auto &entry = data_->line(dataRow);
+    const auto parts = data_->lineParts(dataRow);
+    // Only the visible part of a long line is decoded.
+    const int textLength = maxLength < 0 ? parts.textLength : qMin(parts.textLength, maxLength);
+    const QString text = QString::fromLocal8Bit(parts.text, textLength);
+    if (entry.type == LOG_TYPE_AUX)
+        return text;
+    return QString("%1%2[%3] %4").arg(withTypeMarker ? kTypeMarker[entry.type] : "",
+        isMatch(dataRow) ? "*" : ">", QString::fromLocal8Bit(parts.label, parts.labelLength), text);
+}
+
+void LogView::updateScrollBars()
+{
+    const int count = rowCount();
+    const int visible = visibleRowCount();
+    verticalScrollBar()->setRange(0, qMax(0, count - visible));
+    verticalScrollBar()->setPageStep(visible);
+
+    const QFontMetrics fm(font());
+    const auto cols = columns();
+    const int contentWidth = (data_->maxLineLength() + 16) * qMax(1, fm.averageCharWidth());
+    horizontalScrollBar()->setRange(0, qMax(0, contentWidth - cols.first().width));
+    horizontalScrollBar()->setPageStep(cols.first().width);
+    horizontalScrollBar()->setSingleStep(fm.averageCharWidth() * 4);
+}
@@ -0,0 +1,67 @@
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QVector>
+#include "common.h"
+
+class LogData;
+
+// Virtualized view of the log lines: only the rows in the visible window are read from the log data and
+// painted, so scrolling and jumping to a row don't depend on the size of the logs.
+class LogView final : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit LogView(const LogData *data, QWidget *parent = nullptr);
+
+    // |rows| - the rows of the log data shown, all of them if |isAllRows| is set; |matches| - ordered rows
+    // of the log data marked as filter matches. The current row is reset.
+    void setRows(const QVector<int> &rows, bool isAllRows, const QVector<int> &matches);
+    int rowCount() const;
+    // the row of the log data shown in view row |viewRow|
+    int dataRow(int viewRow) const { return isAllRows_ ? viewRow : rows_[viewRow]; }
+
+    void setMultiColumn(bool isMultiColumn);
+    void setHighlight(bool isHighlight);
+    void setPlaceholderText(const QString &text);
+    void setTitle(const QString &title);
+    // highlights the view row |viewRow| (-1 for none) and scrolls it into view
+    void setCurrentRow(int viewRow);
+    void scrollToBottom();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    struct Column
+    {
+        int x;
+        int width;
+        LogDataType type;   // LOG_TYPE_MIXED for the single combined column
+    };
+
+    QVector<Column> columns() const;
+    int visibleRowCount() const;
+    bool isMatch(int dataRow) const;
+    QString rowText(int dataRow, bool withTypeMarker, int maxLength) const;
+    void updateScrollBars();
+
+    const LogData *data_;
+    QVector<int> rows_;
+    QVector<int> matches_;
+    bool isAllRows_;
+    bool isMultiColumn_;
+    bool isHighlight_;
+    int currentRow_;
+    int selectedRow_;
+    QString placeholderText_;
+    QString title_;
+};
+
+#endif  // LOGVIEW_H
@@ -4,6 +4,33 @@
 #include <QFileInfo>
 #include <QMutexLocker>
 #include <QTextStream>
+#include <QtEndian>
+
+namespace {
+// The part of a file indexed at once.
+const qint64 kIndexChunkSize = 256 * 1024 * 1024;
+
+// rotated log generations (prev_log_*.txt.qz) are compressed with qCompress() in blocks, each preceded
+// by its size, big-endian (see LogRotator of the app)
+bool isCompressedLog(const QString &filename)
+{
+    return filename.endsWith(".qz");
+}
+
+QByteArray readCompressedLog(QFile &file)
+{
+    QByteArray text;
+    uchar header[4];
+    while (file.read(reinterpret_cast<char *>(header), sizeof(header)) == sizeof(header)) {
+        const quint32 block_size = qFromBigEndian<quint32>(header);
+        const QByteArray block = file.read(block_size);
+        if (block.size() != static_cast<int>(block_size))
+            break;
+        text += qUncompress(block);
+    }
+    return text;
+}
+}  // namespace
 
 
 LogWatcher::LogWatcher() : log_index_(0), is_watch_done_(false)
@@ -33,6 +60,7 @@ bool LogWatcher::add(const QString &filename, LogDataType type, LogRangeCheckTyp
         emit logIndexRemoved(it->index);
         it->datasize = 0;
         it->position = 0;
+        it->lasttime = -1;
         it->rangecheck = rangeCheck;
     }
     return true;
@@ -87,6 +115,7 @@ void LogWatcher::run()
                 if (it != logs_.end()) {
                     it->position = currentLogInfo[i].position;
                     it->datasize = currentLogInfo[i].datasize;
+                    it->lasttime = currentLogInfo[i].lasttime;
                 }
             }
             mutex_.unlock();
@@ -107,6 +136,7 @@ void LogWatcher::process(const QString &filename, LogFileInfo *info)
     const auto current_datasize = fi.size();
     if (info->datasize > current_datasize) {
         info->position = 0;
+        info->lasttime = -1;
         emit logIndexRemoved(info->index);
     } else {
         if (rangeCheck == LogRangeCheckType::MIN_TO_MAX)
@@ -115,25 +145,60 @@ void LogWatcher::process(const QString &filename, LogFileInfo *info)
     info->datasize = current_datasize;
     if (!current_datasize)
         return;
-    QStringList lines;
     QFile qf(filename);
     if (!qf.open(QIODevice::ReadOnly))
         return;
-    QTextStream qts(&qf);
-    qts.seek(info->position);
-    while (!qts.atEnd())
-        lines.append(qts.readLine());
-    info->position = qts.pos();
+    if (isCompressedLog(filename)) {
+        // A compressed generation is never appended to, it is replaced as a whole by the next
+        // rotation, so it is always read from the start.
+        if (info->position != 0)
+            emit logIndexRemoved(info->index);
+        const QByteArray text = readCompressedLog(qf);
+        qf.close();
+        info->lasttime = -1;
+        const auto lines = LogIndex::build(text.constData(), text.size(), 0, info->type,
+                                           &info->lasttime);
+        info->position = current_datasize;
+        if (!lines.empty())
+            emit logLinesReady(info->index, info->type, rangeCheck, lines, text);
+        return;
+    }
+
+    // The new part is indexed in big chunks, so the first lines of a huge log show up early.
+    while (info->position < current_datasize && !is_watch_done_) {
+        const qint64 chunk_size = qMin(current_datasize - info->position, kIndexChunkSize);
+        const uchar *map = qf.map(info->position, chunk_size);
+        if (!map)
+            break;
+        const char *data = reinterpret_cast<const char *>(map);
+        // Only complete lines are indexed, the rest is picked up once the line is finished; a single
+        // line longer than a chunk is indexed up to the chunk end.
+        qint64 indexed_size = chunk_size;
+        while (indexed_size > 0 && data[indexed_size - 1] != '\n')
+            --indexed_size;
+        if (indexed_size == 0 && chunk_size == kIndexChunkSize)
+            indexed_size = chunk_size;
+        if (indexed_size == 0) {
+            qf.unmap(const_cast<uchar *>(map));
+            break;
+        }
+        const auto lines = LogIndex::build(data, indexed_size, info->position, info->type,
+                                           &info->lasttime);
+        // The indexed text is copied, so a log being written is not held open or mapped while it is
+        // shown, and can be rotated or removed meanwhile.
+        const QByteArray text(data, static_cast<int>(indexed_size));
+        qf.unmap(const_cast<uchar *>(map));
+        info->position += indexed_size;
+        emit logLinesReady(info->index, info->type, rangeCheck, lines, text);
+    }
     qf.close();
-    if (!lines.empty())
-        emit logLinesReady(lines, info->type, info->index, rangeCheck);
 }
 
 // static
 LogDataType LogWatcher::detectLogType(const QString &filename)
 {
     QFile qf(filename);
-    if (qf.open(QIODevice::ReadOnly)) {
+    if (!isCompressedLog(filename) && qf.open(QIODevice::ReadOnly)) {
         QTextStream qts(&qf);
         QString line;
         while (line.isEmpty() || line.startsWith("==="))
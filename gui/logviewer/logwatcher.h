@@ -6,8 +6,11 @@
 #include <QMutex>
 #include <QThread>
 #include "common.h"
+#include "logindex.h"
 
 
+// Watches the added log files from a background thread and indexes the lines appended to them: the new part of
+// a file is memory-mapped while it is indexed, then the line index and a copy of the text are passed on.
 class LogWatcher final : public QThread
 {
     Q_OBJECT
@@ -25,19 +28,23 @@ public:
     static LogDataType detectLogType(const QString &filename);
 
 signals:
-    void logLinesReady(QStringList lines, LogDataType type, quint32 index,
-                       LogRangeCheckType rangeCheck);
+    // |text| - a copy of the text the lines were indexed from, it continues the text sent before for the same
+    // |index|; the file itself is closed once the lines are indexed
+    void logLinesReady(quint32 index, LogDataType type, LogRangeCheckType rangeCheck, QVector<LogLine> lines,
+                       QByteArray text);
     void logTypeRemoved(LogDataType type);
     void logIndexRemoved(quint32 index);
 
 private:
     struct LogFileInfo {
-        LogFileInfo() : position(0), datasize(-1), index(0), type(LOG_TYPE_UNKNOWN),
+        LogFileInfo() : position(0), datasize(-1), lasttime(-1), index(0), type(LOG_TYPE_UNKNOWN),
                         rangecheck(LogRangeCheckType::NONE) {}
         LogFileInfo(LogDataType theType, quint32 theIndex, LogRangeCheckType rangeCheck)
-            : position(0), datasize(-1), index(theIndex), type(theType), rangecheck(rangeCheck) {}
+            : position(0), datasize(-1), lasttime(-1), index(theIndex), type(theType),
+              rangecheck(rangeCheck) {}
         qint64 position;
         qint64 datasize;
+        qint64 lasttime;
         quint32 index;
         LogDataType type;
         LogRangeCheckType rangecheck;
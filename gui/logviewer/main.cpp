@@ -1,3 +1,4 @@
+#include "logindex.h"
 #include "mainwindow.h"
 
 #include <QApplication>
@@ -8,6 +9,7 @@ namespace
 {
 const int typeIdLogDataType = qRegisterMetaType<LogDataType>("LogDataType");
 const int typeIdLogRangeCheckType = qRegisterMetaType<LogRangeCheckType>("LogRangeCheckType");
+const int typeIdLogLines = qRegisterMetaType<QVector<LogLine>>("QVector<LogLine>");
 
 QStringList parseCommandLine()
 {
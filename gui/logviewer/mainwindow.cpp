@@ -1,7 +1,7 @@
 #include "mainwindow.h"
 #include "logdata.h"
+#include "logview.h"
 #include "logwatcher.h"
-#include "texthighlighter.h"
 
 #include <QApplication>
 #include <QCheckBox>
@@ -15,23 +15,18 @@
 #include <QLineEdit>
 #include <QMessageBox>
 #include <QMimeData>
-#include <QPlainTextEdit>
 #include <QPushButton>
 #include <QScreen>
-#include <QScrollBar>
-#include <QSplitter>
 #include <QStandardPaths>
-#include <QTextBlock>
 #include <QToolButton>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QWindow>
+#include <algorithm>
 
 
 namespace
 {
-const char *kLogTitles[NUM_LOG_TYPES] = { "GUI", "Engine", "Service" };
-
 QFont GetMonospaceFont(int pointSize)
 {
     QFont font("monospace", pointSize);
@@ -53,8 +48,7 @@ MainWindow::MainWindow() : QWidget(), dpiScale_(1.0), logAutoScrollMode_(true),
                            checkRangeOnAppend_(CheckRangeMode::NO),
                            openFilePath_(QStandardPaths::writableLocation(
                                QStandardPaths::DataLocation)),
-                           isFilterCI_(true), isHideUnmatched_(true), textVisibilityMask_(0),
-                           currentFilterMatch_(-1), previousFilterMatch_(-1)
+                           isFilterCI_(true), isHideUnmatched_(true), currentFilterMatch_(-1)
 {
     // Default path for logs.
     openFilePath_.replace(qApp->applicationName(), "Windscribe2");
@@ -123,39 +117,9 @@ MainWindow::MainWindow() : QWidget(), dpiScale_(1.0), logAutoScrollMode_(true),
     filterTimer_->setSingleShot(true);
     connect(filterTimer_, SIGNAL(timeout()), SLOT(applyFilter()));
 
-    timeLabel_ = new QLabel(tr("Timestamp") + ":", this);
-    timeEdit_ = new QPlainTextEdit(this);
-    timeEdit_->setReadOnly(true);
-    timeEdit_->setUndoRedoEnabled(false);
-    timeEdit_->setMaximumWidth(timeEdit_->minimumWidth());
-    timeEdit_->setLineWrapMode(QPlainTextEdit::NoWrap);
-    timeEdit_->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-    timeEdit_->setPalette(window_backround_palette);
-    timeEdit_->setAutoFillBackground(true);
-    QSplitter *splitter = new QSplitter(this);
-    for (int i = 0; i < NUM_LOG_TYPES; ++i) {
-        textLabel_[i] = new QLabel(tr(kLogTitles[i]) + ":", this);
-        textEdit_[i] = new QPlainTextEdit(this);
-        textEdit_[i]->setReadOnly(true);
-        textEdit_[i]->setUndoRedoEnabled(false);
-        textEdit_[i]->setLineWrapMode(QPlainTextEdit::NoWrap);
-        textEdit_[i]->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-        textEdit_[i]->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-        textEdit_[i]->setPalette(window_backround_palette);
-        textEdit_[i]->setAutoFillBackground(true);
-        connect(timeEdit_->verticalScrollBar(), SIGNAL(valueChanged(int)),
-                textEdit_[i]->verticalScrollBar(), SLOT(setValue(int)));
-        connect(textEdit_[i]->verticalScrollBar(), SIGNAL(valueChanged(int)),
-                timeEdit_->verticalScrollBar(), SLOT(setValue(int)));
-        auto *vlayout = new QVBoxLayout;
-        vlayout->setContentsMargins(0, 0, 0, 0);
-        vlayout->addWidget(textLabel_[i]);
-        vlayout->addWidget(textEdit_[i], 1);
-        textWidget_[i] = new QWidget;
-        textWidget_[i]->setLayout(vlayout);
-        textWidget_[i]->setVisible(false);
-        splitter->addWidget(textWidget_[i]);
-    }
+    logView_ = new LogView(logData_.get(), this);
+    logView_->setPalette(window_backround_palette);
+    logView_->setAutoFillBackground(true);
 
     // Setup layouts.
     auto *toplayout = new QHBoxLayout;
@@ -173,18 +137,11 @@ MainWindow::MainWindow() : QWidget(), dpiScale_(1.0), logAutoScrollMode_(true),
     toplayout->addWidget(cbHideUnmatched_);
     toplayout->addWidget(btnNavigate_[0]);
     toplayout->addWidget(btnNavigate_[1]);
-    auto *loghlayout = new QHBoxLayout;
-    auto *logvlayout = new QVBoxLayout;
-    logvlayout->addWidget(timeLabel_);
-    logvlayout->addWidget(timeEdit_, 1);
-    loghlayout->setAlignment(Qt::AlignCenter);
-    loghlayout->addLayout(logvlayout);
-    loghlayout->addWidget(splitter);
     auto *vlayout = new QVBoxLayout(this);
     vlayout->setAlignment(Qt::AlignCenter);
     vlayout->addLayout(toplayout);
     vlayout->addWidget(horzLine);
-    vlayout->addLayout(loghlayout);
+    vlayout->addWidget(logView_, 1);
 
     // Make size of dialog to 70% of desktop size.
     const auto *desktopWidget = QApplication::desktop();
@@ -196,8 +153,9 @@ MainWindow::MainWindow() : QWidget(), dpiScale_(1.0), logAutoScrollMode_(true),
 
     // Setup log watching.
     connect(logWatcher_.get(),
-            SIGNAL(logLinesReady(QStringList, LogDataType, quint32, LogRangeCheckType)),
-            logData_.get(), SLOT(addLines(QStringList, LogDataType, quint32, LogRangeCheckType)));
+            SIGNAL(logLinesReady(quint32, LogDataType, LogRangeCheckType, QVector<LogLine>, QByteArray)),
+            logData_.get(), SLOT(addLines(quint32, LogDataType, LogRangeCheckType, QVector<LogLine>,
+                                          QByteArray)));
     connect(logWatcher_.get(), SIGNAL(logTypeRemoved(LogDataType)),
             logData_.get(), SLOT(clearDataByLogType(LogDataType)));
     connect(logWatcher_.get(), SIGNAL(logIndexRemoved(quint32)),
@@ -243,7 +201,7 @@ void MainWindow::initLogData(const QStringList &filenames)
 void MainWindow::openLogFile()
 {
     auto filenames = QFileDialog::getOpenFileNames(
-        this, tr("Append Logs"), openFilePath_, tr("All files (*.*)"), nullptr,
+        this, tr("Append Logs"), openFilePath_, tr("All files (*.*);;Compressed logs (*.qz)"), nullptr,
         QFileDialog::DontResolveSymlinks);
     if (filenames.empty())
         return;
@@ -282,7 +240,7 @@ void MainWindow::setHighlight(bool value)
     if (logHightlightMode_ == value)
         return;
     logHightlightMode_ = value;
-    updateHighlight();
+    logView_->setHighlight(value);
 }
 
 void MainWindow::setMultiColumn(bool value)
@@ -350,12 +308,9 @@ void MainWindow::gotoPrevMatch()
         return;
 
     const int numFilterMatches = filterMatches_.size();
-    previousFilterMatch_ = currentFilterMatch_;
     if (--currentFilterMatch_ < 0)
         currentFilterMatch_ = numFilterMatches-1;
-    const int lineNumber = filterMatches_[currentFilterMatch_];
-    ensureLineNumberVisible(lineNumber);
-    updateHighlight(/*update_matching_lines_only=*/true);
+    logView_->setCurrentRow(filterMatches_[currentFilterMatch_]);
     updateMatchLabel();
 }
 
@@ -365,19 +320,23 @@ void MainWindow::gotoNextMatch()
         return;
 
     const int numFilterMatches = filterMatches_.size();
-    previousFilterMatch_ = currentFilterMatch_;
     if (++currentFilterMatch_ >= numFilterMatches)
         currentFilterMatch_ = 0;
-    const int lineNumber = filterMatches_[currentFilterMatch_];
-    ensureLineNumberVisible(lineNumber);
-    updateHighlight(/*update_matching_lines_only=*/true);
+    logView_->setCurrentRow(filterMatches_[currentFilterMatch_]);
     updateMatchLabel();
 }
 
 void MainWindow::onDataUpdated()
 {
+    // Only the rows after the unchanged ones are filtered again.
+    const int unchangedRows = logData_->takeUnchangedRowCount();
+    if (!currentFilter_.isEmpty()) {
+        matchingRows_.erase(std::lower_bound(matchingRows_.begin(), matchingRows_.end(), unchangedRows),
+                            matchingRows_.end());
+        matchingRows_ += logData_->findMatches(currentFilter_.toLocal8Bit(), isFilterCI_, unchangedRows);
+    }
     updatePlaceholderText();
-    updateDisplay();
+    updateRows();
     updateScroll();
 }
 
@@ -437,8 +396,8 @@ void MainWindow::appendLogFromFile(const QString &filename)
 
 void MainWindow::setOverrideCursorIfNeeded()
 {
-    const int kDataSizeTooLarge = 5000;
-    if (overrideCursorSet_ || logData_->data().size() < kDataSizeTooLarge)
+    const int kDataSizeTooLarge = 1000000;
+    if (overrideCursorSet_ || logData_->lineCount() < kDataSizeTooLarge)
         return;
     qApp->setOverrideCursor(Qt::WaitCursor);
     overrideCursorSet_ = true;
@@ -452,31 +411,12 @@ void MainWindow::restoreOverrideCursor()
     }
 }
 
-bool MainWindow::checkFilter(LogDataType type, const QString &text) const
-{
-    if (type == LOG_TYPE_AUX || currentFilter_.isEmpty())
-        return true;
-    return text.contains(currentFilter_, isFilterCI_ ? Qt::CaseInsensitive : Qt::CaseSensitive);
-}
-
-void MainWindow::ensureLineNumberVisible(int lineNumber)
-{
-    const QTextCursor timeCursor(timeEdit_->document()->findBlockByLineNumber(lineNumber));
-    timeEdit_->setTextCursor(timeCursor);
-    for (int i = 0; i < NUM_LOG_TYPES; ++i) {
-        if (!(textVisibilityMask_ & (1 << i)))
-            continue;
-        const QTextCursor textCursor(textEdit_[i]->document()->findBlockByLineNumber(lineNumber));
-        textEdit_[i]->setTextCursor(textCursor);
-    }
-}
-
 void MainWindow::updatePlaceholderText()
 {
     if (!logData_->numTypes() || currentFilter_.isEmpty())
-        textEdit_[0]->setPlaceholderText(tr("Logs are empty"));
+        logView_->setPlaceholderText(tr("Logs are empty"));
     else
-        textEdit_[0]->setPlaceholderText(tr("No lines matching \"%1\"")
+        logView_->setPlaceholderText(tr("No lines matching \"%1\"")
             .arg(isFilterCI_ ? currentFilter_.toLower() : currentFilter_));
 }
 
@@ -492,13 +432,7 @@ void MainWindow::updateScale()
     dpiScale_ = 1.0;
 #endif
     // Using fixed-pitch fonts.
-    const auto textFont{ GetMonospaceFont(font().pointSize()) };
-    const int timeEditTextWidth = QFontMetrics(textFont).width("00.00.00 00:00:00:000");
-
-    timeEdit_->setFont(textFont);
-    timeEdit_->setMinimumWidth(25 * dpiScale_ + timeEditTextWidth);
-    for (int i = 0; i < NUM_LOG_TYPES; ++i)
-        textEdit_[i]->setFont(textFont);
+    logView_->setFont(GetMonospaceFont(font().pointSize()));
 
     btnOpenLog_->setFont(font());
     btnClearLog_->setFont(font());
@@ -506,182 +440,46 @@ void MainWindow::updateScale()
     matchLabel_->setFixedWidth(60 * dpiScale_);
 }
 
-void MainWindow::updateHighlight(bool update_matching_lines_only)
+void MainWindow::updateDisplay()
 {
-    const bool kIsMulti = logDisplayMode_ == LogDisplayMode::MULTI_COLUMNS
-        && logData_->numTypes() > 1;
-
-    int currentFilterMatchLine = -1;
-    if (!isHideUnmatched_ && !filterMatches_.isEmpty() && currentFilterMatch_ >= 0)
-        currentFilterMatchLine = filterMatches_[currentFilterMatch_];
-
-    setOverrideCursorIfNeeded();
-    for (int i = 0; i < NUM_LOG_TYPES; ++i) {
-        if (!textWidget_[i]->isVisible())
-            continue;
-        TextHighlighter th(logHightlightMode_, currentFilterMatchLine,
-                           kIsMulti ? static_cast<LogDataType>(i) : LOG_TYPE_MIXED);
-        QList<int> lineNumbers;
-        if (update_matching_lines_only) {
-            if (previousFilterMatch_ >= 0)
-                lineNumbers.push_back(filterMatches_[previousFilterMatch_]);
-            if (currentFilterMatch_ >= 0)
-                lineNumbers.push_back(filterMatches_[currentFilterMatch_]);
-        }
-        th.processDocument(textEdit_[i]->document(), lineNumbers);
-    }
-    restoreOverrideCursor();
+    filterTimer_->stop();
+    logData_->takeUnchangedRowCount();
+    matchingRows_.clear();
+    if (!currentFilter_.isEmpty())
+        matchingRows_ = logData_->findMatches(currentFilter_.toLocal8Bit(), isFilterCI_, 0);
+    updateRows();
 }
 
-void MainWindow::updateDisplay()
+void MainWindow::updateRows()
 {
     const bool kIsMulti = logDisplayMode_ == LogDisplayMode::MULTI_COLUMNS
         && logData_->numTypes() > 1;
- 
-    const int scrollPos = timeEdit_->verticalScrollBar()->value();
-    const auto &lines = logData_->data();
-    const auto global_info = logData_->getDataSizeForType(LOG_TYPE_MIXED);
-    const int oldvismask = textVisibilityMask_;
-    const bool kHasFilter = !currentFilter_.isEmpty();
-    QString texts[NUM_LOG_TYPES];
-    int nonAuxLineCount[NUM_LOG_TYPES] = {};
-
-    filterTimer_->stop();
 
-    textVisibilityMask_ = 0;
     filterMatches_.clear();
-    previousFilterMatch_ = currentFilterMatch_ = -1;
-
-    QString time_string;
-    time_string.reserve(global_info.first * 22); // Estimated timestamp size.
-
-    if (kIsMulti) {
-        QString timestamp;
-        int timestamp_lines[NUM_LOG_TYPES] = {};
-        int timestamp_line_count = 0;
-        auto trim_lines = [&](const QString &timestamp) {
-            const int add =
-                qMax(qMax(timestamp_lines[0], timestamp_lines[1]), timestamp_lines[2]);
-            for (int i = 0; i < NUM_LOG_TYPES; ++i) {
-                const int c = add - timestamp_lines[i];
-                if (c > 0)
-                    texts[i].append(QString().fill('\n', c));
-            }
-            for (int i = 1; i < add; ++i)
-                time_string.append(timestamp + "\n");
-            timestamp_line_count += qMax(0, add - 1);
-        };
-        for (int i = 0; i < NUM_LOG_TYPES; ++i) {
-            const auto local_info = logData_->getDataSizeForType(static_cast<LogDataType>(i));
-            texts[i].reserve(local_info.second + local_info.first * 6  // Estimated line sizes.
-                             + (global_info.first - local_info.first));
-        }
-        int counter = 1, prevmatch = -1;
-        LogDataType prevtype = LOG_TYPE_UNKNOWN;
-        for (auto it = lines.constBegin(); it != lines.constEnd(); ++it) {
-            bool is_filter_match = false;
-            if (kHasFilter) {
-                is_filter_match = checkFilter(it->type, it->text);
-                if (!is_filter_match && isHideUnmatched_)
-                    continue;
-             }
-            if (it->type == LOG_TYPE_AUX || timestamp != it->timestamp) {
-                if (!timestamp.isEmpty()) {
-                    trim_lines(timestamp);
-                    memset(timestamp_lines, 0, sizeof(timestamp_lines));
-                }
-                counter = timestamp_line_count++;
-                time_string.append(it->timestamp + "\n");
-                timestamp = it->timestamp;
-            }
-            if (it->type == LOG_TYPE_AUX) {
-                for (int i = 0; i < NUM_LOG_TYPES; ++i)
-                    texts[i].append(QString("%1\n").arg(it->text));
-            } else {
-                if (it->type == prevtype) {
-                    ++counter;
-                } else {
-                    counter = timestamp_line_count;
-                    prevtype = it->type;
-                }
-                ++timestamp_lines[it->type];
-                ++nonAuxLineCount[it->type];
-                texts[it->type].append(QString("%1[%2] %3\n")
-                    .arg(is_filter_match && !isHideUnmatched_ ? "*" : ">",it->label, it->text));
-            }
-            if (is_filter_match) {
-                if (counter > prevmatch + 1)
-                    filterMatches_.push_back(counter-1);
-                prevmatch = counter;
-            }
-        }
-        trim_lines(timestamp);
-        textLabel_[0]->setText(tr(kLogTitles[0]) + ":");
+    currentFilterMatch_ = -1;
+
+    logView_->setMultiColumn(kIsMulti);
+    logView_->setTitle(tr("Combined Logs") + ":");
+    if (currentFilter_.isEmpty()) {
+        logView_->setRows(QVector<int>(), true, QVector<int>());
+    } else if (isHideUnmatched_) {
+        logView_->setRows(matchingRows_, false, QVector<int>());
     } else {
-        const char *kTypeMarker[] = { "G", "E", "S" };
-        texts[0].reserve(global_info.second + global_info.first * 6); // Estimated line sizes.
-        int counter = 0, prevmatch = 0;
-        for (auto it = lines.constBegin(); it != lines.constEnd(); ++it) {
-            bool is_filter_match = false;
-            if (kHasFilter) {
-                is_filter_match = checkFilter(it->type, it->text);
-                if (!is_filter_match && isHideUnmatched_)
-                    continue;
-                if (is_filter_match) {
-                    if (counter != prevmatch + 1)
-                        filterMatches_.push_back(counter);
-                    prevmatch = counter;
-                }
-                ++counter;
-            }
-            time_string.append(it->timestamp + "\n");
-            if (it->type == LOG_TYPE_AUX) {
-                texts[0].append(QString("%1\n").arg(it->text));
-                continue;
-            }
-            ++nonAuxLineCount[0];
-            texts[0].append(QString("%1%2[%3] %4\n").arg(kTypeMarker[it->type],
-                is_filter_match && !isHideUnmatched_ ? "*" : ">", it->label, it->text));
-        }
-        textLabel_[0]->setText(tr("Combined Logs") + ":");
-    }
-
-    // If we don't hide unmatched lines, and there are no matches, clear the log anyway to prevent
-    // confusion.
-    if (kHasFilter && !isHideUnmatched_ && filterMatches_.isEmpty()) {
-        time_string.clear();
-        for (int i = 0; i < NUM_LOG_TYPES; ++i)
-            texts[i].clear();
-    }
-
-    timeEdit_->setPlainText(time_string);
-
-    for (int i = 0; i < NUM_LOG_TYPES; ++i) {
-        const bool is_empty = texts[i].trimmed().isEmpty();
-        if (!is_empty && nonAuxLineCount[i]) {
-            textEdit_[i]->setPlainText(texts[i]);
-            textWidget_[i]->setVisible(true);
-            textVisibilityMask_ |= (1 << i);
-        } else {
-            textEdit_[i]->clear();
-            textWidget_[i]->setVisible(false);
+        int prevmatch = -2;
+        for (int row : matchingRows_) {
+            if (row != prevmatch + 1)
+                filterMatches_.push_back(row);
+            prevmatch = row;
         }
+        // If we don't hide unmatched lines, and there are no matches, clear the log anyway to prevent
+        // confusion.
+        if (filterMatches_.isEmpty())
+            logView_->setRows(QVector<int>(), false, QVector<int>());
+        else
+            logView_->setRows(QVector<int>(), true, matchingRows_);
     }
 
     cbMultiColumn_->setEnabled(logData_->numTypes() > 1);
-    if (!textVisibilityMask_) {
-        timeEdit_->clear();
-        textWidget_[0]->setVisible(true);
-    } else {
-        timeEdit_->verticalScrollBar()->setValue(scrollPos);
-    }
-
-    if (logHightlightMode_) {
-        if (textVisibilityMask_ == oldvismask)
-            updateHighlight();
-        else
-            QTimer::singleShot(0, [&]() { updateHighlight(); });
-    }
 
     if (!filterMatches_.isEmpty())
         gotoNextMatch();
@@ -690,12 +488,8 @@ void MainWindow::updateDisplay()
 
 void MainWindow::updateScroll()
 {
-    if (logAutoScrollMode_) {
-        QTimer::singleShot(0, [&]() {
-            timeEdit_->verticalScrollBar()->setValue(
-                timeEdit_->verticalScrollBar()->maximum());
-        });
-    }
+    if (logAutoScrollMode_)
+        logView_->scrollToBottom();
 }
 
 void MainWindow::updateMatchLabel()
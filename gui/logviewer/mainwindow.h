@@ -7,7 +7,6 @@
 
 class QDragEnterEvent;
 class QDropEvent;
-class QPlainTextEdit;
 class QPushButton;
 class QCheckBox;
 class QLabel;
@@ -15,6 +14,7 @@ class QLineEdit;
 class QToolButton;
 class LogWatcher;
 class LogData;
+class LogView;
 
 class MainWindow : public QWidget
 {
@@ -52,20 +52,14 @@ private:
     void appendLogFromFile(const QString &filename);
     void setOverrideCursorIfNeeded();
     void restoreOverrideCursor();
-    bool checkFilter(LogDataType type, const QString &text) const;
-    void ensureLineNumberVisible(int lineNumber);
     void updatePlaceholderText();
     void updateScale();
-    void updateHighlight(bool update_matching_lines_only = false);
     void updateDisplay();
+    void updateRows();
     void updateScroll();
     void updateMatchLabel();
  
-    QPlainTextEdit *timeEdit_;
-    QPlainTextEdit *textEdit_[NUM_LOG_TYPES];
-    QLabel *timeLabel_;
-    QLabel *textLabel_[NUM_LOG_TYPES];
-    QWidget *textWidget_[NUM_LOG_TYPES];
+    LogView *logView_;
     QPushButton *btnOpenLog_;
     QPushButton *btnSaveLog_;
     QPushButton *btnClearLog_;
@@ -92,10 +86,9 @@ private:
     QString currentFilter_;
     bool isFilterCI_;
     bool isHideUnmatched_;
-    int textVisibilityMask_;
     int currentFilterMatch_;
-    int previousFilterMatch_;
-    QVector<int> filterMatches_;
+    QVector<int> filterMatches_;    // First rows of the blocks of matching rows.
+    QVector<int> matchingRows_;     // Log data rows matching the filter.
 };
 
 #endif  // MAINWINDOW_H
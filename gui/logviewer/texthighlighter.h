@@ -1,16 +1,15 @@
 #ifndef TEXTHIGHLIGHTER_H
 #define TEXTHIGHLIGHTER_H
 
+#include <QBrush>
 #include "common.h"
 
-class QTextBlock;
-class QTextDocument;
-
 class TextHighlighter
 {
 public:
-    TextHighlighter(bool do_highlight, int current_filter_match_line, LogDataType type);
-    void processDocument(QTextDocument *doc, const QList<int> &lines) const;
+    explicit TextHighlighter(bool do_highlight);
+    // background of a displayed line
+    QBrush lineBrush(LogDataType type, bool is_match, bool is_current) const;
 
 private:
     enum BlockColorType {
@@ -22,11 +21,9 @@ private:
         COLOR_TYPE_CURRENT,
         NUM_COLOR_TYPES
     };
-    BlockColorType getBlockType(const QTextBlock &block, int block_number) const;
+    BlockColorType getBlockType(LogDataType type, bool is_match, bool is_current) const;
 
     bool do_highlight_;
-    int current_filter_match_line_;
-    LogDataType log_data_type_;
 };
 
 #endif  // TEXTHIGHLIGHTER_H
@@ -21,6 +21,8 @@ macx {
 
 SOURCES += \
     logdata.cpp \
+    logindex.cpp \
+    logview.cpp \
     logwatcher.cpp \
     main.cpp \
     mainwindow.cpp \
@@ -29,6 +31,8 @@ SOURCES += \
 HEADERS += \
     common.h \
     logdata.h \
+    logindex.h \
+    logview.h \
     logwatcher.h \
     mainwindow.h \
     texthighlighter.h